@@ -11,6 +11,7 @@
 #include <cstdarg>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 typedef enum
 {
@@ -32,9 +33,21 @@ struct DMDUtil_PUPTriggerCallbackContext
 namespace DMDUtil
 {
 
+// An additional ZeDMD on a serial port, for example a topper next to the DMD.
+struct ZeDMDOutputConfig
+{
+  std::string device;       // Empty searches the ports no other ZeDMD uses.
+  int brightness = -1;      // -1 keeps the setting of the ZeDMD.
+  int roundedCorners = -1;  // -1 follows GetRoundedCorners().
+};
+
 class DMDUTILAPI Config
 {
  public:
+  // Standalone instances can be passed to DMD(const Config&), the global instance stays the default.
+  Config();
+  virtual ~Config() {}
+
   static Config* GetInstance();
   static void SetInstance(Config* pInstance);
   virtual void parseConfigFile(const char* path);
@@ -54,8 +67,10 @@ class DMDUTILAPI Config
   void SetPUPExactColorMatch(bool exactColorMatch) { m_pupExactColorMatch = exactColorMatch; }
   void SetIgnoreUnknownFramesTimeout(int framesTimeout) { m_framesTimeout = framesTimeout; }
   void SetMaximumUnknownFramesToSkip(int framesToSkip) { m_framesToSkip = framesToSkip; }
-  int GetIgnoreUnknownFramesTimeout() { return m_framesTimeout; }
-  int GetMaximumUnknownFramesToSkip() { return m_framesToSkip; }
+  int GetIgnoreUnknownFramesTimeout() const { return m_framesTimeout; }
+  int GetMaximumUnknownFramesToSkip() const { return m_framesToSkip; }
+  bool IsSerumCROMcCache() const { return m_serumCROMcCache; }
+  void SetSerumCROMcCache(bool serumCROMcCache) { m_serumCROMcCache = serumCROMcCache; }
   bool IsShowNotColorizedFrames() const { return m_showNotColorizedFrames; }
   void SetShowNotColorizedFrames(bool showNotColorizedFrames) { m_showNotColorizedFrames = showNotColorizedFrames; }
   bool IsExcludeColorizedFramesForZeDMD() const { return m_excludeColorizedFramesForZeDMD; }
@@ -86,6 +101,16 @@ class DMDUTILAPI Config
   const char* GetDumpPath() const { return m_dumpPath.c_str(); }
   bool IsDumpZip() const { return m_dumpZip; }
   void SetDumpZip(bool dumpZip) { m_dumpZip = dumpZip; }
+  int GetDumpRotateMaxSize() const { return m_dumpRotateMaxSize; }
+  void SetDumpRotateMaxSize(int megabytes) { m_dumpRotateMaxSize = megabytes; }
+  int GetDumpRotateMaxFrames() const { return m_dumpRotateMaxFrames; }
+  void SetDumpRotateMaxFrames(int frames) { m_dumpRotateMaxFrames = frames; }
+  int GetDumpRotateMaxDuration() const { return m_dumpRotateMaxDuration; }
+  void SetDumpRotateMaxDuration(int seconds) { m_dumpRotateMaxDuration = seconds; }
+  int GetDumpRotateIdle() const { return m_dumpRotateIdle; }
+  void SetDumpRotateIdle(int seconds) { m_dumpRotateIdle = seconds; }
+  int GetDumpRetentionSize() const { return m_dumpRetentionSize; }
+  void SetDumpRetentionSize(int megabytes) { m_dumpRetentionSize = megabytes; }
   bool IsFilterTransitionalFrames() const { return m_filterTransitionalFrames; }
   void SetFilterTransitionalFrames(bool filterTransitionalFrames)
   {
@@ -101,6 +126,12 @@ class DMDUTILAPI Config
   void SetZeDMDDebug(bool debug) { m_zedmdDebug = debug; }
   int GetZeDMDBrightness() const { return m_zedmdBrightness; }
   void SetZeDMDBrightness(int brightness) { m_zedmdBrightness = brightness; }
+  // Rounded corners of the ZeDMD opened by serial, WiFi or SPI, -1 follows GetRoundedCorners().
+  int GetZeDMDRoundedCorners() const { return m_zedmdRoundedCorners; }
+  void SetZeDMDRoundedCorners(int roundedCorners) { m_zedmdRoundedCorners = roundedCorners; }
+  void AddZeDMDOutput(const ZeDMDOutputConfig& output) { m_zedmdOutputs.push_back(output); }
+  void ClearZeDMDOutputs() { m_zedmdOutputs.clear(); }
+  const std::vector<ZeDMDOutputConfig>& GetZeDMDOutputs() const { return m_zedmdOutputs; }
   bool IsZeDMDWiFiEnabled() const { return m_zedmdWiFiEnabled; }
   void SetZeDMDWiFiEnabled(bool WiFiEnabled) { m_zedmdWiFiEnabled = WiFiEnabled; }
   const char* GetZeDMDWiFiAddr() const { return m_zedmdWiFiAddr.c_str(); }
@@ -121,19 +152,22 @@ class DMDUTILAPI Config
   const char* GetPixelcadeDevice() const { return m_pixelcadeDevice.c_str(); }
   bool IsPIN2DMD() const { return m_PIN2DMD; }
   void SetPIN2DMD(bool PIN2DMD) { m_PIN2DMD = PIN2DMD; }
+  // File that keeps the serial ports of the displays found last, empty disables it.
+  void SetDiscoveryCachePath(const char* path) { m_discoveryCachePath = path; }
+  const char* GetDiscoveryCachePath() const { return m_discoveryCachePath.c_str(); }
   void SetDMDServer(bool dmdServer)
   {
     m_dmdServer = dmdServer;
     // backward compatibility, use SetLocalDisplaysActive() afterwards to use both.
     m_localDisplaysActive = !dmdServer;
   }
-  bool IsDmdServer() { return m_dmdServer; }
+  bool IsDmdServer() const { return m_dmdServer; }
   void SetDMDServerAddr(const char* addr) { m_dmdServerAddr = addr; }
   const char* GetDMDServerAddr() const { return m_dmdServerAddr.c_str(); }
   void SetDMDServerPort(int port) { m_dmdServerPort = port; }
   int GetDMDServerPort() const { return m_dmdServerPort; }
   void SetLocalDisplaysActive(bool localDisplaysActive) { m_localDisplaysActive = localDisplaysActive; }
-  bool IsLocalDisplaysActive() { return m_localDisplaysActive; }
+  bool IsLocalDisplaysActive() const { return m_localDisplaysActive; }
   DMDUtil_LogLevel GetLogLevel() const { return m_logLevel; }
   void SetLogLevel(DMDUtil_LogLevel logLevel) { m_logLevel = logLevel; }
   DMDUtil_LogCallback GetLogCallback() const { return m_logCallback; }
@@ -145,10 +179,6 @@ class DMDUTILAPI Config
     m_pupTriggerCallbackContext.pUserData = pUserData;
   }
 
- protected:
-  Config();
-  virtual ~Config() {}
-
  private:
   static Config* m_pInstance;
   bool m_altColor;
@@ -160,6 +190,7 @@ class DMDUTILAPI Config
   bool m_pupExactColorMatch;
   int m_framesTimeout;
   int m_framesToSkip;
+  bool m_serumCROMcCache;
   bool m_showNotColorizedFrames;
   bool m_excludeColorizedFramesForZeDMD;
   bool m_excludeColorizedFramesForRGB24DMD;
@@ -169,12 +200,19 @@ class DMDUTILAPI Config
   bool m_dumpFrames;
   std::string m_dumpPath;
   bool m_dumpZip;
+  int m_dumpRotateMaxSize;
+  int m_dumpRotateMaxFrames;
+  int m_dumpRotateMaxDuration;
+  int m_dumpRotateIdle;
+  int m_dumpRetentionSize;
   bool m_filterTransitionalFrames;
   int m_roundedCorners;
   bool m_zedmd;
   std::string m_zedmdDevice;
   bool m_zedmdDebug;
   int m_zedmdBrightness;
+  int m_zedmdRoundedCorners;
+  std::vector<ZeDMDOutputConfig> m_zedmdOutputs;
   bool m_zedmdWiFiEnabled;
   std::string m_zedmdWiFiAddr;
   bool m_zedmdSpiEnabled;
@@ -189,6 +227,7 @@ class DMDUTILAPI Config
   bool m_pixelcade;
   std::string m_pixelcadeDevice;
   bool m_PIN2DMD;
+  std::string m_discoveryCachePath;
   DMDUtil_LogLevel m_logLevel;
   DMDUtil_LogCallback m_logCallback;
   DMDUtil_PUPTriggerCallbackContext m_pupTriggerCallbackContext;
@@ -18,12 +18,15 @@
 #include <atomic>
 #include <condition_variable>
 #include <cstdint>
+#include <future>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <shared_mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
 #if defined(__APPLE__)
 #include <TargetConditionals.h>
@@ -67,17 +70,41 @@ enum class AlphaNumericLayout
 class AlphaNumeric;
 class Serum;
 class PixelcadeDMD;
+class PIN2DMD;
 class LevelDMD;
 class RGB24DMD;
 class ConsoleDMD;
 class DMDServerConnector;
+class Config;
+class ColorizeProfiler;
+class AssetLoader;
+class FramePacer;
+class ZeDMDOutput;
+struct CachedDisplay;
 
 class DMDUTILAPI DMD
 {
  public:
+  // The default constructor reads the global Config::GetInstance(). The Config overload keeps a private snapshot
+  // instead, so several instances in one process can use different displays, paths and dump settings.
   DMD();
+  explicit DMD(const Config& config);
   ~DMD();
 
+  typedef uint64_t FenceId;
+
+  enum class ExecutionMode : int
+  {
+    Threaded = 0,     // QueueUpdate() hands the frame over and returns, the default.
+    Synchronous = 1,  // QueueUpdate() returns once every active consumer processed the frame and its colorized frames.
+  };
+
+  enum class ClockMode : int
+  {
+    Monotonic = 0,        // Wall time, the default.
+    FrameTimestamps = 1,  // Virtual time that only advances with the timestamps of the queued frames.
+  };
+
   enum class Mode : int
   {
     Unknown = 0,
@@ -141,7 +168,7 @@ class DMDUTILAPI DMD
     uint32_t inputDurationMs = 0;
   };
 
-  struct SerumCapture
+  struct SerumCaptureInfo
   {
     bool valid = false;
     bool hasOutput = false;
@@ -162,9 +189,28 @@ class DMDUTILAPI DMD
     uint32_t colorizeTimeUs = 0;
     uint32_t averageColorizeTimeUs = 0;
     uint32_t outputTimestampMs = 0;
+  };
+
+  struct SerumCapture : SerumCaptureInfo
+  {
     Update update;
   };
 
+  // Delivered to the capture callback instead of a SerumCapture. The hash covers the pixels of the primary output
+  // (RGB888, indexed or RGB565, depending on outputMode). output shares the colorized frame and is only set when it
+  // was requested.
+  struct SerumCaptureRecord : SerumCaptureInfo
+  {
+    Mode outputMode = Mode::Unknown;
+    uint16_t outputWidth = 0;
+    uint16_t outputHeight = 0;
+    uint64_t outputHashFNV1a64 = 0;
+    std::shared_ptr<const Update> output;
+  };
+
+  // Runs on the Serum thread for every colorized frame that carries a valid FrameContext, keep it short.
+  typedef void(DMDUTILCALLBACK* SerumCaptureCallback)(const SerumCaptureRecord& record, void* pUserData);
+
   struct StreamHeader
   {
     char header[10] = "DMDStream";
@@ -193,11 +239,14 @@ class DMDUTILAPI DMD
 #pragma pack(pop)  // Reset to default packing
 
   void FindDisplays();
-  static bool IsFinding();
+  bool IsFinding() const;
   bool HasDisplay() const;
   bool HasHDDisplay() const;
   void SetRomName(const char* name);
   void SetAltColorPath(const char* path);
+  // Starts loading the colorization assets of a ROM in the background. Frontends that know the next table call it
+  // ahead of SetRomName(), which does the same for the ROM it sets.
+  void PreloadRom(const char* name);
   void SetPUPVideosPath(const char* path);
   void SetPUPTrigger(const char source, const uint16_t id, const uint8_t value = 1);
   void DumpDMDTxt();
@@ -205,7 +254,87 @@ class DMDUTILAPI DMD
   void DumpDMDRgb565();
   void DumpDMDRgb888();
   uint16_t GetUpdateQueuePosition() const;
-  bool WaitForDumpers(uint16_t targetPosition, uint32_t timeoutMs);
+  // Kept for existing callers, waits for every frame queued so far like Flush().
+  [[deprecated("Use InsertFence() and WaitFence()")]] bool WaitForDumpers(uint16_t targetPosition, uint32_t timeoutMs);
+  // Returns the configuration this instance works with. The pointer stays valid for the lifetime of the DMD.
+  const Config* GetConfig() const;
+  // Atomically replaces the configuration snapshot. Per frame settings like ShowNotColorizedFrames, the exclude flags
+  // and RoundedCorners apply to the next frame, display and Serum settings on the next FindDisplays() or ROM change.
+  void SetConfig(const Config& config);
+  // Time source for Serum scene rotations and dump timing. With ClockMode::FrameTimestamps an offline replay produces
+  // the same output regardless of how fast the frames are queued. Set it before the first frame is queued.
+  void SetClockMode(ClockMode mode);
+  uint32_t GetClockMs() const;
+  // Synchronous execution puts the frames into the ring on the caller thread and runs the consumers in lockstep with
+  // it, so no consumer skips a frame and every run of an offline pipeline produces the same output.
+  void SetExecutionMode(ExecutionMode mode);
+  // A fence covers every frame queued before InsertFence() returned. WaitFence() resolves once all active consumers
+  // (dumpers, Serum, VNI, PUP and the display sinks) processed those frames and the colorized frames derived from them,
+  // dump files are flushed and the ZeDMD outputs wrote them to their devices by then.
+  FenceId InsertFence();
+  bool WaitFence(FenceId fence, uint32_t timeoutMs);
+  bool Flush(uint32_t timeoutMs);
+
+  struct SinkStats
+  {
+    const char* name = nullptr;
+    bool active = false;
+    uint64_t frames = 0;  // Ring frames processed while active, colorized frames included.
+    // Devices pace their output to the measured cost of a frame. fps is the rate frames were recently sent at,
+    // both stay 0 for sinks without pacing.
+    float fps = 0.0f;
+    uint32_t frameCostUs = 0;
+  };
+
+  // One entry per consumer of the frame ring, in a fixed order.
+  std::vector<SinkStats> GetSinkStats() const;
+
+  enum class ColorizeCall : uint8_t
+  {
+    SerumColorize = 0,
+    SerumRotate,
+    SerumSceneTrigger,
+    VniColorize,
+  };
+
+  enum class ColorizeResult : uint8_t
+  {
+    NewFrame = 0,
+    SameFrame,
+    NoFrame,
+    Rotation,
+  };
+
+  // Timing histogram of one colorizer call, result class and Serum_Runtime_Metadata feature flag combination.
+  // Percentiles are accurate to 1/8 of their value.
+  struct ColorizeTimingStats
+  {
+    ColorizeCall call = ColorizeCall::SerumColorize;
+    ColorizeResult result = ColorizeResult::NewFrame;
+    uint32_t featureFlags = 0;  // Always 0 for VNI.
+    uint64_t count = 0;
+    uint64_t totalUs = 0;
+    uint32_t minUs = 0;
+    uint32_t maxUs = 0;
+    uint32_t p50Us = 0;
+    uint32_t p90Us = 0;
+    uint32_t p99Us = 0;
+  };
+
+  // How late Serum rotations ran against their deadline. Rotations replayed on the virtual clock aren't counted.
+  struct RotationJitterStats
+  {
+    uint64_t count = 0;
+    uint32_t avgUs = 0;
+    uint32_t p50Us = 0;
+    uint32_t p99Us = 0;
+    uint32_t maxUs = 0;
+  };
+
+  // Timings of the ROM that is currently loaded. They are logged and start over on every ROM change.
+  std::vector<ColorizeTimingStats> GetColorizeProfile() const;
+  RotationJitterStats GetSerumRotationJitter() const;
+  void ResetColorizeProfile();
   LevelDMD* CreateLevelDMD(uint16_t width, uint16_t height, bool sam);
   bool DestroyLevelDMD(LevelDMD* pLevelDMD);
   void AddRGB24DMD(RGB24DMD* pRGB24DMD);
@@ -239,6 +368,9 @@ class DMDUTILAPI DMD
   void UpdateAlphaNumericData(AlphaNumericLayout layout, const uint16_t* pData1, const uint16_t* pData2, uint8_t r,
                               uint8_t g, uint8_t b);
   bool WaitForSerumColorizeCapture(uint64_t sourceOrdinal, SerumCapture& capture, uint32_t timeoutMs);
+  // While a callback is set, captures go to it and WaitForSerumColorizeCapture() gets none. Once the callback is
+  // replaced or cleared, no call of the previous one is running anymore.
+  void SetSerumCaptureCallback(SerumCaptureCallback callback, void* pUserData, bool withOutput = false);
   void QueueUpdate(const std::shared_ptr<Update> dmdUpdate, bool buffered, bool hasTimestamp = false,
                    uint32_t timestampMs = 0, const FrameContext* frameContext = nullptr);
   bool QueueBuffer();
@@ -254,18 +386,73 @@ class DMDUTILAPI DMD
   std::mutex m_serumCaptureMutex;
   std::condition_variable m_serumCaptureCv;
   std::map<uint64_t, SerumCapture> m_serumColorizeCaptures;
+  std::mutex m_serumCaptureCallbackMutex;
+  std::atomic<SerumCaptureCallback> m_serumCaptureCallback{nullptr};
+  void* m_pSerumCaptureCallbackUserData = nullptr;
+  bool m_serumCaptureWithOutput = false;
   uint64_t m_serumColorizeTimeTotalUs = 0;
   uint64_t m_serumColorizeCount = 0;
-  std::mutex m_dumpPositionMutex;
-  std::condition_variable m_dumpPositionCv;
-  std::atomic<uint16_t> m_dumpTxtPosition{0};
-  std::atomic<uint16_t> m_dumpRawPosition{0};
-  std::atomic<uint16_t> m_dump565Position{0};
-  std::atomic<uint16_t> m_dump888Position{0};
-  std::atomic<bool> m_dumpTxtActive{false};
-  std::atomic<bool> m_dumpRawActive{false};
-  std::atomic<bool> m_dump565Active{false};
-  std::atomic<bool> m_dump888Active{false};
+  std::atomic<uint8_t> m_dumpFormats{0};
+
+  enum class Consumer : uint8_t
+  {
+    Dump = 0,
+    Serum,
+    Vni,
+    PupDMD,
+    ZeDMD,
+    Pixelcade,
+    PIN2DMD,
+    LevelDMD,
+    RGB24DMD,
+    ConsoleDMD,
+    Count
+  };
+
+  // Marks a consumer thread active for fences while it is in scope.
+  class ConsumerScope
+  {
+   public:
+    ConsumerScope(DMD* pDMD, Consumer consumer);
+    ~ConsumerScope();
+
+   private:
+    DMD* m_pDMD;
+    Consumer m_consumer;
+  };
+
+  // Threaded frames are handed to a single inserter thread that puts them into the ring in submission order.
+  struct PendingUpdate
+  {
+    std::shared_ptr<Update> update;
+    bool buffered;
+    bool hasTimestamp;
+    uint32_t timestampMs;
+    FrameContext frameContext;
+    uint64_t sequence;
+  };
+  std::queue<PendingUpdate> m_insertQueue;
+  std::mutex m_insertMutex;
+  std::condition_variable m_insertCv;
+  std::thread* m_pInsertThread;
+
+  std::mutex m_fenceMutex;
+  std::condition_variable m_fenceCv;
+  std::atomic<uint32_t> m_fenceWaiters{0};
+  std::atomic<uint64_t> m_updateBufferQueueSubmitted{0};
+  std::atomic<uint64_t> m_updateBufferQueueSequence{0};
+  std::atomic<uint64_t> m_consumerSequence[(int)Consumer::Count];
+  std::atomic<bool> m_consumerActive[(int)Consumer::Count];
+  std::atomic<uint64_t> m_consumerFrames[(int)Consumer::Count];
+  // Output pacing of Pixelcade and PIN2DMD, nullptr for the others. Each ZeDMD output paces itself.
+  FramePacer* m_pFramePacers[(int)Consumer::Count];
+
+  explicit DMD(const Config* pConfig);
+
+  // nullptr selects the global Config. Replaced snapshots are kept until destruction as threads may still read them.
+  std::atomic<const Config*> m_pConfig{nullptr};
+  std::mutex m_configMutex;
+  std::vector<std::unique_ptr<const Config>> m_configSnapshots;
 
   uint16_t GetNextBufferQueuePosition(uint16_t bufferPosition, const uint16_t updateBufferQueuePosition);
   bool ConnectDMDServer();
@@ -285,31 +472,54 @@ class DMDUTILAPI DMD
                                   uint32_t serumRotationTimer, uint32_t serumFeatureFlags, uint32_t colorizeTimeUs,
                                   uint32_t averageColorizeTimeUs);
   void GenerateRandomSuffix(char* buffer, size_t length);
-  bool DumpersReached(uint16_t targetPosition) const;
-
+  void InsertUpdate(const std::shared_ptr<Update>& dmdUpdate, bool buffered, bool hasTimestamp, uint32_t timestampMs,
+                    const FrameContext& frameContext, uint64_t sequence);
+  uint64_t GetRingSequence(uint16_t bufferPosition) const;
+  void MarkConsumed(Consumer consumer, uint16_t bufferPosition);
+  bool ConsumersReached(uint64_t sequence) const;
+  void NotifyFenceWaiters();
+
+  void InsertThread();
   void DmdFrameThread();
   void LevelDMDThread();
   void RGB24DMDThread();
   void ConsoleDMDThread();
+  void FindZeDMD(const Config* pConfig, CachedDisplay& cached);
   void ZeDMDThread();
-  void DumpDMDTxtThread();
-  void DumpDMDRawThread();
-  void DumpDMDRgb565Thread();
-  void DumpDMDRgb888Thread();
+  void EnableDump(uint8_t format);
+  void DumpDMDThread();
   bool GetDumpSuffix(const char* romName, char* outSuffix, size_t outSize);
   bool GetQueueTimestamp(uint8_t bufferPositionMod, uint32_t& timestampMs) const;
   void PupDMDThread();
   void SerumThread();
   void VniThread();
+  std::string GetEffectiveAltColorPath();
+  std::shared_future<Vni_Context*> LoadVniAsync(const std::string& romName, const std::string& altColorPath);
+  std::shared_future<Vni_Context*> TakeVniPreload(const std::string& romName, const std::string& altColorPath);
+  void DiscardVni(const std::shared_future<Vni_Context*>& vniLoad);
 
   char m_romName[DMDUTIL_MAX_NAME_SIZE] = {0};
   char m_altColorPath[DMDUTIL_MAX_PATH_SIZE] = {0};
   char m_pupVideosPath[DMDUTIL_MAX_PATH_SIZE] = {0};
   char m_dumpPath[DMDUTIL_MAX_PATH_SIZE] = {0};
   AlphaNumeric* m_pAlphaNumeric;
+  ColorizeProfiler* m_pSerumProfiler;
+  ColorizeProfiler* m_pVniProfiler;
+  AssetLoader* m_pAssetLoader;
+  std::mutex m_preloadMutex;
+  std::string m_preloadRomName;
+  std::string m_preloadAltColorPath;
+  std::shared_future<Vni_Context*> m_vniPreload;
   SerumFrameStruct* m_pSerum;
   Vni_Context* m_pVni;
-  ZeDMD* m_pZeDMD;
+  // One per ZeDMD found, all fed by ZeDMDThread.
+  std::vector<ZeDMDOutput*> m_zedmdOutputs;
+  // The search publishes the displays it finds while Serum and the caller may already ask for them. Guards
+  // m_zedmdOutputs, m_pPixelcadeDMD and m_pPIN2DMD, the sink threads start after the pointer is set.
+  mutable std::mutex m_displaysMutex;
+  // ZeDMD and Pixelcade both probe serial ports. Their searches take turns, and neither opens a port the other took.
+  std::mutex m_serialSearchMutex;
+  std::vector<std::string> m_claimedSerialPorts;
   PUPDMD::DMD* m_pPUPDMD;
   std::vector<LevelDMD*> m_levelDMDs;
   std::vector<RGB24DMD*> m_rgb24DMDs;
@@ -322,10 +532,7 @@ class DMDUTILAPI DMD
   std::thread* m_pConsoleDMDThread;
   std::thread* m_pZeDMDThread;
   std::thread* m_pDmdFrameThread;
-  std::thread* m_pDumpDMDTxtThread;
-  std::thread* m_pDumpDMDRawThread;
-  std::thread* m_pDumpDMDRgb565Thread;
-  std::thread* m_pDumpDMDRgb888Thread;
+  std::thread* m_pDumpDMDThread;
   std::thread* m_pPupDMDThread;
   std::thread* m_pSerumThread;
   std::thread* m_pVniThread;
@@ -333,17 +540,23 @@ class DMDUTILAPI DMD
   std::condition_variable_any m_dmdCV;
   std::atomic<bool> m_stopFlag;
   std::atomic<uint16_t> m_updateBufferQueuePosition;
+  std::atomic<ClockMode> m_clockMode{ClockMode::Monotonic};
+  std::atomic<ExecutionMode> m_executionMode{ExecutionMode::Threaded};
+  std::atomic<uint32_t> m_virtualClockMs{0};
   std::mutex m_dumpSuffixMutex;
   char m_dumpSuffixRom[DMDUTIL_MAX_NAME_SIZE] = {0};
   char m_dumpSuffix[9] = {0};
   bool m_dumpSuffixValid = false;
 
   bool m_hasUpdateBuffered = false;
-  static std::atomic<bool> m_finding;
+  // Per instance, so a second DMD searches its own displays.
+  std::atomic<bool> m_finding{false};
+  std::thread* m_pFindThread;
 
 #if !(                                                                                                                \
     (defined(__APPLE__) && ((defined(TARGET_OS_IOS) && TARGET_OS_IOS) || (defined(TARGET_OS_TV) && TARGET_OS_TV))) || \
     defined(__ANDROID__))
+  void FindPixelcadeDMD(const Config* pConfig, CachedDisplay& cached);
   void PixelcadeDMDThread();
   PixelcadeDMD* m_pPixelcadeDMD;
   std::thread* m_pPixelcadeDMDThread;
@@ -352,11 +565,10 @@ class DMDUTILAPI DMD
 #if defined(DMDUTIL_ENABLE_PIN2DMD) && !((defined(__APPLE__) && ((defined(TARGET_OS_IOS) && TARGET_OS_IOS) || \
                                                                  (defined(TARGET_OS_TV) && TARGET_OS_TV))) || \
                                          defined(__ANDROID__))
+  void FindPIN2DMD(const Config* pConfig);
   void PIN2DMDThread();
+  PIN2DMD* m_pPIN2DMD;
   std::thread* m_pPIN2DMDThread;
-  bool m_PIN2DMDConnected;
-  uint16_t m_PIN2DMDWidth;
-  uint16_t m_PIN2DMDHeight;
 #endif
 };
 
@@ -1,8 +1,8 @@
 #pragma once
 
 #define DMDUTIL_VERSION_MAJOR 0   // X Digits
-#define DMDUTIL_VERSION_MINOR 13  // Max 2 Digits
-#define DMDUTIL_VERSION_PATCH 3   // Max 2 Digits
+#define DMDUTIL_VERSION_MINOR 14  // Max 2 Digits
+#define DMDUTIL_VERSION_PATCH 0   // Max 2 Digits
 
 #define _DMDUTIL_STR(x) #x
 #define DMDUTIL_STR(x) _DMDUTIL_STR(x)
@@ -13,6 +13,8 @@
 namespace DMDUtil
 {
 
+class RGB24DMDPrivate;
+
 class DMDUTILAPI RGB24DMD
 {
  public:
@@ -25,6 +27,9 @@ class DMDUTILAPI RGB24DMD
   int GetLength() const { return m_length; }
   int GetPitch() const { return m_pitch; }
   uint8_t* GetData();
+  // Radius applied to every frame, 0 by default. A DMD sets the one of its configuration when the sink is added and
+  // on SetConfig().
+  void SetRoundedCorners(int roundedCorners);
 
  protected:
   uint16_t m_width;
@@ -34,6 +39,9 @@ class DMDUTILAPI RGB24DMD
   bool m_update;
 
   uint8_t* m_pData;
+
+ private:
+  RGB24DMDPrivate* m_pPrivate;
 };
 
 }  // namespace DMDUtil
@@ -0,0 +1,46 @@
+#include "AssetLoader.h"
+
+namespace DMDUtil
+{
+
+AssetLoader::AssetLoader(size_t threadCount)
+{
+  for (size_t i = 0; i < threadCount; i++) m_threads.emplace_back(&AssetLoader::Run, this);
+}
+
+AssetLoader::~AssetLoader()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_cv.notify_all();
+  for (std::thread& thread : m_threads) thread.join();
+}
+
+void AssetLoader::Submit(std::function<void()> job)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_jobs.push_back(std::move(job));
+  }
+  m_cv.notify_one();
+}
+
+void AssetLoader::Run()
+{
+  while (true)
+  {
+    std::function<void()> job;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cv.wait(lock, [&]() { return m_stop || !m_jobs.empty(); });
+      if (m_jobs.empty()) return;
+      job = std::move(m_jobs.front());
+      m_jobs.pop_front();
+    }
+    job();
+  }
+}
+
+}  // namespace DMDUtil
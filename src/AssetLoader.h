@@ -0,0 +1,33 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace DMDUtil
+{
+
+// Runs colorization and PUP asset loads off the frame threads. Jobs start in submission order on a
+// small pool, so loads of different asset kinds overlap. The destructor runs the jobs still queued.
+class AssetLoader
+{
+ public:
+  explicit AssetLoader(size_t threadCount);
+  ~AssetLoader();
+
+  void Submit(std::function<void()> job);
+
+ private:
+  void Run();
+
+  std::vector<std::thread> m_threads;
+  std::deque<std::function<void()>> m_jobs;
+  bool m_stop = false;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+};
+
+}  // namespace DMDUtil
@@ -0,0 +1,117 @@
+#include "ColorizeProfiler.h"
+
+#include "DMDUtil/Logger.h"
+
+namespace DMDUtil
+{
+
+void ColorizeProfiler::Record(DMD::ColorizeCall call, DMD::ColorizeResult result, uint32_t featureFlags, uint32_t us)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_histograms[Key(call, result, featureFlags)].Record(us);
+}
+
+void ColorizeProfiler::RecordRotationLateness(uint32_t us)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_rotationLateness.Record(us);
+}
+
+std::vector<DMD::ColorizeTimingStats> ColorizeProfiler::GetStats() const
+{
+  std::vector<DMD::ColorizeTimingStats> stats;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  stats.reserve(m_histograms.size());
+  for (const auto& entry : m_histograms)
+  {
+    const TimingHistogram& histogram = entry.second;
+    DMD::ColorizeTimingStats s;
+    s.call = std::get<0>(entry.first);
+    s.result = std::get<1>(entry.first);
+    s.featureFlags = std::get<2>(entry.first);
+    s.count = histogram.GetCount();
+    s.totalUs = histogram.GetTotal();
+    s.minUs = histogram.GetMin();
+    s.maxUs = histogram.GetMax();
+    s.p50Us = histogram.Percentile(0.50);
+    s.p90Us = histogram.Percentile(0.90);
+    s.p99Us = histogram.Percentile(0.99);
+    stats.push_back(s);
+  }
+  return stats;
+}
+
+DMD::RotationJitterStats ColorizeProfiler::GetRotationJitter() const
+{
+  DMD::RotationJitterStats s;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  s.count = m_rotationLateness.GetCount();
+  if (s.count > 0) s.avgUs = (uint32_t)(m_rotationLateness.GetTotal() / s.count);
+  s.p50Us = m_rotationLateness.Percentile(0.50);
+  s.p99Us = m_rotationLateness.Percentile(0.99);
+  s.maxUs = m_rotationLateness.GetMax();
+  return s;
+}
+
+void ColorizeProfiler::ReportAndReset(const char* romName)
+{
+  std::vector<DMD::ColorizeTimingStats> stats = GetStats();
+  DMD::RotationJitterStats jitter = GetRotationJitter();
+  Reset();
+  if (stats.empty()) return;
+
+  Log(DMDUtil_LogLevel_INFO, "Colorization profile of %s:", (romName && romName[0]) ? romName : "<none>");
+  for (const auto& s : stats)
+  {
+    Log(DMDUtil_LogLevel_INFO,
+        "  %s %s flags=0x%08x: count=%llu avg=%lluus min=%uus p50=%uus p90=%uus p99=%uus max=%uus",
+        CallName(s.call), ResultName(s.result), s.featureFlags, (unsigned long long)s.count,
+        (unsigned long long)(s.totalUs / s.count), s.minUs, s.p50Us, s.p90Us, s.p99Us, s.maxUs);
+  }
+  if (jitter.count > 0)
+  {
+    Log(DMDUtil_LogLevel_INFO, "  rotation lateness: count=%llu avg=%uus p50=%uus p99=%uus max=%uus",
+        (unsigned long long)jitter.count, jitter.avgUs, jitter.p50Us, jitter.p99Us, jitter.maxUs);
+  }
+}
+
+void ColorizeProfiler::Reset()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_histograms.clear();
+  m_rotationLateness = TimingHistogram();
+}
+
+const char* ColorizeProfiler::CallName(DMD::ColorizeCall call)
+{
+  switch (call)
+  {
+    case DMD::ColorizeCall::SerumColorize:
+      return "Serum_Colorize";
+    case DMD::ColorizeCall::SerumRotate:
+      return "Serum_Rotate";
+    case DMD::ColorizeCall::SerumSceneTrigger:
+      return "Serum_Scene_Trigger";
+    case DMD::ColorizeCall::VniColorize:
+      return "Vni_Colorize";
+  }
+  return "unknown";
+}
+
+const char* ColorizeProfiler::ResultName(DMD::ColorizeResult result)
+{
+  switch (result)
+  {
+    case DMD::ColorizeResult::NewFrame:
+      return "new";
+    case DMD::ColorizeResult::SameFrame:
+      return "same";
+    case DMD::ColorizeResult::NoFrame:
+      return "none";
+    case DMD::ColorizeResult::Rotation:
+      return "rotation";
+  }
+  return "unknown";
+}
+
+}  // namespace DMDUtil
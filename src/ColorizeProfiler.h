@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+#include "DMDUtil/DMD.h"
+#include "TimingHistogram.h"
+
+namespace DMDUtil
+{
+
+// Timing histograms of the colorizer calls of one ROM, split by call, result class and the feature
+// flags libserum reports for the frame.
+class ColorizeProfiler
+{
+ public:
+  void Record(DMD::ColorizeCall call, DMD::ColorizeResult result, uint32_t featureFlags, uint32_t us);
+  void RecordRotationLateness(uint32_t us);
+  std::vector<DMD::ColorizeTimingStats> GetStats() const;
+  DMD::RotationJitterStats GetRotationJitter() const;
+  // Logs a summary for the given ROM and starts over.
+  void ReportAndReset(const char* romName);
+  void Reset();
+
+  static const char* CallName(DMD::ColorizeCall call);
+  static const char* ResultName(DMD::ColorizeResult result);
+
+ private:
+  using Key = std::tuple<DMD::ColorizeCall, DMD::ColorizeResult, uint32_t>;
+
+  mutable std::mutex m_mutex;
+  std::map<Key, TimingHistogram> m_histograms;
+  TimingHistogram m_rotationLateness;
+};
+
+}  // namespace DMDUtil
@@ -32,6 +32,7 @@ Config::Config()
   m_pupExactColorMatch = true;
   m_framesTimeout = 0;
   m_framesToSkip = 0;
+  m_serumCROMcCache = true;
   m_showNotColorizedFrames = false;
   m_excludeColorizedFramesForZeDMD = false;
   m_excludeColorizedFramesForRGB24DMD = false;
@@ -40,12 +41,19 @@ Config::Config()
   m_dumpNotColorizedFrames = false;
   m_dumpFrames = false;
   m_dumpZip = false;
+  m_dumpRotateMaxSize = 0;
+  m_dumpRotateMaxFrames = 0;
+  m_dumpRotateMaxDuration = 0;
+  m_dumpRotateIdle = 0;
+  m_dumpRetentionSize = 0;
   m_filterTransitionalFrames = false;
   m_roundedCorners = 0;
   m_zedmd = true;
   m_zedmdDevice.clear();
   m_zedmdDebug = false;
   m_zedmdBrightness = -1;
+  m_zedmdRoundedCorners = -1;
+  m_zedmdOutputs.clear();
   m_zedmdWiFiEnabled = false;
   m_zedmdWiFiAddr.clear();
   m_zedmdSpiEnabled = false;
@@ -56,6 +64,7 @@ Config::Config()
   m_pixelcade = true;
   m_pixelcadeDevice.clear();
   m_PIN2DMD = true;
+  m_discoveryCachePath.clear();
   m_dmdServer = false;
   m_dmdServerAddr = "localhost";
   m_dmdServerPort = 6789;
@@ -179,6 +188,35 @@ void Config::parseConfigFile(const char* path)
     SetZeDMDBrightness(-1);
   }
 
+  try
+  {
+    SetZeDMDRoundedCorners(r.Get<int>("ZeDMD", "RoundedCorners", -1));
+  }
+  catch (const std::exception&)
+  {
+    SetZeDMDRoundedCorners(-1);
+  }
+
+  // Additional ZeDMDs
+  ClearZeDMDOutputs();
+  for (int i = 2; i <= 4; i++)
+  {
+    const std::string section = "ZeDMD-" + std::to_string(i);
+    try
+    {
+      if (!r.Get<bool>(section, "Enabled", false)) continue;
+
+      ZeDMDOutputConfig output;
+      output.device = r.Get<std::string>(section, "Device", "");
+      output.brightness = r.Get<int>(section, "Brightness", -1);
+      output.roundedCorners = r.Get<int>(section, "RoundedCorners", -1);
+      AddZeDMDOutput(output);
+    }
+    catch (const std::exception&)
+    {
+    }
+  }
+
   // ZeDMD WiFi
   try
   {
@@ -272,6 +310,16 @@ void Config::parseConfigFile(const char* path)
     SetPIN2DMD(true);
   }
 
+  // Discovery
+  try
+  {
+    SetDiscoveryCachePath(r.Get<std::string>("Discovery", "CachePath", "").c_str());
+  }
+  catch (const std::exception&)
+  {
+    SetDiscoveryCachePath("");
+  }
+
   // Serum
   try
   {
@@ -291,6 +339,15 @@ void Config::parseConfigFile(const char* path)
     SetMaximumUnknownFramesToSkip(0);
   }
 
+  try
+  {
+    SetSerumCROMcCache(r.Get<bool>("Serum", "CROMcCache", true));
+  }
+  catch (const std::exception&)
+  {
+    SetSerumCROMcCache(true);
+  }
+
   try
   {
     SetShowNotColorizedFrames(r.Get<bool>("Serum", "ShowNotColorizedFrames", false));
@@ -383,6 +440,51 @@ void Config::parseConfigFile(const char* path)
     SetFilterTransitionalFrames(false);
   }
 
+  try
+  {
+    SetDumpRotateMaxSize(r.Get<int>("Dump", "RotateMaxSize", 0));
+  }
+  catch (const std::exception&)
+  {
+    SetDumpRotateMaxSize(0);
+  }
+
+  try
+  {
+    SetDumpRotateMaxFrames(r.Get<int>("Dump", "RotateMaxFrames", 0));
+  }
+  catch (const std::exception&)
+  {
+    SetDumpRotateMaxFrames(0);
+  }
+
+  try
+  {
+    SetDumpRotateMaxDuration(r.Get<int>("Dump", "RotateMaxDuration", 0));
+  }
+  catch (const std::exception&)
+  {
+    SetDumpRotateMaxDuration(0);
+  }
+
+  try
+  {
+    SetDumpRotateIdle(r.Get<int>("Dump", "RotateIdle", 0));
+  }
+  catch (const std::exception&)
+  {
+    SetDumpRotateIdle(0);
+  }
+
+  try
+  {
+    SetDumpRetentionSize(r.Get<int>("Dump", "RetentionSize", 0));
+  }
+  catch (const std::exception&)
+  {
+    SetDumpRetentionSize(0);
+  }
+
   // OutputFilters
   try
   {
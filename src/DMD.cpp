@@ -37,16 +37,22 @@
 #include <cstring>
 #include <filesystem>
 #include <limits>
-#include <unordered_set>
 
 #include "AlphaNumeric.h"
+#include "AssetLoader.h"
+#include "ColorizeProfiler.h"
+#include "DiscoveryCache.h"
+#include "DumpPipeline.h"
+#include "FramePacer.h"
 #include "FrameUtil.h"
 #include "DMDUtil/Logger.h"
 #include "OutputFilters.h"
+#include "ScalePlan.h"
+#include "SerumCache.h"
+#include "ThreadLogConfig.h"
 #include "TimeUtils.h"
 #include "ZeDMD.h"
-#include "komihash/komihash.h"
-#include "miniz/miniz.h"
+#include "ZeDMDOutput.h"
 #include "pupdmd.h"
 #include "serum-decode.h"
 #include "serum.h"
@@ -59,6 +65,10 @@ namespace
 {
 constexpr size_t kMaxFramePixels = 256u * 64u;
 constexpr size_t kMaxRgb24Bytes = kMaxFramePixels * 3u;
+// Covers a colorization that is loaded on the first frame of a ROM.
+constexpr uint32_t kSynchronousTimeoutMs = 60000;
+// Opening a serial port that isn't a Pixelcade takes about 300 ms, the search gives up after some 15 ports.
+constexpr int kPixelcadeSearchTimeoutMs = 5000;
 
 uint64_t SplitMix64(uint64_t value)
 {
@@ -68,49 +78,58 @@ uint64_t SplitMix64(uint64_t value)
   return value ^ (value >> 31);
 }
 
-std::string ToLower(const std::string& value)
+uint64_t HashBytesFNV1a64(const uint8_t* pData, size_t length)
 {
-  std::string out;
-  out.reserve(value.size());
-  for (unsigned char ch : value)
+  uint64_t hash = 1469598103934665603ull;
+  for (size_t i = 0; i < length; i++)
   {
-    out.push_back(static_cast<char>(std::tolower(ch)));
+    hash ^= pData[i];
+    hash *= 1099511628211ull;
   }
-  return out;
+  hash ^= length;
+  hash *= 1099511628211ull;
+  return hash;
 }
 
-bool ZipDumpFile(const std::string& sourcePath)
+// Hashes the pixels of a colorized frame the way dmdutil-play-dump reports them in its JSON dumps.
+uint64_t HashOutputFNV1a64(const DMDUtil::DMD::Update& update)
 {
-  if (sourcePath.empty())
-  {
-    return false;
-  }
-
-  std::filesystem::path srcPath(sourcePath);
-  std::string zipPath = sourcePath + ".zip";
-  std::string entryName = srcPath.filename().string();
+  using Mode = DMDUtil::DMD::Mode;
+  const size_t pixels = (size_t)update.width * update.height;
+  if (update.mode == Mode::RGB24) return HashBytesFNV1a64(update.data, pixels * 3u);
+  if (update.mode == Mode::SerumV1 || update.mode == Mode::Data || update.mode == Mode::NotColorized ||
+      update.mode == Mode::Vni)
+    return HashBytesFNV1a64(update.data, pixels);
+  return HashBytesFNV1a64(reinterpret_cast<const uint8_t*>(update.segData), pixels * sizeof(uint16_t));
+}
 
-  mz_zip_archive zip;
-  mz_zip_zero_struct(&zip);
-  if (!mz_zip_writer_init_file(&zip, zipPath.c_str(), 0))
+// Returns the position before the newest pending frame with data that the sink accepts, so the consumer loop
+// continues with that frame, or updateBufferQueuePosition if there is none. Only frames still in the ring are
+// searched.
+template <typename Accept>
+uint16_t SkipToNewestFrame(DMDUtil::DMD::Update* const* ppUpdateBufferQueue, uint16_t bufferPosition,
+                           uint16_t updateBufferQueuePosition, Accept accept)
+{
+  const uint16_t pending = std::min<uint16_t>((uint16_t)(updateBufferQueuePosition - bufferPosition),
+                                              DMDUTIL_FRAME_BUFFER_SIZE - 1);
+  for (uint16_t i = 0; i < pending; i++)
   {
-    return false;
+    const uint16_t position = updateBufferQueuePosition - i;
+    const DMDUtil::DMD::Update* pUpdate = ppUpdateBufferQueue[position % DMDUTIL_FRAME_BUFFER_SIZE];
+    if ((pUpdate->hasData || pUpdate->hasSegData) && accept(pUpdate)) return position - 1;
   }
+  return updateBufferQueuePosition;
+}
 
-  bool ok = mz_zip_writer_add_file(&zip, entryName.c_str(), sourcePath.c_str(), nullptr, 0, MZ_BEST_COMPRESSION);
-  ok = ok && mz_zip_writer_finalize_archive(&zip);
-  mz_zip_writer_end(&zip);
-
-  if (!ok)
+std::string ToLower(const std::string& value)
+{
+  std::string out;
+  out.reserve(value.size());
+  for (unsigned char ch : value)
   {
-    std::error_code ec;
-    std::filesystem::remove(zipPath, ec);
-    return false;
+    out.push_back(static_cast<char>(std::tolower(ch)));
   }
-
-  std::error_code ec;
-  std::filesystem::remove(sourcePath, ec);
-  return true;
+  return out;
 }
 
 bool FindCaseInsensitiveFile(const std::string& dir, const std::string& filename, std::string* outPath)
@@ -160,6 +179,45 @@ std::string BuildAltColorDir(const char* altColorPath, const char* romName)
   return path;
 }
 
+uint32_t ElapsedUs(std::chrono::steady_clock::time_point start)
+{
+  return static_cast<uint32_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+DMDUtil::DMD::ColorizeResult SerumResultClass(uint32_t result)
+{
+  if (result == IDENTIFY_NO_FRAME) return DMDUtil::DMD::ColorizeResult::NoFrame;
+  if (result == IDENTIFY_SAME_FRAME) return DMDUtil::DMD::ColorizeResult::SameFrame;
+  return DMDUtil::DMD::ColorizeResult::NewFrame;
+}
+
+uint32_t SerumFeatureFlags()
+{
+  Serum_Runtime_Metadata runtimeMetadata{};
+  runtimeMetadata.size = sizeof(runtimeMetadata);
+  Serum_GetRuntimeMetadata(&runtimeMetadata);
+  return runtimeMetadata.featureFlags;
+}
+
+template <typename T>
+bool IsLoaded(const std::shared_future<T>& load)
+{
+  return load.valid() && load.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+// Reads a file once, so a following load finds it in the OS file cache.
+void WarmFileCache(const std::string& path)
+{
+  FILE* f = fopen(path.c_str(), "rb");
+  if (!f) return;
+  std::vector<char> buffer(1024 * 1024);
+  while (fread(buffer.data(), 1, buffer.size(), f) == buffer.size())
+  {
+  }
+  fclose(f);
+}
+
 size_t PaletteBytesForDepth(uint8_t depth)
 {
   if (depth > 8)
@@ -221,7 +279,9 @@ class DMDServerConnector
   sockpp::tcp_connector* m_pConnector;
 };
 
-std::atomic<bool> DMD::m_finding{false};
+
+// The DMD whose consumer thread is the current thread, if any.
+static thread_local const DMD* t_pConsumerDMD = nullptr;
 
 void DMD::Update::convertToHostByteOrder()
 {
@@ -279,8 +339,18 @@ void DMD::StreamHeader::convertToNetworkByteOrder()
   length = htonl(length);
 }
 
-DMD::DMD()
+DMD::DMD() : DMD(nullptr) {}
+
+DMD::DMD(const Config& config) : DMD(&config) {}
+
+DMD::DMD(const Config* pConfig)
 {
+  if (pConfig)
+  {
+    m_configSnapshots.emplace_back(std::make_unique<const Config>(*pConfig));
+    m_pConfig.store(m_configSnapshots.back().get(), std::memory_order_release);
+  }
+
   for (uint8_t i = 0; i < DMDUTIL_FRAME_BUFFER_SIZE; i++)
   {
     m_pUpdateBufferQueue[i] = new Update();
@@ -293,19 +363,23 @@ DMD::DMD()
   m_updateBuffered = std::make_shared<Update>();
 
   m_pAlphaNumeric = new AlphaNumeric();
+  m_pSerumProfiler = new ColorizeProfiler();
+  m_pVniProfiler = new ColorizeProfiler();
+  for (int i = 0; i < (int)Consumer::Count; i++) m_pFramePacers[i] = nullptr;
+  m_pFramePacers[(int)Consumer::Pixelcade] = new FramePacer();
+  m_pFramePacers[(int)Consumer::PIN2DMD] = new FramePacer();
+  // Serum, VNI and PUP assets load in parallel.
+  m_pAssetLoader = new AssetLoader(3);
   m_pSerum = nullptr;
   m_pVni = nullptr;
-  m_pZeDMD = nullptr;
   m_pPUPDMD = nullptr;
 
+  m_pFindThread = nullptr;
   m_pZeDMDThread = nullptr;
   m_pLevelDMDThread = nullptr;
   m_pRGB24DMDThread = nullptr;
   m_pConsoleDMDThread = nullptr;
-  m_pDumpDMDTxtThread = nullptr;
-  m_pDumpDMDRawThread = nullptr;
-  m_pDumpDMDRgb565Thread = nullptr;
-  m_pDumpDMDRgb888Thread = nullptr;
+  m_pDumpDMDThread = nullptr;
 #if !(                                                                                                                \
     (defined(__APPLE__) && ((defined(TARGET_OS_IOS) && TARGET_OS_IOS) || (defined(TARGET_OS_TV) && TARGET_OS_TV))) || \
     defined(__ANDROID__))
@@ -316,12 +390,11 @@ DMD::DMD()
 #if defined(DMDUTIL_ENABLE_PIN2DMD) && !((defined(__APPLE__) && ((defined(TARGET_OS_IOS) && TARGET_OS_IOS) || \
                                                                  (defined(TARGET_OS_TV) && TARGET_OS_TV))) || \
                                          defined(__ANDROID__))
+  m_pPIN2DMD = nullptr;
   m_pPIN2DMDThread = nullptr;
-  m_PIN2DMDConnected = false;
-  m_PIN2DMDWidth = 0;
-  m_PIN2DMDHeight = 0;
 #endif
 
+  m_pInsertThread = new std::thread(&DMD::InsertThread, this);
   m_pDmdFrameThread = new std::thread(&DMD::DmdFrameThread, this);
   m_pPupDMDThread = new std::thread(&DMD::PupDMDThread, this);
   m_pSerumThread = new std::thread(&DMD::SerumThread, this);
@@ -336,6 +409,29 @@ DMD::~DMD()
   m_stopFlag.store(true, std::memory_order_release);
   ul.unlock();
   m_dmdCV.notify_all();
+  {
+    std::lock_guard<std::mutex> lock(m_fenceMutex);
+  }
+  m_fenceCv.notify_all();
+  {
+    std::lock_guard<std::mutex> lock(m_insertMutex);
+  }
+  m_insertCv.notify_all();
+
+  // Frames still waiting for the inserter are dropped, none of them reaches the ring anymore.
+  Log(DMDUtil_LogLevel_INFO, "DMD destructor: joining InsertThread");
+  m_pInsertThread->join();
+  delete m_pInsertThread;
+  m_pInsertThread = nullptr;
+
+  // The search starts the render threads of the displays it finds, so it has to end before they are joined.
+  if (m_pFindThread)
+  {
+    Log(DMDUtil_LogLevel_INFO, "DMD destructor: joining display search");
+    m_pFindThread->join();
+    delete m_pFindThread;
+    m_pFindThread = nullptr;
+  }
 
   Log(DMDUtil_LogLevel_INFO, "DMD destructor: joining DmdFrameThread");
   if (m_pDmdFrameThread->joinable())
@@ -389,32 +485,15 @@ DMD::~DMD()
     m_pZeDMDThread = nullptr;
   }
 
-  if (m_pDumpDMDTxtThread)
-  {
-    m_pDumpDMDTxtThread->join();
-    delete m_pDumpDMDTxtThread;
-    m_pDumpDMDTxtThread = nullptr;
-  }
-
-  if (m_pDumpDMDRawThread)
-  {
-    m_pDumpDMDRawThread->join();
-    delete m_pDumpDMDRawThread;
-    m_pDumpDMDRawThread = nullptr;
-  }
-
-  if (m_pDumpDMDRgb565Thread)
-  {
-    m_pDumpDMDRgb565Thread->join();
-    delete m_pDumpDMDRgb565Thread;
-    m_pDumpDMDRgb565Thread = nullptr;
-  }
-
-  if (m_pDumpDMDRgb888Thread)
+  if (m_pDumpDMDThread)
   {
-    m_pDumpDMDRgb888Thread->join();
-    delete m_pDumpDMDRgb888Thread;
-    m_pDumpDMDRgb888Thread = nullptr;
+    Log(DMDUtil_LogLevel_INFO, "DMD destructor: joining DumpDMDThread");
+    if (m_pDumpDMDThread->joinable())
+      m_pDumpDMDThread->join();
+    else
+      Log(DMDUtil_LogLevel_ERROR, "DMD destructor: DumpDMDThread not joinable");
+    delete m_pDumpDMDThread;
+    m_pDumpDMDThread = nullptr;
   }
 
   if (m_pPupDMDThread)
@@ -471,14 +550,24 @@ DMD::~DMD()
     m_pPIN2DMDThread = nullptr;
   }
 #endif
+  DiscardVni(m_vniPreload);
+  delete m_pAssetLoader;
   delete m_pAlphaNumeric;
-  delete m_pZeDMD;
+  delete m_pSerumProfiler;
+  delete m_pVniProfiler;
+  for (FramePacer* pFramePacer : m_pFramePacers) delete pFramePacer;
+  for (ZeDMDOutput* pZeDMDOutput : m_zedmdOutputs) delete pZeDMDOutput;
   delete m_pPUPDMD;
 #if !(                                                                                                                \
     (defined(__APPLE__) && ((defined(TARGET_OS_IOS) && TARGET_OS_IOS) || (defined(TARGET_OS_TV) && TARGET_OS_TV))) || \
     defined(__ANDROID__))
   if (m_pPixelcadeDMD) delete m_pPixelcadeDMD;
 #endif
+#if defined(DMDUTIL_ENABLE_PIN2DMD) && !((defined(__APPLE__) && ((defined(TARGET_OS_IOS) && TARGET_OS_IOS) || \
+                                                                 (defined(TARGET_OS_TV) && TARGET_OS_TV))) || \
+                                         defined(__ANDROID__))
+  delete m_pPIN2DMD;
+#endif
 
   for (LevelDMD* pLevelDMD : m_levelDMDs) delete pLevelDMD;
   for (RGB24DMD* pRGB24DMD : m_rgb24DMDs) delete pRGB24DMD;
@@ -503,7 +592,7 @@ bool DMD::ConnectDMDServer()
 {
   if (!m_pDMDServerConnector)
   {
-    Config* const pConfig = Config::GetInstance();
+    const Config* const pConfig = GetConfig();
     sockpp::initialize();
     Log(DMDUtil_LogLevel_INFO, "Connecting DMDServer on %s:%d", pConfig->GetDMDServerAddr(),
         pConfig->GetDMDServerPort());
@@ -517,15 +606,18 @@ bool DMD::ConnectDMDServer()
   return (m_pDMDServerConnector);
 }
 
-bool DMD::IsFinding() { return m_finding.load(std::memory_order_acquire); }
+bool DMD::IsFinding() const { return m_finding.load(std::memory_order_acquire); }
 
 bool DMD::HasDisplay() const
 {
-  if (m_pZeDMD != nullptr || m_rgb24DMDs.size() > 0)
+  if (m_rgb24DMDs.size() > 0)
   {
     return true;
   }
 
+  std::lock_guard<std::mutex> lock(m_displaysMutex);
+  if (!m_zedmdOutputs.empty()) return true;
+
 #if !(                                                                                                                \
     (defined(__APPLE__) && ((defined(TARGET_OS_IOS) && TARGET_OS_IOS) || (defined(TARGET_OS_TV) && TARGET_OS_TV))) || \
     defined(__ANDROID__))
@@ -535,7 +627,7 @@ bool DMD::HasDisplay() const
 #if defined(DMDUTIL_ENABLE_PIN2DMD) && !((defined(__APPLE__) && ((defined(TARGET_OS_IOS) && TARGET_OS_IOS) || \
                                                                  (defined(TARGET_OS_TV) && TARGET_OS_TV))) || \
                                          defined(__ANDROID__))
-  if (m_PIN2DMDConnected) return true;
+  if (m_pPIN2DMD != nullptr) return true;
 #endif
 
   return false;
@@ -543,8 +635,6 @@ bool DMD::HasDisplay() const
 
 bool DMD::HasHDDisplay() const
 {
-  if (m_pZeDMD != nullptr && m_pZeDMD->GetWidth() == 256) return true;
-
   if (m_rgb24DMDs.size() > 0)
   {
     for (RGB24DMD* pRGB24DMD : m_rgb24DMDs)
@@ -553,50 +643,156 @@ bool DMD::HasHDDisplay() const
     }
   }
 
+  std::lock_guard<std::mutex> lock(m_displaysMutex);
+  for (ZeDMDOutput* pZeDMDOutput : m_zedmdOutputs)
+  {
+    if (pZeDMDOutput->GetWidth() == 256) return true;
+  }
+
 #if defined(DMDUTIL_ENABLE_PIN2DMD) && !((defined(__APPLE__) && ((defined(TARGET_OS_IOS) && TARGET_OS_IOS) || \
                                                                  (defined(TARGET_OS_TV) && TARGET_OS_TV))) || \
                                          defined(__ANDROID__))
-  if (m_PIN2DMDConnected && m_PIN2DMDWidth == 256) return true;
+  if (m_pPIN2DMD != nullptr && m_pPIN2DMD->GetWidth() == 256) return true;
 #endif
 
   return false;
 }
 
-void DMD::SetRomName(const char* name) { strcpy(m_romName, name ? name : ""); }
-
-void DMD::SetAltColorPath(const char* path) { strcpy(m_altColorPath, path ? path : ""); }
+void DMD::SetRomName(const char* name)
+{
+  strcpy(m_romName, name ? name : "");
+  PreloadRom(m_romName);
+}
 
-void DMD::SetPUPVideosPath(const char* path) { strcpy(m_pupVideosPath, path ? path : ""); }
+void DMD::SetAltColorPath(const char* path)
+{
+  strcpy(m_altColorPath, path ? path : "");
+  PreloadRom(m_romName);
+}
 
-void DMD::DumpDMDTxt()
+void DMD::PreloadRom(const char* name)
 {
-  if (!m_pDumpDMDTxtThread)
+  if (!name || name[0] == '\0' || !GetConfig()->IsAltColor()) return;
+
+  const std::string romName = name;
+  const std::string altColorPath = GetEffectiveAltColorPath();
   {
-    m_pDumpDMDTxtThread = new std::thread(&DMD::DumpDMDTxtThread, this);
+    std::lock_guard<std::mutex> lock(m_preloadMutex);
+    if (romName == m_preloadRomName && altColorPath == m_preloadAltColorPath) return;
+
+    m_preloadRomName = romName;
+    m_preloadAltColorPath = altColorPath;
+    DiscardVni(m_vniPreload);
+#ifdef DMDUTIL_ENABLE_VNI
+    m_vniPreload = LoadVniAsync(romName, altColorPath);
+#else
+    m_vniPreload = std::shared_future<Vni_Context*>();
+#endif
   }
+
+  // libserum holds a single colorization per process, so Serum can't load next to the one in use. Reading the file
+  // ahead still takes the disk out of the ROM switch.
+  m_pAssetLoader->Submit(
+      [altColorPath, romName]()
+      {
+        const std::string baseDir = BuildAltColorDir(altColorPath.c_str(), romName.c_str());
+        std::string serumPath;
+        if (FindCaseInsensitiveFile(baseDir, romName + ".cROMc", &serumPath) ||
+            FindCaseInsensitiveFile(baseDir, romName + ".cRZ", &serumPath) ||
+            FindCaseInsensitiveFile(baseDir, romName + ".cROM", &serumPath))
+        {
+          WarmFileCache(serumPath);
+        }
+      });
 }
 
-void DMD::DumpDMDRaw()
+std::string DMD::GetEffectiveAltColorPath()
 {
-  if (m_pDumpDMDRawThread)
-  {
-    m_pDumpDMDRawThread = new std::thread(&DMD::DumpDMDRawThread, this);
-  }
+  return m_altColorPath[0] != '\0' ? std::string(m_altColorPath) : std::string(GetConfig()->GetAltColorPath());
 }
 
-void DMD::DumpDMDRgb565()
+std::shared_future<Vni_Context*> DMD::LoadVniAsync(const std::string& romName, const std::string& altColorPath)
 {
-  if (!m_pDumpDMDRgb565Thread)
-  {
-    m_pDumpDMDRgb565Thread = new std::thread(&DMD::DumpDMDRgb565Thread, this);
-  }
+  auto promise = std::make_shared<std::promise<Vni_Context*>>();
+  std::shared_future<Vni_Context*> vniLoad = promise->get_future().share();
+  m_pAssetLoader->Submit(
+      [this, promise, romName, altColorPath]()
+      {
+        SetThreadLogConfig(&m_pConfig);
+        Vni_Context* pVni = nullptr;
+#ifdef DMDUTIL_ENABLE_VNI
+        const std::string baseDir = BuildAltColorDir(altColorPath.c_str(), romName.c_str());
+        std::string palPath;
+        std::string vniPath;
+        std::string pacPath;
+
+        FindCaseInsensitiveFile(baseDir, romName + ".pal", &palPath);
+        FindCaseInsensitiveFile(baseDir, romName + ".vni", &vniPath);
+        FindCaseInsensitiveFile(baseDir, romName + ".pac", &pacPath);
+
+        const char* vniKey = GetConfig()->GetVniKey();
+        if (!pacPath.empty() && (!vniKey || vniKey[0] == '\0'))
+        {
+          Log(DMDUtil_LogLevel_ERROR, "VNI: pac file requires VNI key for %s", romName.c_str());
+        }
+        else if (!palPath.empty() || !vniPath.empty() || !pacPath.empty())
+        {
+          pVni = Vni_LoadFromPaths(palPath.empty() ? nullptr : palPath.c_str(),
+                                   vniPath.empty() ? nullptr : vniPath.c_str(),
+                                   pacPath.empty() ? nullptr : pacPath.c_str(),
+                                   (vniKey && vniKey[0] != '\0') ? vniKey : nullptr);
+        }
+#endif
+        promise->set_value(pVni);
+      });
+  return vniLoad;
+}
+
+std::shared_future<Vni_Context*> DMD::TakeVniPreload(const std::string& romName, const std::string& altColorPath)
+{
+  std::lock_guard<std::mutex> lock(m_preloadMutex);
+  if (!m_vniPreload.valid() || romName != m_preloadRomName || altColorPath != m_preloadAltColorPath)
+    return std::shared_future<Vni_Context*>();
+
+  std::shared_future<Vni_Context*> vniLoad = std::move(m_vniPreload);
+  m_vniPreload = std::shared_future<Vni_Context*>();
+  m_preloadRomName.clear();
+  m_preloadAltColorPath.clear();
+  return vniLoad;
+}
+
+void DMD::DiscardVni(const std::shared_future<Vni_Context*>& vniLoad)
+{
+#ifdef DMDUTIL_ENABLE_VNI
+  if (!vniLoad.valid()) return;
+
+  // Disposing has to wait for the load, which is the loader's business and not the caller's.
+  m_pAssetLoader->Submit(
+      [vniLoad]()
+      {
+        Vni_Context* pVni = vniLoad.get();
+        if (pVni) Vni_Dispose(pVni);
+      });
+#endif
 }
 
-void DMD::DumpDMDRgb888()
+void DMD::SetPUPVideosPath(const char* path) { strcpy(m_pupVideosPath, path ? path : ""); }
+
+void DMD::DumpDMDTxt() { EnableDump(DMDUTIL_DUMP_FORMAT_TXT); }
+
+void DMD::DumpDMDRaw() { EnableDump(DMDUTIL_DUMP_FORMAT_RAW); }
+
+void DMD::DumpDMDRgb565() { EnableDump(DMDUTIL_DUMP_FORMAT_RGB565); }
+
+void DMD::DumpDMDRgb888() { EnableDump(DMDUTIL_DUMP_FORMAT_RGB888); }
+
+void DMD::EnableDump(uint8_t format)
 {
-  if (!m_pDumpDMDRgb888Thread)
+  // All formats share one dump stage, additional formats are picked up on its next wakeup.
+  m_dumpFormats.fetch_or(format, std::memory_order_acq_rel);
+  if (!m_pDumpDMDThread)
   {
-    m_pDumpDMDRgb888Thread = new std::thread(&DMD::DumpDMDRgb888Thread, this);
+    m_pDumpDMDThread = new std::thread(&DMD::DumpDMDThread, this);
   }
 }
 
@@ -628,6 +824,7 @@ bool DMD::DestroyLevelDMD(LevelDMD* pLevelDMD)
 
 void DMD::AddRGB24DMD(RGB24DMD* pRGB24DMD)
 {
+  pRGB24DMD->SetRoundedCorners(GetConfig()->GetRoundedCorners());
   m_rgb24DMDs.push_back(pRGB24DMD);
   Log(DMDUtil_LogLevel_INFO, "Added RGB24DMD");
   if (!m_pRGB24DMDThread)
@@ -744,51 +941,105 @@ void DMD::QueueUpdate(const std::shared_ptr<Update> dmdUpdate, bool buffered, bo
                       const FrameContext* frameContext)
 {
   const FrameContext frameContextCopy = frameContext ? *frameContext : FrameContext{};
-  std::thread(
-      [this, dmdUpdate, buffered, hasTimestamp, timestampMs, frameContextCopy]()
-      {
-        std::unique_lock<std::shared_mutex> ul(m_dmdSharedMutex);
-        uint16_t updateBufferQueuePosition = m_updateBufferQueuePosition.load(std::memory_order_acquire);
-        uint8_t slot = (++updateBufferQueuePosition) % DMDUTIL_FRAME_BUFFER_SIZE;
-        memcpy(m_pUpdateBufferQueue[slot], dmdUpdate.get(), sizeof(Update));
-        m_updateBufferQueueHasTimestamp[slot] = hasTimestamp;
-        m_updateBufferQueueTimestamp[slot] = timestampMs;
-        m_updateBufferQueueFrameContext[slot] = frameContextCopy;
-        m_updateBufferQueuePosition.store(updateBufferQueuePosition, std::memory_order_release);
-
-        Log(DMDUtil_LogLevel_DEBUG, "Queued Frame: position=%d, mode=%d, depth=%d", updateBufferQueuePosition,
-            dmdUpdate->mode, dmdUpdate->depth);
-
-        if (buffered)
-        {
-          memcpy(m_updateBuffered.get(), dmdUpdate.get(), sizeof(Update));
-          m_hasUpdateBuffered = true;
-        }
 
-        ul.unlock();
-        m_dmdCV.notify_all();
+  if (m_executionMode.load(std::memory_order_acquire) == ExecutionMode::Synchronous)
+  {
+    const uint64_t sequence = m_updateBufferQueueSubmitted.fetch_add(1, std::memory_order_acq_rel) + 1;
+    InsertUpdate(dmdUpdate, buffered, hasTimestamp, timestampMs, frameContextCopy, sequence);
+    // Serum and VNI queue their colorized frames from their own consumer thread, they must not wait for themselves.
+    if (t_pConsumerDMD != this && !WaitFence(sequence, kSynchronousTimeoutMs))
+    {
+      Log(DMDUtil_LogLevel_ERROR, "Synchronous frame %llu not consumed within %ums", (unsigned long long)sequence,
+          kSynchronousTimeoutMs);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_insertMutex);
+    // Numbered under the lock, so the queue order matches the sequence.
+    const uint64_t sequence = m_updateBufferQueueSubmitted.fetch_add(1, std::memory_order_acq_rel) + 1;
+    m_insertQueue.push({dmdUpdate, buffered, hasTimestamp, timestampMs, frameContextCopy, sequence});
+  }
+  m_insertCv.notify_one();
+}
 
-        const bool sendToDMDServer = !IsSerumMode(dmdUpdate->mode) || dmdUpdate->mode == Mode::SerumCommand;
-        if (m_pDMDServerConnector && sendToDMDServer)
-        {
-          StreamHeader streamHeader;
-          streamHeader.buffered = (uint8_t)buffered;
-          streamHeader.disconnectOthers = (uint8_t)m_dmdServerDisconnectOthers;
-          streamHeader.convertToNetworkByteOrder();
-          m_pDMDServerConnector->Write(&streamHeader, sizeof(StreamHeader));
-          PathsHeader pathsHeader;
-          strcpy(pathsHeader.name, m_romName);
-          strcpy(pathsHeader.altColorPath, m_altColorPath);
-          strcpy(pathsHeader.pupVideosPath, m_pupVideosPath);
-          pathsHeader.convertToNetworkByteOrder();
-          m_pDMDServerConnector->Write(&pathsHeader, sizeof(PathsHeader));
-          Update dmdUpdateNetwork = dmdUpdate->toNetworkByteOrder();
-          m_pDMDServerConnector->Write(&dmdUpdateNetwork, sizeof(Update));
-
-          if (streamHeader.disconnectOthers != 0) m_dmdServerDisconnectOthers = false;
-        }
-      })
-      .detach();
+void DMD::InsertThread()
+{
+  SetThreadLogConfig(&m_pConfig);
+
+  while (true)
+  {
+    std::unique_lock<std::mutex> lock(m_insertMutex);
+    m_insertCv.wait(lock, [&]() { return m_stopFlag.load(std::memory_order_relaxed) || !m_insertQueue.empty(); });
+    if (m_stopFlag.load(std::memory_order_acquire)) return;
+
+    PendingUpdate pending = std::move(m_insertQueue.front());
+    m_insertQueue.pop();
+    lock.unlock();
+
+    InsertUpdate(pending.update, pending.buffered, pending.hasTimestamp, pending.timestampMs, pending.frameContext,
+                 pending.sequence);
+  }
+}
+
+void DMD::InsertUpdate(const std::shared_ptr<Update>& dmdUpdate, bool buffered, bool hasTimestamp,
+                       uint32_t timestampMs, const FrameContext& frameContext, uint64_t sequence)
+{
+  std::unique_lock<std::shared_mutex> ul(m_dmdSharedMutex);
+  // Enter the ring in submission order, fences rely on it.
+  m_dmdCV.wait(ul,
+               [&]()
+               {
+                 return m_stopFlag.load(std::memory_order_relaxed) ||
+                        (m_updateBufferQueueSequence.load(std::memory_order_relaxed) + 1 == sequence);
+               });
+  if (m_stopFlag.load(std::memory_order_acquire)) return;
+
+  uint16_t updateBufferQueuePosition = m_updateBufferQueuePosition.load(std::memory_order_acquire);
+  uint8_t slot = (++updateBufferQueuePosition) % DMDUTIL_FRAME_BUFFER_SIZE;
+  memcpy(m_pUpdateBufferQueue[slot], dmdUpdate.get(), sizeof(Update));
+  m_updateBufferQueueHasTimestamp[slot] = hasTimestamp;
+  m_updateBufferQueueTimestamp[slot] = timestampMs;
+  m_updateBufferQueueFrameContext[slot] = frameContext;
+  m_updateBufferQueueSequence.store(sequence, std::memory_order_release);
+  m_updateBufferQueuePosition.store(updateBufferQueuePosition, std::memory_order_release);
+  if (hasTimestamp && m_clockMode.load(std::memory_order_relaxed) == ClockMode::FrameTimestamps &&
+      timestampMs > m_virtualClockMs.load(std::memory_order_relaxed))
+    m_virtualClockMs.store(timestampMs, std::memory_order_release);
+
+  Log(DMDUtil_LogLevel_DEBUG, "Queued Frame: position=%d, mode=%d, depth=%d", updateBufferQueuePosition,
+      dmdUpdate->mode, dmdUpdate->depth);
+
+  if (buffered)
+  {
+    memcpy(m_updateBuffered.get(), dmdUpdate.get(), sizeof(Update));
+    m_hasUpdateBuffered = true;
+  }
+
+  ul.unlock();
+  m_dmdCV.notify_all();
+  NotifyFenceWaiters();
+
+  const bool sendToDMDServer = !IsSerumMode(dmdUpdate->mode) || dmdUpdate->mode == Mode::SerumCommand;
+  if (m_pDMDServerConnector && sendToDMDServer)
+  {
+    StreamHeader streamHeader;
+    streamHeader.buffered = (uint8_t)buffered;
+    streamHeader.disconnectOthers = (uint8_t)m_dmdServerDisconnectOthers;
+    streamHeader.convertToNetworkByteOrder();
+    m_pDMDServerConnector->Write(&streamHeader, sizeof(StreamHeader));
+    PathsHeader pathsHeader;
+    strcpy(pathsHeader.name, m_romName);
+    strcpy(pathsHeader.altColorPath, m_altColorPath);
+    strcpy(pathsHeader.pupVideosPath, m_pupVideosPath);
+    pathsHeader.convertToNetworkByteOrder();
+    m_pDMDServerConnector->Write(&pathsHeader, sizeof(PathsHeader));
+    Update dmdUpdateNetwork = dmdUpdate->toNetworkByteOrder();
+    m_pDMDServerConnector->Write(&dmdUpdateNetwork, sizeof(Update));
+
+    if (streamHeader.disconnectOthers != 0) m_dmdServerDisconnectOthers = false;
+  }
 }
 
 bool DMD::QueueBuffer()
@@ -1020,7 +1271,7 @@ void DMD::FindDisplays()
 {
   if (m_finding.load(std::memory_order_acquire)) return;
 
-  Config* const pConfig = Config::GetInstance();
+  const Config* const pConfig = GetConfig();
 
   if (pConfig->IsDmdServer())
   {
@@ -1031,176 +1282,366 @@ void DMD::FindDisplays()
   {
     m_finding.store(true, std::memory_order_release);
 
-    std::thread(
-        [this]()
-        {
-          Config* const pConfig = Config::GetInstance();
-          ZeDMD* pZeDMD = nullptr;
-
-          bool openSerial = false;
-          bool openWiFi = false;
-          bool openSpi = false;
-
-          if (pConfig->IsZeDMD() || pConfig->IsZeDMDWiFiEnabled() || pConfig->IsZeDMDSpiEnabled())
-          {
-            pZeDMD = new ZeDMD();
-            pZeDMD->SetLogCallback(ZeDMDLogCallback, nullptr);
-          }
-
-          if (pConfig->IsZeDMDWiFiEnabled())
-          {
-            std::string WiFiAddr = pConfig->GetZeDMDWiFiAddr() ? pConfig->GetZeDMDWiFiAddr() : "zedmd-wifi.local";
-
-            if (WiFiAddr.empty())
-            {
-              DMDUtil::Log(DMDUtil_LogLevel_ERROR, "ERROR: ZeDMD WiFi IP address is not configured.");
-            }
-
-            // Proceed only if the WiFiAddr is valid.
-            if (!WiFiAddr.empty() && (openWiFi = pZeDMD->OpenWiFi(WiFiAddr.c_str())))
-            {
-              std::stringstream logMessage;
-              logMessage << "ZeDMD WiFi enabled, connected to " << WiFiAddr << ".";
-              DMDUtil::Log(DMDUtil_LogLevel_INFO, logMessage.str().c_str());
-            }
-          }
-
-          if (pConfig->IsZeDMD())
-          {
-            if (pConfig->GetZeDMDDevice() != nullptr && pConfig->GetZeDMDDevice()[0] != '\0')
-              pZeDMD->SetDevice(pConfig->GetZeDMDDevice());
-
-            if ((openSerial = pZeDMD->Open()))
-            {
-              if (pConfig->GetZeDMDBrightness() != -1) pZeDMD->SetBrightness(pConfig->GetZeDMDBrightness());
-            }
-          }
+    // A previous search has finished, m_finding was false.
+    if (m_pFindThread)
+    {
+      m_pFindThread->join();
+      delete m_pFindThread;
+    }
 
-          if (pConfig->IsZeDMDSpiEnabled())
-          {
-            Log(DMDUtil_LogLevel_INFO, "ZeDMD SPI: try to open with speed=%d, framePause=%d, width=%d, height=%d",
-                pConfig->GetZeDMDSpiSpeed(), pConfig->GetZeDMDSpiFramePause(), pConfig->GetZeDMDWidth(),
-                pConfig->GetZeDMDHeight());
-            if ((openSpi = pZeDMD->OpenSpi(pConfig->GetZeDMDSpiSpeed(), pConfig->GetZeDMDSpiFramePause(),
-                                           pConfig->GetZeDMDWidth(), pConfig->GetZeDMDHeight())))
-            {
-              Log(DMDUtil_LogLevel_INFO, "ZeDMD SPI: speed=%d, framePause=%d, width=%d, height=%d",
-                  pConfig->GetZeDMDSpiSpeed(), pConfig->GetZeDMDSpiFramePause(), pZeDMD->GetWidth(),
-                  pZeDMD->GetHeight());
-            }
-            else
-            {
-              Log(DMDUtil_LogLevel_ERROR, "ZeDMD SPI failed");
-            }
-          }
+    // The transports are searched in parallel and every display starts rendering as soon as it is found, so a slow
+    // search doesn't hold back the others.
+    m_pFindThread = new std::thread(
+        [this, pConfig]()
+        {
+          SetThreadLogConfig(&m_pConfig);
+          const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 
-          if (openSerial || openWiFi || openSpi)
-          {
-            if (pConfig->IsZeDMDDebug())
-            {
-              pZeDMD->EnableDebug();
-              pZeDMD->EnableVerbose();
-            }
-            pZeDMD->EnableUpscaling();
-            m_pZeDMDThread = new std::thread(&DMD::ZeDMDThread, this);
-          }
-          else
-          {
-            delete pZeDMD;
-            pZeDMD = nullptr;
-          }
+          // Every finder updates its own entry of the cache.
+          const std::string cachePath = pConfig->GetDiscoveryCachePath();
+          DiscoveryCache cache;
+          if (!cachePath.empty()) cache = LoadDiscoveryCache(cachePath);
+          const DiscoveryCache loadedCache = cache;
 
-          m_pZeDMD = pZeDMD;
+          std::vector<std::thread> finders;
+          if (pConfig->IsZeDMD() || pConfig->IsZeDMDWiFiEnabled() || pConfig->IsZeDMDSpiEnabled() ||
+              !pConfig->GetZeDMDOutputs().empty())
+            finders.emplace_back(&DMD::FindZeDMD, this, pConfig, std::ref(cache.zedmd));
 
 #if !(                                                                                                                \
     (defined(__APPLE__) && ((defined(TARGET_OS_IOS) && TARGET_OS_IOS) || (defined(TARGET_OS_TV) && TARGET_OS_TV))) || \
     defined(__ANDROID__))
-          PixelcadeDMD* pPixelcadeDMD = nullptr;
-
           if (pConfig->IsPixelcade())
-          {
-            pPixelcadeDMD = PixelcadeDMD::Connect(pConfig->GetPixelcadeDevice());
-            if (pPixelcadeDMD) m_pPixelcadeDMDThread = new std::thread(&DMD::PixelcadeDMDThread, this);
-          }
-
-          m_pPixelcadeDMD = pPixelcadeDMD;
+            finders.emplace_back(&DMD::FindPixelcadeDMD, this, pConfig, std::ref(cache.pixelcade));
 #endif
 
 #if defined(DMDUTIL_ENABLE_PIN2DMD) && !((defined(__APPLE__) && ((defined(TARGET_OS_IOS) && TARGET_OS_IOS) || \
                                                                  (defined(TARGET_OS_TV) && TARGET_OS_TV))) || \
                                          defined(__ANDROID__))
-          m_PIN2DMDConnected = false;
-          m_PIN2DMDWidth = 0;
-          m_PIN2DMDHeight = 0;
-
-          if (pConfig->IsPIN2DMD())
-          {
-            int PIN2DMDInitResult = PIN2DMDInit();
-            if (PIN2DMDInitResult > 0)
-            {
-              m_PIN2DMDWidth = PIN2DMDGetWidth();
-              m_PIN2DMDHeight = PIN2DMDGetHeight();
-              if (m_PIN2DMDWidth > 0 && m_PIN2DMDHeight > 0)
-              {
-                m_PIN2DMDConnected = true;
-                m_pPIN2DMDThread = new std::thread(&DMD::PIN2DMDThread, this);
-              }
-            }
-          }
+          if (pConfig->IsPIN2DMD()) finders.emplace_back(&DMD::FindPIN2DMD, this, pConfig);
 #endif
 
+          for (std::thread& finder : finders) finder.join();
+
+          if (!cachePath.empty() && !(cache == loadedCache) && !SaveDiscoveryCache(cachePath, cache))
+            Log(DMDUtil_LogLevel_ERROR, "Failed to write the display cache %s", cachePath.c_str());
+
+          Log(DMDUtil_LogLevel_INFO, "Display search finished after %u ms", ElapsedUs(start) / 1000);
           m_finding.store(false, std::memory_order_release);
-        })
-        .detach();
+        });
   }
 }
 
-uint16_t DMD::GetNextBufferQueuePosition(uint16_t bufferPosition, const uint16_t updateBufferQueuePosition)
+void DMD::FindZeDMD(const Config* pConfig, CachedDisplay& cached)
 {
-  if (bufferPosition == updateBufferQueuePosition)
+  SetThreadLogConfig(&m_pConfig);
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  // Every transport and every additional panel gets its own ZeDMD and render thread.
+  std::vector<ZeDMDOutput*> outputs;
+  // Serial ports a search must not take: the configured ones and those opened already.
+  std::vector<std::string> reservedDevices;
+  for (const ZeDMDOutputConfig& outputConfig : pConfig->GetZeDMDOutputs())
   {
-    return bufferPosition;  // No change, return current position
+    if (!outputConfig.device.empty()) reservedDevices.push_back(outputConfig.device);
   }
 
-  ++bufferPosition;  // 65535 + 1 = 0
-
-  if (bufferPosition < updateBufferQueuePosition)
+  auto createZeDMD = []()
   {
-    if ((updateBufferQueuePosition - bufferPosition) > DMDUTIL_MAX_FRAMES_BEHIND)
-      return updateBufferQueuePosition - DMDUTIL_MIN_FRAMES_BEHIND;  // Too many frames behind, skip a lot
-    else if ((updateBufferQueuePosition - bufferPosition) > (DMDUTIL_MAX_FRAMES_BEHIND / 2))
-      return ++bufferPosition;  // Skip one frame to avoid too many frames behind
-  }
-  else if (bufferPosition > updateBufferQueuePosition)  // updateBufferQueuePosition crossed the overflow point
+    ZeDMD* pZeDMD = new ZeDMD();
+    pZeDMD->SetLogCallback(ZeDMDLogCallback, nullptr);
+    return pZeDMD;
+  };
+
+  // Only called with m_serialSearchMutex held.
+  auto openSerial = [&](ZeDMD* pZeDMD, const std::string& device)
   {
-    if ((65535 - bufferPosition + updateBufferQueuePosition) > DMDUTIL_MAX_FRAMES_BEHIND)
-      // Too many frames behind, skip a lot, if the result is negative, it's fine, it
-      // will wrap around
-      return updateBufferQueuePosition - DMDUTIL_MIN_FRAMES_BEHIND;
-    else if ((65535 - bufferPosition + updateBufferQueuePosition) > (DMDUTIL_MAX_FRAMES_BEHIND / 2))
-      return ++bufferPosition;  // Skip one frame to avoid too many frames behind
-  }
+    if (!device.empty())
+    {
+      if (std::find(m_claimedSerialPorts.begin(), m_claimedSerialPorts.end(), device) != m_claimedSerialPorts.end())
+      {
+        Log(DMDUtil_LogLevel_INFO, "ZeDMD: %s is used by another display", device.c_str());
+        return false;
+      }
+      pZeDMD->SetDevice(device.c_str());
+    }
+    else
+    {
+      for (const std::string& reservedDevice : reservedDevices) pZeDMD->IgnoreDevice(reservedDevice.c_str());
+    }
 
-  return bufferPosition;
-}
+    if (!pZeDMD->Open()) return false;
 
-void DMD::DmdFrameThread()
-{
-  char name[DMDUTIL_MAX_NAME_SIZE] = {0};
-  uint16_t bufferPosition = 0;
+    const char* pDevice = pZeDMD->GetDevice();
+    if (pDevice)
+    {
+      reservedDevices.push_back(pDevice);
+      m_claimedSerialPorts.push_back(pDevice);
+    }
+    return true;
+  };
 
-  (void)m_stopFlag.load(std::memory_order_acquire);
+  auto addOutput = [&](ZeDMD* pZeDMD, const char* pName, int brightness, int roundedCorners)
+  {
+    if (brightness != -1) pZeDMD->SetBrightness(brightness);
+    if (pConfig->IsZeDMDDebug())
+    {
+      pZeDMD->EnableDebug();
+      pZeDMD->EnableVerbose();
+    }
+    pZeDMD->EnableUpscaling();
+    outputs.push_back(new ZeDMDOutput(pZeDMD, pName, roundedCorners, [this]() { NotifyFenceWaiters(); }));
+    Log(DMDUtil_LogLevel_INFO, "%s: %dx%d", pName, pZeDMD->GetWidth(), pZeDMD->GetHeight());
+  };
 
-  while (true)
+  if (pConfig->IsZeDMDWiFiEnabled())
   {
-    std::shared_lock<std::shared_mutex> sl(m_dmdSharedMutex);
-    m_dmdCV.wait(sl,
-                 [&]()
-                 {
-                   return m_stopFlag.load(std::memory_order_relaxed) ||
-                          (m_updateBufferQueuePosition.load(std::memory_order_relaxed) != bufferPosition);
-                 });
-    sl.unlock();
+    std::string WiFiAddr = pConfig->GetZeDMDWiFiAddr() ? pConfig->GetZeDMDWiFiAddr() : "zedmd-wifi.local";
+
+    if (WiFiAddr.empty())
+    {
+      DMDUtil::Log(DMDUtil_LogLevel_ERROR, "ERROR: ZeDMD WiFi IP address is not configured.");
+    }
+
+    // Proceed only if the WiFiAddr is valid.
+    ZeDMD* pZeDMD = createZeDMD();
+    if (!WiFiAddr.empty() && pZeDMD->OpenWiFi(WiFiAddr.c_str()))
+    {
+      std::stringstream logMessage;
+      logMessage << "ZeDMD WiFi enabled, connected to " << WiFiAddr << ".";
+      DMDUtil::Log(DMDUtil_LogLevel_INFO, logMessage.str().c_str());
+      addOutput(pZeDMD, "ZeDMD WiFi", -1, pConfig->GetZeDMDRoundedCorners());
+    }
+    else
+    {
+      delete pZeDMD;
+    }
+  }
+
+  if (pConfig->IsZeDMDSpiEnabled())
+  {
+    Log(DMDUtil_LogLevel_INFO, "ZeDMD SPI: try to open with speed=%d, framePause=%d, width=%d, height=%d",
+        pConfig->GetZeDMDSpiSpeed(), pConfig->GetZeDMDSpiFramePause(), pConfig->GetZeDMDWidth(),
+        pConfig->GetZeDMDHeight());
+    ZeDMD* pZeDMD = createZeDMD();
+    if (pZeDMD->OpenSpi(pConfig->GetZeDMDSpiSpeed(), pConfig->GetZeDMDSpiFramePause(), pConfig->GetZeDMDWidth(),
+                        pConfig->GetZeDMDHeight()))
+    {
+      Log(DMDUtil_LogLevel_INFO, "ZeDMD SPI: speed=%d, framePause=%d, width=%d, height=%d",
+          pConfig->GetZeDMDSpiSpeed(), pConfig->GetZeDMDSpiFramePause(), pZeDMD->GetWidth(), pZeDMD->GetHeight());
+      addOutput(pZeDMD, "ZeDMD SPI", -1, pConfig->GetZeDMDRoundedCorners());
+    }
+    else
+    {
+      Log(DMDUtil_LogLevel_ERROR, "ZeDMD SPI failed");
+      delete pZeDMD;
+    }
+  }
+
+  if (pConfig->IsZeDMD() || !pConfig->GetZeDMDOutputs().empty())
+  {
+    // Pixelcade is searched on serial ports too. A port both talk to at the same time answers neither.
+    std::lock_guard<std::mutex> serialLock(m_serialSearchMutex);
+    reservedDevices.insert(reservedDevices.end(), m_claimedSerialPorts.begin(), m_claimedSerialPorts.end());
+
+    if (pConfig->IsZeDMD())
+    {
+      ZeDMD* pZeDMD = createZeDMD();
+      const std::string device = pConfig->GetZeDMDDevice() ? pConfig->GetZeDMDDevice() : "";
+      bool open = false;
+      if (device.empty() && !cached.device.empty() &&
+          std::find(reservedDevices.begin(), reservedDevices.end(), cached.device) == reservedDevices.end())
+      {
+        Log(DMDUtil_LogLevel_INFO, "ZeDMD: Trying %s from the display cache", cached.device.c_str());
+        if (!(open = openSerial(pZeDMD, cached.device)))
+        {
+          Log(DMDUtil_LogLevel_INFO, "ZeDMD: Not found on %s, searching all ports", cached.device.c_str());
+          delete pZeDMD;
+          pZeDMD = createZeDMD();
+        }
+      }
+
+      const CachedDisplay previous = cached;
+      cached = CachedDisplay();
+      if (open || openSerial(pZeDMD, device))
+      {
+        const char* pDevice = pZeDMD->GetDevice();
+        const char* pFirmware = pZeDMD->GetFirmwareVersion();
+        cached.device = pDevice ? pDevice : "";
+        cached.firmware = pFirmware ? pFirmware : "";
+        cached.width = pZeDMD->GetWidth();
+        cached.height = pZeDMD->GetHeight();
+        LogDisplayChange("ZeDMD", previous, cached);
+        addOutput(pZeDMD, "ZeDMD", pConfig->GetZeDMDBrightness(), pConfig->GetZeDMDRoundedCorners());
+      }
+      else
+      {
+        delete pZeDMD;
+      }
+    }
+
+    int index = 2;
+    for (const ZeDMDOutputConfig& outputConfig : pConfig->GetZeDMDOutputs())
+    {
+      const std::string name = "ZeDMD " + std::to_string(index++);
+      ZeDMD* pZeDMD = createZeDMD();
+      if (openSerial(pZeDMD, outputConfig.device))
+      {
+        addOutput(pZeDMD, name.c_str(), outputConfig.brightness, outputConfig.roundedCorners);
+      }
+      else
+      {
+        Log(DMDUtil_LogLevel_ERROR, "%s: Not found", name.c_str());
+        delete pZeDMD;
+      }
+    }
+  }
+
+  if (!outputs.empty())
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_displaysMutex);
+      m_zedmdOutputs = outputs;
+    }
+    m_pZeDMDThread = new std::thread(&DMD::ZeDMDThread, this);
+  }
+
+  Log(DMDUtil_LogLevel_INFO, "ZeDMD: Search finished after %u ms, %d display(s) found", ElapsedUs(start) / 1000,
+      (int)outputs.size());
+}
+
+#if !(                                                                                                                \
+    (defined(__APPLE__) && ((defined(TARGET_OS_IOS) && TARGET_OS_IOS) || (defined(TARGET_OS_TV) && TARGET_OS_TV))) || \
+    defined(__ANDROID__))
+void DMD::FindPixelcadeDMD(const Config* pConfig, CachedDisplay& cached)
+{
+  SetThreadLogConfig(&m_pConfig);
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  // Takes turns with the ZeDMD serial search, see FindZeDMD().
+  std::lock_guard<std::mutex> serialLock(m_serialSearchMutex);
+  // Ports opened by another display and the ones configured for ZeDMD are left alone.
+  std::vector<std::string> ignoredDevices = m_claimedSerialPorts;
+  if (pConfig->GetZeDMDDevice()[0] != '\0') ignoredDevices.push_back(pConfig->GetZeDMDDevice());
+  for (const ZeDMDOutputConfig& outputConfig : pConfig->GetZeDMDOutputs())
+  {
+    if (!outputConfig.device.empty()) ignoredDevices.push_back(outputConfig.device);
+  }
+  auto isIgnored = [&](const std::string& device)
+  { return std::find(ignoredDevices.begin(), ignoredDevices.end(), device) != ignoredDevices.end(); };
+
+  PixelcadeDMD* pPixelcadeDMD = nullptr;
+  const char* pDevice = pConfig->GetPixelcadeDevice();
+  if ((!pDevice || pDevice[0] == '\0') && !cached.device.empty() && !isIgnored(cached.device))
+  {
+    Log(DMDUtil_LogLevel_INFO, "Pixelcade: Trying %s from the display cache", cached.device.c_str());
+    if (!(pPixelcadeDMD = PixelcadeDMD::Connect(cached.device.c_str())))
+      Log(DMDUtil_LogLevel_INFO, "Pixelcade: Not found on %s, searching all ports", cached.device.c_str());
+  }
+  if (!pPixelcadeDMD)
+  {
+    if (pDevice && pDevice[0] != '\0' &&
+        std::find(m_claimedSerialPorts.begin(), m_claimedSerialPorts.end(), pDevice) != m_claimedSerialPorts.end())
+      Log(DMDUtil_LogLevel_INFO, "Pixelcade: %s is used by another display", pDevice);
+    else
+      pPixelcadeDMD = PixelcadeDMD::Connect(pDevice, kPixelcadeSearchTimeoutMs, &ignoredDevices);
+  }
+
+  const CachedDisplay previous = cached;
+  cached = CachedDisplay();
+  if (pPixelcadeDMD)
+  {
+    m_claimedSerialPorts.push_back(pPixelcadeDMD->GetDevice());
+
+    cached.device = pPixelcadeDMD->GetDevice();
+    cached.firmware = pPixelcadeDMD->GetFirmware();
+    cached.width = pPixelcadeDMD->GetWidth();
+    cached.height = pPixelcadeDMD->GetHeight();
+    cached.isV2 = pPixelcadeDMD->GetIsV2();
+    cached.colorSwap = pPixelcadeDMD->GetColorSwap();
+    LogDisplayChange("Pixelcade", previous, cached);
+
+    {
+      std::lock_guard<std::mutex> lock(m_displaysMutex);
+      m_pPixelcadeDMD = pPixelcadeDMD;
+    }
+    m_pPixelcadeDMDThread = new std::thread(&DMD::PixelcadeDMDThread, this);
+  }
+
+  Log(DMDUtil_LogLevel_INFO, "Pixelcade: Search finished after %u ms", ElapsedUs(start) / 1000);
+}
+#endif
+
+#if defined(DMDUTIL_ENABLE_PIN2DMD) && !((defined(__APPLE__) && ((defined(TARGET_OS_IOS) && TARGET_OS_IOS) || \
+                                                                 (defined(TARGET_OS_TV) && TARGET_OS_TV))) || \
+                                         defined(__ANDROID__))
+void DMD::FindPIN2DMD(const Config* pConfig)
+{
+  (void)pConfig;
+  SetThreadLogConfig(&m_pConfig);
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  PIN2DMD* pPIN2DMD = PIN2DMD::Connect();
+  if (pPIN2DMD)
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_displaysMutex);
+      m_pPIN2DMD = pPIN2DMD;
+    }
+    m_pPIN2DMDThread = new std::thread(&DMD::PIN2DMDThread, this);
+  }
+
+  Log(DMDUtil_LogLevel_INFO, "PIN2DMD: Search finished after %u ms", ElapsedUs(start) / 1000);
+}
+#endif
+
+uint16_t DMD::GetNextBufferQueuePosition(uint16_t bufferPosition, const uint16_t updateBufferQueuePosition)
+{
+  if (bufferPosition == updateBufferQueuePosition)
+  {
+    return bufferPosition;  // No change, return current position
+  }
+
+  ++bufferPosition;  // 65535 + 1 = 0
+
+  if (bufferPosition < updateBufferQueuePosition)
+  {
+    if ((updateBufferQueuePosition - bufferPosition) > DMDUTIL_MAX_FRAMES_BEHIND)
+      return updateBufferQueuePosition - DMDUTIL_MIN_FRAMES_BEHIND;  // Too many frames behind, skip a lot
+    else if ((updateBufferQueuePosition - bufferPosition) > (DMDUTIL_MAX_FRAMES_BEHIND / 2))
+      return ++bufferPosition;  // Skip one frame to avoid too many frames behind
+  }
+  else if (bufferPosition > updateBufferQueuePosition)  // updateBufferQueuePosition crossed the overflow point
+  {
+    if ((65535 - bufferPosition + updateBufferQueuePosition) > DMDUTIL_MAX_FRAMES_BEHIND)
+      // Too many frames behind, skip a lot, if the result is negative, it's fine, it
+      // will wrap around
+      return updateBufferQueuePosition - DMDUTIL_MIN_FRAMES_BEHIND;
+    else if ((65535 - bufferPosition + updateBufferQueuePosition) > (DMDUTIL_MAX_FRAMES_BEHIND / 2))
+      return ++bufferPosition;  // Skip one frame to avoid too many frames behind
+  }
+
+  return bufferPosition;
+}
+
+void DMD::DmdFrameThread()
+{
+  char name[DMDUTIL_MAX_NAME_SIZE] = {0};
+  uint16_t bufferPosition = 0;
+
+  (void)m_stopFlag.load(std::memory_order_acquire);
+  SetThreadLogConfig(&m_pConfig);
+
+  while (true)
+  {
+    std::shared_lock<std::shared_mutex> sl(m_dmdSharedMutex);
+    m_dmdCV.wait(sl,
+                 [&]()
+                 {
+                   return m_stopFlag.load(std::memory_order_relaxed) ||
+                          (m_updateBufferQueuePosition.load(std::memory_order_relaxed) != bufferPosition);
+                 });
+    sl.unlock();
 
     bufferPosition = m_updateBufferQueuePosition.load(std::memory_order_relaxed);
 
@@ -1234,11 +1675,8 @@ void DMD::ZeDMDThread()
   uint8_t renderBuffer[256 * 64 * 3] = {0};
 
   (void)m_stopFlag.load(std::memory_order_acquire);
-
-  Config* const pConfig = Config::GetInstance();
-  bool showNotColorizedFrames = pConfig->IsShowNotColorizedFrames();
-  bool excludeColorizedFrames = pConfig->IsExcludeColorizedFramesForZeDMD();
-  const int roundedCorners = pConfig->GetRoundedCorners();
+  SetThreadLogConfig(&m_pConfig);
+  ConsumerScope consumerScope(this, Consumer::ZeDMD);
 
   while (true)
   {
@@ -1256,7 +1694,32 @@ void DMD::ZeDMDThread()
       return;
     }
 
+    // A synchronous producer waits for every frame, so the outputs only pace and supersede frames asynchronously.
+    const bool paced = m_executionMode.load(std::memory_order_acquire) != ExecutionMode::Synchronous;
+
     const uint16_t updateBufferQueuePosition = m_updateBufferQueuePosition.load(std::memory_order_acquire);
+    // Per frame settings follow a snapshot swapped in by SetConfig().
+    const Config* const pConfig = GetConfig();
+    const bool showNotColorizedFrames = pConfig->IsShowNotColorizedFrames();
+    const bool excludeColorizedFrames = pConfig->IsExcludeColorizedFramesForZeDMD();
+    const int roundedCorners = pConfig->GetRoundedCorners();
+    // Colorized frames of Serum v2 come in two heights, each output takes the one that fits its panel.
+    auto acceptOutput = [&](const ZeDMDOutput* pOutput, Mode mode)
+    {
+      if (excludeColorizedFrames || !(m_pSerum || m_pVni)) return true;
+      return !((pOutput->GetWidth() == 256 && mode == Mode::SerumV2_32_64) ||
+               (pOutput->GetWidth() < 256 && mode == Mode::SerumV2_64_32));
+    };
+    // Frames are converted once and every output applies its own rounded corners.
+    auto submit = [&](ZeDMDFrameFormat format, const void* pFrame, Mode mode)
+    {
+      for (ZeDMDOutput* pOutput : m_zedmdOutputs)
+      {
+        if (acceptOutput(pOutput, mode))
+          pOutput->Submit(format, width, height, pFrame, roundedCorners, paced, GetRingSequence(bufferPosition));
+      }
+    };
+
     while (!m_stopFlag.load(std::memory_order_relaxed) && bufferPosition != updateBufferQueuePosition)
     {
       uint16_t nextBufferPosition = GetNextBufferQueuePosition(bufferPosition, updateBufferQueuePosition);
@@ -1278,14 +1741,13 @@ void DMD::ZeDMDThread()
       {
         if (IsSerumMode(updateMode, true)) continue;
       }
-      else if ((m_pSerum || m_pVni) && (!IsSerumMode(updateMode, showNotColorizedFrames) ||
-                                        (m_pZeDMD->GetWidth() == 256 && updateMode == Mode::SerumV2_32_64) ||
-                                        (m_pZeDMD->GetWidth() < 256 && updateMode == Mode::SerumV2_64_32)))
+      else if ((m_pSerum || m_pVni) && !IsSerumMode(updateMode, showNotColorizedFrames))
       {
         continue;
       }
-
-      // Note: libzedmd has its own update detection.
+      if (std::none_of(m_zedmdOutputs.begin(), m_zedmdOutputs.end(),
+                       [&](const ZeDMDOutput* pOutput) { return acceptOutput(pOutput, updateMode); }))
+        continue;
 
       if (m_pUpdateBufferQueue[bufferPositionMod]->hasData || m_pUpdateBufferQueue[bufferPositionMod]->hasSegData)
       {
@@ -1306,8 +1768,6 @@ void DMD::ZeDMDThread()
             continue;
           }
           frameSize = (uint16_t)framePixels;
-          // Activate the correct scaling mode.
-          m_pZeDMD->SetFrameSize(width, height);
         }
 
         Log(DMDUtil_LogLevel_DEBUG, "ZeDMD: Render frame buffer position %d at real buffer position %d", bufferPosition,
@@ -1334,16 +1794,13 @@ void DMD::ZeDMDThread()
 
           AdjustRGB24Depth(m_pUpdateBufferQueue[bufferPositionMod]->data, rgb24Data, (size_t)width * height, palette,
                            m_pUpdateBufferQueue[bufferPositionMod]->depth);
-          ApplyRoundedCornersRGB24(rgb24Data, width, height, roundedCorners);
-          m_pZeDMD->RenderRgb888(rgb24Data);
+          submit(ZeDMDFrameFormat::RGB888, rgb24Data, updateMode);
         }
         else if (m_pUpdateBufferQueue[bufferPositionMod]->mode == Mode::RGB16 ||
                  (m_pSerum && IsSerumV2Mode(m_pUpdateBufferQueue[bufferPositionMod]->mode)))
         {
-          uint16_t rgb565Data[256 * 64];
-          memcpy(rgb565Data, m_pUpdateBufferQueue[bufferPositionMod]->segData, (size_t)frameSize * sizeof(uint16_t));
-          ApplyRoundedCornersRGB565(rgb565Data, width, height, roundedCorners);
-          m_pZeDMD->RenderRgb565(rgb565Data);
+          // The outputs copy the frame, so it is passed straight from the ring.
+          submit(ZeDMDFrameFormat::RGB565, m_pUpdateBufferQueue[bufferPositionMod]->segData, updateMode);
         }
         else
         {
@@ -1392,30 +1849,20 @@ void DMD::ZeDMDThread()
 
           if (update)
           {
-            uint16_t renderBuferPosition = 0;
-            for (int i = 0; i < frameSize; i++)
-            {
-              int pos = indexBuffer[i] * 3;
-              renderBuffer[renderBuferPosition++] = palette[pos];
-              renderBuffer[renderBuferPosition++] = palette[pos + 1];
-              renderBuffer[renderBuferPosition++] = palette[pos + 2];
-            }
+            FrameUtil::Helper::ConvertToRgb24(renderBuffer, indexBuffer, frameSize, palette);
+            submit(ZeDMDFrameFormat::RGB888, renderBuffer, updateMode);
           }
         }
-
-        if (update)
-        {
-          ApplyRoundedCornersRGB24(renderBuffer, width, height, roundedCorners);
-          m_pZeDMD->RenderRgb888(renderBuffer);
-        }
       }
     }
+    MarkConsumed(Consumer::ZeDMD, bufferPosition);
   }
 }
 
 void DMD::SerumThread()
 {
-  Config* const pConfig = Config::GetInstance();
+  SetThreadLogConfig(&m_pConfig);
+  const Config* pConfig = GetConfig();
   constexpr uint16_t kSerumTriggerMinEvent = 50000;
   constexpr uint16_t kSerumTriggerMaxEvent = 62000;
 
@@ -1427,11 +1874,81 @@ void DMD::SerumThread()
     uint32_t prevTriggerId = 0;
     char name[DMDUTIL_MAX_NAME_SIZE] = {0};
     char csvPath[DMDUTIL_MAX_PATH_SIZE + DMDUTIL_MAX_NAME_SIZE + DMDUTIL_MAX_NAME_SIZE + 10] = {0};
+    // libserum loads a single colorization per process, so a new ROM is only loaded once the previous load is handed
+    // over. Frames pass uncolorized in the meantime, unless the DMD runs synchronously.
+    std::shared_future<SerumFrameStruct*> serumLoad;
     uint32_t nextRotation = 0;
+    // Real time point of nextRotation. The thread sleeps until then unless a frame arrives first.
+    std::chrono::steady_clock::time_point rotationDeadline;
     Update* lastDmdUpdate = nullptr;
     uint8_t flags = 0;
+    bool virtualClock = false;
 
     (void)m_stopFlag.load(std::memory_order_acquire);
+    ConsumerScope consumerScope(this, Consumer::Serum);
+
+    auto takeSerum = [&]()
+    {
+      if (m_executionMode.load(std::memory_order_acquire) == ExecutionMode::Synchronous && serumLoad.valid())
+        serumLoad.wait();
+      if (!IsLoaded(serumLoad)) return;
+
+      m_pSerum = serumLoad.get();
+      serumLoad = std::shared_future<SerumFrameStruct*>();
+      if (m_pSerum)
+      {
+        Log(DMDUtil_LogLevel_INFO, "Serum: Loaded v%d colorization for %s", m_pSerum->SerumVersion, name);
+
+        Serum_SetIgnoreUnknownFramesTimeout(pConfig->GetIgnoreUnknownFramesTimeout());
+        Serum_SetMaximumUnknownFramesToSkip(pConfig->GetMaximumUnknownFramesToSkip());
+        m_serumHasTimestamp = false;
+        m_serumLastTimestampMs = 0;
+      }
+    };
+
+    auto scheduleRotation = [&](uint32_t at)
+    {
+      nextRotation = at;
+      if (virtualClock) return;
+      const uint32_t clockNow = GetClockMs();
+      rotationDeadline =
+          std::chrono::steady_clock::now() + std::chrono::milliseconds(at > clockNow ? at - clockNow : 0);
+    };
+
+    auto rotationPending = [&]()
+    { return m_pSerum && nextRotation > 0 && m_pSerum->rotationtimer > 0 && lastDmdUpdate; };
+
+    auto rotationDue = [&](uint32_t now)
+    { return virtualClock ? now >= nextRotation : std::chrono::steady_clock::now() >= rotationDeadline; };
+
+    // On the virtual clock every rotation that fell due up to now is replayed at its own point in time, as it would
+    // have happened in real time.
+    auto rotate = [&](uint32_t now)
+    {
+      while (rotationPending() && rotationDue(now))
+      {
+        const uint32_t rotationTime = virtualClock ? nextRotation : now;
+        if (!virtualClock) m_pSerumProfiler->RecordRotationLateness(ElapsedUs(rotationDeadline));
+        const auto rotateStart = std::chrono::steady_clock::now();
+        uint32_t result = Serum_Rotate();
+        m_pSerumProfiler->Record(ColorizeCall::SerumRotate,
+                                 (result & 0x30000) ? ColorizeResult::Rotation : ColorizeResult::NoFrame,
+                                 SerumFeatureFlags(), ElapsedUs(rotateStart));
+
+        Log(DMDUtil_LogLevel_DEBUG, "Serum: rotation=%lu, flags=%lu", m_pSerum->rotationtimer, result >> 16);
+
+        QueueSerumFrames(lastDmdUpdate, result & 0x10000, result & 0x20000, virtualClock, rotationTime);
+
+        if (result > 0 && ((result & 0xffff) < 2048))
+        {
+          scheduleRotation(rotationTime + m_pSerum->rotationtimer);
+        }
+        else
+          nextRotation = 0;
+
+        if (!virtualClock) break;
+      }
+    };
 
     bool showNotColorizedFrames = pConfig->IsShowNotColorizedFrames();
     bool dumpNotColorizedFrames = pConfig->IsDumpNotColorizedFrames();
@@ -1443,27 +1960,43 @@ void DMD::SerumThread()
       {
         if (m_pSerum)
         {
+          m_pSerumProfiler->ReportAndReset(name);
           Serum_Dispose();
           m_serumHasTimestamp = false;
           m_serumLastTimestampMs = 0;
         }
+        else if (serumLoad.valid() && serumLoad.get())
+        {
+          Serum_Dispose();
+        }
 
         return;
       }
 
-      if (nextRotation == 0)
+      virtualClock = m_clockMode.load(std::memory_order_acquire) == ClockMode::FrameTimestamps;
+
+      // Per frame settings follow a snapshot swapped in by SetConfig().
+      pConfig = GetConfig();
+      showNotColorizedFrames = pConfig->IsShowNotColorizedFrames();
+      dumpNotColorizedFrames = pConfig->IsDumpNotColorizedFrames();
+
       {
+        auto wakeUp = [&]()
+        {
+          return m_stopFlag.load(std::memory_order_relaxed) ||
+                 (m_updateBufferQueuePosition.load(std::memory_order_relaxed) != bufferPosition);
+        };
+
         std::shared_lock<std::shared_mutex> sl(m_dmdSharedMutex);
-        m_dmdCV.wait(sl,
-                     [&]()
-                     {
-                       return m_stopFlag.load(std::memory_order_relaxed) ||
-                              (m_updateBufferQueuePosition.load(std::memory_order_relaxed) != bufferPosition);
-                     });
+        // The virtual clock doesn't advance without new frames, so there is no rotation to wait for.
+        if (!rotationPending() || virtualClock)
+          m_dmdCV.wait(sl, wakeUp);
+        else
+          m_dmdCV.wait_until(sl, rotationDeadline, wakeUp);
         sl.unlock();
       }
 
-      uint32_t now = GetMonotonicTimeMs();
+      uint32_t now = GetClockMs();
 
       const uint16_t updateBufferQueuePosition = m_updateBufferQueuePosition.load(std::memory_order_acquire);
       while (bufferPosition != updateBufferQueuePosition)
@@ -1472,6 +2005,8 @@ void DMD::SerumThread()
         ++bufferPosition;  // 65635 + 1 = 0
         uint8_t bufferPositionMod = bufferPosition % DMDUTIL_FRAME_BUFFER_SIZE;
 
+        if (virtualClock && GetQueueTimestamp(bufferPositionMod, now)) rotate(now);
+
         if (m_pUpdateBufferQueue[bufferPositionMod]->mode == Mode::SerumCommand)
         {
           if (m_pSerum && m_pUpdateBufferQueue[bufferPositionMod]->hasData &&
@@ -1483,7 +2018,10 @@ void DMD::SerumThread()
 
             if (source == 'D' && value == 1 && event >= kSerumTriggerMinEvent && event <= kSerumTriggerMaxEvent)
             {
+              const auto triggerStart = std::chrono::steady_clock::now();
               uint32_t result = Serum_Scene_Trigger(event);
+              m_pSerumProfiler->Record(ColorizeCall::SerumSceneTrigger, SerumResultClass(result), SerumFeatureFlags(),
+                                       ElapsedUs(triggerStart));
 
               if (result != IDENTIFY_NO_FRAME && result != IDENTIFY_SAME_FRAME && lastDmdUpdate)
               {
@@ -1493,7 +2031,7 @@ void DMD::SerumThread()
 
               if (result > 0 && ((result & 0xffff) < 2048))
               {
-                nextRotation = now + m_pSerum->rotationtimer;
+                scheduleRotation(now + m_pSerum->rotationtimer);
                 if (result & 0x40000)
                   Log(DMDUtil_LogLevel_DEBUG, "Serum: starting scene rotation, timer=%lu", m_pSerum->rotationtimer);
               }
@@ -1508,6 +2046,7 @@ void DMD::SerumThread()
                          m_pUpdateBufferQueue[bufferPositionMod]->mode == Mode::RGB16))
         {
           // DMDServer accepted a different connection, turn off Serum Colorization.
+          m_pSerumProfiler->ReportAndReset(name);
           Serum_Dispose();
           m_pSerum = nullptr;
           m_serumHasTimestamp = false;
@@ -1520,19 +2059,11 @@ void DMD::SerumThread()
 
         if (m_pUpdateBufferQueue[bufferPositionMod]->mode == Mode::Data)
         {
-          if (strcmp(m_romName, name) != 0)
+          if (strcmp(m_romName, name) != 0 && !serumLoad.valid())
           {
-            // don't load Serum until all displays are found
-            if (m_finding.load(std::memory_order_acquire))
-            {
-              QueueBuffer();
-              continue;
-            }
-
-            strcpy(name, m_romName);
-
             if (m_pSerum)
             {
+              m_pSerumProfiler->ReportAndReset(name);
               Serum_Dispose();
               m_pSerum = nullptr;
               m_serumHasTimestamp = false;
@@ -1540,35 +2071,44 @@ void DMD::SerumThread()
               lastDmdUpdate = nullptr;
             }
 
-            if (m_altColorPath[0] == '\0') strcpy(m_altColorPath, Config::GetInstance()->GetAltColorPath());
+            strcpy(name, m_romName);
+
+            if (m_altColorPath[0] == '\0') strcpy(m_altColorPath, pConfig->GetAltColorPath());
             flags = 0;
-            const bool zedmdOnly = m_pZeDMD && m_rgb24DMDs.empty() && m_levelDMDs.empty()
+            // Serum loads while displays are still being searched. Their frame heights aren't known yet then, so
+            // both are requested. The displays are only read once the search finished.
+            const bool finding = m_finding.load(std::memory_order_acquire);
+            if (finding) flags = FLAG_REQUEST_32P_FRAMES | FLAG_REQUEST_64P_FRAMES;
+            // At the moment, ZeDMD HD, PIN2DMD HD and RGB24DMD are the only devices supporting 64P frames.
+            // Not requesting 64P saves memory, displays that all have the same height only get frames of that height.
+            if (!finding)
+            {
+              std::lock_guard<std::mutex> lock(m_displaysMutex);
+              for (ZeDMDOutput* pZeDMDOutput : m_zedmdOutputs)
+              {
+                if (pZeDMDOutput->GetHeight() == 64)
+                  flags |= FLAG_REQUEST_64P_FRAMES;
+                else
+                  flags |= FLAG_REQUEST_32P_FRAMES;
+              }
+
 #if !(                                                                                                                \
     (defined(__APPLE__) && ((defined(TARGET_OS_IOS) && TARGET_OS_IOS) || (defined(TARGET_OS_TV) && TARGET_OS_TV))) || \
     defined(__ANDROID__))
-                                   && !m_pPixelcadeDMD
+              if (m_pPixelcadeDMD) flags |= FLAG_REQUEST_32P_FRAMES;
 #endif
+
 #if defined(DMDUTIL_ENABLE_PIN2DMD) && !((defined(__APPLE__) && ((defined(TARGET_OS_IOS) && TARGET_OS_IOS) || \
                                                                  (defined(TARGET_OS_TV) && TARGET_OS_TV))) || \
                                          defined(__ANDROID__))
-                                   && !m_PIN2DMDConnected
+              if (m_pPIN2DMD)
+              {
+                if (m_pPIN2DMD->GetHeight() == 64)
+                  flags |= FLAG_REQUEST_64P_FRAMES;
+                else
+                  flags |= FLAG_REQUEST_32P_FRAMES;
+              }
 #endif
-                ;
-
-            if (zedmdOnly)
-            {
-              // A single ZeDMD only needs the frame height it can actually render.
-              flags = (m_pZeDMD->GetHeight() == 64) ? FLAG_REQUEST_64P_FRAMES : FLAG_REQUEST_32P_FRAMES;
-            }
-
-            // At the moment, ZeDMD HD, PIN2DMD HD and RGB24DMD are the only devices supporting 64P frames.
-            // Not requesting 64P saves memory.
-            if (!zedmdOnly && m_pZeDMD)
-            {
-              if (m_pZeDMD->GetHeight() == 64)
-                flags |= FLAG_REQUEST_64P_FRAMES;
-              else
-                flags |= FLAG_REQUEST_32P_FRAMES;
             }
 
             if (m_rgb24DMDs.size() > 0)
@@ -1593,39 +2133,50 @@ void DMD::SerumThread()
               }
             }
 
-#if !(                                                                                                                \
-    (defined(__APPLE__) && ((defined(TARGET_OS_IOS) && TARGET_OS_IOS) || (defined(TARGET_OS_TV) && TARGET_OS_TV))) || \
-    defined(__ANDROID__))
-            if (m_pPixelcadeDMD) flags |= FLAG_REQUEST_32P_FRAMES;
-#endif
-
-#if defined(DMDUTIL_ENABLE_PIN2DMD) && !((defined(__APPLE__) && ((defined(TARGET_OS_IOS) && TARGET_OS_IOS) || \
-                                                                 (defined(TARGET_OS_TV) && TARGET_OS_TV))) || \
-                                         defined(__ANDROID__))
-            if (m_PIN2DMDConnected)
-            {
-              if (m_PIN2DMDHeight == 64)
-                flags |= FLAG_REQUEST_64P_FRAMES;
-              else
-                flags |= FLAG_REQUEST_32P_FRAMES;
-            }
-#endif
-
             if (!flags) flags |= FLAG_REQUEST_32P_FRAMES;
             flags |= FLAG_REQUEST_FALLBACK;
 
-            m_pSerum = (name[0] != '\0') ? Serum_Load(m_altColorPath, m_romName, flags) : nullptr;
-            if (m_pSerum)
+            if (name[0] != '\0')
             {
-              Log(DMDUtil_LogLevel_INFO, "Serum: Loaded v%d colorization for %s", m_pSerum->SerumVersion, m_romName);
+              auto promise = std::make_shared<std::promise<SerumFrameStruct*>>();
+              serumLoad = promise->get_future().share();
+              m_pAssetLoader->Submit(
+                  [this, promise, altColorPath = std::string(m_altColorPath), romName = std::string(name), flags,
+                   cacheEnabled = pConfig->IsSerumCROMcCache()]()
+                  {
+                    SetThreadLogConfig(&m_pConfig);
 
-              Serum_SetIgnoreUnknownFramesTimeout(Config::GetInstance()->GetIgnoreUnknownFramesTimeout());
-              Serum_SetMaximumUnknownFramesToSkip(Config::GetInstance()->GetMaximumUnknownFramesToSkip());
-              m_serumHasTimestamp = false;
-              m_serumLastTimestampMs = 0;
+                    // A cRZ or cROM without up to date cROMc is converted while it loads, so the next load is fast.
+                    SerumCacheFiles cacheFiles;
+                    SerumCacheState cacheState = SerumCacheState::NoSource;
+                    if (cacheEnabled) cacheState = CheckSerumCache(altColorPath, romName, cacheFiles);
+                    if (cacheState == SerumCacheState::Stale)
+                    {
+                      Log(DMDUtil_LogLevel_INFO, "Serum: %s is outdated, regenerating it", cacheFiles.cache.c_str());
+                      if (!RemoveSerumCache(cacheFiles))
+                      {
+                        Log(DMDUtil_LogLevel_ERROR, "Serum: Failed to remove %s", cacheFiles.cache.c_str());
+                        cacheState = SerumCacheState::NoSource;
+                      }
+                    }
+                    const bool generateCache =
+                        cacheState == SerumCacheState::Missing || cacheState == SerumCacheState::Stale;
+
+                    if (generateCache) Serum_SetGenerateCRomC(true);
+                    SerumFrameStruct* pSerum = Serum_Load(altColorPath.c_str(), romName.c_str(), flags);
+                    if (generateCache)
+                    {
+                      Serum_SetGenerateCRomC(false);
+                      if (pSerum && WriteSerumCacheStamp(cacheFiles))
+                        Log(DMDUtil_LogLevel_INFO, "Serum: Generated %s", cacheFiles.cache.c_str());
+                    }
+                    promise->set_value(pSerum);
+                  });
             }
           }
 
+          takeSerum();
+
           if (m_pSerum)
           {
             FrameContext frameContext{};
@@ -1633,9 +2184,7 @@ void DMD::SerumThread()
 
             const auto colorizeStart = std::chrono::steady_clock::now();
             uint32_t result = Serum_Colorize(m_pUpdateBufferQueue[bufferPositionMod]->data);
-            const uint32_t colorizeTimeUs = static_cast<uint32_t>(
-                std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - colorizeStart)
-                    .count());
+            const uint32_t colorizeTimeUs = ElapsedUs(colorizeStart);
             uint32_t averageColorizeTimeUs = 0;
             if (m_serumColorizeCount < (std::numeric_limits<uint64_t>::max)())
             {
@@ -1647,6 +2196,8 @@ void DMD::SerumThread()
             Serum_Runtime_Metadata runtimeMetadata{};
             runtimeMetadata.size = sizeof(runtimeMetadata);
             Serum_GetRuntimeMetadata(&runtimeMetadata);
+            m_pSerumProfiler->Record(ColorizeCall::SerumColorize, SerumResultClass(result),
+                                     runtimeMetadata.featureFlags, colorizeTimeUs);
 
             if (result != IDENTIFY_NO_FRAME && result != IDENTIFY_SAME_FRAME)
             {
@@ -1668,7 +2219,7 @@ void DMD::SerumThread()
 
               if (result > 0 && ((result & 0xffff) < 2048))
               {
-                nextRotation = now + m_pSerum->rotationtimer;
+                scheduleRotation(now + m_pSerum->rotationtimer);
                 if (result & 0x40000)
                   Log(DMDUtil_LogLevel_DEBUG, "Serum: starting scene rotation, timer=%lu", m_pSerum->rotationtimer);
               }
@@ -1715,25 +2266,9 @@ void DMD::SerumThread()
           }
         }
       }
+      MarkConsumed(Consumer::Serum, bufferPosition);
 
-      if (m_pSerum)
-      {
-        if (nextRotation > 0 && m_pSerum->rotationtimer > 0 && lastDmdUpdate && now >= nextRotation)
-        {
-          uint32_t result = Serum_Rotate();
-
-          Log(DMDUtil_LogLevel_DEBUG, "Serum: rotation=%lu, flags=%lu", m_pSerum->rotationtimer, result >> 16);
-
-          QueueSerumFrames(lastDmdUpdate, result & 0x10000, result & 0x20000, false, 0);
-
-          if (result > 0 && ((result & 0xffff) < 2048))
-          {
-            nextRotation = now + m_pSerum->rotationtimer;
-          }
-          else
-            nextRotation = 0;
-        }
-      }
+      rotate(now);
     }
   }
 }
@@ -1741,7 +2276,8 @@ void DMD::SerumThread()
 void DMD::VniThread()
 {
 #ifdef DMDUTIL_ENABLE_VNI
-  Config* const pConfig = Config::GetInstance();
+  SetThreadLogConfig(&m_pConfig);
+  const Config* pConfig = GetConfig();
 
   if (!pConfig->IsAltColor())
   {
@@ -1750,8 +2286,22 @@ void DMD::VniThread()
 
   uint16_t bufferPosition = 0;
   char name[DMDUTIL_MAX_NAME_SIZE] = {0};
+  // Frames pass uncolorized while the colorization loads in the background, unless the DMD runs synchronously.
+  std::shared_future<Vni_Context*> vniLoad;
 
   (void)m_stopFlag.load(std::memory_order_acquire);
+  ConsumerScope consumerScope(this, Consumer::Vni);
+
+  auto takeVni = [&]()
+  {
+    if (m_executionMode.load(std::memory_order_acquire) == ExecutionMode::Synchronous && vniLoad.valid())
+      vniLoad.wait();
+    if (!IsLoaded(vniLoad)) return;
+
+    m_pVni = vniLoad.get();
+    vniLoad = std::shared_future<Vni_Context*>();
+    if (m_pVni) Log(DMDUtil_LogLevel_INFO, "VNI: Loaded colorization for %s", name);
+  };
 
   bool showNotColorizedFrames = pConfig->IsShowNotColorizedFrames();
   bool dumpNotColorizedFrames = pConfig->IsDumpNotColorizedFrames();
@@ -1771,12 +2321,19 @@ void DMD::VniThread()
     {
       if (m_pVni)
       {
+        m_pVniProfiler->ReportAndReset(name);
         Vni_Dispose(m_pVni);
         m_pVni = nullptr;
       }
+      DiscardVni(vniLoad);
       return;
     }
 
+    // Per frame settings follow a snapshot swapped in by SetConfig().
+    pConfig = GetConfig();
+    showNotColorizedFrames = pConfig->IsShowNotColorizedFrames();
+    dumpNotColorizedFrames = pConfig->IsDumpNotColorizedFrames();
+
     const uint16_t updateBufferQueuePosition = m_updateBufferQueuePosition.load(std::memory_order_acquire);
     while (bufferPosition != updateBufferQueuePosition)
     {
@@ -1787,18 +2344,27 @@ void DMD::VniThread()
       {
         if (m_pVni)
         {
+          m_pVniProfiler->ReportAndReset(name);
           Vni_Dispose(m_pVni);
           m_pVni = nullptr;
         }
+        DiscardVni(vniLoad);
+        vniLoad = std::shared_future<Vni_Context*>();
         strcpy(name, "");
         continue;
       }
 
-      if (m_pVni && (m_pUpdateBufferQueue[bufferPositionMod]->mode == Mode::RGB24 ||
-                     m_pUpdateBufferQueue[bufferPositionMod]->mode == Mode::RGB16))
+      if ((m_pVni || vniLoad.valid()) && (m_pUpdateBufferQueue[bufferPositionMod]->mode == Mode::RGB24 ||
+                                          m_pUpdateBufferQueue[bufferPositionMod]->mode == Mode::RGB16))
       {
-        Vni_Dispose(m_pVni);
-        m_pVni = nullptr;
+        if (m_pVni)
+        {
+          m_pVniProfiler->ReportAndReset(name);
+          Vni_Dispose(m_pVni);
+          m_pVni = nullptr;
+        }
+        DiscardVni(vniLoad);
+        vniLoad = std::shared_future<Vni_Context*>();
         strcpy(name, "");
         QueueBuffer();
         continue;
@@ -1808,42 +2374,24 @@ void DMD::VniThread()
       {
         if (strcmp(m_romName, name) != 0)
         {
-          strcpy(name, m_romName);
-
           if (m_pVni)
           {
+            m_pVniProfiler->ReportAndReset(name);
             Vni_Dispose(m_pVni);
             m_pVni = nullptr;
           }
 
-          if (m_altColorPath[0] == '\0') strcpy(m_altColorPath, Config::GetInstance()->GetAltColorPath());
+          DiscardVni(vniLoad);
+          strcpy(name, m_romName);
 
-          std::string baseDir = BuildAltColorDir(m_altColorPath, m_romName);
-          std::string palPath;
-          std::string vniPath;
-          std::string pacPath;
+          if (m_altColorPath[0] == '\0') strcpy(m_altColorPath, pConfig->GetAltColorPath());
 
-          const std::string baseName = std::string(m_romName);
-          FindCaseInsensitiveFile(baseDir, baseName + ".pal", &palPath);
-          FindCaseInsensitiveFile(baseDir, baseName + ".vni", &vniPath);
-          FindCaseInsensitiveFile(baseDir, baseName + ".pac", &pacPath);
+          // Picks up what SetRomName() or PreloadRom() already started.
+          vniLoad = TakeVniPreload(name, m_altColorPath);
+          if (!vniLoad.valid() && name[0] != '\0') vniLoad = LoadVniAsync(name, m_altColorPath);
+        }
 
-          const char* vniKey = pConfig->GetVniKey();
-          if (!pacPath.empty() && (!vniKey || vniKey[0] == '\0'))
-          {
-            Log(DMDUtil_LogLevel_ERROR, "VNI: pac file requires VNI key for %s", m_romName);
-          }
-          else if (!palPath.empty() || !vniPath.empty() || !pacPath.empty())
-          {
-            m_pVni = Vni_LoadFromPaths(
-                palPath.empty() ? nullptr : palPath.c_str(), vniPath.empty() ? nullptr : vniPath.c_str(),
-                pacPath.empty() ? nullptr : pacPath.c_str(), (vniKey && vniKey[0] != '\0') ? vniKey : nullptr);
-            if (m_pVni)
-            {
-              Log(DMDUtil_LogLevel_INFO, "VNI: Loaded colorization for %s", m_romName);
-            }
-          }
-        }
+        takeVni();
 
         if (m_pVni)
         {
@@ -1851,7 +2399,10 @@ void DMD::VniThread()
           uint16_t height = m_pUpdateBufferQueue[bufferPositionMod]->height;
           uint8_t depth = (uint8_t)m_pUpdateBufferQueue[bufferPositionMod]->depth;
 
+          const auto colorizeStart = std::chrono::steady_clock::now();
           uint32_t result = Vni_Colorize(m_pVni, m_pUpdateBufferQueue[bufferPositionMod]->data, width, height, depth);
+          m_pVniProfiler->Record(ColorizeCall::VniColorize, result ? ColorizeResult::NewFrame : ColorizeResult::NoFrame,
+                                 0, ElapsedUs(colorizeStart));
           if (result)
           {
             const Vni_Frame_Struc* frame = Vni_GetFrame(m_pVni);
@@ -1902,6 +2453,7 @@ void DMD::VniThread()
         }
       }
     }
+    MarkConsumed(Consumer::Vni, bufferPosition);
   }
 #endif
 }
@@ -2073,25 +2625,24 @@ void DMD::PIN2DMDThread()
   uint8_t palette[256 * 3] = {0};
   uint8_t renderBuffer[256 * 64] = {0};
 
-  const int targetWidth = m_PIN2DMDWidth;
-  const int targetHeight = m_PIN2DMDHeight;
+  const int targetWidth = m_pPIN2DMD->GetWidth();
+  const int targetHeight = m_pPIN2DMD->GetHeight();
   const int targetLength = targetWidth * targetHeight;
   const int maxSourceLength = 256 * 64;
   uint8_t* rgb24Data = new uint8_t[maxSourceLength * 3];
   uint8_t* scaledBuffer = new uint8_t[targetLength * 3];
+  // Largest intermediate frame of a scale up followed by a scale down.
   constexpr int kMaxTempWidth = 384;
   constexpr int kMaxTempHeight = 128;
-  uint8_t* tempBuffer = new uint8_t[kMaxTempWidth * kMaxTempHeight * 3];
 
   memset(rgb24Data, 0, maxSourceLength * 3);
   memset(scaledBuffer, 0, targetLength * 3);
+  OutputFilter outputFilter;
+  FramePacer* const pFramePacer = m_pFramePacers[(int)Consumer::PIN2DMD];
 
   (void)m_stopFlag.load(std::memory_order_acquire);
-
-  Config* const pConfig = Config::GetInstance();
-  bool showNotColorizedFrames = pConfig->IsShowNotColorizedFrames();
-  bool excludeColorizedFrames = pConfig->IsExcludeColorizedFramesForPIN2DMD();
-  const int roundedCorners = pConfig->GetRoundedCorners();
+  SetThreadLogConfig(&m_pConfig);
+  ConsumerScope consumerScope(this, Consumer::PIN2DMD);
 
   auto scaleToTarget = [&](const uint8_t* src, uint16_t width, uint16_t height, uint8_t* dst) -> bool
   {
@@ -2103,13 +2654,13 @@ void DMD::PIN2DMDThread()
 
     if (width == targetWidth && height == 16)
     {
-      FrameUtil::Helper::Center(dst, targetWidth, targetHeight, src, targetWidth, 16, 24);
+      ScalePlan::Get(ScaleOp::Center, targetWidth, 16, targetWidth, targetHeight, 24)->Run(dst, src);
       return true;
     }
 
     if (height == 64 && targetHeight == 32)
     {
-      FrameUtil::Helper::ScaleDown(dst, targetWidth, targetHeight, src, width, 64, 24);
+      ScalePlan::Get(ScaleOp::ScaleDown, width, 64, targetWidth, targetHeight, 24)->Run(dst, src);
       return true;
     }
 
@@ -2119,13 +2670,12 @@ void DMD::PIN2DMDThread()
       const int upHeight = height * 2;
       if (upWidth == targetWidth && upHeight == targetHeight)
       {
-        FrameUtil::Helper::ScaleUp(dst, src, width, height, 24);
+        ScalePlan::Get(ScaleOp::ScaleUp, width, height, upWidth, upHeight, 24)->Run(dst, src);
         return true;
       }
       if (upWidth <= kMaxTempWidth && upHeight <= kMaxTempHeight)
       {
-        FrameUtil::Helper::ScaleUp(tempBuffer, src, width, height, 24);
-        FrameUtil::Helper::ScaleDown(dst, targetWidth, targetHeight, tempBuffer, upWidth, upHeight, 24);
+        ScalePlan::Get(ScaleOp::ScaleUpDown, width, height, targetWidth, targetHeight, 24)->Run(dst, src);
         return true;
       }
       return false;
@@ -2135,7 +2685,7 @@ void DMD::PIN2DMDThread()
     {
       if (width > targetWidth)
       {
-        FrameUtil::Helper::ScaleDown(dst, targetWidth, targetHeight, src, width, height, 24);
+        ScalePlan::Get(ScaleOp::ScaleDown, width, height, targetWidth, targetHeight, 24)->Run(dst, src);
         return true;
       }
       if (width < targetWidth)
@@ -2144,8 +2694,7 @@ void DMD::PIN2DMDThread()
         const int upHeight = height * 2;
         if (upWidth <= kMaxTempWidth && upHeight <= kMaxTempHeight)
         {
-          FrameUtil::Helper::ScaleUp(tempBuffer, src, width, height, 24);
-          FrameUtil::Helper::ScaleDown(dst, targetWidth, targetHeight, tempBuffer, upWidth, upHeight, 24);
+          ScalePlan::Get(ScaleOp::ScaleUpDown, width, height, targetWidth, targetHeight, 24)->Run(dst, src);
           return true;
         }
       }
@@ -2163,30 +2712,38 @@ void DMD::PIN2DMDThread()
                    return m_stopFlag.load(std::memory_order_relaxed) ||
                           (m_updateBufferQueuePosition.load(std::memory_order_relaxed) != bufferPosition);
                  });
+    const bool paced = m_executionMode.load(std::memory_order_acquire) != ExecutionMode::Synchronous;
+    if (paced)
+      m_dmdCV.wait_until(sl, pFramePacer->GetNextSend(),
+                         [&]() { return m_stopFlag.load(std::memory_order_relaxed); });
     sl.unlock();
     if (m_stopFlag.load(std::memory_order_acquire))
     {
       delete[] rgb24Data;
       delete[] scaledBuffer;
-      delete[] tempBuffer;
       return;
     }
 
     const uint16_t updateBufferQueuePosition = m_updateBufferQueuePosition.load(std::memory_order_acquire);
+    // Per frame settings follow a snapshot swapped in by SetConfig().
+    const Config* const pConfig = GetConfig();
+    const bool showNotColorizedFrames = pConfig->IsShowNotColorizedFrames();
+    const bool excludeColorizedFrames = pConfig->IsExcludeColorizedFramesForPIN2DMD();
+    const int roundedCorners = pConfig->GetRoundedCorners();
+    auto acceptFrame = [&](const Update* pUpdate)
+    {
+      if (excludeColorizedFrames) return !IsSerumMode(pUpdate->mode, true);
+      return !((m_pSerum || m_pVni) && !IsSerumMode(pUpdate->mode, showNotColorizedFrames));
+    };
+    if (paced)
+      bufferPosition =
+          SkipToNewestFrame(m_pUpdateBufferQueue, bufferPosition, updateBufferQueuePosition, acceptFrame);
     while (!m_stopFlag.load(std::memory_order_relaxed) && bufferPosition != updateBufferQueuePosition)
     {
       bufferPosition = GetNextBufferQueuePosition(bufferPosition, updateBufferQueuePosition);
       uint8_t bufferPositionMod = bufferPosition % DMDUTIL_FRAME_BUFFER_SIZE;
 
-      const Mode updateMode = m_pUpdateBufferQueue[bufferPositionMod]->mode;
-      if (excludeColorizedFrames)
-      {
-        if (IsSerumMode(updateMode, true)) continue;
-      }
-      else if ((m_pSerum || m_pVni) && !IsSerumMode(updateMode, showNotColorizedFrames))
-      {
-        continue;
-      }
+      if (!acceptFrame(m_pUpdateBufferQueue[bufferPositionMod])) continue;
 
       if (!(m_pUpdateBufferQueue[bufferPositionMod]->hasData || m_pUpdateBufferQueue[bufferPositionMod]->hasSegData))
         continue;
@@ -2278,10 +2835,18 @@ void DMD::PIN2DMDThread()
 
       if (update && scaleToTarget(rgb24Data, width, height, scaledBuffer))
       {
-        ApplyRoundedCornersRGB24(scaledBuffer, targetWidth, targetHeight, roundedCorners);
-        PIN2DMDRenderRaw(targetWidth, targetHeight, scaledBuffer, 1);
+        outputFilter.Configure(targetWidth, targetHeight, roundedCorners);
+        outputFilter.ApplyRGB24(scaledBuffer);
+        if (pFramePacer->IsNewContent(scaledBuffer, targetLength * 3))
+        {
+          // Transfers complete asynchronously, their latency is the cost of a frame.
+          pFramePacer->RecordCumulativeCost(m_pPIN2DMD->GetTransferTimeUs(), m_pPIN2DMD->GetTransfersCompleted());
+          pFramePacer->RecordSend(FramePacer::Clock::now());
+          m_pPIN2DMD->RenderRaw(targetWidth, targetHeight, scaledBuffer, 1);
+        }
       }
     }
+    MarkConsumed(Consumer::PIN2DMD, bufferPosition);
   }
 }
 #endif
@@ -2298,13 +2863,22 @@ void DMD::PixelcadeDMDThread()
   const int targetLength = targetWidth * targetHeight;
   uint16_t* rgb565Data = new uint16_t[targetLength];
   memset(rgb565Data, 0, targetLength * sizeof(uint16_t));
+  OutputFilter outputFilter;
+  FramePacer* const pFramePacer = m_pFramePacers[(int)Consumer::Pixelcade];
 
   (void)m_stopFlag.load(std::memory_order_acquire);
+  SetThreadLogConfig(&m_pConfig);
+  ConsumerScope consumerScope(this, Consumer::Pixelcade);
 
-  Config* const pConfig = Config::GetInstance();
-  bool showNotColorizedFrames = pConfig->IsShowNotColorizedFrames();
-  bool excludeColorizedFrames = pConfig->IsExcludeColorizedFramesForPixelcade();
-  const int roundedCorners = pConfig->GetRoundedCorners();
+  // PixelcadeDMD writes on its own thread, the time it spends per written frame is the cost of a frame.
+  auto send = [&](const void* pFrame, size_t size, auto update)
+  {
+    if (!pFramePacer->IsNewContent(pFrame, size)) return;
+
+    pFramePacer->RecordCumulativeCost(m_pPixelcadeDMD->GetWriteTimeUs(), m_pPixelcadeDMD->GetFramesWritten());
+    pFramePacer->RecordSend(FramePacer::Clock::now());
+    update();
+  };
 
   while (true)
   {
@@ -2315,6 +2889,10 @@ void DMD::PixelcadeDMDThread()
                    return m_stopFlag.load(std::memory_order_relaxed) ||
                           (m_updateBufferQueuePosition.load(std::memory_order_relaxed) != bufferPosition);
                  });
+    const bool paced = m_executionMode.load(std::memory_order_acquire) != ExecutionMode::Synchronous;
+    if (paced)
+      m_dmdCV.wait_until(sl, pFramePacer->GetNextSend(),
+                         [&]() { return m_stopFlag.load(std::memory_order_relaxed); });
     sl.unlock();
     if (m_stopFlag.load(std::memory_order_acquire))
     {
@@ -2323,20 +2901,26 @@ void DMD::PixelcadeDMDThread()
     }
 
     const uint16_t updateBufferQueuePosition = m_updateBufferQueuePosition.load(std::memory_order_acquire);
+    // Per frame settings follow a snapshot swapped in by SetConfig().
+    const Config* const pConfig = GetConfig();
+    const bool showNotColorizedFrames = pConfig->IsShowNotColorizedFrames();
+    const bool excludeColorizedFrames = pConfig->IsExcludeColorizedFramesForPixelcade();
+    // Frames are scaled to the panel size first, the filter then works on the panel size only.
+    outputFilter.Configure(targetWidth, targetHeight, pConfig->GetRoundedCorners());
+    auto acceptFrame = [&](const Update* pUpdate)
+    {
+      if (excludeColorizedFrames) return !IsSerumMode(pUpdate->mode, true);
+      return !((m_pSerum || m_pVni) && !IsSerumMode(pUpdate->mode, showNotColorizedFrames));
+    };
+    if (paced)
+      bufferPosition =
+          SkipToNewestFrame(m_pUpdateBufferQueue, bufferPosition, updateBufferQueuePosition, acceptFrame);
     while (!m_stopFlag.load(std::memory_order_relaxed) && bufferPosition != updateBufferQueuePosition)
     {
       bufferPosition = GetNextBufferQueuePosition(bufferPosition, updateBufferQueuePosition);
       uint8_t bufferPositionMod = bufferPosition % DMDUTIL_FRAME_BUFFER_SIZE;
 
-      const Mode updateMode = m_pUpdateBufferQueue[bufferPositionMod]->mode;
-      if (excludeColorizedFrames)
-      {
-        if (IsSerumMode(updateMode, true)) continue;
-      }
-      else if ((m_pSerum || m_pVni) && !IsSerumMode(updateMode, showNotColorizedFrames))
-      {
-        continue;
-      }
+      if (!acceptFrame(m_pUpdateBufferQueue[bufferPositionMod])) continue;
 
       if (m_pUpdateBufferQueue[bufferPositionMod]->hasData || m_pUpdateBufferQueue[bufferPositionMod]->hasSegData)
       {
@@ -2358,50 +2942,42 @@ void DMD::PixelcadeDMDThread()
           AdjustRGB24Depth(m_pUpdateBufferQueue[bufferPositionMod]->data, rgb24Data, length, palette,
                            m_pUpdateBufferQueue[bufferPositionMod]->depth);
 
-          uint8_t* scaledBuffer = new uint8_t[targetLength * 3];
+          uint8_t scaledBuffer[256 * 64 * 3];
           if (width == targetWidth && height == targetHeight)
             memcpy(scaledBuffer, rgb24Data, targetLength * 3);
           else if (width == targetWidth && height == 16)
-            FrameUtil::Helper::Center(scaledBuffer, targetWidth, targetHeight, rgb24Data, targetWidth, 16, 24);
+            ScalePlan::Get(ScaleOp::Center, targetWidth, 16, targetWidth, targetHeight, 24)
+                ->Run(scaledBuffer, rgb24Data);
           else if (height == 64)
-            FrameUtil::Helper::ScaleDown(scaledBuffer, targetWidth, targetHeight, rgb24Data, width, 64, 24);
+            ScalePlan::Get(ScaleOp::ScaleDown, width, 64, targetWidth, targetHeight, 24)->Run(scaledBuffer, rgb24Data);
           else
             continue;
 
           if (m_pPixelcadeDMD->GetIsV2())
           {
-            ApplyRoundedCornersRGB24(scaledBuffer, targetWidth, targetHeight, roundedCorners);
-            m_pPixelcadeDMD->UpdateRGB24(scaledBuffer);
+            outputFilter.ApplyRGB24(scaledBuffer);
+            send(scaledBuffer, targetLength * 3, [&]() { m_pPixelcadeDMD->UpdateRGB24(scaledBuffer); });
           }
           else
           {
-            for (int i = 0; i < targetLength; i++)
-            {
-              int pos = i * 3;
-              uint32_t r = scaledBuffer[pos];
-              uint32_t g = scaledBuffer[pos + 1];
-              uint32_t b = scaledBuffer[pos + 2];
-
-              rgb565Data[i] = (uint16_t)(((r & 0xF8u) << 8) | ((g & 0xFCu) << 3) | (b >> 3));
-            }
+            outputFilter.RGB24ToRGB565(rgb565Data, scaledBuffer);
             update = true;
           }
-
-          delete[] scaledBuffer;
         }
         else if (m_pUpdateBufferQueue[bufferPositionMod]->mode == Mode::RGB16)
         {
           if (width == targetWidth && height == targetHeight)
             memcpy(rgb565Data, m_pUpdateBufferQueue[bufferPositionMod]->segData, targetLength * 2);
           else if (width == targetWidth && height == 16)
-            FrameUtil::Helper::Center((uint8_t*)rgb565Data, targetWidth, targetHeight,
-                                      (uint8_t*)m_pUpdateBufferQueue[bufferPositionMod]->segData, targetWidth, 16, 16);
+            ScalePlan::Get(ScaleOp::Center, targetWidth, 16, targetWidth, targetHeight, 16)
+                ->Run((uint8_t*)rgb565Data, (uint8_t*)m_pUpdateBufferQueue[bufferPositionMod]->segData);
           else if (height == 64)
-            FrameUtil::Helper::ScaleDown((uint8_t*)rgb565Data, targetWidth, targetHeight,
-                                         (uint8_t*)m_pUpdateBufferQueue[bufferPositionMod]->segData, width, 64, 16);
+            ScalePlan::Get(ScaleOp::ScaleDown, width, 64, targetWidth, targetHeight, 16)
+                ->Run((uint8_t*)rgb565Data, (uint8_t*)m_pUpdateBufferQueue[bufferPositionMod]->segData);
           else
             continue;
 
+          outputFilter.ApplyRGB565(rgb565Data);
           update = true;
         }
         else if (IsSerumV2Mode(m_pUpdateBufferQueue[bufferPositionMod]->mode))
@@ -2410,11 +2986,12 @@ void DMD::PixelcadeDMDThread()
               m_pUpdateBufferQueue[bufferPositionMod]->mode == Mode::SerumV2_32_64)
             memcpy(rgb565Data, m_pUpdateBufferQueue[bufferPositionMod]->segData, targetLength * 2);
           else if (m_pUpdateBufferQueue[bufferPositionMod]->mode == Mode::SerumV2_64)
-            FrameUtil::Helper::ScaleDown((uint8_t*)rgb565Data, targetWidth, targetHeight,
-                                         (uint8_t*)m_pUpdateBufferQueue[bufferPositionMod]->segData, width, 64, 16);
+            ScalePlan::Get(ScaleOp::ScaleDown, width, 64, targetWidth, targetHeight, 16)
+                ->Run((uint8_t*)rgb565Data, (uint8_t*)m_pUpdateBufferQueue[bufferPositionMod]->segData);
           else
             continue;
 
+          outputFilter.ApplyRGB565(rgb565Data);
           update = true;
         }
         else
@@ -2470,33 +3047,26 @@ void DMD::PixelcadeDMDThread()
             if (width == targetWidth && height == targetHeight)
               memcpy(scaledBuffer, renderBuffer, targetLength);
             else if (width == targetWidth && height == 16)
-              FrameUtil::Helper::CenterIndexed(scaledBuffer, targetWidth, targetHeight, renderBuffer, targetWidth, 16);
+              ScalePlan::Get(ScaleOp::CenterIndexed, targetWidth, 16, targetWidth, targetHeight, 8)
+                  ->Run(scaledBuffer, renderBuffer);
             else if (width == 192 && height == 64)
-              FrameUtil::Helper::ScaleDownIndexed(scaledBuffer, targetWidth, targetHeight, renderBuffer, 192, 64);
+              ScalePlan::Get(ScaleOp::ScaleDownIndexed, 192, 64, targetWidth, targetHeight, 8)
+                  ->Run(scaledBuffer, renderBuffer);
             else if (width == 256 && height == 64)
-              FrameUtil::Helper::ScaleDownIndexed(scaledBuffer, targetWidth, targetHeight, renderBuffer, 256, 64);
+              ScalePlan::Get(ScaleOp::ScaleDownIndexed, 256, 64, targetWidth, targetHeight, 8)
+                  ->Run(scaledBuffer, renderBuffer);
             else
               continue;
 
-            for (int i = 0; i < targetLength; i++)
-            {
-              int pos = scaledBuffer[i] * 3;
-              uint32_t r = palette[pos];
-              uint32_t g = palette[pos + 1];
-              uint32_t b = palette[pos + 2];
-
-              rgb565Data[i] = (uint16_t)(((r & 0xF8u) << 8) | ((g & 0xFCu) << 3) | (b >> 3));
-            }
+            outputFilter.IndexedToRGB565(rgb565Data, scaledBuffer, palette);
           }
         }
 
         if (update)
-        {
-          ApplyRoundedCornersRGB565(rgb565Data, targetWidth, targetHeight, roundedCorners);
-          m_pPixelcadeDMD->Update(rgb565Data);
-        }
+          send(rgb565Data, targetLength * sizeof(uint16_t), [&]() { m_pPixelcadeDMD->Update(rgb565Data); });
       }
     }
+    MarkConsumed(Consumer::Pixelcade, bufferPosition);
   }
 }
 #endif
@@ -2507,6 +3077,8 @@ void DMD::LevelDMDThread()
   uint8_t renderBuffer[256 * 64] = {0};
 
   (void)m_stopFlag.load(std::memory_order_acquire);
+  SetThreadLogConfig(&m_pConfig);
+  ConsumerScope consumerScope(this, Consumer::LevelDMD);
 
   while (true)
   {
@@ -2545,6 +3117,7 @@ void DMD::LevelDMDThread()
         }
       }
     }
+    MarkConsumed(Consumer::LevelDMD, bufferPosition);
   }
 }
 
@@ -2559,10 +3132,8 @@ void DMD::RGB24DMDThread()
   uint8_t rgb24DataScaled[256 * 64 * 3] = {0};
 
   (void)m_stopFlag.load(std::memory_order_acquire);
-
-  Config* const pConfig = Config::GetInstance();
-  bool showNotColorizedFrames = pConfig->IsShowNotColorizedFrames();
-  bool excludeColorizedFrames = pConfig->IsExcludeColorizedFramesForRGB24DMD();
+  SetThreadLogConfig(&m_pConfig);
+  ConsumerScope consumerScope(this, Consumer::RGB24DMD);
 
   while (true)
   {
@@ -2580,6 +3151,10 @@ void DMD::RGB24DMDThread()
     }
 
     const uint16_t updateBufferQueuePosition = m_updateBufferQueuePosition.load(std::memory_order_acquire);
+    // Per frame settings follow a snapshot swapped in by SetConfig().
+    const Config* const pConfig = GetConfig();
+    const bool showNotColorizedFrames = pConfig->IsShowNotColorizedFrames();
+    const bool excludeColorizedFrames = pConfig->IsExcludeColorizedFramesForRGB24DMD();
     while (!m_stopFlag.load(std::memory_order_relaxed) && bufferPosition != updateBufferQueuePosition)
     {
       bufferPosition = GetNextBufferQueuePosition(bufferPosition, updateBufferQueuePosition);
@@ -2735,6 +3310,7 @@ void DMD::RGB24DMDThread()
         }
       }
     }
+    MarkConsumed(Consumer::RGB24DMD, bufferPosition);
   }
 }
 
@@ -2744,6 +3320,8 @@ void DMD::ConsoleDMDThread()
   uint8_t renderBuffer[256 * 64] = {0};
 
   (void)m_stopFlag.load(std::memory_order_acquire);
+  SetThreadLogConfig(&m_pConfig);
+  ConsumerScope consumerScope(this, Consumer::ConsoleDMD);
 
   while (true)
   {
@@ -2783,6 +3361,7 @@ void DMD::ConsoleDMDThread()
         }
       }
     }
+    MarkConsumed(Consumer::ConsoleDMD, bufferPosition);
   }
 }
 
@@ -2897,21 +3476,34 @@ bool DMD::GetQueueTimestamp(uint8_t bufferPositionMod, uint32_t& timestampMs) co
 
 uint16_t DMD::GetUpdateQueuePosition() const { return m_updateBufferQueuePosition.load(std::memory_order_acquire); }
 
-bool DMD::DumpersReached(uint16_t targetPosition) const
+const Config* DMD::GetConfig() const
 {
-  if (m_dumpTxtActive.load(std::memory_order_acquire) &&
-      m_dumpTxtPosition.load(std::memory_order_acquire) != targetPosition)
-    return false;
-  if (m_dumpRawActive.load(std::memory_order_acquire) &&
-      m_dumpRawPosition.load(std::memory_order_acquire) != targetPosition)
-    return false;
-  if (m_dump565Active.load(std::memory_order_acquire) &&
-      m_dump565Position.load(std::memory_order_acquire) != targetPosition)
-    return false;
-  if (m_dump888Active.load(std::memory_order_acquire) &&
-      m_dump888Position.load(std::memory_order_acquire) != targetPosition)
-    return false;
-  return true;
+  const Config* pConfig = m_pConfig.load(std::memory_order_acquire);
+  return pConfig ? pConfig : Config::GetInstance();
+}
+
+void DMD::SetConfig(const Config& config)
+{
+  std::lock_guard<std::mutex> lock(m_configMutex);
+  m_configSnapshots.emplace_back(std::make_unique<const Config>(config));
+  m_pConfig.store(m_configSnapshots.back().get(), std::memory_order_release);
+  for (RGB24DMD* pRGB24DMD : m_rgb24DMDs) pRGB24DMD->SetRoundedCorners(config.GetRoundedCorners());
+}
+
+void DMD::SetClockMode(ClockMode mode)
+{
+  m_virtualClockMs.store(0, std::memory_order_release);
+  m_clockMode.store(mode, std::memory_order_release);
+}
+
+void DMD::SetExecutionMode(ExecutionMode mode) { m_executionMode.store(mode, std::memory_order_release); }
+
+uint32_t DMD::GetClockMs() const
+{
+  if (m_clockMode.load(std::memory_order_acquire) == ClockMode::FrameTimestamps)
+    return m_virtualClockMs.load(std::memory_order_acquire);
+
+  return GetMonotonicTimeMs();
 }
 
 void DMD::RecordSerumColorizeCapture(const FrameContext& frameContext, const std::shared_ptr<Update>& primaryOutput,
@@ -2925,26 +3517,52 @@ void DMD::RecordSerumColorizeCapture(const FrameContext& frameContext, const std
     return;
   }
 
+  SerumCaptureInfo info;
+  info.valid = true;
+  info.hasOutput = (primaryOutput != nullptr);
+  info.isRotation = isRotation;
+  info.hasTimestamp = hasTimestamp;
+  info.sourceOrdinal = frameContext.sourceOrdinal;
+  info.sourceFrameIndex = frameContext.sourceFrameIndex;
+  info.originalFrameIndex = frameContext.originalFrameIndex;
+  info.inputCrc32 = frameContext.inputCrc32;
+  info.inputTimestampMs = frameContext.inputTimestampMs;
+  info.inputDurationMs = frameContext.inputDurationMs;
+  info.serumResult = serumResult;
+  info.serumVersion = serumVersion;
+  info.serumFrameId = serumFrameId;
+  info.serumTriggerId = serumTriggerId;
+  info.serumRotationTimer = serumRotationTimer;
+  info.serumFeatureFlags = serumFeatureFlags;
+  info.colorizeTimeUs = colorizeTimeUs;
+  info.averageColorizeTimeUs = averageColorizeTimeUs;
+  info.outputTimestampMs = outputTimestampMs;
+
+  if (m_serumCaptureCallback.load(std::memory_order_acquire))
+  {
+    // Subscribers get the metadata and a hash, the frame itself is shared instead of copied.
+    SerumCaptureRecord record;
+    static_cast<SerumCaptureInfo&>(record) = info;
+    if (primaryOutput)
+    {
+      record.outputMode = primaryOutput->mode;
+      record.outputWidth = primaryOutput->width;
+      record.outputHeight = primaryOutput->height;
+      record.outputHashFNV1a64 = HashOutputFNV1a64(*primaryOutput);
+    }
+
+    std::lock_guard<std::mutex> callbackLock(m_serumCaptureCallbackMutex);
+    const SerumCaptureCallback callback = m_serumCaptureCallback.load(std::memory_order_relaxed);
+    if (callback)
+    {
+      if (m_serumCaptureWithOutput) record.output = primaryOutput;
+      (*callback)(record, m_pSerumCaptureCallbackUserData);
+      return;
+    }
+  }
+
   SerumCapture capture;
-  capture.valid = true;
-  capture.hasOutput = (primaryOutput != nullptr);
-  capture.isRotation = isRotation;
-  capture.hasTimestamp = hasTimestamp;
-  capture.sourceOrdinal = frameContext.sourceOrdinal;
-  capture.sourceFrameIndex = frameContext.sourceFrameIndex;
-  capture.originalFrameIndex = frameContext.originalFrameIndex;
-  capture.inputCrc32 = frameContext.inputCrc32;
-  capture.inputTimestampMs = frameContext.inputTimestampMs;
-  capture.inputDurationMs = frameContext.inputDurationMs;
-  capture.serumResult = serumResult;
-  capture.serumVersion = serumVersion;
-  capture.serumFrameId = serumFrameId;
-  capture.serumTriggerId = serumTriggerId;
-  capture.serumRotationTimer = serumRotationTimer;
-  capture.serumFeatureFlags = serumFeatureFlags;
-  capture.colorizeTimeUs = colorizeTimeUs;
-  capture.averageColorizeTimeUs = averageColorizeTimeUs;
-  capture.outputTimestampMs = outputTimestampMs;
+  static_cast<SerumCaptureInfo&>(capture) = info;
   if (primaryOutput)
   {
     capture.update = *primaryOutput;
@@ -2959,6 +3577,15 @@ void DMD::RecordSerumColorizeCapture(const FrameContext& frameContext, const std
   m_serumCaptureCv.notify_all();
 }
 
+void DMD::SetSerumCaptureCallback(SerumCaptureCallback callback, void* pUserData, bool withOutput)
+{
+  // Waits for a running call of the previous callback.
+  std::lock_guard<std::mutex> callbackLock(m_serumCaptureCallbackMutex);
+  m_pSerumCaptureCallbackUserData = pUserData;
+  m_serumCaptureWithOutput = withOutput;
+  m_serumCaptureCallback.store(callback, std::memory_order_release);
+}
+
 bool DMD::GetQueueFrameContext(uint8_t bufferPositionMod, FrameContext& frameContext) const
 {
   if (bufferPositionMod >= DMDUTIL_FRAME_BUFFER_SIZE)
@@ -2969,729 +3596,374 @@ bool DMD::GetQueueFrameContext(uint8_t bufferPositionMod, FrameContext& frameCon
   return frameContext.valid;
 }
 
-bool DMD::WaitForDumpers(uint16_t targetPosition, uint32_t timeoutMs)
+DMD::ConsumerScope::ConsumerScope(DMD* pDMD, Consumer consumer) : m_pDMD(pDMD), m_consumer(consumer)
 {
-  std::unique_lock<std::mutex> lock(m_dumpPositionMutex);
-  if (DumpersReached(targetPosition)) return true;
-  if (timeoutMs == 0) return false;
-  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
-  return m_dumpPositionCv.wait_until(lock, deadline, [&]() { return DumpersReached(targetPosition); });
+  m_pDMD->MarkConsumed(m_consumer, 0);
+  m_pDMD->m_consumerActive[(int)m_consumer].store(true, std::memory_order_release);
+  t_pConsumerDMD = m_pDMD;
 }
 
-void DMD::DumpDMDTxtThread()
+DMD::ConsumerScope::~ConsumerScope()
 {
-  char name[DMDUTIL_MAX_NAME_SIZE] = {0};
-  uint16_t bufferPosition = 0;
-  uint8_t renderBuffer[3][256 * 64] = {0};
-  uint32_t passed[3] = {0};
-  std::chrono::steady_clock::time_point start;
-  FILE* f = nullptr;
-  std::string currentPath;
-  std::unordered_set<uint64_t> seenHashes;
+  t_pConsumerDMD = nullptr;
+  m_pDMD->m_consumerActive[(int)m_consumer].store(false, std::memory_order_release);
+  m_pDMD->NotifyFenceWaiters();
+}
 
-  (void)m_stopFlag.load(std::memory_order_acquire);
+uint64_t DMD::GetRingSequence(uint16_t bufferPosition) const
+{
+  // The ring position is the low 16 bits of the ring sequence, consumers never fall a full wrap behind.
+  const uint64_t sequence = m_updateBufferQueueSequence.load(std::memory_order_acquire);
+  return sequence - (uint16_t)((uint16_t)sequence - bufferPosition);
+}
 
-  Config* const pConfig = Config::GetInstance();
-  bool dumpNotColorizedFrames = pConfig->IsDumpNotColorizedFrames();
-  bool filterTransitionalFrames = pConfig->IsFilterTransitionalFrames();
-  bool dumpZip = pConfig->IsDumpZip();
-  m_dumpTxtActive.store(true, std::memory_order_release);
-  m_dumpTxtPosition.store(bufferPosition, std::memory_order_release);
-  m_dumpPositionCv.notify_all();
+void DMD::MarkConsumed(Consumer consumer, uint16_t bufferPosition)
+{
+  const uint64_t consumed = GetRingSequence(bufferPosition);
+  const uint64_t previous = m_consumerSequence[(int)consumer].exchange(consumed, std::memory_order_acq_rel);
+  if (consumed > previous && m_consumerActive[(int)consumer].load(std::memory_order_relaxed))
+    m_consumerFrames[(int)consumer].fetch_add(consumed - previous, std::memory_order_relaxed);
+  NotifyFenceWaiters();
+}
 
-  auto closeDumpFile = [&](FILE*& handle, std::string& path)
+bool DMD::ConsumersReached(uint64_t sequence) const
+{
+  for (int i = 0; i < (int)Consumer::Count; i++)
   {
-    if (!handle) return;
-    fflush(handle);
-    fclose(handle);
-    handle = nullptr;
-    if (dumpZip && !path.empty())
-    {
-      ZipDumpFile(path);
-    }
-    path.clear();
-  };
+    if (m_consumerActive[i].load(std::memory_order_acquire) &&
+        m_consumerSequence[i].load(std::memory_order_acquire) < sequence)
+      return false;
+  }
 
-  while (true)
+  // The ZeDMD thread hands its frames to the outputs, a frame counts once every device got it.
+  if (m_consumerActive[(int)Consumer::ZeDMD].load(std::memory_order_acquire))
   {
-    std::shared_lock<std::shared_mutex> sl(m_dmdSharedMutex);
-    m_dmdCV.wait(sl,
-                 [&]()
-                 {
-                   return m_stopFlag.load(std::memory_order_relaxed) ||
-                          (m_updateBufferQueuePosition.load(std::memory_order_relaxed) != bufferPosition);
-                 });
-    sl.unlock();
-    if (m_stopFlag.load(std::memory_order_acquire))
+    std::lock_guard<std::mutex> lock(m_displaysMutex);
+    for (const ZeDMDOutput* pZeDMDOutput : m_zedmdOutputs)
     {
-      closeDumpFile(f, currentPath);
-      m_dumpTxtActive.store(false, std::memory_order_release);
-      m_dumpPositionCv.notify_all();
-      return;
+      if (!pZeDMDOutput->HasRendered(sequence)) return false;
     }
+  }
+  return true;
+}
 
-    const uint16_t updateBufferQueuePosition = m_updateBufferQueuePosition.load(std::memory_order_acquire);
-    while (!m_stopFlag.load(std::memory_order_relaxed) && bufferPosition != updateBufferQueuePosition)
-    {
-      // Don't use GetNextBufferPosition() here, we need all frames!
-      ++bufferPosition;  // 65635 + 1 = 0
-      uint8_t bufferPositionMod = bufferPosition % DMDUTIL_FRAME_BUFFER_SIZE;
-      m_dumpTxtPosition.store(bufferPosition, std::memory_order_release);
-      m_dumpPositionCv.notify_all();
-
-      if (m_pUpdateBufferQueue[bufferPositionMod]->depth <= 4 && m_pUpdateBufferQueue[bufferPositionMod]->hasData &&
-          ((m_pUpdateBufferQueue[bufferPositionMod]->mode == Mode::Data && !dumpNotColorizedFrames) ||
-           (m_pUpdateBufferQueue[bufferPositionMod]->mode == Mode::NotColorized && dumpNotColorizedFrames)))
-      {
-        bool update = false;
-        if (strcmp(m_romName, name) != 0)
-        {
-          // New game ROM.
-          start = std::chrono::steady_clock::now();
-          closeDumpFile(f, currentPath);
-          strcpy(name, m_romName);
-
-          if (name[0] != '\0')
-          {
-            char filename[DMDUTIL_MAX_NAME_SIZE + 128 + 8 + 5];
-            char suffix[9];  // 8 chars + null terminator
-            if (!GetDumpSuffix(name, suffix, sizeof(suffix)))
-            {
-              GenerateRandomSuffix(suffix, 8);
-            }
-            if (m_dumpPath[0] == '\0') strcpy(m_dumpPath, Config::GetInstance()->GetDumpPath());
-            size_t pathLen = strlen(m_dumpPath);
-            if (pathLen == 0)
-            {
-              snprintf(filename, sizeof(filename), "./%s-%s.txt", name, suffix);
-            }
-            else if (m_dumpPath[pathLen - 1] == '/' || m_dumpPath[pathLen - 1] == '\\')
-            {
-              snprintf(filename, sizeof(filename), "%s%s-%s.txt", m_dumpPath, name, suffix);
-            }
-            else
-            {
-              snprintf(filename, sizeof(filename), "%s/%s-%s.txt", m_dumpPath, name, suffix);
-            }
-            f = fopen(filename, "w");
-            if (f)
-            {
-              currentPath = filename;
-            }
-            else
-            {
-              currentPath.clear();
-            }
-            update = true;
-            memset(renderBuffer, 0, 2 * 256 * 64);
-            passed[0] = passed[1] = 0;
-          }
-        }
+void DMD::NotifyFenceWaiters()
+{
+  if (m_fenceWaiters.load() == 0) return;
+  {
+    // Pairs with the predicate check in WaitFence() so a wakeup can't get lost.
+    std::lock_guard<std::mutex> lock(m_fenceMutex);
+  }
+  m_fenceCv.notify_all();
+}
 
-        if (name[0] != '\0')
-        {
-          int length =
-              (int)m_pUpdateBufferQueue[bufferPositionMod]->width * m_pUpdateBufferQueue[bufferPositionMod]->height;
-          if (update || (memcmp(renderBuffer[1], m_pUpdateBufferQueue[bufferPositionMod]->data, length) != 0))
-          {
-            uint32_t queuedTimestamp = 0;
-            if (GetQueueTimestamp(bufferPositionMod, queuedTimestamp))
-            {
-              passed[2] = queuedTimestamp;
-            }
-            else
-            {
-              passed[2] = (uint32_t)(std::chrono::duration_cast<std::chrono::milliseconds>(
-                                         std::chrono::steady_clock::now() - start)
-                                         .count());
-            }
-            memcpy(renderBuffer[2], m_pUpdateBufferQueue[bufferPositionMod]->data, length);
+DMD::FenceId DMD::InsertFence() { return m_updateBufferQueueSubmitted.load(std::memory_order_acquire); }
 
-            if (filterTransitionalFrames && m_pUpdateBufferQueue[bufferPositionMod]->depth == 2 &&
-                (passed[2] - passed[1]) < DMDUTIL_MAX_TRANSITIONAL_FRAME_DURATION)
-            {
-              int i = 0;
-              while (i < length &&
-                     ((renderBuffer[0][i] == 2) ||
-                      ((renderBuffer[0][i] == 3) || (renderBuffer[2][i] > 1)) == (renderBuffer[1][i] > 0)))
-              {
-                i++;
-              }
-              if (i == length)
-              {
-                Log(DMDUtil_LogLevel_DEBUG, "DumpDMDTxt: skip transitional frame");
+bool DMD::WaitFence(FenceId fence, uint32_t timeoutMs)
+{
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+  bool reached = false;
+
+  m_fenceWaiters.fetch_add(1);
+  std::unique_lock<std::mutex> lock(m_fenceMutex);
+  // Serum and VNI queue their colorized frames before they mark the source frame as consumed. So once every consumer
+  // reached the fence, a second round covers those derived frames.
+  for (int round = 0; round < 2; round++)
+  {
+    reached = m_fenceCv.wait_until(lock, deadline,
+                                   [&]()
+                                   {
+                                     return m_stopFlag.load(std::memory_order_relaxed) ||
+                                            (m_updateBufferQueueSequence.load(std::memory_order_acquire) >= fence &&
+                                             ConsumersReached(fence));
+                                   });
+    if (!reached || m_stopFlag.load(std::memory_order_acquire)) break;
+
+    const FenceId submitted = m_updateBufferQueueSubmitted.load(std::memory_order_acquire);
+    if (submitted == fence) break;
+    fence = submitted;
+  }
+  lock.unlock();
+  m_fenceWaiters.fetch_sub(1);
 
-                // renderBuffer[1] is a transitional frame, delete it.
-                memcpy(renderBuffer[1], renderBuffer[2], length);
-                passed[1] += passed[2];
-                continue;
-              }
-            }
+  return reached && !m_stopFlag.load(std::memory_order_acquire);
+}
 
-            if (f)
-            {
-              if (passed[0] > 0)
-              {
-                bool dump = true;
+bool DMD::Flush(uint32_t timeoutMs) { return WaitFence(InsertFence(), timeoutMs); }
 
-                if (dumpNotColorizedFrames)
-                {
-                  uint64_t hash = komihash(renderBuffer[0], length, 0);
-                  if (seenHashes.find(hash) == seenHashes.end())
-                  {
-                    seenHashes.insert(hash);
-                  }
-                  else
-                  {
-                    Log(DMDUtil_LogLevel_DEBUG, "DumpDMDTxt: skip duplicate frame");
-                    dump = false;
-                  }
-                }
+bool DMD::WaitForDumpers(uint16_t targetPosition, uint32_t timeoutMs)
+{
+  // The ring position was taken after the frame was queued, so a fence inserted now covers it.
+  (void)targetPosition;
+  return WaitFence(InsertFence(), timeoutMs);
+}
 
-                if (dump)
-                {
-                  fprintf(f, "0x%08x\r\n", passed[0]);
-                  for (int y = 0; y < m_pUpdateBufferQueue[bufferPositionMod]->height; y++)
-                  {
-                    for (int x = 0; x < m_pUpdateBufferQueue[bufferPositionMod]->width; x++)
-                    {
-                      fprintf(f, "%x", renderBuffer[0][y * m_pUpdateBufferQueue[bufferPositionMod]->width + x]);
-                    }
-                    fprintf(f, "\r\n");
-                  }
-                  fprintf(f, "\r\n");
-                }
-              }
-            }
-            memcpy(renderBuffer[0], renderBuffer[1], length);
-            passed[0] = passed[1];
-            memcpy(renderBuffer[1], renderBuffer[2], length);
-            passed[1] = passed[2];
-          }
-        }
-      }
-    }
-  }
+std::vector<DMD::ColorizeTimingStats> DMD::GetColorizeProfile() const
+{
+  std::vector<ColorizeTimingStats> stats = m_pSerumProfiler->GetStats();
+  std::vector<ColorizeTimingStats> vniStats = m_pVniProfiler->GetStats();
+  stats.insert(stats.end(), vniStats.begin(), vniStats.end());
+  return stats;
 }
 
-void DMD::DumpDMDRgb565Thread()
+void DMD::ResetColorizeProfile()
 {
-  char name[DMDUTIL_MAX_NAME_SIZE] = {0};
-  uint16_t bufferPosition = 0;
-  uint16_t renderBuffer[3][256 * 64] = {0};
-  uint16_t frameWidths[3] = {0};
-  uint16_t frameHeights[3] = {0};
-  uint32_t passed[3] = {0};
-  std::chrono::steady_clock::time_point start;
-  FILE* f = nullptr;
-  std::string currentPath;
-  uint8_t palette[256 * 3] = {0};
-  uint8_t rgb24Temp[256 * 64 * 3] = {0};
+  m_pSerumProfiler->Reset();
+  m_pVniProfiler->Reset();
+}
 
-  (void)m_stopFlag.load(std::memory_order_acquire);
-  bool dumpZip = Config::GetInstance()->IsDumpZip();
-  m_dump565Active.store(true, std::memory_order_release);
-  m_dump565Position.store(bufferPosition, std::memory_order_release);
-  m_dumpPositionCv.notify_all();
+DMD::RotationJitterStats DMD::GetSerumRotationJitter() const { return m_pSerumProfiler->GetRotationJitter(); }
 
-  auto closeDumpFile = [&](FILE*& handle, std::string& path)
+std::vector<DMD::SinkStats> DMD::GetSinkStats() const
+{
+  static const char* const names[(int)Consumer::Count] = {"Dump",    "Serum",     "VNI",      "PUP",      "ZeDMD",
+                                                          "Pixelcade", "PIN2DMD", "LevelDMD", "RGB24DMD", "ConsoleDMD"};
+  std::vector<SinkStats> stats((int)Consumer::Count);
+  for (int i = 0; i < (int)Consumer::Count; i++)
   {
-    if (!handle) return;
-    fflush(handle);
-    fclose(handle);
-    handle = nullptr;
-    if (dumpZip && !path.empty())
+    stats[i].name = names[i];
+    stats[i].active = m_consumerActive[i].load(std::memory_order_acquire);
+    stats[i].frames = m_consumerFrames[i].load(std::memory_order_relaxed);
+    if (m_pFramePacers[i])
     {
-      ZipDumpFile(path);
+      stats[i].fps = m_pFramePacers[i]->GetFps();
+      stats[i].frameCostUs = m_pFramePacers[i]->GetCostUs();
     }
-    path.clear();
-  };
+  }
 
-  while (true)
+  // The ZeDMD outputs pace themselves, the slowest one is reported.
+  std::lock_guard<std::mutex> lock(m_displaysMutex);
+  SinkStats& zedmdStats = stats[(int)Consumer::ZeDMD];
+  for (size_t i = 0; i < m_zedmdOutputs.size(); i++)
   {
-    std::shared_lock<std::shared_mutex> sl(m_dmdSharedMutex);
-    m_dmdCV.wait(sl,
-                 [&]()
-                 {
-                   return m_stopFlag.load(std::memory_order_relaxed) ||
-                          (m_updateBufferQueuePosition.load(std::memory_order_relaxed) != bufferPosition);
-                 });
-    sl.unlock();
-    if (m_stopFlag.load(std::memory_order_acquire))
-    {
-      closeDumpFile(f, currentPath);
-      m_dump565Active.store(false, std::memory_order_release);
-      m_dumpPositionCv.notify_all();
-      return;
-    }
-
-    const uint16_t updateBufferQueuePosition = m_updateBufferQueuePosition.load(std::memory_order_acquire);
-    while (!m_stopFlag.load(std::memory_order_relaxed) && bufferPosition != updateBufferQueuePosition)
-    {
-      // Don't use GetNextBufferPosition() here, we need all frames!
-      ++bufferPosition;  // 65635 + 1 = 0
-      uint8_t bufferPositionMod = bufferPosition % DMDUTIL_FRAME_BUFFER_SIZE;
-      m_dump565Position.store(bufferPosition, std::memory_order_release);
-      m_dumpPositionCv.notify_all();
-
-      Update* update = m_pUpdateBufferQueue[bufferPositionMod];
-      if (!(update->hasData || update->hasSegData)) continue;
-
-      if (!(update->mode == Mode::RGB24 || update->mode == Mode::RGB16 || update->mode == Mode::SerumV1 ||
-            update->mode == Mode::Vni || IsSerumV2Mode(update->mode)))
-        continue;
-
-      bool updateFrame = false;
-      if (strcmp(m_romName, name) != 0)
-      {
-        // New game ROM.
-        start = std::chrono::steady_clock::now();
-        closeDumpFile(f, currentPath);
-        strcpy(name, m_romName);
-
-        if (name[0] != '\0')
-        {
-          char filename[DMDUTIL_MAX_NAME_SIZE + 128 + 8 + 9];
-          char suffix[9];  // 8 chars + null terminator
-          if (!GetDumpSuffix(name, suffix, sizeof(suffix)))
-          {
-            GenerateRandomSuffix(suffix, 8);
-          }
-          if (m_dumpPath[0] == '\0') strcpy(m_dumpPath, Config::GetInstance()->GetDumpPath());
-          size_t pathLen = strlen(m_dumpPath);
-          if (pathLen == 0)
-          {
-            snprintf(filename, sizeof(filename), "./%s-%s.565.txt", name, suffix);
-          }
-          else if (m_dumpPath[pathLen - 1] == '/' || m_dumpPath[pathLen - 1] == '\\')
-          {
-            snprintf(filename, sizeof(filename), "%s%s-%s.565.txt", m_dumpPath, name, suffix);
-          }
-          else
-          {
-            snprintf(filename, sizeof(filename), "%s/%s-%s.565.txt", m_dumpPath, name, suffix);
-          }
-          f = fopen(filename, "w");
-          if (f)
-          {
-            currentPath = filename;
-          }
-          else
-          {
-            currentPath.clear();
-          }
-          updateFrame = true;
-          memset(renderBuffer, 0, sizeof(renderBuffer));
-          memset(frameWidths, 0, sizeof(frameWidths));
-          memset(frameHeights, 0, sizeof(frameHeights));
-          passed[0] = passed[1] = 0;
-        }
-      }
-
-      if (name[0] == '\0')
-      {
-        continue;
-      }
-
-      uint16_t width = update->width;
-      uint16_t height = update->height;
-      int length = (int)width * height;
-      size_t frameBytes = (size_t)length * sizeof(uint16_t);
-      if (frameBytes > sizeof(renderBuffer[0]))
-      {
-        continue;
-      }
-
-      if (width != frameWidths[1] || height != frameHeights[1])
-      {
-        updateFrame = true;
-      }
-
-      uint16_t* nextFrame = renderBuffer[2];
-      if (update->mode == Mode::RGB16 || IsSerumV2Mode(update->mode))
-      {
-        memcpy(nextFrame, update->segData, frameBytes);
-      }
-      else
-      {
-        if (update->mode == Mode::RGB24)
-        {
-          if (update->depth != 24)
-          {
-            UpdatePalette(palette, update->depth, update->r, update->g, update->b);
-          }
-          AdjustRGB24Depth(update->data, rgb24Temp, length, palette, update->depth);
-        }
-        else
-        {
-          size_t paletteBytes = PaletteBytesForDepth((uint8_t)update->depth);
-          if (paletteBytes > 0 && paletteBytes <= sizeof(palette))
-          {
-            memcpy(palette, update->segData, paletteBytes);
-          }
-          FrameUtil::Helper::ConvertToRgb24(rgb24Temp, update->data, length, palette);
-        }
-
-        for (int i = 0; i < length; i++)
-        {
-          int pos = i * 3;
-          uint32_t r = rgb24Temp[pos];
-          uint32_t g = rgb24Temp[pos + 1];
-          uint32_t b = rgb24Temp[pos + 2];
-          nextFrame[i] = (uint16_t)(((r & 0xF8u) << 8) | ((g & 0xFCu) << 3) | (b >> 3));
-        }
-      }
-
-      if (updateFrame || memcmp(renderBuffer[1], nextFrame, frameBytes) != 0)
-      {
-        uint32_t queuedTimestamp = 0;
-        if (GetQueueTimestamp(bufferPositionMod, queuedTimestamp))
-        {
-          passed[2] = queuedTimestamp;
-        }
-        else
-        {
-          passed[2] =
-              (uint32_t)(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start)
-                             .count());
-        }
-        frameWidths[2] = width;
-        frameHeights[2] = height;
-
-        if (f && passed[0] > 0 && frameWidths[0] > 0 && frameHeights[0] > 0)
-        {
-          fprintf(f, "0x%08x\r\n", passed[0]);
-          uint32_t rowWidth = frameWidths[0];
-          uint32_t rowHeight = frameHeights[0];
-          const uint16_t* frame = renderBuffer[0];
-          for (uint32_t y = 0; y < rowHeight; y++)
-          {
-            for (uint32_t x = 0; x < rowWidth; x++)
-            {
-              fprintf(f, "%04x", frame[y * rowWidth + x]);
-            }
-            fprintf(f, "\r\n");
-          }
-          fprintf(f, "\r\n");
-        }
-
-        size_t prevBytes = (size_t)frameWidths[1] * frameHeights[1] * sizeof(uint16_t);
-        if (prevBytes > sizeof(renderBuffer[0])) prevBytes = sizeof(renderBuffer[0]);
-        memcpy(renderBuffer[0], renderBuffer[1], prevBytes);
-        passed[0] = passed[1];
-        frameWidths[0] = frameWidths[1];
-        frameHeights[0] = frameHeights[1];
-
-        memcpy(renderBuffer[1], nextFrame, frameBytes);
-        passed[1] = passed[2];
-        frameWidths[1] = frameWidths[2];
-        frameHeights[1] = frameHeights[2];
-      }
-    }
+    const FramePacer& framePacer = m_zedmdOutputs[i]->GetFramePacer();
+    const float fps = framePacer.GetFps();
+    if (i == 0 || fps < zedmdStats.fps) zedmdStats.fps = fps;
+    zedmdStats.frameCostUs = std::max(zedmdStats.frameCostUs, framePacer.GetCostUs());
   }
+  return stats;
 }
 
-void DMD::DumpDMDRgb888Thread()
+void DMD::DumpDMDThread()
 {
   char name[DMDUTIL_MAX_NAME_SIZE] = {0};
   uint16_t bufferPosition = 0;
-  uint8_t renderBuffer[3][256 * 64 * 3] = {0};
-  uint16_t frameWidths[3] = {0};
-  uint16_t frameHeights[3] = {0};
-  uint32_t passed[3] = {0};
-  std::chrono::steady_clock::time_point start;
-  FILE* f = nullptr;
-  std::string currentPath;
+  uint32_t startMs = 0;
+  std::string basePath;
+  // Indexed by the bit position of the DMDUTIL_DUMP_FORMAT_* flag.
+  // Declared before the encoders, so segments closed during shutdown are still archived.
+  const Config* const pConfig = GetConfig();
+  const DumpRotationPolicy rotation = DumpRotationPolicy::FromConfig(*pConfig);
+  DumpArchiver archiver((uint64_t)std::max(pConfig->GetDumpRetentionSize(), 0) * 1024 * 1024);
+  std::unique_ptr<DumpEncoder> encoders[DMDUTIL_DUMP_FORMAT_COUNT];
+  std::vector<DumpEncoder*> writers;
+  writers.reserve(DMDUTIL_DUMP_FORMAT_COUNT);
+  std::vector<uint16_t> rgb565(kMaxFramePixels);
+  std::vector<uint8_t> rgb888(kMaxRgb24Bytes);
   uint8_t palette[256 * 3] = {0};
 
+  const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+  DumpWorkerPool pool(hardwareThreads > 1 ? std::min<size_t>(DMDUTIL_DUMP_MAX_WORKERS, hardwareThreads - 1) : 0);
+
   (void)m_stopFlag.load(std::memory_order_acquire);
-  bool dumpZip = Config::GetInstance()->IsDumpZip();
-  m_dump888Active.store(true, std::memory_order_release);
-  m_dump888Position.store(bufferPosition, std::memory_order_release);
-  m_dumpPositionCv.notify_all();
+  SetThreadLogConfig(&m_pConfig);
+  ConsumerScope consumerScope(this, Consumer::Dump);
 
-  auto closeDumpFile = [&](FILE*& handle, std::string& path)
+  auto ready = [&]()
   {
-    if (!handle) return;
-    fflush(handle);
-    fclose(handle);
-    handle = nullptr;
-    if (dumpZip && !path.empty())
-    {
-      ZipDumpFile(path);
-    }
-    path.clear();
+    return m_stopFlag.load(std::memory_order_relaxed) ||
+           (m_updateBufferQueuePosition.load(std::memory_order_relaxed) != bufferPosition);
   };
 
   while (true)
   {
     std::shared_lock<std::shared_mutex> sl(m_dmdSharedMutex);
-    m_dmdCV.wait(sl,
-                 [&]()
-                 {
-                   return m_stopFlag.load(std::memory_order_relaxed) ||
-                          (m_updateBufferQueuePosition.load(std::memory_order_relaxed) != bufferPosition);
-                 });
-    sl.unlock();
-    if (m_stopFlag.load(std::memory_order_acquire))
+    if (rotation.idleMs > 0)
     {
-      closeDumpFile(f, currentPath);
-      m_dump888Active.store(false, std::memory_order_release);
-      m_dumpPositionCv.notify_all();
-      return;
-    }
-
-    const uint16_t updateBufferQueuePosition = m_updateBufferQueuePosition.load(std::memory_order_acquire);
-    while (!m_stopFlag.load(std::memory_order_relaxed) && bufferPosition != updateBufferQueuePosition)
-    {
-      // Don't use GetNextBufferPosition() here, we need all frames!
-      ++bufferPosition;  // 65635 + 1 = 0
-      uint8_t bufferPositionMod = bufferPosition % DMDUTIL_FRAME_BUFFER_SIZE;
-      m_dump888Position.store(bufferPosition, std::memory_order_release);
-      m_dumpPositionCv.notify_all();
-
-      Update* update = m_pUpdateBufferQueue[bufferPositionMod];
-      if (!(update->hasData || update->hasSegData)) continue;
-
-      if (!(update->mode == Mode::RGB24 || update->mode == Mode::RGB16 || update->mode == Mode::SerumV1 ||
-            update->mode == Mode::Vni || IsSerumV2Mode(update->mode)))
-        continue;
-
-      bool updateFrame = false;
-      if (strcmp(m_romName, name) != 0)
+      if (!m_dmdCV.wait_for(sl, std::chrono::milliseconds(rotation.idleMs), ready))
       {
-        // New game ROM.
-        start = std::chrono::steady_clock::now();
-        closeDumpFile(f, currentPath);
-        strcpy(name, m_romName);
-
-        if (name[0] != '\0')
+        sl.unlock();
+        for (auto& pEncoder : encoders)
         {
-          char filename[DMDUTIL_MAX_NAME_SIZE + 128 + 8 + 9];
-          char suffix[9];  // 8 chars + null terminator
-          if (!GetDumpSuffix(name, suffix, sizeof(suffix)))
-          {
-            GenerateRandomSuffix(suffix, 8);
-          }
-          if (m_dumpPath[0] == '\0') strcpy(m_dumpPath, Config::GetInstance()->GetDumpPath());
-          size_t pathLen = strlen(m_dumpPath);
-          if (pathLen == 0)
-          {
-            snprintf(filename, sizeof(filename), "./%s-%s.888.txt", name, suffix);
-          }
-          else if (m_dumpPath[pathLen - 1] == '/' || m_dumpPath[pathLen - 1] == '\\')
-          {
-            snprintf(filename, sizeof(filename), "%s%s-%s.888.txt", m_dumpPath, name, suffix);
-          }
-          else
-          {
-            snprintf(filename, sizeof(filename), "%s/%s-%s.888.txt", m_dumpPath, name, suffix);
-          }
-          f = fopen(filename, "w");
-          if (f)
-          {
-            currentPath = filename;
-          }
-          else
-          {
-            currentPath.clear();
-          }
-          updateFrame = true;
-          memset(renderBuffer, 0, sizeof(renderBuffer));
-          memset(frameWidths, 0, sizeof(frameWidths));
-          memset(frameHeights, 0, sizeof(frameHeights));
-          passed[0] = passed[1] = 0;
+          if (pEncoder) pEncoder->CheckIdle();
         }
-      }
-
-      if (name[0] == '\0')
-      {
-        continue;
-      }
-
-      uint16_t width = update->width;
-      uint16_t height = update->height;
-      int length = (int)width * height;
-      size_t frameBytes = (size_t)length * 3;
-      if (frameBytes > sizeof(renderBuffer[0]))
-      {
         continue;
       }
-
-      if (width != frameWidths[1] || height != frameHeights[1])
-      {
-        updateFrame = true;
-      }
-
-      uint8_t* nextFrame = renderBuffer[2];
-      if (update->mode == Mode::RGB24)
-      {
-        if (update->depth != 24)
-        {
-          UpdatePalette(palette, update->depth, update->r, update->g, update->b);
-        }
-        AdjustRGB24Depth(update->data, nextFrame, length, palette, update->depth);
-      }
-      else if (update->mode == Mode::RGB16 || IsSerumV2Mode(update->mode))
-      {
-        const uint16_t* src = update->segData;
-        for (int i = 0; i < length; i++)
-        {
-          uint16_t value = src[i];
-          uint8_t r = (uint8_t)((value >> 11) & 0x1F);
-          uint8_t g = (uint8_t)((value >> 5) & 0x3F);
-          uint8_t b = (uint8_t)(value & 0x1F);
-          nextFrame[i * 3] = (uint8_t)((r << 3) | (r >> 2));
-          nextFrame[i * 3 + 1] = (uint8_t)((g << 2) | (g >> 4));
-          nextFrame[i * 3 + 2] = (uint8_t)((b << 3) | (b >> 2));
-        }
-      }
-      else
-      {
-        size_t paletteBytes = PaletteBytesForDepth((uint8_t)update->depth);
-        if (paletteBytes > 0 && paletteBytes <= sizeof(palette))
-        {
-          memcpy(palette, update->segData, paletteBytes);
-        }
-        FrameUtil::Helper::ConvertToRgb24(nextFrame, update->data, length, palette);
-      }
-
-      if (updateFrame || memcmp(renderBuffer[1], nextFrame, frameBytes) != 0)
-      {
-        uint32_t queuedTimestamp = 0;
-        if (GetQueueTimestamp(bufferPositionMod, queuedTimestamp))
-        {
-          passed[2] = queuedTimestamp;
-        }
-        else
-        {
-          passed[2] =
-              (uint32_t)(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start)
-                             .count());
-        }
-        frameWidths[2] = width;
-        frameHeights[2] = height;
-
-        if (f && passed[0] > 0 && frameWidths[0] > 0 && frameHeights[0] > 0)
-        {
-          fprintf(f, "0x%08x\r\n", passed[0]);
-          uint32_t rowWidth = frameWidths[0];
-          uint32_t rowHeight = frameHeights[0];
-          const uint8_t* frame = renderBuffer[0];
-          for (uint32_t y = 0; y < rowHeight; y++)
-          {
-            for (uint32_t x = 0; x < rowWidth; x++)
-            {
-              int pos = (int)(y * rowWidth + x) * 3;
-              fprintf(f, "%02x%02x%02x", frame[pos], frame[pos + 1], frame[pos + 2]);
-            }
-            fprintf(f, "\r\n");
-          }
-          fprintf(f, "\r\n");
-        }
-
-        size_t prevBytes = (size_t)frameWidths[1] * frameHeights[1] * 3;
-        if (prevBytes > sizeof(renderBuffer[0])) prevBytes = sizeof(renderBuffer[0]);
-        memcpy(renderBuffer[0], renderBuffer[1], prevBytes);
-        passed[0] = passed[1];
-        frameWidths[0] = frameWidths[1];
-        frameHeights[0] = frameHeights[1];
-
-        memcpy(renderBuffer[1], nextFrame, frameBytes);
-        passed[1] = passed[2];
-        frameWidths[1] = frameWidths[2];
-        frameHeights[1] = frameHeights[2];
-      }
     }
-  }
-}
-
-void DMD::DumpDMDRawThread()
-{
-  char name[DMDUTIL_MAX_NAME_SIZE] = {0};
-  uint16_t bufferPosition = 0;
-  std::chrono::steady_clock::time_point start;
-  FILE* f = nullptr;
-
-  (void)m_stopFlag.load(std::memory_order_acquire);
-  m_dumpRawActive.store(true, std::memory_order_release);
-  m_dumpRawPosition.store(bufferPosition, std::memory_order_release);
-  m_dumpPositionCv.notify_all();
-
-  while (true)
-  {
-    std::shared_lock<std::shared_mutex> sl(m_dmdSharedMutex);
-    m_dmdCV.wait(sl,
-                 [&]()
-                 {
-                   return m_stopFlag.load(std::memory_order_relaxed) ||
-                          (m_updateBufferQueuePosition.load(std::memory_order_relaxed) != bufferPosition);
-                 });
+    else
+    {
+      m_dmdCV.wait(sl, ready);
+    }
     sl.unlock();
     if (m_stopFlag.load(std::memory_order_acquire))
     {
-      if (f)
+      for (auto& pEncoder : encoders)
       {
-        fflush(f);
-        fclose(f);
-        f = nullptr;
+        if (pEncoder) pEncoder->Close();
       }
-      m_dumpRawActive.store(false, std::memory_order_release);
-      m_dumpPositionCv.notify_all();
       return;
     }
 
+    // Formats enabled after the stage started join at the current ROM.
+    const uint8_t formats = m_dumpFormats.load(std::memory_order_acquire);
+    for (int i = 0; i < DMDUTIL_DUMP_FORMAT_COUNT; i++)
+    {
+      if ((formats & (1 << i)) && !encoders[i])
+      {
+        encoders[i] = DumpEncoder::Create((uint8_t)(1 << i), *GetConfig());
+        if (!encoders[i]) continue;
+        encoders[i]->SetRotation(rotation, &archiver);
+        if (name[0] != '\0') encoders[i]->Reset(name, basePath);
+      }
+    }
+    DumpEncoder* const pRgb565Encoder = encoders[2].get();  // DMDUTIL_DUMP_FORMAT_RGB565
+    DumpEncoder* const pRgb888Encoder = encoders[3].get();  // DMDUTIL_DUMP_FORMAT_RGB888
+
     const uint16_t updateBufferQueuePosition = m_updateBufferQueuePosition.load(std::memory_order_acquire);
     while (!m_stopFlag.load(std::memory_order_relaxed) && bufferPosition != updateBufferQueuePosition)
     {
       // Don't use GetNextBufferPosition() here, we need all frames!
       ++bufferPosition;  // 65635 + 1 = 0
       uint8_t bufferPositionMod = bufferPosition % DMDUTIL_FRAME_BUFFER_SIZE;
-      m_dumpRawPosition.store(bufferPosition, std::memory_order_release);
-      m_dumpPositionCv.notify_all();
+      Update* update = m_pUpdateBufferQueue[bufferPositionMod];
 
-      if (m_pUpdateBufferQueue[bufferPositionMod]->hasData || m_pUpdateBufferQueue[bufferPositionMod]->hasSegData)
+      if (update->hasData || update->hasSegData)
       {
         if (strcmp(m_romName, name) != 0)
         {
           // New game ROM.
-          start = std::chrono::steady_clock::now();
-          if (f)
-          {
-            fclose(f);
-            f = nullptr;
-          }
+          startMs = GetClockMs();
           strcpy(name, m_romName);
+          basePath.clear();
 
           if (name[0] != '\0')
           {
-            char filename[128];
-            snprintf(filename, DMDUTIL_MAX_NAME_SIZE + 5, "%s.raw", name);
-            f = fopen(filename, "ab");
+            char suffix[9];  // 8 chars + null terminator
+            if (!GetDumpSuffix(name, suffix, sizeof(suffix)))
+            {
+              GenerateRandomSuffix(suffix, 8);
+            }
+            if (m_dumpPath[0] == '\0') strcpy(m_dumpPath, GetConfig()->GetDumpPath());
+            size_t pathLen = strlen(m_dumpPath);
+            if (pathLen == 0)
+            {
+              basePath = "./";
+            }
+            else
+            {
+              basePath = m_dumpPath;
+              if (m_dumpPath[pathLen - 1] != '/' && m_dumpPath[pathLen - 1] != '\\') basePath += '/';
+            }
+            basePath += name;
+            basePath += '-';
+            basePath += suffix;
+          }
+
+          for (auto& pEncoder : encoders)
+          {
+            if (pEncoder) pEncoder->Reset(name, basePath);
           }
         }
 
         if (name[0] != '\0')
         {
-          if (f)
+          const int length = (int)update->width * update->height;
+          DumpFrame frame;
+          frame.pUpdate = update;
+          frame.isIndexed = update->depth <= 4 && update->hasData &&
+                            (update->mode == Mode::Data || update->mode == Mode::NotColorized);
+          frame.isColor = length <= (int)kMaxFramePixels &&
+                          (update->mode == Mode::RGB24 || update->mode == Mode::RGB16 ||
+                           update->mode == Mode::SerumV1 || update->mode == Mode::Vni || IsSerumV2Mode(update->mode));
+
+          writers.clear();
+          for (auto& pEncoder : encoders)
+          {
+            if (pEncoder && pEncoder->Accepts(frame)) writers.push_back(pEncoder.get());
+          }
+
+          if (!writers.empty())
           {
-            uint32_t current = 0;
-            if (!GetQueueTimestamp(bufferPositionMod, current))
+            uint32_t queuedTimestamp = 0;
+            if (GetQueueTimestamp(bufferPositionMod, queuedTimestamp))
+            {
+              frame.timestampMs = queuedTimestamp;
+            }
+            else
             {
-              current = (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
-                            std::chrono::steady_clock::now() - start)
-                            .count();
+              frame.timestampMs = GetClockMs() - startMs;
             }
-            fwrite(&current, 4, 1, f);
 
-            uint32_t size = sizeof(m_pUpdateBufferQueue[bufferPositionMod]);
-            fwrite(&size, 4, 1, f);
+            if (frame.isColor && (pRgb565Encoder || pRgb888Encoder))
+            {
+              // Convert the frame once and share the result between the rgb565 and rgb888 encoders.
+              if (update->mode == Mode::RGB16 || IsSerumV2Mode(update->mode))
+              {
+                frame.pRgb565 = update->segData;
+                if (pRgb888Encoder)
+                {
+                  const uint16_t* src = update->segData;
+                  for (int i = 0; i < length; i++)
+                  {
+                    uint16_t value = src[i];
+                    uint8_t r = (uint8_t)((value >> 11) & 0x1F);
+                    uint8_t g = (uint8_t)((value >> 5) & 0x3F);
+                    uint8_t b = (uint8_t)(value & 0x1F);
+                    rgb888[i * 3] = (uint8_t)((r << 3) | (r >> 2));
+                    rgb888[i * 3 + 1] = (uint8_t)((g << 2) | (g >> 4));
+                    rgb888[i * 3 + 2] = (uint8_t)((b << 3) | (b >> 2));
+                  }
+                  frame.pRgb888 = rgb888.data();
+                }
+              }
+              else
+              {
+                if (update->mode == Mode::RGB24)
+                {
+                  if (update->depth != 24)
+                  {
+                    UpdatePalette(palette, update->depth, update->r, update->g, update->b);
+                  }
+                  AdjustRGB24Depth(update->data, rgb888.data(), length, palette, update->depth);
+                }
+                else
+                {
+                  size_t paletteBytes = PaletteBytesForDepth((uint8_t)update->depth);
+                  if (paletteBytes > 0 && paletteBytes <= sizeof(palette))
+                  {
+                    memcpy(palette, update->segData, paletteBytes);
+                  }
+                  FrameUtil::Helper::ConvertToRgb24(rgb888.data(), update->data, length, palette);
+                }
+                frame.pRgb888 = rgb888.data();
+
+                if (pRgb565Encoder)
+                {
+                  for (int i = 0; i < length; i++)
+                  {
+                    int pos = i * 3;
+                    uint32_t r = rgb888[pos];
+                    uint32_t g = rgb888[pos + 1];
+                    uint32_t b = rgb888[pos + 2];
+                    rgb565[i] = (uint16_t)(((r & 0xF8u) << 8) | ((g & 0xFCu) << 3) | (b >> 3));
+                  }
+                  frame.pRgb565 = rgb565.data();
+                }
+              }
+            }
 
-            fwrite(m_pUpdateBufferQueue[bufferPositionMod], 1, size, f);
+            pool.Write(writers, frame);
           }
         }
       }
     }
+
+    // Frames only count as consumed once they left the stdio buffers.
+    for (auto& pEncoder : encoders)
+    {
+      if (pEncoder) pEncoder->Flush();
+    }
+    MarkConsumed(Consumer::Dump, bufferPosition);
   }
 }
 
@@ -3701,8 +3973,18 @@ void DMD::PupDMDThread()
   uint8_t renderBuffer[256 * 64] = {0};
   uint8_t palette[192] = {0};
   char name[DMDUTIL_MAX_NAME_SIZE] = {0};
+  std::shared_future<PUPDMD::DMD*> pupLoad;
 
   (void)m_stopFlag.load(std::memory_order_acquire);
+  SetThreadLogConfig(&m_pConfig);
+  ConsumerScope consumerScope(this, Consumer::PupDMD);
+
+  auto discardPup = [&]()
+  {
+    if (!pupLoad.valid()) return;
+    m_pAssetLoader->Submit([load = pupLoad]() { delete load.get(); });
+    pupLoad = std::shared_future<PUPDMD::DMD*>();
+  };
 
   while (true)
   {
@@ -3716,6 +3998,7 @@ void DMD::PupDMDThread()
     sl.unlock();
     if (m_stopFlag.load(std::memory_order_acquire))
     {
+      discardPup();
       return;
     }
 
@@ -3730,29 +4013,49 @@ void DMD::PupDMDThread()
       {
         strcpy(name, m_romName);
 
-        if (Config::GetInstance()->IsPUPCapture())
+        if (GetConfig()->IsPUPCapture())
         {
           if (m_pPUPDMD)
           {
             delete (m_pPUPDMD);
             m_pPUPDMD = nullptr;
           }
+          discardPup();
 
           if (name[0] != '\0')
           {
-            if (m_pupVideosPath[0] == '\0') strcpy(m_pupVideosPath, Config::GetInstance()->GetPUPVideosPath());
-            m_pPUPDMD = new PUPDMD::DMD();
-            m_pPUPDMD->SetLogCallback(PUPDMDLogCallback, nullptr);
+            if (m_pupVideosPath[0] == '\0') strcpy(m_pupVideosPath, GetConfig()->GetPUPVideosPath());
+
+            // The PUP capture images load in the background, triggers start matching once they are in.
+            auto promise = std::make_shared<std::promise<PUPDMD::DMD*>>();
+            pupLoad = promise->get_future().share();
+            m_pAssetLoader->Submit(
+                [this, promise, pupVideosPath = std::string(m_pupVideosPath), romName = std::string(name),
+                 depth = m_pUpdateBufferQueue[bufferPositionMod]->depth]()
+                {
+                  SetThreadLogConfig(&m_pConfig);
+                  PUPDMD::DMD* pPUPDMD = new PUPDMD::DMD();
+                  pPUPDMD->SetLogCallback(PUPDMDLogCallback, nullptr);
 
-            if (!m_pPUPDMD->Load(m_pupVideosPath, m_romName, m_pUpdateBufferQueue[bufferPositionMod]->depth))
-            {
-              delete (m_pPUPDMD);
-              m_pPUPDMD = nullptr;
-            }
+                  if (!pPUPDMD->Load(pupVideosPath.c_str(), romName.c_str(), depth))
+                  {
+                    delete (pPUPDMD);
+                    pPUPDMD = nullptr;
+                  }
+                  promise->set_value(pPUPDMD);
+                });
           }
         }
       }
 
+      if (m_executionMode.load(std::memory_order_acquire) == ExecutionMode::Synchronous && pupLoad.valid())
+        pupLoad.wait();
+      if (IsLoaded(pupLoad))
+      {
+        m_pPUPDMD = pupLoad.get();
+        pupLoad = std::shared_future<PUPDMD::DMD*>();
+      }
+
       if (m_pPUPDMD && m_pUpdateBufferQueue[bufferPositionMod]->hasData &&
           m_pUpdateBufferQueue[bufferPositionMod]->mode == Mode::Data &&
           m_pUpdateBufferQueue[bufferPositionMod]->depth != 24)
@@ -3770,14 +4073,14 @@ void DMD::PupDMDThread()
           if (width == 128 && height == 32)
             memcpy(scaledBuffer, renderBuffer, 128 * 32);
           else if (width == 128 && height == 16)
-            FrameUtil::Helper::CenterIndexed(scaledBuffer, 128, 32, renderBuffer, 128, 16);
+            ScalePlan::Get(ScaleOp::CenterIndexed, 128, 16, 128, 32, 8)->Run(scaledBuffer, renderBuffer);
           else if (width == 192 && height == 64)
-            FrameUtil::Helper::ScaleDownPUP(scaledBuffer, 128, 32, renderBuffer, 192, 64);
+            ScalePlan::Get(ScaleOp::ScaleDownPUP, 192, 64, 128, 32, 8)->Run(scaledBuffer, renderBuffer);
           else
             return;
 
           uint16_t triggerID = 0;
-          if (Config::GetInstance()->IsPUPExactColorMatch())
+          if (GetConfig()->IsPUPExactColorMatch())
           {
             triggerID = m_pPUPDMD->MatchIndexed(scaledBuffer, width, height);
           }
@@ -3800,16 +4103,15 @@ void DMD::PupDMDThread()
         }
       }
     }
+    MarkConsumed(Consumer::PupDMD, bufferPosition);
   }
 }
 
 void DMD::HandleTrigger(uint16_t id)
 {
-  static Config* pConfig = Config::GetInstance();
-
   Log(DMDUtil_LogLevel_DEBUG, "HandleTrigger: id=D%d", id);
 
-  DMDUtil_PUPTriggerCallbackContext callbackContext = pConfig->GetPUPTriggerCallbackContext();
+  DMDUtil_PUPTriggerCallbackContext callbackContext = GetConfig()->GetPUPTriggerCallbackContext();
   if (callbackContext.callback != nullptr)
   {
     (*callbackContext.callback)(id, callbackContext.pUserData);
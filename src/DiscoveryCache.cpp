@@ -0,0 +1,78 @@
+#include "DiscoveryCache.h"
+
+#include <exception>
+#include <fstream>
+
+#include "DMDUtil/Logger.h"
+#include "ini.h"
+
+namespace DMDUtil
+{
+
+namespace
+{
+CachedDisplay ReadDisplay(const inih::INIReader& r, const std::string& section)
+{
+  CachedDisplay display;
+  display.device = r.Get<std::string>(section, "Device", "");
+  if (display.device.empty()) return display;
+
+  display.firmware = r.Get<std::string>(section, "Firmware", "");
+  display.width = r.Get<int>(section, "Width", 0);
+  display.height = r.Get<int>(section, "Height", 0);
+  display.isV2 = r.Get<bool>(section, "V2", false);
+  display.colorSwap = r.Get<bool>(section, "ColorSwap", false);
+  return display;
+}
+
+void WriteDisplay(std::ofstream& file, const char* section, const CachedDisplay& display)
+{
+  if (display.device.empty()) return;
+
+  file << "[" << section << "]\n";
+  file << "Device = " << display.device << "\n";
+  file << "Firmware = " << display.firmware << "\n";
+  file << "Width = " << display.width << "\n";
+  file << "Height = " << display.height << "\n";
+  file << "V2 = " << (display.isV2 ? 1 : 0) << "\n";
+  file << "ColorSwap = " << (display.colorSwap ? 1 : 0) << "\n\n";
+}
+}  // namespace
+
+DiscoveryCache LoadDiscoveryCache(const std::string& path)
+{
+  DiscoveryCache cache;
+  try
+  {
+    inih::INIReader r{path};
+    cache.zedmd = ReadDisplay(r, "ZeDMD");
+    cache.pixelcade = ReadDisplay(r, "Pixelcade");
+  }
+  catch (const std::exception&)
+  {
+    return DiscoveryCache();
+  }
+  return cache;
+}
+
+bool SaveDiscoveryCache(const std::string& path, const DiscoveryCache& cache)
+{
+  std::ofstream file(path, std::ios::trunc);
+  file << "# Displays found by libdmdutil, tried first on the next start. Delete this file to search all ports.\n\n";
+  WriteDisplay(file, "ZeDMD", cache.zedmd);
+  WriteDisplay(file, "Pixelcade", cache.pixelcade);
+  return static_cast<bool>(file);
+}
+
+void LogDisplayChange(const char* pName, const CachedDisplay& cached, const CachedDisplay& found)
+{
+  if (cached.device.empty() || found.device.empty() || found == cached) return;
+
+  Log(DMDUtil_LogLevel_INFO,
+      "%s: Hardware changed since the last search, %s %dx%d firmware %s%s%s, was %s %dx%d firmware %s%s%s", pName,
+      found.device.c_str(), found.width, found.height, found.firmware.c_str(), found.isV2 ? " V2" : "",
+      found.colorSwap ? " color swap" : "", cached.device.c_str(), cached.width, cached.height,
+      cached.firmware.c_str(), cached.isV2 ? " V2" : "", cached.colorSwap ? " color swap" : "");
+}
+
+}  // namespace DMDUtil
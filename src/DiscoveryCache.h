@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+
+namespace DMDUtil
+{
+
+// A serial display found by DMD::FindDisplays(). An empty device means it wasn't found.
+struct CachedDisplay
+{
+  std::string device;
+  std::string firmware;
+  int width = 0;
+  int height = 0;
+  bool isV2 = false;       // Pixelcade only.
+  bool colorSwap = false;  // Pixelcade only.
+
+  bool operator==(const CachedDisplay& other) const = default;
+};
+
+// The serial displays of the last search. Cabinet hardware rarely changes, so the next search tries these ports
+// first and only scans all ports if the display doesn't answer there anymore. PIN2DMD is found by its USB IDs
+// without probing anything, so it isn't cached.
+struct DiscoveryCache
+{
+  CachedDisplay zedmd;
+  CachedDisplay pixelcade;
+
+  bool operator==(const DiscoveryCache& other) const = default;
+};
+
+// A missing or unreadable file gives an empty cache.
+DiscoveryCache LoadDiscoveryCache(const std::string& path);
+bool SaveDiscoveryCache(const std::string& path, const DiscoveryCache& cache);
+// Logs a display that answers the handshake with another size, firmware or mode than at the last search, which
+// means the panel was swapped or updated.
+void LogDisplayChange(const char* pName, const CachedDisplay& cached, const CachedDisplay& found);
+
+}  // namespace DMDUtil
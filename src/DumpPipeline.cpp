@@ -0,0 +1,650 @@
+#include "DumpPipeline.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+#include "DMDUtil/Config.h"
+#include "DMDUtil/Logger.h"
+#include "komihash/komihash.h"
+#include "miniz/miniz.h"
+
+namespace DMDUtil
+{
+
+namespace
+{
+constexpr size_t kMaxFramePixels = 256u * 64u;
+
+FILE* OpenDumpFile(const std::string& path, const char* mode)
+{
+  if (path.empty()) return nullptr;
+  FILE* f = fopen(path.c_str(), mode);
+  if (!f)
+  {
+    Log(DMDUtil_LogLevel_ERROR, "Failed to open dump file %s", path.c_str());
+  }
+  return f;
+}
+}  // namespace
+
+bool ZipDumpFile(const std::string& sourcePath)
+{
+  if (sourcePath.empty())
+  {
+    return false;
+  }
+
+  std::filesystem::path srcPath(sourcePath);
+  std::string zipPath = sourcePath + ".zip";
+  std::string entryName = srcPath.filename().string();
+
+  mz_zip_archive zip;
+  mz_zip_zero_struct(&zip);
+  if (!mz_zip_writer_init_file(&zip, zipPath.c_str(), 0))
+  {
+    return false;
+  }
+
+  bool ok = mz_zip_writer_add_file(&zip, entryName.c_str(), sourcePath.c_str(), nullptr, 0, MZ_BEST_COMPRESSION);
+  ok = ok && mz_zip_writer_finalize_archive(&zip);
+  mz_zip_writer_end(&zip);
+
+  if (!ok)
+  {
+    std::error_code ec;
+    std::filesystem::remove(zipPath, ec);
+    return false;
+  }
+
+  std::error_code ec;
+  std::filesystem::remove(sourcePath, ec);
+  return true;
+}
+
+DumpRotationPolicy DumpRotationPolicy::FromConfig(const Config& config)
+{
+  DumpRotationPolicy rotation;
+  rotation.maxBytes = (uint64_t)std::max(config.GetDumpRotateMaxSize(), 0) * 1024 * 1024;
+  rotation.maxFrames = (uint32_t)std::max(config.GetDumpRotateMaxFrames(), 0);
+  rotation.maxDurationMs = (uint32_t)std::max(config.GetDumpRotateMaxDuration(), 0) * 1000;
+  rotation.idleMs = (uint32_t)std::max(config.GetDumpRotateIdle(), 0) * 1000;
+  return rotation;
+}
+
+DumpArchiver::DumpArchiver(uint64_t budgetBytes) : m_budgetBytes(budgetBytes)
+{
+  m_thread = std::thread(&DumpArchiver::Run, this);
+}
+
+DumpArchiver::~DumpArchiver()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_cv.notify_all();
+  // Run() drains the remaining jobs before it returns.
+  if (m_thread.joinable()) m_thread.join();
+}
+
+void DumpArchiver::Submit(const std::string& path, bool zip)
+{
+  if (path.empty()) return;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_jobs.push_back({path, zip});
+  }
+  m_cv.notify_one();
+}
+
+void DumpArchiver::Run()
+{
+  while (true)
+  {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cv.wait(lock, [&]() { return m_stop || !m_jobs.empty(); });
+      if (m_jobs.empty()) return;
+      job = std::move(m_jobs.front());
+      m_jobs.pop_front();
+    }
+
+    std::string path = job.path;
+    if (job.zip)
+    {
+      if (ZipDumpFile(path))
+        path += ".zip";
+      else
+        Log(DMDUtil_LogLevel_ERROR, "Failed to zip dump file %s", job.path.c_str());
+    }
+
+    if (m_budgetBytes > 0)
+    {
+      std::error_code ec;
+      uint64_t size = std::filesystem::file_size(path, ec);
+      if (!ec)
+      {
+        m_segments.emplace_back(path, size);
+        m_totalBytes += size;
+        Prune();
+      }
+    }
+  }
+}
+
+void DumpArchiver::Prune()
+{
+  // The newest segment is always kept, even if it exceeds the budget on its own.
+  while (m_totalBytes > m_budgetBytes && m_segments.size() > 1)
+  {
+    const auto& oldest = m_segments.front();
+    std::error_code ec;
+    std::filesystem::remove(oldest.first, ec);
+    if (ec)
+      Log(DMDUtil_LogLevel_ERROR, "Failed to prune dump file %s", oldest.first.c_str());
+    else
+      Log(DMDUtil_LogLevel_INFO, "Pruned dump file %s", oldest.first.c_str());
+    m_totalBytes -= oldest.second;
+    m_segments.pop_front();
+  }
+}
+
+void DumpEncoder::SetRotation(const DumpRotationPolicy& rotation, DumpArchiver* pArchiver)
+{
+  m_rotation = rotation;
+  m_pArchiver = pArchiver;
+}
+
+void DumpEncoder::CheckIdle()
+{
+  if (!m_pFile || m_rotation.idleMs == 0) return;
+  if (std::chrono::steady_clock::now() - m_lastWrite < std::chrono::milliseconds(m_rotation.idleMs)) return;
+
+  CloseFile();
+  m_rotatePending = true;
+}
+
+void DumpEncoder::PrepareFile(const std::string& base, const char* extension)
+{
+  CloseFile();
+  m_rotatePending = false;
+  m_segmentBase = base;
+  m_segmentExtension = extension;
+  m_segmentIndex = 0;
+  m_path = base + extension;
+  m_pendingOpen = true;
+}
+
+bool DumpEncoder::OpenFile()
+{
+  m_pendingOpen = false;
+  m_pFile = OpenDumpFile(m_path, m_openMode);
+  if (!m_pFile)
+  {
+    m_path.clear();
+    return false;
+  }
+
+  // Append mode continues an existing file, count what is already there.
+  long offset = ftell(m_pFile);
+  m_segmentBytes = offset > 0 ? (uint64_t)offset : 0;
+  m_segmentFrames = 0;
+  m_segmentStart = m_lastWrite = std::chrono::steady_clock::now();
+  return true;
+}
+
+void DumpEncoder::EndDump()
+{
+  m_pendingOpen = false;
+  m_rotatePending = false;
+  CloseFile();
+}
+
+void DumpEncoder::CloseFile()
+{
+  if (!m_pFile) return;
+  fclose(m_pFile);
+  m_pFile = nullptr;
+  if (m_pArchiver)
+    m_pArchiver->Submit(m_path, m_dumpZip);
+  else if (m_dumpZip)
+    ZipDumpFile(m_path);
+  m_path.clear();
+}
+
+bool DumpEncoder::RotationDue() const
+{
+  if (!m_rotation.IsEnabled()) return false;
+  if (m_rotation.maxBytes > 0 && m_segmentBytes >= m_rotation.maxBytes) return true;
+  if (m_rotation.maxFrames > 0 && m_segmentFrames >= m_rotation.maxFrames) return true;
+  if (m_rotation.maxDurationMs == 0 && m_rotation.idleMs == 0) return false;
+
+  const auto now = std::chrono::steady_clock::now();
+  if (m_rotation.maxDurationMs > 0 && now - m_segmentStart >= std::chrono::milliseconds(m_rotation.maxDurationMs))
+    return true;
+  return m_rotation.idleMs > 0 && now - m_lastWrite >= std::chrono::milliseconds(m_rotation.idleMs);
+}
+
+void DumpEncoder::OpenNextSegment()
+{
+  // Skip segments left over from an earlier session, so they are neither overwritten nor appended to.
+  std::error_code ec;
+  do
+  {
+    char index[16];
+    snprintf(index, sizeof(index), ".%03u", ++m_segmentIndex);
+    m_path = m_segmentBase + index + m_segmentExtension;
+  } while (std::filesystem::exists(m_path, ec) || std::filesystem::exists(m_path + ".zip", ec));
+
+  OpenFile();
+}
+
+FILE* DumpEncoder::SegmentFile()
+{
+  if (m_rotatePending || (m_pFile && RotationDue()))
+  {
+    CloseFile();
+    m_rotatePending = false;
+    OpenNextSegment();
+  }
+  return m_pFile;
+}
+
+void DumpEncoder::CountWritten(size_t bytes)
+{
+  m_segmentBytes += bytes;
+  m_segmentFrames++;
+  if (m_rotation.maxDurationMs > 0 || m_rotation.idleMs > 0) m_lastWrite = std::chrono::steady_clock::now();
+}
+
+std::unique_ptr<DumpEncoder> DumpEncoder::Create(uint8_t format, const Config& config)
+{
+  switch (format)
+  {
+    case DMDUTIL_DUMP_FORMAT_TXT:
+      return std::make_unique<TxtDumpEncoder>(config.IsDumpNotColorizedFrames(), config.IsFilterTransitionalFrames(),
+                                              config.IsDumpZip());
+    case DMDUTIL_DUMP_FORMAT_RAW:
+      return std::make_unique<RawDumpEncoder>();
+    case DMDUTIL_DUMP_FORMAT_RGB565:
+      return std::make_unique<Rgb565DumpEncoder>(config.IsDumpZip());
+    case DMDUTIL_DUMP_FORMAT_RGB888:
+      return std::make_unique<Rgb888DumpEncoder>(config.IsDumpZip());
+    default:
+      return nullptr;
+  }
+}
+
+TxtDumpEncoder::TxtDumpEncoder(bool dumpNotColorizedFrames, bool filterTransitionalFrames, bool dumpZip)
+    : m_dumpNotColorizedFrames(dumpNotColorizedFrames), m_filterTransitionalFrames(filterTransitionalFrames)
+{
+  m_dumpZip = dumpZip;
+  for (auto& buffer : m_renderBuffer) buffer.assign(kMaxFramePixels, 0);
+}
+
+bool TxtDumpEncoder::Accepts(const DumpFrame& frame) const
+{
+  if (!frame.isIndexed) return false;
+  const DMD::Mode mode = frame.pUpdate->mode;
+  return (mode == DMD::Mode::Data && !m_dumpNotColorizedFrames) ||
+         (mode == DMD::Mode::NotColorized && m_dumpNotColorizedFrames);
+}
+
+void TxtDumpEncoder::Reset(const char* romName, const std::string& basePath)
+{
+  // Transitional frames are detected per ROM.
+  m_seenHashes.clear();
+  if (romName && romName[0] != '\0' && !basePath.empty())
+    PrepareFile(basePath, ".txt");
+  else
+    Close();
+}
+
+void TxtDumpEncoder::Write(const DumpFrame& frame)
+{
+  const DMD::Update* pUpdate = frame.pUpdate;
+  bool update = false;
+  if (m_pendingOpen)
+  {
+    OpenFile();
+    update = true;
+    memset(m_renderBuffer[0].data(), 0, kMaxFramePixels);
+    memset(m_renderBuffer[1].data(), 0, kMaxFramePixels);
+    m_passed[0] = m_passed[1] = 0;
+  }
+
+  uint8_t* renderBuffer[3] = {m_renderBuffer[0].data(), m_renderBuffer[1].data(), m_renderBuffer[2].data()};
+  int length = (int)pUpdate->width * pUpdate->height;
+  if (length > (int)kMaxFramePixels) return;
+  if (!update && memcmp(renderBuffer[1], pUpdate->data, length) == 0) return;
+
+  m_passed[2] = frame.timestampMs;
+  memcpy(renderBuffer[2], pUpdate->data, length);
+
+  if (m_filterTransitionalFrames && pUpdate->depth == 2 &&
+      (m_passed[2] - m_passed[1]) < DMDUTIL_MAX_TRANSITIONAL_FRAME_DURATION)
+  {
+    int i = 0;
+    while (i < length && ((renderBuffer[0][i] == 2) ||
+                          ((renderBuffer[0][i] == 3) || (renderBuffer[2][i] > 1)) == (renderBuffer[1][i] > 0)))
+    {
+      i++;
+    }
+    if (i == length)
+    {
+      Log(DMDUtil_LogLevel_DEBUG, "DumpDMDTxt: skip transitional frame");
+
+      // renderBuffer[1] is a transitional frame, delete it.
+      memcpy(renderBuffer[1], renderBuffer[2], length);
+      m_passed[1] += m_passed[2];
+      return;
+    }
+  }
+
+  if (HasFile() && m_passed[0] > 0)
+  {
+    bool dump = true;
+
+    if (m_dumpNotColorizedFrames)
+    {
+      uint64_t hash = komihash(renderBuffer[0], length, 0);
+      if (!m_seenHashes.insert(hash).second)
+      {
+        Log(DMDUtil_LogLevel_DEBUG, "DumpDMDTxt: skip duplicate frame");
+        dump = false;
+      }
+    }
+
+    FILE* f = dump ? SegmentFile() : nullptr;
+    if (f)
+    {
+      fprintf(f, "0x%08x\r\n", m_passed[0]);
+      for (int y = 0; y < pUpdate->height; y++)
+      {
+        for (int x = 0; x < pUpdate->width; x++)
+        {
+          fprintf(f, "%x", renderBuffer[0][y * pUpdate->width + x]);
+        }
+        fprintf(f, "\r\n");
+      }
+      fprintf(f, "\r\n");
+      CountWritten(12 + (size_t)pUpdate->height * (pUpdate->width + 2) + 2);
+    }
+  }
+
+  memcpy(renderBuffer[0], renderBuffer[1], length);
+  m_passed[0] = m_passed[1];
+  memcpy(renderBuffer[1], renderBuffer[2], length);
+  m_passed[1] = m_passed[2];
+}
+
+void TxtDumpEncoder::Close()
+{
+  EndDump();
+}
+
+bool RawDumpEncoder::Accepts(const DumpFrame& frame) const
+{
+  return frame.pUpdate->hasData || frame.pUpdate->hasSegData;
+}
+
+void RawDumpEncoder::Reset(const char* romName, const std::string& basePath)
+{
+  (void)basePath;
+  if (romName && romName[0] != '\0')
+    PrepareFile(romName, ".raw");
+  else
+    Close();
+}
+
+void RawDumpEncoder::Write(const DumpFrame& frame)
+{
+  if (m_pendingOpen) OpenFile();
+  FILE* f = SegmentFile();
+  if (!f) return;
+
+  uint32_t current = frame.timestampMs;
+  fwrite(&current, 4, 1, f);
+
+  uint32_t size = sizeof(DMD::Update);
+  fwrite(&size, 4, 1, f);
+
+  fwrite(frame.pUpdate, 1, size, f);
+  CountWritten(8 + size);
+}
+
+void RawDumpEncoder::Close()
+{
+  EndDump();
+}
+
+Rgb565DumpEncoder::Rgb565DumpEncoder(bool dumpZip)
+{
+  m_dumpZip = dumpZip;
+  for (auto& buffer : m_renderBuffer) buffer.assign(kMaxFramePixels, 0);
+}
+
+void Rgb565DumpEncoder::Reset(const char* romName, const std::string& basePath)
+{
+  if (romName && romName[0] != '\0' && !basePath.empty())
+    PrepareFile(basePath, ".565.txt");
+  else
+    Close();
+}
+
+void Rgb565DumpEncoder::Write(const DumpFrame& frame)
+{
+  bool updateFrame = false;
+  if (m_pendingOpen)
+  {
+    OpenFile();
+    updateFrame = true;
+    for (auto& buffer : m_renderBuffer) std::fill(buffer.begin(), buffer.end(), 0);
+    memset(m_frameWidths, 0, sizeof(m_frameWidths));
+    memset(m_frameHeights, 0, sizeof(m_frameHeights));
+    m_passed[0] = m_passed[1] = 0;
+  }
+
+  uint16_t width = frame.pUpdate->width;
+  uint16_t height = frame.pUpdate->height;
+  size_t length = (size_t)width * height;
+  size_t frameBytes = length * sizeof(uint16_t);
+  if (length > kMaxFramePixels || !frame.pRgb565) return;
+
+  if (width != m_frameWidths[1] || height != m_frameHeights[1])
+  {
+    updateFrame = true;
+  }
+
+  if (!updateFrame && memcmp(m_renderBuffer[1].data(), frame.pRgb565, frameBytes) == 0) return;
+
+  m_passed[2] = frame.timestampMs;
+  m_frameWidths[2] = width;
+  m_frameHeights[2] = height;
+
+  FILE* f = (HasFile() && m_passed[0] > 0 && m_frameWidths[0] > 0 && m_frameHeights[0] > 0) ? SegmentFile() : nullptr;
+  if (f)
+  {
+    fprintf(f, "0x%08x\r\n", m_passed[0]);
+    uint32_t rowWidth = m_frameWidths[0];
+    uint32_t rowHeight = m_frameHeights[0];
+    const uint16_t* pFrame = m_renderBuffer[0].data();
+    for (uint32_t y = 0; y < rowHeight; y++)
+    {
+      for (uint32_t x = 0; x < rowWidth; x++)
+      {
+        fprintf(f, "%04x", pFrame[y * rowWidth + x]);
+      }
+      fprintf(f, "\r\n");
+    }
+    fprintf(f, "\r\n");
+    CountWritten(12 + (size_t)rowHeight * (rowWidth * 4 + 2) + 2);
+  }
+
+  // Rotate the triple buffer instead of copying whole frames around.
+  std::swap(m_renderBuffer[0], m_renderBuffer[1]);
+  m_passed[0] = m_passed[1];
+  m_frameWidths[0] = m_frameWidths[1];
+  m_frameHeights[0] = m_frameHeights[1];
+
+  memcpy(m_renderBuffer[1].data(), frame.pRgb565, frameBytes);
+  m_passed[1] = m_passed[2];
+  m_frameWidths[1] = m_frameWidths[2];
+  m_frameHeights[1] = m_frameHeights[2];
+}
+
+void Rgb565DumpEncoder::Close()
+{
+  EndDump();
+}
+
+Rgb888DumpEncoder::Rgb888DumpEncoder(bool dumpZip)
+{
+  m_dumpZip = dumpZip;
+  for (auto& buffer : m_renderBuffer) buffer.assign(kMaxFramePixels * 3, 0);
+}
+
+void Rgb888DumpEncoder::Reset(const char* romName, const std::string& basePath)
+{
+  if (romName && romName[0] != '\0' && !basePath.empty())
+    PrepareFile(basePath, ".888.txt");
+  else
+    Close();
+}
+
+void Rgb888DumpEncoder::Write(const DumpFrame& frame)
+{
+  bool updateFrame = false;
+  if (m_pendingOpen)
+  {
+    OpenFile();
+    updateFrame = true;
+    for (auto& buffer : m_renderBuffer) std::fill(buffer.begin(), buffer.end(), 0);
+    memset(m_frameWidths, 0, sizeof(m_frameWidths));
+    memset(m_frameHeights, 0, sizeof(m_frameHeights));
+    m_passed[0] = m_passed[1] = 0;
+  }
+
+  uint16_t width = frame.pUpdate->width;
+  uint16_t height = frame.pUpdate->height;
+  size_t length = (size_t)width * height;
+  size_t frameBytes = length * 3;
+  if (length > kMaxFramePixels || !frame.pRgb888) return;
+
+  if (width != m_frameWidths[1] || height != m_frameHeights[1])
+  {
+    updateFrame = true;
+  }
+
+  if (!updateFrame && memcmp(m_renderBuffer[1].data(), frame.pRgb888, frameBytes) == 0) return;
+
+  m_passed[2] = frame.timestampMs;
+  m_frameWidths[2] = width;
+  m_frameHeights[2] = height;
+
+  FILE* f = (HasFile() && m_passed[0] > 0 && m_frameWidths[0] > 0 && m_frameHeights[0] > 0) ? SegmentFile() : nullptr;
+  if (f)
+  {
+    fprintf(f, "0x%08x\r\n", m_passed[0]);
+    uint32_t rowWidth = m_frameWidths[0];
+    uint32_t rowHeight = m_frameHeights[0];
+    const uint8_t* pFrame = m_renderBuffer[0].data();
+    for (uint32_t y = 0; y < rowHeight; y++)
+    {
+      for (uint32_t x = 0; x < rowWidth; x++)
+      {
+        int pos = (int)(y * rowWidth + x) * 3;
+        fprintf(f, "%02x%02x%02x", pFrame[pos], pFrame[pos + 1], pFrame[pos + 2]);
+      }
+      fprintf(f, "\r\n");
+    }
+    fprintf(f, "\r\n");
+    CountWritten(12 + (size_t)rowHeight * (rowWidth * 6 + 2) + 2);
+  }
+
+  std::swap(m_renderBuffer[0], m_renderBuffer[1]);
+  m_passed[0] = m_passed[1];
+  m_frameWidths[0] = m_frameWidths[1];
+  m_frameHeights[0] = m_frameHeights[1];
+
+  memcpy(m_renderBuffer[1].data(), frame.pRgb888, frameBytes);
+  m_passed[1] = m_passed[2];
+  m_frameWidths[1] = m_frameWidths[2];
+  m_frameHeights[1] = m_frameHeights[2];
+}
+
+void Rgb888DumpEncoder::Close()
+{
+  EndDump();
+}
+
+DumpWorkerPool::DumpWorkerPool(size_t threadCount)
+{
+  for (size_t i = 0; i < threadCount; i++) m_threads.emplace_back(&DumpWorkerPool::Run, this);
+}
+
+DumpWorkerPool::~DumpWorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_taskCv.notify_all();
+  for (auto& thread : m_threads)
+  {
+    if (thread.joinable()) thread.join();
+  }
+}
+
+void DumpWorkerPool::Write(const std::vector<DumpEncoder*>& encoders, const DumpFrame& frame)
+{
+  if (encoders.empty()) return;
+
+  if (encoders.size() == 1 || m_threads.empty())
+  {
+    for (DumpEncoder* pEncoder : encoders) pEncoder->Write(frame);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pFrame = &frame;
+    for (size_t i = 1; i < encoders.size(); i++) m_tasks.push_back(encoders[i]);
+    m_pending = encoders.size() - 1;
+  }
+  m_taskCv.notify_all();
+
+  // The calling thread takes the first encoder itself.
+  encoders[0]->Write(frame);
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_doneCv.wait(lock, [&]() { return m_pending == 0; });
+  m_pFrame = nullptr;
+}
+
+void DumpWorkerPool::Run()
+{
+  while (true)
+  {
+    DumpEncoder* pEncoder = nullptr;
+    const DumpFrame* pFrame = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_taskCv.wait(lock, [&]() { return m_stop || !m_tasks.empty(); });
+      if (m_tasks.empty()) return;
+      pEncoder = m_tasks.front();
+      m_tasks.pop_front();
+      pFrame = m_pFrame;
+    }
+
+    pEncoder->Write(*pFrame);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (--m_pending == 0) m_doneCv.notify_one();
+  }
+}
+
+}  // namespace DMDUtil
@@ -0,0 +1,228 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "DMDUtil/DMD.h"
+
+#define DMDUTIL_DUMP_FORMAT_TXT 0x01
+#define DMDUTIL_DUMP_FORMAT_RAW 0x02
+#define DMDUTIL_DUMP_FORMAT_RGB565 0x04
+#define DMDUTIL_DUMP_FORMAT_RGB888 0x08
+#define DMDUTIL_DUMP_FORMAT_COUNT 4
+#define DMDUTIL_DUMP_MAX_WORKERS 3
+
+namespace DMDUtil
+{
+
+// A single ring slot as prepared by the dump stage. The shared color representations are filled
+// once per slot, so the encoders never convert the same palette or RGB data twice.
+struct DumpFrame
+{
+  const DMD::Update* pUpdate = nullptr;
+  uint32_t timestampMs = 0;
+  bool isIndexed = false;  // 2 or 4 bit Data or NotColorized frame.
+  bool isColor = false;    // pRgb565 and pRgb888 are valid for the encoders that asked for them.
+  const uint16_t* pRgb565 = nullptr;
+  const uint8_t* pRgb888 = nullptr;
+};
+
+// Limits after which an encoder closes its file and continues in a new segment. 0 disables a limit.
+struct DumpRotationPolicy
+{
+  uint64_t maxBytes = 0;
+  uint32_t maxFrames = 0;
+  uint32_t maxDurationMs = 0;
+  uint32_t idleMs = 0;
+
+  static DumpRotationPolicy FromConfig(const Config& config);
+  bool IsEnabled() const { return maxBytes > 0 || maxFrames > 0 || maxDurationMs > 0 || idleMs > 0; }
+};
+
+// Takes closed dump segments off the dump stage: zip compression and pruning of the oldest segments
+// once their total size exceeds the budget run on an own thread, so rotation never blocks the ring.
+class DumpArchiver
+{
+ public:
+  explicit DumpArchiver(uint64_t budgetBytes);
+  ~DumpArchiver();
+
+  void Submit(const std::string& path, bool zip);
+
+ private:
+  struct Job
+  {
+    std::string path;
+    bool zip;
+  };
+
+  void Run();
+  void Prune();
+
+  uint64_t m_budgetBytes;
+  uint64_t m_totalBytes = 0;
+  std::deque<Job> m_jobs;
+  std::deque<std::pair<std::string, uint64_t>> m_segments;
+  bool m_stop = false;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::thread m_thread;
+};
+
+class DumpEncoder
+{
+ public:
+  virtual ~DumpEncoder() {}
+
+  static std::unique_ptr<DumpEncoder> Create(uint8_t format, const Config& config);
+
+  virtual bool Accepts(const DumpFrame& frame) const = 0;
+  // Called on ROM change. The file is opened lazily on the first accepted frame.
+  virtual void Reset(const char* romName, const std::string& basePath) = 0;
+  virtual void Write(const DumpFrame& frame) = 0;
+  virtual void Close() = 0;
+  void Flush()
+  {
+    if (m_pFile) fflush(m_pFile);
+  }
+
+  void SetRotation(const DumpRotationPolicy& rotation, DumpArchiver* pArchiver);
+  // Ends the current segment if nothing was written within the idle limit.
+  void CheckIdle();
+
+ protected:
+  // Closes the current file and prepares <base><extension> as the first segment of a new dump.
+  void PrepareFile(const std::string& base, const char* extension);
+  bool OpenFile();
+  void CloseFile();
+  // Closes the file for good, no further segment is started.
+  void EndDump();
+  bool HasFile() const { return m_pFile || m_rotatePending; }
+  // Returns the file the next frame goes to, after starting a new segment if a limit is reached.
+  FILE* SegmentFile();
+  void CountWritten(size_t bytes);
+
+  FILE* m_pFile = nullptr;
+  std::string m_path;
+  bool m_pendingOpen = false;
+  bool m_dumpZip = false;
+  const char* m_openMode = "w";
+
+ private:
+  bool RotationDue() const;
+  void OpenNextSegment();
+
+  DumpRotationPolicy m_rotation;
+  DumpArchiver* m_pArchiver = nullptr;
+  std::string m_segmentBase;
+  std::string m_segmentExtension;
+  uint32_t m_segmentIndex = 0;
+  uint64_t m_segmentBytes = 0;
+  uint32_t m_segmentFrames = 0;
+  std::chrono::steady_clock::time_point m_segmentStart;
+  std::chrono::steady_clock::time_point m_lastWrite;
+  bool m_rotatePending = false;
+};
+
+class TxtDumpEncoder : public DumpEncoder
+{
+ public:
+  TxtDumpEncoder(bool dumpNotColorizedFrames, bool filterTransitionalFrames, bool dumpZip);
+  ~TxtDumpEncoder() override { Close(); }
+
+  bool Accepts(const DumpFrame& frame) const override;
+  void Reset(const char* romName, const std::string& basePath) override;
+  void Write(const DumpFrame& frame) override;
+  void Close() override;
+
+ private:
+  bool m_dumpNotColorizedFrames;
+  bool m_filterTransitionalFrames;
+  std::vector<uint8_t> m_renderBuffer[3];
+  uint32_t m_passed[3] = {0};
+  std::unordered_set<uint64_t> m_seenHashes;
+};
+
+class RawDumpEncoder : public DumpEncoder
+{
+ public:
+  RawDumpEncoder() { m_openMode = "ab"; }
+  ~RawDumpEncoder() override { Close(); }
+
+  bool Accepts(const DumpFrame& frame) const override;
+  void Reset(const char* romName, const std::string& basePath) override;
+  void Write(const DumpFrame& frame) override;
+  void Close() override;
+};
+
+class Rgb565DumpEncoder : public DumpEncoder
+{
+ public:
+  explicit Rgb565DumpEncoder(bool dumpZip);
+  ~Rgb565DumpEncoder() override { Close(); }
+
+  bool Accepts(const DumpFrame& frame) const override { return frame.isColor; }
+  void Reset(const char* romName, const std::string& basePath) override;
+  void Write(const DumpFrame& frame) override;
+  void Close() override;
+
+ private:
+  std::vector<uint16_t> m_renderBuffer[3];
+  uint16_t m_frameWidths[3] = {0};
+  uint16_t m_frameHeights[3] = {0};
+  uint32_t m_passed[3] = {0};
+};
+
+class Rgb888DumpEncoder : public DumpEncoder
+{
+ public:
+  explicit Rgb888DumpEncoder(bool dumpZip);
+  ~Rgb888DumpEncoder() override { Close(); }
+
+  bool Accepts(const DumpFrame& frame) const override { return frame.isColor; }
+  void Reset(const char* romName, const std::string& basePath) override;
+  void Write(const DumpFrame& frame) override;
+  void Close() override;
+
+ private:
+  std::vector<uint8_t> m_renderBuffer[3];
+  uint16_t m_frameWidths[3] = {0};
+  uint16_t m_frameHeights[3] = {0};
+  uint32_t m_passed[3] = {0};
+};
+
+// Small fixed pool that runs the encoders of one frame in parallel. Write() returns once every
+// encoder is done, so each file still receives its frames in ring order.
+class DumpWorkerPool
+{
+ public:
+  explicit DumpWorkerPool(size_t threadCount);
+  ~DumpWorkerPool();
+
+  void Write(const std::vector<DumpEncoder*>& encoders, const DumpFrame& frame);
+
+ private:
+  void Run();
+
+  std::vector<std::thread> m_threads;
+  std::deque<DumpEncoder*> m_tasks;
+  const DumpFrame* m_pFrame = nullptr;
+  size_t m_pending = 0;
+  bool m_stop = false;
+  std::mutex m_mutex;
+  std::condition_variable m_taskCv;
+  std::condition_variable m_doneCv;
+};
+
+bool ZipDumpFile(const std::string& sourcePath);
+
+}  // namespace DMDUtil
@@ -0,0 +1,62 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+
+#include "komihash/komihash.h"
+
+namespace DMDUtil
+{
+
+void FramePacer::RecordCost(uint64_t us, uint64_t count)
+{
+  if (count == 0) return;
+
+  const double sample = std::min((double)us / count, kMaxCostUs);
+  m_cost = m_hasCost ? m_cost + kWeight * (sample - m_cost) : sample;
+  m_hasCost = true;
+  m_costUs.store((uint32_t)m_cost, std::memory_order_relaxed);
+}
+
+void FramePacer::RecordCumulativeCost(uint64_t totalUs, uint64_t count)
+{
+  if (count > m_lastCount) RecordCost(totalUs - m_lastTotalUs, count - m_lastCount);
+  m_lastTotalUs = totalUs;
+  m_lastCount = count;
+}
+
+bool FramePacer::IsNewContent(const void* pFrame, size_t size)
+{
+  const uint64_t hash = komihash(pFrame, size, size);
+  if (m_hasHash && hash == m_lastHash) return false;
+
+  m_lastHash = hash;
+  m_hasHash = true;
+  return true;
+}
+
+void FramePacer::RecordSend(Clock::time_point now)
+{
+  if (m_lastSend != Clock::time_point{})
+  {
+    const double interval = (double)std::chrono::duration_cast<std::chrono::microseconds>(now - m_lastSend).count();
+    m_interval = m_interval > 0 ? m_interval + kWeight * (interval - m_interval) : interval;
+    m_intervalUs.store((uint32_t)std::min(m_interval, (double)UINT32_MAX), std::memory_order_relaxed);
+  }
+  m_lastSend = now;
+  m_nextSend = now + std::chrono::microseconds((int64_t)m_cost);
+  m_lastSendUs.store(std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count(),
+                     std::memory_order_relaxed);
+}
+
+float FramePacer::GetFps() const
+{
+  const int64_t lastSendUs = m_lastSendUs.load(std::memory_order_relaxed);
+  const uint32_t intervalUs = m_intervalUs.load(std::memory_order_relaxed);
+  if (lastSendUs == 0 || intervalUs == 0) return 0.0f;
+
+  const int64_t sinceLastSendUs =
+      std::chrono::duration_cast<std::chrono::microseconds>(Clock::now().time_since_epoch()).count() - lastSendUs;
+  return 1000000.0f / (float)std::max<int64_t>(intervalUs, sinceLastSendUs);
+}
+
+}  // namespace DMDUtil
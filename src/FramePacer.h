@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace DMDUtil
+{
+
+// Paces the frames of one device to the rate the device takes them. The cost of a frame is an exponentially
+// weighted moving average of the measured write or transfer times, a frame is sent at most once per cost
+// and the frames queued in between are superseded by the newest one. A frame equal to the last one sent
+// is not sent at all, so it neither delays a changed frame nor lowers the measured cost.
+class FramePacer
+{
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // Time spent on count frames.
+  void RecordCost(uint64_t us, uint64_t count = 1);
+  // Takes the cumulative time and frame counters of a device and records their growth since the last call.
+  void RecordCumulativeCost(uint64_t totalUs, uint64_t count);
+  // Returns false if the frame is the one sent last.
+  bool IsNewContent(const void* pFrame, size_t size);
+  void RecordSend(Clock::time_point now);
+
+  Clock::time_point GetNextSend() const { return m_nextSend; }
+  uint32_t GetCostUs() const { return m_costUs.load(std::memory_order_relaxed); }
+  // Frames per second over the recent send intervals, falling towards 0 while nothing is sent.
+  float GetFps() const;
+
+ private:
+  // Weight of a new sample, the average follows a changed cost within about 8 frames.
+  static constexpr double kWeight = 0.125;
+  // A device that timed out is still given the newest frame once per second.
+  static constexpr double kMaxCostUs = 1000000.0;
+
+  double m_cost = 0;
+  bool m_hasCost = false;
+  double m_interval = 0;
+  Clock::time_point m_lastSend;
+  Clock::time_point m_nextSend;
+  uint64_t m_lastTotalUs = 0;
+  uint64_t m_lastCount = 0;
+  uint64_t m_lastHash = 0;
+  bool m_hasHash = false;
+
+  // Read by DMD::GetSinkStats() from other threads.
+  std::atomic<uint32_t> m_costUs{0};
+  std::atomic<uint32_t> m_intervalUs{0};
+  std::atomic<int64_t> m_lastSendUs{0};
+};
+
+}  // namespace DMDUtil
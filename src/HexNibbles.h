@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// clang-format off
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DMDUTIL_HEX_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define DMDUTIL_HEX_NEON
+#endif
+// clang-format on
+
+namespace DMDUtil
+{
+
+inline int HexToInt(char ch)
+{
+  if (ch >= '0' && ch <= '9') return ch - '0';
+  if (ch >= 'a' && ch <= 'f') return 10 + (ch - 'a');
+  if (ch >= 'A' && ch <= 'F') return 10 + (ch - 'A');
+  return -1;
+}
+
+// The reference for DecodeHexNibbles(), which decodes the tail of every line with it.
+inline bool DecodeHexNibblesScalar(const char* src, size_t count, uint8_t* dst)
+{
+  for (size_t i = 0; i < count; ++i)
+  {
+    int value = HexToInt(src[i]);
+    if (value < 0) return false;
+    dst[i] = (uint8_t)value;
+  }
+  return true;
+}
+
+// Decodes count hex digits into nibble values. Returns false on any non-hex character.
+inline bool DecodeHexNibbles(const char* src, size_t count, uint8_t* dst)
+{
+  size_t i = 0;
+#if defined(DMDUTIL_HEX_SSE2)
+  const __m128i zero = _mm_set1_epi8('0' - 1);
+  const __m128i nine = _mm_set1_epi8('9' + 1);
+  const __m128i lowerA = _mm_set1_epi8('a' - 1);
+  const __m128i lowerF = _mm_set1_epi8('f' + 1);
+  const __m128i caseBit = _mm_set1_epi8(0x20);
+  const __m128i digitOffset = _mm_set1_epi8('0');
+  const __m128i alphaOffset = _mm_set1_epi8('a' - 10);
+  for (; i + 16 <= count; i += 16)
+  {
+    const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m128i lower = _mm_or_si128(c, caseBit);
+    // Bytes >= 0x80 are negative in the signed compares, so they fail both ranges.
+    const __m128i isDigit = _mm_and_si128(_mm_cmpgt_epi8(c, zero), _mm_cmplt_epi8(c, nine));
+    const __m128i isAlpha = _mm_and_si128(_mm_cmpgt_epi8(lower, lowerA), _mm_cmplt_epi8(lower, lowerF));
+    if (_mm_movemask_epi8(_mm_or_si128(isDigit, isAlpha)) != 0xFFFF) return false;
+    const __m128i digits = _mm_and_si128(isDigit, _mm_sub_epi8(c, digitOffset));
+    const __m128i alphas = _mm_andnot_si128(isDigit, _mm_sub_epi8(lower, alphaOffset));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_or_si128(digits, alphas));
+  }
+#elif defined(DMDUTIL_HEX_NEON)
+  const uint8x16_t caseBit = vdupq_n_u8(0x20);
+  for (; i + 16 <= count; i += 16)
+  {
+    const uint8x16_t c = vld1q_u8(reinterpret_cast<const uint8_t*>(src + i));
+    const uint8x16_t digits = vsubq_u8(c, vdupq_n_u8('0'));
+    const uint8x16_t alphas = vsubq_u8(vorrq_u8(c, caseBit), vdupq_n_u8('a'));
+    const uint8x16_t isDigit = vcltq_u8(digits, vdupq_n_u8(10));
+    const uint8x16_t isAlpha = vcltq_u8(alphas, vdupq_n_u8(6));
+    if (vminvq_u8(vorrq_u8(isDigit, isAlpha)) == 0) return false;
+    vst1q_u8(dst + i, vbslq_u8(isDigit, digits, vaddq_u8(alphas, vdupq_n_u8(10))));
+  }
+#endif
+  return DecodeHexNibblesScalar(src + i, count - i, dst + i);
+}
+
+}  // namespace DMDUtil
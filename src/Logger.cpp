@@ -1,17 +1,29 @@
 #include "DMDUtil/Logger.h"
 
 #include "DMDUtil/Config.h"
+#include "ThreadLogConfig.h"
 
 namespace DMDUtil
 {
 
+static thread_local const std::atomic<const Config*>* t_pThreadConfig = nullptr;
+
+void SetThreadLogConfig(const std::atomic<const Config*>* pConfig) { t_pThreadConfig = pConfig; }
+
 void Log(DMDUtil_LogLevel logLevel, const char* format, ...)
 {
   static Config* pConfig = Config::GetInstance();
 
-  DMDUtil_LogCallback logCallback = pConfig->GetLogCallback();
+  const Config* pLogConfig = pConfig;
+  if (t_pThreadConfig)
+  {
+    const Config* pThreadConfig = t_pThreadConfig->load(std::memory_order_acquire);
+    if (pThreadConfig) pLogConfig = pThreadConfig;
+  }
+
+  DMDUtil_LogCallback logCallback = pLogConfig->GetLogCallback();
 
-  if (!logCallback || logLevel < pConfig->GetLogLevel()) return;
+  if (!logCallback || logLevel < pLogConfig->GetLogLevel()) return;
 
   va_list args;
   va_start(args, format);
@@ -17,76 +17,128 @@ int ClampCornerRadius(uint16_t width, uint16_t height, int radius)
 
   return std::min<int>(radius, std::min<int>(width, height) / 2);
 }
+
+inline uint16_t PackRGB565(uint32_t r, uint32_t g, uint32_t b)
+{
+  return (uint16_t)(((r & 0xF8u) << 8) | ((g & 0xFCu) << 3) | (b >> 3));
+}
 }  // namespace
 
-void ApplyRoundedCornersRGB24(uint8_t* pData, uint16_t width, uint16_t height, int radius)
+void OutputFilter::Configure(uint16_t width, uint16_t height, int roundedCorners)
 {
-  if (pData == nullptr)
-  {
-    return;
-  }
+  if (width == m_width && height == m_height && roundedCorners == m_radius) return;
 
-  const int maxRadius = ClampCornerRadius(width, height, radius);
-  if (maxRadius <= 0)
-  {
-    return;
-  }
+  m_width = width;
+  m_height = height;
+  m_radius = roundedCorners;
+  m_insets.clear();
 
+  const int maxRadius = ClampCornerRadius(width, height, roundedCorners);
   const float circleRadius = static_cast<float>(maxRadius);
   for (int y = 0; y < maxRadius; ++y)
   {
-    for (int x = 0; x < maxRadius; ++x)
+    // The pixels outside the circle are the ones closest to the edge, so each corner row is blanked
+    // from the edge up to the first pixel inside.
+    const float dy = circleRadius - (static_cast<float>(y) + 0.5f);
+    uint16_t inset = 0;
+    while (inset < maxRadius)
+    {
+      const float dx = circleRadius - (static_cast<float>(inset) + 0.5f);
+      if (dx * dx + dy * dy <= circleRadius * circleRadius) break;
+      ++inset;
+    }
+    m_insets.push_back(inset);
+  }
+}
+
+uint16_t OutputFilter::RowInset(int y) const
+{
+  const int corners = (int)m_insets.size();
+  if (y < corners) return m_insets[y];
+  if (y >= m_height - corners) return m_insets[m_height - 1 - y];
+  return 0;
+}
+
+void OutputFilter::ApplyRGB24(uint8_t* pData) const
+{
+  if (pData == nullptr) return;
+
+  const int corners = (int)m_insets.size();
+  for (int i = 0; i < corners; ++i)
+  {
+    const size_t inset = m_insets[i] * 3u;
+    for (int y : {i, m_height - 1 - i})
     {
-      const float dx = circleRadius - (static_cast<float>(x) + 0.5f);
-      const float dy = circleRadius - (static_cast<float>(y) + 0.5f);
-      if (dx * dx + dy * dy <= circleRadius * circleRadius)
-      {
-        continue;
-      }
-
-      const size_t topLeft = ((size_t)y * width + x) * 3u;
-      const size_t topRight = ((size_t)y * width + (width - 1 - x)) * 3u;
-      const size_t bottomLeft = (((size_t)height - 1 - y) * width + x) * 3u;
-      const size_t bottomRight = (((size_t)height - 1 - y) * width + (width - 1 - x)) * 3u;
-
-      memset(pData + topLeft, 0, 3);
-      memset(pData + topRight, 0, 3);
-      memset(pData + bottomLeft, 0, 3);
-      memset(pData + bottomRight, 0, 3);
+      uint8_t* pRow = pData + (size_t)y * m_width * 3u;
+      memset(pRow, 0, inset);
+      memset(pRow + m_width * 3u - inset, 0, inset);
     }
   }
 }
 
-void ApplyRoundedCornersRGB565(uint16_t* pData, uint16_t width, uint16_t height, int radius)
+void OutputFilter::ApplyRGB565(uint16_t* pData) const
 {
-  if (pData == nullptr)
+  if (pData == nullptr) return;
+
+  const int corners = (int)m_insets.size();
+  for (int i = 0; i < corners; ++i)
   {
-    return;
+    const size_t inset = m_insets[i];
+    for (int y : {i, m_height - 1 - i})
+    {
+      uint16_t* pRow = pData + (size_t)y * m_width;
+      std::fill(pRow, pRow + inset, 0);
+      std::fill(pRow + m_width - inset, pRow + m_width, 0);
+    }
   }
+}
 
-  const int maxRadius = ClampCornerRadius(width, height, radius);
-  if (maxRadius <= 0)
+void OutputFilter::IndexedToRGB24(uint8_t* pDst, const uint8_t* pIndexed, const uint8_t* pPalette) const
+{
+  for (int y = 0; y < m_height; ++y)
   {
-    return;
+    const int inset = RowInset(y);
+    const uint8_t* pSrc = pIndexed + (size_t)y * m_width;
+    uint8_t* pRow = pDst + (size_t)y * m_width * 3u;
+    memset(pRow, 0, inset * 3u);
+    for (int x = inset; x < m_width - inset; ++x)
+    {
+      const uint8_t* pColor = pPalette + pSrc[x] * 3;
+      pRow[x * 3] = pColor[0];
+      pRow[x * 3 + 1] = pColor[1];
+      pRow[x * 3 + 2] = pColor[2];
+    }
+    memset(pRow + (m_width - inset) * 3u, 0, inset * 3u);
   }
+}
 
-  const float circleRadius = static_cast<float>(maxRadius);
-  for (int y = 0; y < maxRadius; ++y)
+void OutputFilter::IndexedToRGB565(uint16_t* pDst, const uint8_t* pIndexed, const uint8_t* pPalette) const
+{
+  for (int y = 0; y < m_height; ++y)
   {
-    for (int x = 0; x < maxRadius; ++x)
+    const int inset = RowInset(y);
+    const uint8_t* pSrc = pIndexed + (size_t)y * m_width;
+    uint16_t* pRow = pDst + (size_t)y * m_width;
+    std::fill(pRow, pRow + inset, 0);
+    for (int x = inset; x < m_width - inset; ++x)
     {
-      const float dx = circleRadius - (static_cast<float>(x) + 0.5f);
-      const float dy = circleRadius - (static_cast<float>(y) + 0.5f);
-      if (dx * dx + dy * dy <= circleRadius * circleRadius)
-      {
-        continue;
-      }
-
-      pData[(size_t)y * width + x] = 0;
-      pData[(size_t)y * width + (width - 1 - x)] = 0;
-      pData[((size_t)height - 1 - y) * width + x] = 0;
-      pData[((size_t)height - 1 - y) * width + (width - 1 - x)] = 0;
+      const uint8_t* pColor = pPalette + pSrc[x] * 3;
+      pRow[x] = PackRGB565(pColor[0], pColor[1], pColor[2]);
     }
+    std::fill(pRow + m_width - inset, pRow + m_width, 0);
+  }
+}
+
+void OutputFilter::RGB24ToRGB565(uint16_t* pDst, const uint8_t* pRGB24) const
+{
+  for (int y = 0; y < m_height; ++y)
+  {
+    const int inset = RowInset(y);
+    const uint8_t* pSrc = pRGB24 + (size_t)y * m_width * 3u;
+    uint16_t* pRow = pDst + (size_t)y * m_width;
+    std::fill(pRow, pRow + inset, 0);
+    for (int x = inset; x < m_width - inset; ++x) pRow[x] = PackRGB565(pSrc[x * 3], pSrc[x * 3 + 1], pSrc[x * 3 + 2]);
+    std::fill(pRow + m_width - inset, pRow + m_width, 0);
   }
 }
 
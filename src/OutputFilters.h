@@ -1,11 +1,35 @@
 #pragma once
 
 #include <cstdint>
+#include <vector>
 
 namespace DMDUtil
 {
 
-void ApplyRoundedCornersRGB24(uint8_t* pData, uint16_t width, uint16_t height, int radius);
-void ApplyRoundedCornersRGB565(uint16_t* pData, uint16_t width, uint16_t height, int radius);
+// Output processing of one sink. The rounded corners are kept as the number of pixels to blank at both
+// ends of each corner row, computed once per size and radius, and the palette and RGB565 conversions
+// blank them in the same pass over the frame.
+class OutputFilter
+{
+ public:
+  // Rebuilds the corner mask if the size or radius differ from the last call.
+  void Configure(uint16_t width, uint16_t height, int roundedCorners);
+
+  void ApplyRGB24(uint8_t* pData) const;
+  void ApplyRGB565(uint16_t* pData) const;
+
+  void IndexedToRGB24(uint8_t* pDst, const uint8_t* pIndexed, const uint8_t* pPalette) const;
+  void IndexedToRGB565(uint16_t* pDst, const uint8_t* pIndexed, const uint8_t* pPalette) const;
+  void RGB24ToRGB565(uint16_t* pDst, const uint8_t* pRGB24) const;
+
+ private:
+  uint16_t RowInset(int y) const;
+
+  uint16_t m_width = 0;
+  uint16_t m_height = 0;
+  int m_radius = -1;
+  // Pixels to blank at the start and at the end of corner row y, for y < radius.
+  std::vector<uint16_t> m_insets;
+};
 
 }  // namespace DMDUtil
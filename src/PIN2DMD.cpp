@@ -1,10 +1,12 @@
 #include "PIN2DMD.h"
 
-#include <libusb-1.0/libusb.h>
-
-#include <cstdint>
 #include <cstring>
 
+#include "DMDUtil/Logger.h"
+
+namespace DMDUtil
+{
+
 // define PIN2DMD vendor id and product id
 constexpr uint16_t kVid = 0x0314;
 constexpr uint16_t kPid = 0xe457;
@@ -13,169 +15,273 @@ constexpr uint16_t kPid = 0xe457;
 constexpr uint8_t kEpIn = 0x81;
 constexpr uint8_t kEpOut = 0x01;
 
-static bool g_PIN2DMD = false;
-static bool g_PIN2DMDXL = false;
-static bool g_PIN2DMDHD = false;
+PIN2DMD::PIN2DMD(libusb_context* pContext, libusb_device_handle* pDeviceHandle, Model model)
+{
+  m_pContext = pContext;
+  m_pDeviceHandle = pDeviceHandle;
+  m_model = model;
 
-static libusb_device** g_devices = nullptr;
-static libusb_device_handle* g_deviceHandle = nullptr;
-static libusb_device_descriptor g_descriptor;
-static libusb_context* g_usbContext = nullptr;
+  for (Transfer& transfer : m_transfers)
+  {
+    transfer.pTransfer = libusb_alloc_transfer(0);
+    transfer.pBuffer = new uint8_t[PIN2DMD_MAX_TRANSFER_SIZE];
+    transfer.busy = false;
+  }
+  m_pPending = new uint8_t[PIN2DMD_MAX_TRANSFER_SIZE];
+  m_pendingLength = 0;
 
-static uint8_t g_outputBuffer[65536] = {};
+  m_running = true;
+  m_pThread = new std::thread(&PIN2DMD::Run, this);
+}
 
-int PIN2DMDInit()
+PIN2DMD::~PIN2DMD()
 {
-  static int ret = 0;
-  static uint8_t product[256] = {};
-  static const char* string = nullptr;
+  m_running = false;
+  m_pThread->join();
+  delete m_pThread;
 
-  libusb_init(&g_usbContext); /* initialize the library */
+  libusb_release_interface(m_pDeviceHandle, 0);
+  libusb_close(m_pDeviceHandle);
+  libusb_exit(m_pContext);
 
-  int device_count = libusb_get_device_list(g_usbContext, &g_devices);
-  if (device_count < 0)
+  for (Transfer& transfer : m_transfers)
   {
-    return 0;
+    libusb_free_transfer(transfer.pTransfer);
+    delete[] transfer.pBuffer;
   }
+  delete[] m_pPending;
 
-  // Now look through the list that we just populated. We are trying to see if any of them match our device.
-  int i;
-  for (i = 0; i < device_count; i++)
-  {
-    libusb_get_device_descriptor(g_devices[i], &g_descriptor);
-    if (kVid == g_descriptor.idVendor && kPid == g_descriptor.idProduct)
-    {
-      break;
-    }
-  }
+  Log(DMDUtil_LogLevel_INFO,
+      "PIN2DMD: frames submitted=%llu, coalesced=%llu, failed=%llu, transfer latency p50=%uus p99=%uus max=%uus",
+      (unsigned long long)m_framesSubmitted.load(), (unsigned long long)m_framesCoalesced.load(),
+      (unsigned long long)m_transfersFailed.load(), m_latency.Percentile(0.5), m_latency.Percentile(0.99),
+      m_latency.GetMax());
+}
+
+PIN2DMD* PIN2DMD::Connect(int deviceIndex)
+{
+  libusb_context* pContext = nullptr;
+  if (libusb_init(&pContext) < 0) return nullptr;
 
-  if (kVid == g_descriptor.idVendor && kPid == g_descriptor.idProduct)
+  libusb_device** ppDevices = nullptr;
+  ssize_t deviceCount = libusb_get_device_list(pContext, &ppDevices);
+  if (deviceCount < 0)
   {
-    ret = libusb_open(g_devices[i], &g_deviceHandle);
-    if (ret < 0)
-    {
-      libusb_free_device_list(g_devices, 1);
-      return ret;
-    }
+    libusb_exit(pContext);
+    return nullptr;
   }
-  else
+
+  // Now look through the list that we just populated. We are trying to see if any of them match our device.
+  libusb_device_handle* pDeviceHandle = nullptr;
+  libusb_device_descriptor descriptor;
+  int found = 0;
+  for (ssize_t i = 0; i < deviceCount; i++)
   {
-    libusb_free_device_list(g_devices, 1);
-    return 0;
+    if (libusb_get_device_descriptor(ppDevices[i], &descriptor) < 0) continue;
+    if (kVid != descriptor.idVendor || kPid != descriptor.idProduct) continue;
+    if (found++ < deviceIndex) continue;
+
+    if (libusb_open(ppDevices[i], &pDeviceHandle) < 0) pDeviceHandle = nullptr;
+    break;
   }
 
-  libusb_free_device_list(g_devices, 1);
+  libusb_free_device_list(ppDevices, 1);
 
-  if (g_deviceHandle == nullptr)
+  if (pDeviceHandle == nullptr)
   {
-    libusb_exit(g_usbContext);
-    return 0;
+    libusb_exit(pContext);
+    return nullptr;
   }
 
-  ret = libusb_get_string_descriptor_ascii(g_deviceHandle, g_descriptor.iProduct, product, 256);
+  unsigned char product[256] = {};
+  int ret = libusb_get_string_descriptor_ascii(pDeviceHandle, descriptor.iProduct, product, sizeof(product));
 
-  if (libusb_claim_interface(g_deviceHandle, 0) < 0)  // claims the interface with the Operating System
+  if (libusb_claim_interface(pDeviceHandle, 0) < 0)  // claims the interface with the Operating System
   {
     // Closes a device opened since the claim interface is failed.
-    libusb_close(g_deviceHandle);
-    g_deviceHandle = nullptr;
-    libusb_exit(g_usbContext);
-    return 0;
+    libusb_close(pDeviceHandle);
+    libusb_exit(pContext);
+    return nullptr;
   }
 
-  string = (const char*)product;
-  if (ret > 0)
+  const char* string = (const char*)product;
+  Model model;
+  if (ret > 0 && strcmp(string, "PIN2DMD") == 0)
+    model = Model::PIN2DMD;
+  else if (ret > 0 && strcmp(string, "PIN2DMD XL") == 0)
+    model = Model::PIN2DMDXL;
+  else if (ret > 0 && strcmp(string, "PIN2DMD HD") == 0)
+    model = Model::PIN2DMDHD;
+  else
   {
-    if (strcmp(string, "PIN2DMD") == 0)
-    {
-      g_PIN2DMD = true;
-      ret = 1;
-    }
-    else if (strcmp(string, "PIN2DMD XL") == 0)
-    {
-      g_PIN2DMDXL = true;
-      ret = 2;
-    }
-    else if (strcmp(string, "PIN2DMD HD") == 0)
-    {
-      g_PIN2DMDHD = true;
-      ret = 3;
-    }
-    else
-    {
-      ret = 0;
-    }
+    libusb_release_interface(pDeviceHandle, 0);
+    libusb_close(pDeviceHandle);
+    libusb_exit(pContext);
+    return nullptr;
+  }
+
+  Log(DMDUtil_LogLevel_INFO, "%s connected", string);
+
+  return new PIN2DMD(pContext, pDeviceHandle, model);
+}
+
+uint16_t PIN2DMD::GetWidth() const
+{
+  if (m_model == Model::PIN2DMDHD) return 256;
+  if (m_model == Model::PIN2DMDXL) return 192;
+  return 128;
+}
+
+uint16_t PIN2DMD::GetHeight() const
+{
+  if (m_model == Model::PIN2DMD) return 32;
+  return 64;
+}
+
+TimingHistogram PIN2DMD::GetTransferLatency() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_latency;
+}
+
+bool PIN2DMD::Supports(uint16_t width, uint16_t height) const
+{
+  return (width == 256 && height == 64 && m_model == Model::PIN2DMDHD) ||
+         (width == 192 && height == 64 && m_model != Model::PIN2DMD) || (width == 128 && height <= 32);
+}
+
+void PIN2DMD::Render(uint16_t width, uint16_t height, const uint8_t* buffer, int bitDepth)
+{
+  if (!Supports(width, height)) return;
+
+  int frameSizeInByte = width * height / 8;
+  int chunksOf512Bytes = (frameSizeInByte / 512) * bitDepth;
+
+  uint8_t header[4];
+  header[0] = 0x81;
+  header[1] = 0xc3;
+  if (bitDepth == 4 && width == 128 && height == 32)
+  {
+    header[2] = 0xe7;  // 4 bit header
+    header[3] = 0x00;
+  }
+  else
+  {
+    header[2] = 0xe8;              // non 4 bit header
+    header[3] = chunksOf512Bytes;  // number of 512 byte chunks
   }
 
-  return ret;
+  // The OutputBuffer to be sent consists of a 4 byte header and a number of chunks of 512 bytes.
+  Send(header, buffer, chunksOf512Bytes * 512);
 }
 
-bool PIN2DMDIsConnected() { return (g_PIN2DMD || g_PIN2DMDXL || g_PIN2DMDHD); }
+void PIN2DMD::RenderRaw(uint16_t width, uint16_t height, const uint8_t* buffer, uint32_t frames)
+{
+  if (!Supports(width, height)) return;
+
+  int frameSizeInByte = width * height * 3;
+  int chunksOf512Bytes = (frameSizeInByte / 512) * frames;
+
+  uint8_t header[4];
+  header[0] = 0x52;  // RAW mode
+  header[1] = 0x80;
+  header[2] = 0x20;
+  header[3] = chunksOf512Bytes;  // number of 512 byte chunks
+
+  Send(header, buffer, frameSizeInByte * frames);
+}
 
-uint16_t PIN2DMDGetWidth()
+void PIN2DMD::Send(const uint8_t* pHeader, const uint8_t* pPayload, int payloadSize)
 {
-  if (g_PIN2DMDHD) return 256;
-  if (g_PIN2DMDXL) return 192;
-  if (g_PIN2DMD) return 128;
-  return 0;
+  const int length = payloadSize + 4;
+  if (length > PIN2DMD_MAX_TRANSFER_SIZE) return;
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (Transfer& transfer : m_transfers)
+  {
+    if (transfer.busy) continue;
+
+    memcpy(transfer.pBuffer, pHeader, 4);
+    memcpy(transfer.pBuffer + 4, pPayload, payloadSize);
+    Submit(transfer, length);
+    return;
+  }
+
+  // All transfers are in flight, the completion callback submits the latest frame.
+  if (m_pendingLength > 0) m_framesCoalesced.fetch_add(1, std::memory_order_relaxed);
+  memcpy(m_pPending, pHeader, 4);
+  memcpy(m_pPending + 4, pPayload, payloadSize);
+  m_pendingLength = length;
 }
 
-uint16_t PIN2DMDGetHeight()
+void PIN2DMD::Submit(Transfer& transfer, int length)
 {
-  if (g_PIN2DMDHD) return 64;
-  if (g_PIN2DMDXL) return 64;
-  if (g_PIN2DMD) return 32;
-  return 0;
+  libusb_fill_bulk_transfer(transfer.pTransfer, m_pDeviceHandle, kEpOut, transfer.pBuffer, length,
+                            &PIN2DMD::OnTransferComplete, this, PIN2DMD_TRANSFER_TIMEOUT);
+  transfer.submitted = std::chrono::steady_clock::now();
+  if (libusb_submit_transfer(transfer.pTransfer) < 0)
+  {
+    m_transfersFailed.fetch_add(1, std::memory_order_relaxed);
+    transfer.busy = false;
+    return;
+  }
+
+  transfer.busy = true;
+  m_framesSubmitted.fetch_add(1, std::memory_order_relaxed);
 }
 
-void PIN2DMDRender(uint16_t width, uint16_t height, uint8_t* buffer, int bitDepth)
+void LIBUSB_CALL PIN2DMD::OnTransferComplete(libusb_transfer* pTransfer)
 {
-  if (!g_deviceHandle) return;
-  if ((width == 256 && height == 64 && g_PIN2DMDHD) || (width == 192 && height == 64 && (g_PIN2DMDXL || g_PIN2DMDHD)) ||
-      (width == 128 && height <= 32 && (g_PIN2DMD || g_PIN2DMDXL || g_PIN2DMDHD)))
+  PIN2DMD* pPIN2DMD = static_cast<PIN2DMD*>(pTransfer->user_data);
+
+  std::lock_guard<std::mutex> lock(pPIN2DMD->m_mutex);
+  for (Transfer& transfer : pPIN2DMD->m_transfers)
   {
-    int frameSizeInByte = width * height / 8;
-    int chunksOf512Bytes = (frameSizeInByte / 512) * bitDepth;
+    if (transfer.pTransfer != pTransfer) continue;
 
-    g_outputBuffer[0] = 0x81;
-    g_outputBuffer[1] = 0xc3;
-    if (bitDepth == 4 && width == 128 && height == 32)
-    {
-      g_outputBuffer[2] = 0xe7;  // 4 bit header
-      g_outputBuffer[3] = 0x00;
-    }
-    else
+    transfer.busy = false;
+    const std::chrono::steady_clock::duration latency = std::chrono::steady_clock::now() - transfer.submitted;
+    const uint32_t latencyUs = (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+    pPIN2DMD->m_latency.Record(latencyUs);
+    pPIN2DMD->m_transferTimeUs.fetch_add(latencyUs, std::memory_order_relaxed);
+    pPIN2DMD->m_transfersCompleted.fetch_add(1, std::memory_order_relaxed);
+    if (pTransfer->status != LIBUSB_TRANSFER_COMPLETED)
+      pPIN2DMD->m_transfersFailed.fetch_add(1, std::memory_order_relaxed);
+
+    if (pPIN2DMD->m_pendingLength > 0 && pPIN2DMD->m_running)
     {
-      g_outputBuffer[2] = 0xe8;              // non 4 bit header
-      g_outputBuffer[3] = chunksOf512Bytes;  // number of 512 byte chunks
+      // Hand the pending buffer to the transfer instead of copying the frame again.
+      std::swap(transfer.pBuffer, pPIN2DMD->m_pPending);
+      pPIN2DMD->Submit(transfer, pPIN2DMD->m_pendingLength);
+      pPIN2DMD->m_pendingLength = 0;
     }
+    break;
+  }
+}
 
-    const int payloadSize = chunksOf512Bytes * 512;
-    if ((payloadSize + 4) > (int)sizeof(g_outputBuffer)) return;
-    memcpy(&g_outputBuffer[4], buffer, payloadSize);
-
-    // The OutputBuffer to be sent consists of a 4 byte header and a number of chunks of 512 bytes.
-    libusb_bulk_transfer(g_deviceHandle, kEpOut, g_outputBuffer, payloadSize + 4, nullptr, 1000);
+bool PIN2DMD::IsBusy()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (const Transfer& transfer : m_transfers)
+  {
+    if (transfer.busy) return true;
   }
+  return false;
 }
 
-void PIN2DMDRenderRaw(uint16_t width, uint16_t height, uint8_t* buffer, uint32_t frames)
+void PIN2DMD::Run()
 {
-  if (!g_deviceHandle) return;
-  if ((width == 256 && height == 64 && g_PIN2DMDHD) || (width == 192 && height == 64 && (g_PIN2DMDXL || g_PIN2DMDHD)) ||
-      (width == 128 && height <= 32 && (g_PIN2DMD || g_PIN2DMDXL || g_PIN2DMDHD)))
+  Log(DMDUtil_LogLevel_INFO, "PIN2DMD event thread starting");
+
+  // Completion callbacks run on this thread. After stop, the transfers still in flight are waited for,
+  // they end by the transfer timeout at the latest.
+  while (m_running || IsBusy())
   {
-    int frameSizeInByte = width * height * 3;
-    int chunksOf512Bytes = (frameSizeInByte / 512) * frames;
-    int bufferSizeInBytes = frameSizeInByte * frames;
-    if ((bufferSizeInBytes + 4) > (int)sizeof(g_outputBuffer)) return;
-
-    g_outputBuffer[0] = 0x52;  // RAW mode
-    g_outputBuffer[1] = 0x80;
-    g_outputBuffer[2] = 0x20;
-    g_outputBuffer[3] = chunksOf512Bytes;  // number of 512 byte chunks
-    memcpy(&g_outputBuffer[4], buffer, bufferSizeInBytes);
-
-    libusb_bulk_transfer(g_deviceHandle, kEpOut, g_outputBuffer, bufferSizeInBytes + 4, nullptr, 1000);
+    timeval timeout = {0, 100000};
+    libusb_handle_events_timeout_completed(m_pContext, &timeout, nullptr);
   }
+
+  Log(DMDUtil_LogLevel_INFO, "PIN2DMD event thread finished");
 }
+
+}  // namespace DMDUtil
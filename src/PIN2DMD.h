@@ -1,13 +1,95 @@
 #ifndef PIN2DMD_H
 #define PIN2DMD_H
 
+#include <libusb-1.0/libusb.h>
+
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "TimingHistogram.h"
+
+#define PIN2DMD_MAX_TRANSFER_SIZE 65536
+#define PIN2DMD_TRANSFER_COUNT 2
+#define PIN2DMD_TRANSFER_TIMEOUT 1000
+
+namespace DMDUtil
+{
+
+// One PIN2DMD, with its own libusb context. Frames are sent with asynchronous bulk transfers, up to
+// PIN2DMD_TRANSFER_COUNT at once, so the caller does not wait for USB. While all transfers are in flight,
+// the latest frame waits in a pending buffer and replaces any older one that did not get out yet.
+class PIN2DMD
+{
+ public:
+  ~PIN2DMD();
+
+  // Opens the deviceIndex-th PIN2DMD found on the bus.
+  static PIN2DMD* Connect(int deviceIndex = 0);
+
+  uint16_t GetWidth() const;
+  uint16_t GetHeight() const;
+  void Render(uint16_t width, uint16_t height, const uint8_t* buffer, int bitDepth);
+  void RenderRaw(uint16_t width, uint16_t height, const uint8_t* buffer, uint32_t frames);
+
+  uint64_t GetFramesSubmitted() const { return m_framesSubmitted.load(std::memory_order_relaxed); }
+  // Frames replaced by a newer one while all transfers were in flight.
+  uint64_t GetFramesCoalesced() const { return m_framesCoalesced.load(std::memory_order_relaxed); }
+  uint64_t GetTransfersFailed() const { return m_transfersFailed.load(std::memory_order_relaxed); }
+  // Submit to completion time of the transfers, in microseconds. Copies the histogram, meant for statistics.
+  TimingHistogram GetTransferLatency() const;
+  // Lock free totals of the same latencies, cheap enough to read per frame.
+  uint64_t GetTransferTimeUs() const { return m_transferTimeUs.load(std::memory_order_relaxed); }
+  uint64_t GetTransfersCompleted() const { return m_transfersCompleted.load(std::memory_order_relaxed); }
+
+ private:
+  enum class Model
+  {
+    PIN2DMD,
+    PIN2DMDXL,
+    PIN2DMDHD,
+  };
+
+  struct Transfer
+  {
+    libusb_transfer* pTransfer;
+    uint8_t* pBuffer;
+    bool busy;
+    std::chrono::steady_clock::time_point submitted;
+  };
+
+  PIN2DMD(libusb_context* pContext, libusb_device_handle* pDeviceHandle, Model model);
+
+  bool Supports(uint16_t width, uint16_t height) const;
+  // Copies the frame into an idle transfer and submits it, or keeps it as pending frame.
+  void Send(const uint8_t* pHeader, const uint8_t* pPayload, int payloadSize);
+  // Called with m_mutex held.
+  void Submit(Transfer& transfer, int length);
+  bool IsBusy();
+  void Run();
+  static void LIBUSB_CALL OnTransferComplete(libusb_transfer* pTransfer);
+
+  libusb_context* m_pContext;
+  libusb_device_handle* m_pDeviceHandle;
+  Model m_model;
+
+  Transfer m_transfers[PIN2DMD_TRANSFER_COUNT];
+  uint8_t* m_pPending;
+  int m_pendingLength;
+  mutable std::mutex m_mutex;
+  TimingHistogram m_latency;
+
+  std::thread* m_pThread;
+  std::atomic<bool> m_running;
+  std::atomic<uint64_t> m_framesSubmitted{0};
+  std::atomic<uint64_t> m_framesCoalesced{0};
+  std::atomic<uint64_t> m_transfersFailed{0};
+  std::atomic<uint64_t> m_transferTimeUs{0};
+  std::atomic<uint64_t> m_transfersCompleted{0};
+};
 
-int PIN2DMDInit();
-bool PIN2DMDIsConnected();
-uint16_t PIN2DMDGetWidth();
-uint16_t PIN2DMDGetHeight();
-void PIN2DMDRender(uint16_t width, uint16_t height, uint8_t* buffer, int bitDepth);
-void PIN2DMDRenderRaw(uint16_t width, uint16_t height, uint8_t* buffer, uint32_t frames);
+}  // namespace DMDUtil
 
 #endif /* PIN2DMD_H */
@@ -6,12 +6,14 @@
 
 #include "PixelcadeDMD.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstring>
 #include <thread>
 
 #include "FrameUtil.h"
 #include "DMDUtil/Logger.h"
+#include "PixelcadePlaneEncoder.h"
 
 namespace DMDUtil
 {
@@ -24,6 +26,11 @@ PixelcadeDMD::PixelcadeDMD(struct sp_port* pSerialPort, int width, int height, b
   m_colorSwap = colorSwap;
   m_isV2 = isV2;
   m_length = width * height;
+  for (int i = 0; i < 3; i++)
+  {
+    m_pSlots[i] = new uint8_t[m_length * 3];
+    m_slotFormats[i] = PixelcadeFrameFormat::RGB565;
+  }
   m_pThread = nullptr;
   m_running = false;
 
@@ -34,21 +41,22 @@ PixelcadeDMD::~PixelcadeDMD()
 {
   if (m_pThread)
   {
-    m_running = false;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_running = false;
+    }
+    m_cv.notify_one();
 
     m_pThread->join();
     delete m_pThread;
     m_pThread = nullptr;
   }
 
-  while (!m_frames.empty())
-  {
-    free(m_frames.front().pData);
-    m_frames.pop();
-  }
+  for (int i = 0; i < 3; i++) delete[] m_pSlots[i];
 }
 
-PixelcadeDMD* PixelcadeDMD::Connect(const char* pDevice)
+PixelcadeDMD* PixelcadeDMD::Connect(const char* pDevice, int searchTimeoutMs,
+                                    const std::vector<std::string>* pIgnoredDevices)
 {
   PixelcadeDMD* pPixelcadeDMD = nullptr;
 
@@ -68,9 +76,21 @@ PixelcadeDMD* PixelcadeDMD::Connect(const char* pDevice)
     enum sp_return result = sp_list_ports(&ppPorts);
     if (result == SP_OK)
     {
+      const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(searchTimeoutMs);
       for (int i = 0; ppPorts[i]; i++)
       {
-        pPixelcadeDMD = Open(sp_get_port_name(ppPorts[i]));
+        if (searchTimeoutMs > 0 && std::chrono::steady_clock::now() >= deadline)
+        {
+          Log(DMDUtil_LogLevel_INFO, "Pixelcade search timed out after %d ms", searchTimeoutMs);
+          break;
+        }
+
+        const char* pPortName = sp_get_port_name(ppPorts[i]);
+        if (pIgnoredDevices &&
+            std::find(pIgnoredDevices->begin(), pIgnoredDevices->end(), pPortName) != pIgnoredDevices->end())
+          continue;
+
+        pPixelcadeDMD = Open(pPortName);
         if (pPixelcadeDMD) break;
       }
       sp_free_port_list(ppPorts);
@@ -178,37 +198,34 @@ PixelcadeDMD* PixelcadeDMD::Open(const char* pDevice)
     return nullptr;
   }
 
-  return new PixelcadeDMD(pSerialPort, width, height, colorSwap, isV2);
+  PixelcadeDMD* pPixelcadeDMD = new PixelcadeDMD(pSerialPort, width, height, colorSwap, isV2);
+  memcpy(pPixelcadeDMD->m_firmware, firmware, sizeof(firmware));
+  return pPixelcadeDMD;
 }
 
 void PixelcadeDMD::Update(uint16_t* pData)
 {
-  uint16_t* pFrame = (uint16_t*)malloc(m_length * sizeof(uint16_t));
-  memcpy(pFrame, pData, m_length * sizeof(uint16_t));
-
-  PixelcadeFrame frame;
-  frame.pData = pFrame;
-  frame.format = PixelcadeFrameFormat::RGB565;
-
-  {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_frames.push(frame);
-  }
+  // The write slot belongs to the caller until Publish() hands it over.
+  memcpy(m_pSlots[m_writeSlot], pData, m_length * sizeof(uint16_t));
+  Publish(PixelcadeFrameFormat::RGB565);
 }
 
 void PixelcadeDMD::UpdateRGB24(uint8_t* pData)
 {
-  uint8_t* pFrame = (uint8_t*)malloc(m_length * 3);
-  memcpy(pFrame, pData, m_length * 3);
-
-  PixelcadeFrame frame;
-  frame.pData = pFrame;
-  frame.format = PixelcadeFrameFormat::RGB888;
+  memcpy(m_pSlots[m_writeSlot], pData, m_length * 3);
+  Publish(PixelcadeFrameFormat::RGB888);
+}
 
+void PixelcadeDMD::Publish(PixelcadeFrameFormat format)
+{
   {
     std::lock_guard<std::mutex> lock(m_mutex);
-    m_frames.push(frame);
+    m_slotFormats[m_writeSlot] = format;
+    std::swap(m_writeSlot, m_readySlot);
+    if (m_frameReady) m_framesCoalesced.fetch_add(1, std::memory_order_relaxed);
+    m_frameReady = true;
   }
+  m_cv.notify_one();
 }
 
 int PixelcadeDMD::BuildFrame(uint8_t* pFrameBuffer, size_t bufferSize, uint8_t command, const uint8_t* pData,
@@ -276,28 +293,24 @@ void PixelcadeDMD::Run()
 
         const int maxFrameDataSize = m_length * 3;
         uint8_t* pFrameData = new uint8_t[maxFrameDataSize + 10];
+        // Keeps the planes of the previous v1 frame in pFrameData and only re-encodes the changed rows.
+        PixelcadePlaneEncoder planeEncoder(m_width, rows, colorMatrix);
 
         while (m_running)
         {
-          PixelcadeFrame frame;
-          frame.pData = nullptr;
-
+          PixelcadeFrameFormat format;
           {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            if (!m_frames.empty())
-            {
-              frame = m_frames.front();
-              m_frames.pop();
-            }
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [&]() { return !m_running || m_frameReady; });
+            if (!m_running) break;
 
-            while (m_frames.size() > PIXELCADE_MAX_QUEUE_FRAMES)
-            {
-              free(m_frames.front().pData);
-              m_frames.pop();
-            }
+            std::swap(m_sendSlot, m_readySlot);
+            m_frameReady = false;
+            format = m_slotFormats[m_sendSlot];
           }
+          const uint8_t* pFrame = m_pSlots[m_sendSlot];
+          const auto writeStart = std::chrono::steady_clock::now();
 
-          if (frame.pData)
           {
             int payloadSize = 0;
             uint8_t command = 0;
@@ -305,18 +318,18 @@ void PixelcadeDMD::Run()
 
             if (m_isV2)
             {
-              if (frame.format == PixelcadeFrameFormat::RGB565)
+              if (format == PixelcadeFrameFormat::RGB565)
               {
                 command = PIXELCADE_COMMAND_RGB565;
                 payloadSize = m_length * 2;
               }
-              else if (frame.format == PixelcadeFrameFormat::RGB888)
+              else if (format == PixelcadeFrameFormat::RGB888)
               {
                 command = PIXELCADE_COMMAND_RGB888;
                 payloadSize = m_length * 3;
               }
 
-              memcpy(pFrameData + 5, frame.pData, payloadSize);
+              memcpy(pFrameData + 5, pFrame, payloadSize);
               int frameSize = BuildFrame(pFrameData, maxFrameDataSize + 10, command, pFrameData + 5, payloadSize);
 
               if (frameSize > 0)
@@ -327,8 +340,11 @@ void PixelcadeDMD::Run()
               command = PIXELCADE_COMMAND_RGB_LED_MATRIX_FRAME;
               payloadSize = m_length * 3 / 2;
               pFrameData[0] = command;
-              FrameUtil::Helper::SplitIntoRgbPlanes((uint16_t*)frame.pData, m_length, m_width, rows / 2, pFrameData + 1,
-                                                    colorMatrix);
+              if (planeEncoder.IsSupported())
+                planeEncoder.Encode((const uint16_t*)pFrame, pFrameData + 1);
+              else
+                FrameUtil::Helper::SplitIntoRgbPlanes((uint16_t*)pFrame, m_length, m_width, rows / 2, pFrameData + 1,
+                                                      colorMatrix);
               response = sp_blocking_write(m_pSerialPort, pFrameData, 1 + payloadSize, PIXELCADE_COMMAND_WRITE_TIMEOUT);
             }
 
@@ -357,10 +373,12 @@ void PixelcadeDMD::Run()
               m_running = false;
             }
 
-            free(frame.pData);
+            m_framesWritten.fetch_add(1, std::memory_order_relaxed);
+            m_writeTimeUs.fetch_add(std::chrono::duration_cast<std::chrono::microseconds>(
+                                        std::chrono::steady_clock::now() - writeStart)
+                                        .count(),
+                                    std::memory_order_relaxed);
           }
-          else
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
         }
 
         delete[] pFrameData;
@@ -379,7 +397,11 @@ void PixelcadeDMD::Run()
 
         m_pSerialPort = nullptr;
 
-        Log(DMDUtil_LogLevel_INFO, "PixelcadeDMD run thread finished");
+        const uint64_t framesWritten = m_framesWritten.load(std::memory_order_relaxed);
+        Log(DMDUtil_LogLevel_INFO,
+            "PixelcadeDMD run thread finished: frames written=%llu, coalesced=%llu, average write time=%lluus",
+            (unsigned long long)framesWritten, (unsigned long long)m_framesCoalesced.load(std::memory_order_relaxed),
+            (unsigned long long)(framesWritten ? m_writeTimeUs.load(std::memory_order_relaxed) / framesWritten : 0));
       });
 }
 
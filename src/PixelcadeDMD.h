@@ -6,10 +6,13 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <mutex>
-#include <queue>
+#include <string>
 #include <thread>
+#include <vector>
 
 #include "libserialport.h"
 
@@ -25,7 +28,6 @@
 #define PIXELCADE_MAX_DATA_SIZE (128 * 32 * 3)
 #define PIXELCADE_COMMAND_READ_TIMEOUT 100
 #define PIXELCADE_COMMAND_WRITE_TIMEOUT 100
-#define PIXELCADE_MAX_QUEUE_FRAMES 4
 #define PIXELCADE_MAX_NO_RESPONSE 20
 
 namespace DMDUtil
@@ -37,31 +39,36 @@ enum class PixelcadeFrameFormat
   RGB888
 };
 
-struct PixelcadeFrame
-{
-  void* pData;
-  PixelcadeFrameFormat format;
-};
-
 class PixelcadeDMD
 {
  public:
   PixelcadeDMD(struct sp_port* pSerialPort, int width, int height, bool colorSwap, bool isV2);
   ~PixelcadeDMD();
 
-  static PixelcadeDMD* Connect(const char* pDevice = nullptr);
+  // Without a device all serial ports except the ignored ones are tried until searchTimeoutMs passed, 0 tries all of
+  // them.
+  static PixelcadeDMD* Connect(const char* pDevice = nullptr, int searchTimeoutMs = 0,
+                               const std::vector<std::string>* pIgnoredDevices = nullptr);
   void Update(uint16_t* pData);
   void UpdateRGB24(uint8_t* pData);
 
   int GetWidth() const { return m_width; }
   int GetHeight() const { return m_height; }
   bool GetIsV2() const { return m_isV2; }
+  bool GetColorSwap() const { return m_colorSwap; }
+  const char* GetDevice() const { return sp_get_port_name(m_pSerialPort); }
+  const char* GetFirmware() const { return m_firmware; }
+  // Frames replaced by a newer one before the serial port was free to take them.
+  uint64_t GetFramesCoalesced() const { return m_framesCoalesced.load(std::memory_order_relaxed); }
+  uint64_t GetFramesWritten() const { return m_framesWritten.load(std::memory_order_relaxed); }
+  uint64_t GetWriteTimeUs() const { return m_writeTimeUs.load(std::memory_order_relaxed); }
 
  private:
   static PixelcadeDMD* Open(const char* pDevice);
   void Run();
   void EnableRgbLedMatrix(int shifterLen32, int rows);
   int BuildFrame(uint8_t* pFrameBuffer, size_t bufferSize, uint8_t command, const uint8_t* pData, uint16_t dataLength);
+  void Publish(PixelcadeFrameFormat format);
 
   struct sp_port* m_pSerialPort;
   int m_width;
@@ -69,11 +76,23 @@ class PixelcadeDMD
   bool m_colorSwap;
   bool m_isV2;
   int m_length;
+  char m_firmware[9] = {0};
 
   std::thread* m_pThread;
-  std::queue<PixelcadeFrame> m_frames;
+  // Triple buffer: Update() fills the write slot and swaps it with the ready slot, the run thread swaps
+  // the ready slot with the send slot. A frame still waiting in the ready slot is replaced by the newer one.
+  uint8_t* m_pSlots[3];
+  PixelcadeFrameFormat m_slotFormats[3];
+  int m_writeSlot = 0;
+  int m_readySlot = 1;
+  int m_sendSlot = 2;
+  bool m_frameReady = false;
   std::mutex m_mutex;
-  bool m_running;
+  std::condition_variable m_cv;
+  std::atomic<bool> m_running;
+  std::atomic<uint64_t> m_framesCoalesced{0};
+  std::atomic<uint64_t> m_framesWritten{0};
+  std::atomic<uint64_t> m_writeTimeUs{0};
 };
 
 }  // namespace DMDUtil
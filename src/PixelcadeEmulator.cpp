@@ -0,0 +1,271 @@
+#include "PixelcadeEmulator.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include "PixelcadeDMD.h"
+
+namespace DMDUtil
+{
+
+PixelcadeEmulator::PixelcadeEmulator(int width, bool isV2, int baud)
+{
+  m_width = width;
+  m_height = 32;
+  m_isV2 = isV2;
+  m_baud = baud;
+  m_masterFd = -1;
+  m_pThread = nullptr;
+  m_running = false;
+}
+
+PixelcadeEmulator::~PixelcadeEmulator()
+{
+  if (m_pThread)
+  {
+    m_running = false;
+    m_pThread->join();
+    delete m_pThread;
+  }
+
+  if (m_masterFd >= 0) close(m_masterFd);
+}
+
+bool PixelcadeEmulator::Start()
+{
+  m_masterFd = posix_openpt(O_RDWR | O_NOCTTY);
+  if (m_masterFd < 0 || grantpt(m_masterFd) != 0 || unlockpt(m_masterFd) != 0) return false;
+
+  const char* pName = ptsname(m_masterFd);
+  if (!pName) return false;
+  m_device = pName;
+  fcntl(m_masterFd, F_SETFL, fcntl(m_masterFd, F_GETFL) | O_NONBLOCK);
+
+  // The master reports a hang up once the terminal has been opened and closed again, opening it here
+  // makes the next open by the host visible.
+  int slaveFd = open(pName, O_RDWR | O_NOCTTY);
+  if (slaveFd < 0) return false;
+  close(slaveFd);
+
+  m_running = true;
+  m_pThread = new std::thread(&PixelcadeEmulator::Run, this);
+  return true;
+}
+
+PixelcadeEmulator::Stats PixelcadeEmulator::GetStats() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats;
+}
+
+void PixelcadeEmulator::Run()
+{
+  while (m_running)
+  {
+    if (WaitForHost()) Serve();
+  }
+}
+
+bool PixelcadeEmulator::WaitForHost()
+{
+  while (m_running)
+  {
+    pollfd pfd = {m_masterFd, POLLIN, 0};
+    if (poll(&pfd, 1, 0) >= 0 && !(pfd.revents & POLLHUP)) return true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return false;
+}
+
+void PixelcadeEmulator::Serve()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.sessions++;
+  }
+  m_pending.clear();
+  m_lastFrame = {};
+
+  // A pseudo terminal starts in canonical mode on every open, the handshake must not be line edited.
+  termios tty;
+  if (tcgetattr(m_masterFd, &tty) == 0)
+  {
+    cfmakeraw(&tty);
+    tcsetattr(m_masterFd, TCSANOW, &tty);
+  }
+
+  // Connection established, "IOIO", hardware id, bootloader id and firmware. The firmware encodes the
+  // panel size in the third and V2 in the fourth character, the version in the last two.
+  uint8_t response[29] = {PIXELCADE_RESPONSE_ESTABLE_CONNECTION, 'I', 'O', 'I', 'O'};
+  memcpy(response + 5, "EMULATOR", 8);
+  memcpy(response + 13, "EMULATOR", 8);
+  memcpy(response + 21, m_width == 64 ? "PIM" : "PIX", 3);
+  memcpy(response + 24, m_isV2 ? "R0023" : "L0023", 5);
+  if (write(m_masterFd, response, sizeof(response)) != (ssize_t)sizeof(response)) return;
+
+  // Token bucket of the bytes the link may carry, filled at the baud rate and capped at 10 ms worth of
+  // data so an idle host does not build up a burst.
+  const double bytesPerUs = m_baud / 10.0 / 1000000.0;
+  const double maxCredit = std::max(64.0, bytesPerUs * 10000.0);
+  double credit = 0;
+  auto lastRefill = std::chrono::steady_clock::now();
+  uint8_t buffer[4096];
+
+  while (m_running)
+  {
+    size_t allowed = sizeof(buffer);
+    if (m_baud > 0)
+    {
+      const auto now = std::chrono::steady_clock::now();
+      credit = std::min(maxCredit, credit + bytesPerUs * std::chrono::duration_cast<std::chrono::microseconds>(
+                                                             now - lastRefill)
+                                                             .count());
+      lastRefill = now;
+      if (credit < 1)
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        continue;
+      }
+      allowed = std::min(allowed, (size_t)credit);
+    }
+
+    pollfd pfd = {m_masterFd, POLLIN, 0};
+    if (poll(&pfd, 1, 50) < 0) break;
+    if (pfd.revents & POLLIN)
+    {
+      const ssize_t count = read(m_masterFd, buffer, allowed);
+      if (count < 0 && errno != EAGAIN) break;  // EIO once the host closed the terminal
+      if (count <= 0) continue;
+
+      credit -= count;
+      int backlog = 0;
+      ioctl(m_masterFd, FIONREAD, &backlog);
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.bytes += count;
+        m_stats.maxBacklog = std::max(m_stats.maxBacklog, backlog);
+      }
+      m_pending.insert(m_pending.end(), buffer, buffer + count);
+      Parse();
+    }
+    else if (pfd.revents & POLLHUP)
+      break;
+  }
+}
+
+void PixelcadeEmulator::Parse()
+{
+  size_t pos = 0;
+  if (m_isV2)
+    ParseV2(pos);
+  else
+    ParseV1(pos);
+  m_pending.erase(m_pending.begin(), m_pending.begin() + pos);
+}
+
+void PixelcadeEmulator::ParseV1(size_t& pos)
+{
+  // Unframed commands: enable with one config byte, or a frame with the RGB planes of all row pairs.
+  const size_t frameSize = 1 + m_width * m_height * 3 / 2;
+  while (pos < m_pending.size())
+  {
+    const size_t available = m_pending.size() - pos;
+    const uint8_t command = m_pending[pos];
+    if (command == PIXELCADE_COMMAND_RGB_LED_MATRIX_ENABLE)
+    {
+      if (available < 2) return;
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stats.enables++;
+      pos += 2;
+    }
+    else if (command == PIXELCADE_COMMAND_RGB_LED_MATRIX_FRAME)
+    {
+      if (available < frameSize) return;
+      RecordFrame(m_stats.planeFrames);
+      pos += frameSize;
+    }
+    else
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stats.invalidBytes++;
+      pos++;
+    }
+  }
+}
+
+void PixelcadeEmulator::ParseV2(size_t& pos)
+{
+  // The init byte is sent unframed, everything else as packets of start markers, payload length, command,
+  // data and end delimiter as built by PixelcadeDMD::BuildFrame().
+  const size_t length = m_width * m_height;
+  while (pos < m_pending.size())
+  {
+    const uint8_t* pPacket = m_pending.data() + pos;
+    const size_t available = m_pending.size() - pos;
+    if (pPacket[0] == PIXELCADE_COMMAND_INIT_V2)
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stats.inits++;
+      pos++;
+      continue;
+    }
+
+    if (available < 5) return;
+    const size_t payloadLength = pPacket[2] | (pPacket[3] << 8);
+    if (pPacket[0] != PIXELCADE_FRAME_START_MARKER || pPacket[1] != PIXELCADE_FRAME_START_MARKER ||
+        payloadLength == 0 || payloadLength - 1 > PIXELCADE_MAX_DATA_SIZE)
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stats.invalidBytes++;
+      pos++;
+      continue;
+    }
+
+    const size_t packetSize = 5 + payloadLength;
+    if (available < packetSize) return;
+    if (pPacket[packetSize - 1] != PIXELCADE_FRAME_END_DELIMITER)
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stats.invalidBytes++;
+      pos++;
+      continue;
+    }
+
+    const uint8_t command = pPacket[4];
+    const size_t dataLength = payloadLength - 1;
+    if (command == PIXELCADE_COMMAND_RGB565 && dataLength == length * 2)
+      RecordFrame(m_stats.rgb565Frames);
+    else if (command == PIXELCADE_COMMAND_RGB888 && dataLength == length * 3)
+      RecordFrame(m_stats.rgb888Frames);
+    else
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (command == PIXELCADE_COMMAND_RGB_LED_MATRIX_ENABLE_V2 && dataLength == 1)
+        m_stats.enables++;
+      else
+        m_stats.unknownPackets++;
+    }
+    pos += packetSize;
+  }
+}
+
+void PixelcadeEmulator::RecordFrame(uint64_t& counter)
+{
+  const auto now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lock(m_mutex);
+  counter++;
+  if (m_lastFrame != std::chrono::steady_clock::time_point{})
+    m_stats.frameInterval.Record(
+        (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(now - m_lastFrame).count());
+  m_lastFrame = now;
+}
+
+}  // namespace DMDUtil
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TimingHistogram.h"
+
+namespace DMDUtil
+{
+
+// Pixelcade on the master side of a pseudo terminal, for testing PixelcadeDMD without hardware. When a host
+// opens the terminal it answers the handshake PixelcadeDMD::Open() expects, then it parses the v1 bit plane
+// frames or the V2 packets. Reading is limited to the configured baud rate at 10 bits per byte, so a slow
+// link fills the terminal buffer and blocks the writer like the device does.
+class PixelcadeEmulator
+{
+ public:
+  struct Stats
+  {
+    uint64_t sessions = 0;
+    uint64_t bytes = 0;
+    uint64_t inits = 0;
+    uint64_t enables = 0;
+    uint64_t planeFrames = 0;
+    uint64_t rgb565Frames = 0;
+    uint64_t rgb888Frames = 0;
+    uint64_t invalidBytes = 0;    // skipped while searching the next command
+    uint64_t unknownPackets = 0;  // V2 packets with an unknown command or an unexpected length
+    int maxBacklog = 0;           // bytes written by the host but not read yet
+    TimingHistogram frameInterval;
+  };
+
+  // width is 128 or 64, the panel is 32 rows high. A baud rate of 0 reads as fast as the host writes.
+  PixelcadeEmulator(int width, bool isV2, int baud);
+  ~PixelcadeEmulator();
+
+  // Creates the pseudo terminal and starts the device thread.
+  bool Start();
+  const char* GetDevice() const { return m_device.c_str(); }
+  Stats GetStats() const;
+
+ private:
+  void Run();
+  bool WaitForHost();
+  void Serve();
+  void Parse();
+  void ParseV1(size_t& pos);
+  void ParseV2(size_t& pos);
+  void RecordFrame(uint64_t& counter);
+
+  int m_width;
+  int m_height;
+  bool m_isV2;
+  int m_baud;
+  int m_masterFd;
+  std::string m_device;
+
+  std::thread* m_pThread;
+  std::atomic<bool> m_running;
+  std::vector<uint8_t> m_pending;
+  std::chrono::steady_clock::time_point m_lastFrame;
+
+  mutable std::mutex m_mutex;
+  Stats m_stats;
+};
+
+}  // namespace DMDUtil
@@ -0,0 +1,119 @@
+#include "PixelcadePlaneEncoder.h"
+
+#include <cstring>
+
+namespace DMDUtil
+{
+
+namespace
+{
+// The v1 protocol drives two rows at once: row y and row y + 16 form a dot pair per column.
+constexpr int kPairOffset = 16;
+constexpr int kPlaneCount = 3;
+
+// Per RGB565 byte, the bit of every plane at 8 * plane, as (r << 2 | g << 1 | b) with the color
+// order applied. The high byte carries red and green, the low byte blue, so two 256 entry tables
+// replace the per plane shifts and masks of the generic splitter.
+struct PlaneLut
+{
+  uint32_t high[256];
+  uint32_t low[256];
+
+  static constexpr uint32_t Spread(uint32_t value3, int shift)
+  {
+    uint32_t spread = 0;
+    for (int plane = 0; plane < kPlaneCount; plane++) spread |= ((value3 >> plane) & 1) << (8 * plane + shift);
+    return spread;
+  }
+
+  constexpr explicit PlaneLut(FrameUtil::ColorMatrix colorMatrix) : high(), low()
+  {
+    // Rgb sends green in the middle bit, Rbg swaps green and blue.
+    const int greenShift = (colorMatrix == FrameUtil::ColorMatrix::Rgb) ? 1 : 0;
+    const int blueShift = (colorMatrix == FrameUtil::ColorMatrix::Rgb) ? 0 : 1;
+    for (uint32_t i = 0; i < 256; i++)
+    {
+      // Bits 15-13 and 10-8 of the RGB565 value, the upper three bits of red and green.
+      high[i] = Spread(i >> 5, 2) | Spread(i & 7, greenShift);
+      // Bits 4-2, the upper three bits of blue.
+      low[i] = Spread((i >> 2) & 7, blueShift);
+    }
+  }
+
+  uint32_t Lookup(uint16_t color) const { return high[color >> 8] | low[color & 0xFF]; }
+};
+
+constexpr PlaneLut kRgbLut(FrameUtil::ColorMatrix::Rgb);
+constexpr PlaneLut kRbgLut(FrameUtil::ColorMatrix::Rbg);
+
+template <int Width, FrameUtil::ColorMatrix Matrix>
+void EncodeRowPair(const uint16_t* pTop, const uint16_t* pBottom, uint8_t* pPlanes, int row)
+{
+  constexpr int planeSize = Width * kPairOffset;
+  const PlaneLut& lut = (Matrix == FrameUtil::ColorMatrix::Rgb) ? kRgbLut : kRbgLut;
+
+  uint8_t* pPlane0 = pPlanes + row * Width;
+  uint8_t* pPlane1 = pPlane0 + planeSize;
+  uint8_t* pPlane2 = pPlane1 + planeSize;
+  for (int x = 0; x < Width; x++)
+  {
+    // One byte per plane: the top pixel in bits 5-3, the bottom pixel in bits 2-0.
+    const uint32_t dotPairs = (lut.Lookup(pTop[x]) << 3) | lut.Lookup(pBottom[x]);
+    pPlane0[x] = (uint8_t)dotPairs;
+    pPlane1[x] = (uint8_t)(dotPairs >> 8);
+    pPlane2[x] = (uint8_t)(dotPairs >> 16);
+  }
+}
+}  // namespace
+
+PixelcadePlaneEncoder::PixelcadePlaneEncoder(int width, int height, FrameUtil::ColorMatrix colorMatrix)
+{
+  m_width = width;
+  m_height = height;
+  m_encodeRowPair = nullptr;
+  m_pPrevious = nullptr;
+  m_hasPrevious = false;
+
+  if (height != 2 * kPairOffset) return;
+
+  const bool rgb = (colorMatrix == FrameUtil::ColorMatrix::Rgb);
+  if (width == 128)
+    m_encodeRowPair = rgb ? &EncodeRowPair<128, FrameUtil::ColorMatrix::Rgb>
+                          : &EncodeRowPair<128, FrameUtil::ColorMatrix::Rbg>;
+  else if (width == 64)
+    m_encodeRowPair =
+        rgb ? &EncodeRowPair<64, FrameUtil::ColorMatrix::Rgb> : &EncodeRowPair<64, FrameUtil::ColorMatrix::Rbg>;
+
+  if (m_encodeRowPair) m_pPrevious = new uint16_t[width * height];
+}
+
+PixelcadePlaneEncoder::~PixelcadePlaneEncoder() { delete[] m_pPrevious; }
+
+int PixelcadePlaneEncoder::Encode(const uint16_t* pFrame, uint8_t* pPlanes)
+{
+  if (!m_encodeRowPair) return 0;
+
+  const size_t rowBytes = m_width * sizeof(uint16_t);
+  int encoded = 0;
+  for (int row = 0; row < kPairOffset; row++)
+  {
+    const uint16_t* pTop = pFrame + row * m_width;
+    const uint16_t* pBottom = pTop + kPairOffset * m_width;
+    uint16_t* pPreviousTop = m_pPrevious + row * m_width;
+    uint16_t* pPreviousBottom = pPreviousTop + kPairOffset * m_width;
+
+    if (m_hasPrevious && memcmp(pTop, pPreviousTop, rowBytes) == 0 &&
+        memcmp(pBottom, pPreviousBottom, rowBytes) == 0)
+      continue;
+
+    m_encodeRowPair(pTop, pBottom, pPlanes, row);
+    memcpy(pPreviousTop, pTop, rowBytes);
+    memcpy(pPreviousBottom, pBottom, rowBytes);
+    encoded++;
+  }
+
+  m_hasPrevious = true;
+  return encoded;
+}
+
+}  // namespace DMDUtil
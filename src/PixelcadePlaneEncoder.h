@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+#include "FrameUtil.h"
+
+namespace DMDUtil
+{
+
+// Encodes RGB565 frames into the three bit planes of the Pixelcade v1 RGB LED matrix protocol, byte
+// for byte like FrameUtil::Helper::SplitIntoRgbPlanes(). The 128x32 and 64x32 panels in RGB and RBG
+// order have encoders specialized at compile time; each frame only re-encodes the row pairs that
+// changed since the previous one, the planes of the other rows are left as they are in the buffer.
+class PixelcadePlaneEncoder
+{
+ public:
+  PixelcadePlaneEncoder(int width, int height, FrameUtil::ColorMatrix colorMatrix);
+  ~PixelcadePlaneEncoder();
+  // Owns the previous frame.
+  PixelcadePlaneEncoder(const PixelcadePlaneEncoder&) = delete;
+  PixelcadePlaneEncoder& operator=(const PixelcadePlaneEncoder&) = delete;
+
+  // False for panel sizes without specialized encoder, the caller keeps using SplitIntoRgbPlanes().
+  bool IsSupported() const { return m_encodeRowPair != nullptr; }
+  // Writes the planes of pFrame to pPlanes, which must hold the planes of the previous frame unless
+  // Reset() was called. Returns the number of row pairs that were encoded.
+  int Encode(const uint16_t* pFrame, uint8_t* pPlanes);
+  // Makes the next Encode() write all rows.
+  void Reset() { m_hasPrevious = false; }
+
+ private:
+  using EncodeRowPairFn = void (*)(const uint16_t* pTop, const uint16_t* pBottom, uint8_t* pPlanes, int row);
+
+  int m_width;
+  int m_height;
+  EncodeRowPairFn m_encodeRowPair;
+  uint16_t* m_pPrevious;
+  bool m_hasPrevious;
+};
+
+}  // namespace DMDUtil
@@ -0,0 +1,85 @@
+#include "ProcessPool.h"
+
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#endif
+
+namespace DMDUtil
+{
+
+std::string QuoteCommandArgument(const std::string& arg)
+{
+#if defined(_WIN32)
+  // Follows the rules the C runtime uses to split the command line: a quote is escaped by a backslash, and
+  // backslashes are only special in front of a quote, where each of them has to be doubled.
+  std::string quoted = "\"";
+  size_t backslashes = 0;
+  for (char ch : arg)
+  {
+    if (ch == '\\')
+    {
+      backslashes++;
+      continue;
+    }
+    if (ch == '"')
+      quoted.append(backslashes * 2 + 1, '\\');
+    else
+      quoted.append(backslashes, '\\');
+    backslashes = 0;
+    quoted += ch;
+  }
+  // Backslashes at the end precede the closing quote.
+  quoted.append(backslashes * 2, '\\');
+  quoted += "\"";
+  return quoted;
+#else
+  std::string quoted = "'";
+  for (char ch : arg)
+  {
+    if (ch == '\'')
+      quoted += "'\\''";
+    else
+      quoted += ch;
+  }
+  quoted += "'";
+  return quoted;
+#endif
+}
+
+int RunCommand(const std::string& commandLine)
+{
+#if defined(_WIN32)
+  // cmd.exe strips the outer quotes of a command line that starts with a quoted program path.
+  return std::system(("\"" + commandLine + "\"").c_str());
+#else
+  const int status = std::system(commandLine.c_str());
+  if (status == -1) return -1;
+  if (WIFEXITED(status)) return WEXITSTATUS(status);
+  return 128 + (WIFSIGNALED(status) ? WTERMSIG(status) : 0);
+#endif
+}
+
+void RunJobPool(size_t jobCount, unsigned int workerCount, const std::function<void(size_t)>& runJob,
+                const std::atomic<bool>* pStop)
+{
+  std::atomic<size_t> nextJob{0};
+  auto worker = [&]()
+  {
+    while (!pStop || !pStop->load(std::memory_order_acquire))
+    {
+      const size_t jobIndex = nextJob.fetch_add(1);
+      if (jobIndex >= jobCount) break;
+      runJob(jobIndex);
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (unsigned int i = 0; i < workerCount; ++i) workers.emplace_back(worker);
+  for (std::thread& thread : workers) thread.join();
+}
+
+}  // namespace DMDUtil
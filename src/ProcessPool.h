@@ -0,0 +1,20 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace DMDUtil
+{
+
+// Quotes an argument for the shell std::system() runs, so paths with spaces or quotes reach the child unchanged.
+std::string QuoteCommandArgument(const std::string& arg);
+// Runs a shell command line and returns the exit code of the command, or -1 if it couldn't be started.
+int RunCommand(const std::string& commandLine);
+// Calls runJob(index) for every index below jobCount on workerCount threads, each thread takes the next job as
+// soon as its previous one returns. If pStop is set, no further job is started. Returns when all threads ended.
+void RunJobPool(size_t jobCount, unsigned int workerCount, const std::function<void(size_t)>& runJob,
+                const std::atomic<bool>* pStop = nullptr);
+
+}  // namespace DMDUtil
@@ -0,0 +1,171 @@
+// The part of the libserialport API used by PixelcadeDMD, implemented with plain termios calls. libserialport
+// reads the modem control lines when it opens a port, which pseudo terminals do not have, so the device
+// emulator links this file instead: the definitions in the executable take precedence over the shared
+// libserialport for the calls from libdmdutil, and PixelcadeDMD runs unchanged against an emulated device.
+// Baud rate and modem control settings are accepted and ignored, the emulator limits the rate itself.
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "libserialport.h"
+
+#define PTY_SERIAL_PORT_API __attribute__((visibility("default")))
+
+struct sp_port
+{
+  char* pName;
+  int fd;
+};
+
+namespace
+{
+thread_local std::string s_lastError;
+
+enum sp_return Fail(const char* pWhat)
+{
+  s_lastError = std::string(pWhat) + ": " + strerror(errno);
+  return SP_ERR_FAIL;
+}
+
+// Transfers up to count bytes, waiting at most timeoutMs for the port to become ready, 0 waits forever.
+// Returns the number of bytes transferred like the blocking libserialport calls.
+template <typename Transfer>
+enum sp_return BlockingTransfer(struct sp_port* pPort, size_t count, unsigned int timeoutMs, short events,
+                                Transfer transfer)
+{
+  if (!pPort || pPort->fd < 0) return SP_ERR_ARG;
+
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+  size_t done = 0;
+  while (done < count)
+  {
+    const ssize_t result = transfer(done);
+    if (result > 0)
+    {
+      done += result;
+      continue;
+    }
+    if (result < 0 && errno != EAGAIN && errno != EINTR) return Fail("transfer failed");
+
+    int waitMs = -1;
+    if (timeoutMs > 0)
+    {
+      waitMs = (int)std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now())
+                   .count();
+      if (waitMs <= 0) break;
+    }
+    pollfd pfd = {pPort->fd, events, 0};
+    if (poll(&pfd, 1, waitMs) < 0 && errno != EINTR) return Fail("poll failed");
+  }
+  return (enum sp_return)done;
+}
+}  // namespace
+
+PTY_SERIAL_PORT_API enum sp_return sp_get_port_by_name(const char* portname, struct sp_port** port_ptr)
+{
+  if (!portname || !port_ptr) return SP_ERR_ARG;
+
+  *port_ptr = new sp_port{strdup(portname), -1};
+  return SP_OK;
+}
+
+PTY_SERIAL_PORT_API void sp_free_port(struct sp_port* port)
+{
+  if (!port) return;
+
+  free(port->pName);
+  delete port;
+}
+
+// Searching ports is not supported, the emulated device is always opened by name.
+PTY_SERIAL_PORT_API enum sp_return sp_list_ports(struct sp_port*** list_ptr)
+{
+  if (!list_ptr) return SP_ERR_ARG;
+
+  *list_ptr = new sp_port*[1]{nullptr};
+  return SP_OK;
+}
+
+PTY_SERIAL_PORT_API void sp_free_port_list(struct sp_port** ports)
+{
+  if (!ports) return;
+
+  for (int i = 0; ports[i]; i++) sp_free_port(ports[i]);
+  delete[] ports;
+}
+
+PTY_SERIAL_PORT_API char* sp_get_port_name(const struct sp_port* port) { return port ? port->pName : nullptr; }
+
+PTY_SERIAL_PORT_API enum sp_return sp_open(struct sp_port* port, enum sp_mode flags)
+{
+  (void)flags;
+  if (!port) return SP_ERR_ARG;
+
+  port->fd = open(port->pName, O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if (port->fd < 0) return Fail("open failed");
+
+  termios tty;
+  if (tcgetattr(port->fd, &tty) != 0)
+  {
+    close(port->fd);
+    port->fd = -1;
+    return Fail("tcgetattr failed");
+  }
+  cfmakeraw(&tty);
+  tty.c_cflag |= CLOCAL | CREAD;
+  tcsetattr(port->fd, TCSANOW, &tty);
+  return SP_OK;
+}
+
+PTY_SERIAL_PORT_API enum sp_return sp_close(struct sp_port* port)
+{
+  if (!port || port->fd < 0) return SP_ERR_ARG;
+
+  close(port->fd);
+  port->fd = -1;
+  return SP_OK;
+}
+
+PTY_SERIAL_PORT_API enum sp_return sp_set_baudrate(struct sp_port*, int) { return SP_OK; }
+PTY_SERIAL_PORT_API enum sp_return sp_set_bits(struct sp_port*, int) { return SP_OK; }
+PTY_SERIAL_PORT_API enum sp_return sp_set_parity(struct sp_port*, enum sp_parity) { return SP_OK; }
+PTY_SERIAL_PORT_API enum sp_return sp_set_stopbits(struct sp_port*, int) { return SP_OK; }
+PTY_SERIAL_PORT_API enum sp_return sp_set_xon_xoff(struct sp_port*, enum sp_xonxoff) { return SP_OK; }
+PTY_SERIAL_PORT_API enum sp_return sp_set_dtr(struct sp_port*, enum sp_dtr) { return SP_OK; }
+PTY_SERIAL_PORT_API enum sp_return sp_set_rts(struct sp_port*, enum sp_rts) { return SP_OK; }
+
+PTY_SERIAL_PORT_API enum sp_return sp_blocking_read(struct sp_port* port, void* buf, size_t count,
+                                                    unsigned int timeout_ms)
+{
+  return BlockingTransfer(port, count, timeout_ms, POLLIN,
+                          [&](size_t done) { return read(port->fd, (uint8_t*)buf + done, count - done); });
+}
+
+PTY_SERIAL_PORT_API enum sp_return sp_blocking_write(struct sp_port* port, const void* buf, size_t count,
+                                                     unsigned int timeout_ms)
+{
+  return BlockingTransfer(port, count, timeout_ms, POLLOUT,
+                          [&](size_t done) { return write(port->fd, (const uint8_t*)buf + done, count - done); });
+}
+
+PTY_SERIAL_PORT_API enum sp_return sp_flush(struct sp_port* port, enum sp_buffer buffers)
+{
+  if (!port || port->fd < 0) return SP_ERR_ARG;
+
+  const int queue = buffers == SP_BUF_BOTH ? TCIOFLUSH : (buffers == SP_BUF_INPUT ? TCIFLUSH : TCOFLUSH);
+  if (tcflush(port->fd, queue) != 0) return Fail("tcflush failed");
+  return SP_OK;
+}
+
+PTY_SERIAL_PORT_API char* sp_last_error_message(void) { return strdup(s_lastError.c_str()); }
+
+PTY_SERIAL_PORT_API void sp_free_error_message(char* message) { free(message); }
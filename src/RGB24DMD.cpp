@@ -1,16 +1,24 @@
 #include "DMDUtil/RGB24DMD.h"
 
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <string>
 
-#include "DMDUtil/Config.h"
-#include "FrameUtil.h"
 #include "OutputFilters.h"
+#include "ScalePlan.h"
 
 namespace DMDUtil
 {
 
+// Kept out of the exported class, so its layout only carries one pointer.
+class RGB24DMDPrivate
+{
+ public:
+  std::atomic<int> roundedCorners{0};
+  OutputFilter outputFilter;
+};
+
 RGB24DMD::RGB24DMD(uint16_t width, uint16_t height)
 {
   m_width = width;
@@ -22,9 +30,19 @@ RGB24DMD::RGB24DMD(uint16_t width, uint16_t height)
   memset(m_pData, 0, m_length);
 
   m_update = false;
+  m_pPrivate = new RGB24DMDPrivate();
 }
 
-RGB24DMD::~RGB24DMD() { free(m_pData); }
+RGB24DMD::~RGB24DMD()
+{
+  free(m_pData);
+  delete m_pPrivate;
+}
+
+void RGB24DMD::SetRoundedCorners(int roundedCorners)
+{
+  m_pPrivate->roundedCorners.store(roundedCorners, std::memory_order_relaxed);
+}
 
 void RGB24DMD::Update(uint8_t* pData, uint16_t width, uint16_t height)
 {
@@ -38,23 +56,24 @@ void RGB24DMD::Update(uint8_t* pData, uint16_t width, uint16_t height)
   }
   else if (width == 128 && height == 16 && m_width == 128 && m_height == 32)
   {
-    FrameUtil::Helper::Center(m_pData, 128, 32, pData, 128, 16, 24);
+    ScalePlan::Get(ScaleOp::Center, 128, 16, 128, 32, 24)->Run(m_pData, pData);
     m_update = true;
   }
   else if (height == 64 && m_height == 32)
   {
-    FrameUtil::Helper::ScaleDown(m_pData, 128, 32, pData, width, height, 24);
+    ScalePlan::Get(ScaleOp::ScaleDown, width, height, 128, 32, 24)->Run(m_pData, pData);
     m_update = true;
   }
   else if (width == 128 && height == 32 && m_width == 256 && m_height == 64)
   {
-    FrameUtil::Helper::ScaleUp(m_pData, pData, width, height, 24);
+    ScalePlan::Get(ScaleOp::ScaleUp, width, height, 256, 64, 24)->Run(m_pData, pData);
     m_update = true;
   }
 
   if (m_update)
   {
-    ApplyRoundedCornersRGB24(m_pData, m_width, m_height, Config::GetInstance()->GetRoundedCorners());
+    m_pPrivate->outputFilter.Configure(m_width, m_height, m_pPrivate->roundedCorners.load(std::memory_order_relaxed));
+    m_pPrivate->outputFilter.ApplyRGB24(m_pData);
   }
 }
 
@@ -0,0 +1,266 @@
+#include "ScalePlan.h"
+
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
+#include "FrameUtil.h"
+
+namespace DMDUtil
+{
+
+namespace
+{
+constexpr int32_t kZeroPixel = -1;
+
+using PlanKey = std::tuple<ScaleOp, uint16_t, uint16_t, uint16_t, uint16_t, uint8_t>;
+
+std::mutex s_plansMutex;
+std::map<PlanKey, std::unique_ptr<ScalePlan>> s_plans;
+
+// Plans are never freed, so every sink thread keeps the ones it used last and only takes the lock of the shared
+// map when its frame size changes. A sink alternates between a handful of sizes at most.
+constexpr int kThreadCacheSize = 4;
+
+struct ThreadCacheEntry
+{
+  PlanKey key;
+  const ScalePlan* pPlan = nullptr;
+};
+
+thread_local ThreadCacheEntry t_cache[kThreadCacheSize];
+thread_local int t_cacheNext = 0;
+
+// Fills a frame with random pixels, every second one black if sparse is set. Scale downs that pick
+// lit pixels or average a block then disagree with the probed source pixel.
+void FillRandom(std::vector<uint8_t>& frame, int bytes, uint32_t seed, bool sparse)
+{
+  for (size_t i = 0; i < frame.size(); i += bytes)
+  {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    for (int b = 0; b < bytes; b++) frame[i + b] = (sparse && (seed & 0x100)) ? 0 : (uint8_t)(seed >> (8 * b));
+  }
+}
+
+template <int Bytes>
+inline void CopyPixel(uint8_t* pDst, const uint8_t* pSrc)
+{
+  memcpy(pDst, pSrc, Bytes);
+}
+
+template <int Bytes>
+void DoublePixels(uint8_t* pDst, const uint8_t* pSrc, uint32_t count)
+{
+  for (uint32_t i = 0; i < count; i += 2, pSrc += Bytes, pDst += 2 * Bytes)
+  {
+    CopyPixel<Bytes>(pDst, pSrc);
+    CopyPixel<Bytes>(pDst + Bytes, pSrc);
+  }
+}
+}  // namespace
+
+const ScalePlan* ScalePlan::Get(ScaleOp op, uint16_t srcWidth, uint16_t srcHeight, uint16_t dstWidth,
+                                uint16_t dstHeight, uint8_t bits)
+{
+  if (op == ScaleOp::ScaleUp)
+  {
+    dstWidth = srcWidth * 2;
+    dstHeight = srcHeight * 2;
+  }
+
+  const PlanKey key(op, srcWidth, srcHeight, dstWidth, dstHeight, bits);
+  for (const ThreadCacheEntry& entry : t_cache)
+  {
+    if (entry.pPlan && entry.key == key) return entry.pPlan;
+  }
+
+  std::lock_guard<std::mutex> lock(s_plansMutex);
+  std::unique_ptr<ScalePlan>& pPlan = s_plans[key];
+  if (!pPlan) pPlan.reset(new ScalePlan(op, srcWidth, srcHeight, dstWidth, dstHeight, bits));
+
+  ThreadCacheEntry& entry = t_cache[t_cacheNext];
+  t_cacheNext = (t_cacheNext + 1) % kThreadCacheSize;
+  entry.key = key;
+  entry.pPlan = pPlan.get();
+  return pPlan.get();
+}
+
+ScalePlan::ScalePlan(ScaleOp op, uint16_t srcWidth, uint16_t srcHeight, uint16_t dstWidth, uint16_t dstHeight,
+                     uint8_t bits)
+{
+  m_op = op;
+  m_srcWidth = srcWidth;
+  m_srcHeight = srcHeight;
+  m_dstWidth = dstWidth;
+  m_dstHeight = dstHeight;
+  m_bits = bits;
+  m_bytes = bits / 8;
+  m_mapped = BuildSpans();
+}
+
+void ScalePlan::Run(uint8_t* pDst, const uint8_t* pSrc) const
+{
+  if (m_mapped)
+    RunMapped(pDst, pSrc);
+  else
+    Apply(pDst, pSrc);
+}
+
+void ScalePlan::Apply(uint8_t* pDst, const uint8_t* pSrc) const
+{
+  switch (m_op)
+  {
+    case ScaleOp::Center:
+      FrameUtil::Helper::Center(pDst, m_dstWidth, m_dstHeight, pSrc, m_srcWidth, m_srcHeight, m_bits);
+      break;
+
+    case ScaleOp::ScaleDown:
+      FrameUtil::Helper::ScaleDown(pDst, m_dstWidth, m_dstHeight, pSrc, m_srcWidth, m_srcHeight, m_bits);
+      break;
+
+    case ScaleOp::ScaleUp:
+      FrameUtil::Helper::ScaleUp(pDst, pSrc, m_srcWidth, m_srcHeight, m_bits);
+      break;
+
+    case ScaleOp::ScaleUpDown:
+    {
+      thread_local std::vector<uint8_t> upscaled;
+      upscaled.resize(m_srcWidth * 2 * m_srcHeight * 2 * m_bytes);
+      FrameUtil::Helper::ScaleUp(upscaled.data(), pSrc, m_srcWidth, m_srcHeight, m_bits);
+      FrameUtil::Helper::ScaleDown(pDst, m_dstWidth, m_dstHeight, upscaled.data(), m_srcWidth * 2, m_srcHeight * 2,
+                                   m_bits);
+      break;
+    }
+
+    case ScaleOp::CenterIndexed:
+      FrameUtil::Helper::CenterIndexed(pDst, m_dstWidth, m_dstHeight, pSrc, m_srcWidth, m_srcHeight);
+      break;
+
+    case ScaleOp::ScaleDownIndexed:
+      FrameUtil::Helper::ScaleDownIndexed(pDst, m_dstWidth, m_dstHeight, pSrc, m_srcWidth, m_srcHeight);
+      break;
+
+    case ScaleOp::ScaleDownPUP:
+      FrameUtil::Helper::ScaleDownPUP(pDst, m_dstWidth, m_dstHeight, pSrc, m_srcWidth, m_srcHeight);
+      break;
+  }
+}
+
+bool ScalePlan::BuildSpans()
+{
+  if (m_bytes < 1 || m_bytes > 3) return false;
+
+  const int srcPixels = m_srcWidth * m_srcHeight;
+  const int dstPixels = m_dstWidth * m_dstHeight;
+  std::vector<uint8_t> src(srcPixels * m_bytes);
+  std::vector<uint8_t> dst(dstPixels * m_bytes);
+
+  // Number every source pixel, starting at 1 so that 0 stays black, and spread the 24 bit numbers over
+  // as many probe frames as needed for the pixel size.
+  std::vector<int32_t> map(dstPixels, 0);
+  const int bitsPerProbe = 8 * m_bytes;
+  for (int shift = 0; shift < 24; shift += bitsPerProbe)
+  {
+    for (int i = 0; i < srcPixels; i++)
+    {
+      const uint32_t value = (uint32_t)(i + 1) >> shift;
+      for (int b = 0; b < m_bytes; b++) src[i * m_bytes + b] = (uint8_t)(value >> (8 * b));
+    }
+    memset(dst.data(), 0xAA, dst.size());
+    Apply(dst.data(), src.data());
+
+    for (int i = 0; i < dstPixels; i++)
+    {
+      uint32_t value = 0;
+      for (int b = 0; b < m_bytes; b++) value |= (uint32_t)dst[i * m_bytes + b] << (8 * b);
+      if (shift + bitsPerProbe > 24) value &= (1u << (24 - shift)) - 1;
+      map[i] |= (int32_t)(value << shift);
+    }
+  }
+
+  for (int i = 0; i < dstPixels; i++)
+  {
+    map[i] -= 1;
+    if (map[i] >= srcPixels) return false;
+  }
+
+  // Compress the map into spans, each reading one contiguous range of source pixels.
+  for (int i = 0; i < dstPixels;)
+  {
+    Span span = {(uint32_t)i, 0, 1, SpanKind::Copy};
+    if (map[i] == kZeroPixel)
+    {
+      span.kind = SpanKind::Zero;
+      while (i + (int)span.count < dstPixels && map[i + span.count] == kZeroPixel) span.count++;
+    }
+    else if (i + 3 < dstPixels && map[i + 1] == map[i] && map[i + 2] == map[i] + 1 && map[i + 3] == map[i] + 1)
+    {
+      span.kind = SpanKind::Double;
+      span.src = map[i];
+      span.count = 4;
+      while (i + (int)span.count + 1 < dstPixels && map[i + span.count] == map[i] + (int32_t)span.count / 2 &&
+             map[i + span.count + 1] == map[i + span.count])
+        span.count += 2;
+    }
+    else
+    {
+      span.src = map[i];
+      while (i + (int)span.count < dstPixels && map[i + span.count] == map[i] + (int32_t)span.count) span.count++;
+    }
+    m_spans.push_back(span);
+    i += span.count;
+  }
+
+  // The spans have to reproduce FrameUtil for arbitrary frames, not only for the numbered probes.
+  std::vector<uint8_t> expected(dst.size());
+  for (uint32_t seed = 1; seed <= 3; seed++)
+  {
+    FillRandom(src, m_bytes, 0x9E3779B9u * seed, seed == 2);
+    memset(expected.data(), 0x55, expected.size());
+    Apply(expected.data(), src.data());
+    memset(dst.data(), 0x55, dst.size());
+    RunMapped(dst.data(), src.data());
+    if (memcmp(expected.data(), dst.data(), dst.size()) != 0)
+    {
+      m_spans.clear();
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void ScalePlan::RunMapped(uint8_t* pDst, const uint8_t* pSrc) const
+{
+  const int bytes = m_bytes;
+  for (const Span& span : m_spans)
+  {
+    uint8_t* pSpanDst = pDst + span.dst * bytes;
+    const uint8_t* pSpanSrc = pSrc + span.src * bytes;
+    switch (span.kind)
+    {
+      case SpanKind::Zero:
+        memset(pSpanDst, 0, span.count * bytes);
+        break;
+
+      case SpanKind::Copy:
+        memcpy(pSpanDst, pSpanSrc, span.count * bytes);
+        break;
+
+      case SpanKind::Double:
+        if (bytes == 3)
+          DoublePixels<3>(pSpanDst, pSpanSrc, span.count);
+        else if (bytes == 2)
+          DoublePixels<2>(pSpanDst, pSpanSrc, span.count);
+        else
+          DoublePixels<1>(pSpanDst, pSpanSrc, span.count);
+        break;
+    }
+  }
+}
+
+}  // namespace DMDUtil
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace DMDUtil
+{
+
+enum class ScaleOp
+{
+  Center,            // FrameUtil::Helper::Center()
+  ScaleDown,         // FrameUtil::Helper::ScaleDown()
+  ScaleUp,           // FrameUtil::Helper::ScaleUp(), the destination is twice the source size
+  ScaleUpDown,       // ScaleUp() followed by ScaleDown() to the destination size
+  CenterIndexed,     // FrameUtil::Helper::CenterIndexed()
+  ScaleDownIndexed,  // FrameUtil::Helper::ScaleDownIndexed()
+  ScaleDownPUP,      // FrameUtil::Helper::ScaleDownPUP()
+};
+
+// Frame scaling for one combination of operation, source size, destination size and bits per pixel.
+// On first use the FrameUtil operation is run on probe frames to find out which source pixel ends up in
+// each destination pixel. If that mapping holds for random frames, too, it is stored as spans of zero
+// fills, copies and doubled pixels and replayed for every frame; ScaleUp() followed by ScaleDown() then
+// becomes a single pass without temporary frame. Operations that depend on the pixel values, like
+// averaging scale downs, keep calling FrameUtil.
+class ScalePlan
+{
+ public:
+  // Returns the cached plan, building it on first use. bits is 24 for RGB24, 16 for RGB565 and 8 for
+  // the indexed operations. Repeated calls of a thread with the same arguments don't take a lock.
+  static const ScalePlan* Get(ScaleOp op, uint16_t srcWidth, uint16_t srcHeight, uint16_t dstWidth,
+                              uint16_t dstHeight, uint8_t bits);
+
+  void Run(uint8_t* pDst, const uint8_t* pSrc) const;
+  bool IsMapped() const { return m_mapped; }
+
+ private:
+  enum class SpanKind : uint8_t
+  {
+    Zero,
+    Copy,
+    Double,  // every source pixel is written to two adjacent destination pixels
+  };
+
+  struct Span
+  {
+    uint32_t dst;
+    uint32_t src;
+    uint32_t count;  // destination pixels
+    SpanKind kind;
+  };
+
+  ScalePlan(ScaleOp op, uint16_t srcWidth, uint16_t srcHeight, uint16_t dstWidth, uint16_t dstHeight, uint8_t bits);
+
+  void Apply(uint8_t* pDst, const uint8_t* pSrc) const;
+  bool BuildSpans();
+  void RunMapped(uint8_t* pDst, const uint8_t* pSrc) const;
+
+  ScaleOp m_op;
+  uint16_t m_srcWidth;
+  uint16_t m_srcHeight;
+  uint16_t m_dstWidth;
+  uint16_t m_dstHeight;
+  uint8_t m_bits;
+  int m_bytes;
+  bool m_mapped;
+  std::vector<Span> m_spans;
+};
+
+}  // namespace DMDUtil
@@ -0,0 +1,102 @@
+#include "SerumCache.h"
+
+#include <cctype>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+namespace DMDUtil
+{
+
+namespace
+{
+namespace fs = std::filesystem;
+
+bool EqualsIgnoreCase(const std::string& a, const std::string& b)
+{
+  if (a.size() != b.size()) return false;
+  for (size_t i = 0; i < a.size(); i++)
+  {
+    if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) return false;
+  }
+  return true;
+}
+
+bool GetSourceStamp(const std::string& path, uint64_t& size, int64_t& mtime)
+{
+  std::error_code ec;
+  size = fs::file_size(path, ec);
+  if (ec) return false;
+  const fs::file_time_type writeTime = fs::last_write_time(path, ec);
+  if (ec) return false;
+  mtime = static_cast<int64_t>(writeTime.time_since_epoch().count());
+  return true;
+}
+}  // namespace
+
+SerumCacheState CheckSerumCache(const std::string& altColorPath, const std::string& romName, SerumCacheFiles& files)
+{
+  files = SerumCacheFiles();
+  const fs::path dir = fs::path(altColorPath) / romName;
+
+  std::string crz;
+  std::string crom;
+  std::error_code ec;
+  for (const auto& entry : fs::directory_iterator(dir, ec))
+  {
+    if (!entry.is_regular_file(ec)) continue;
+    const std::string name = entry.path().filename().string();
+    if (EqualsIgnoreCase(name, romName + ".cRZ"))
+      crz = entry.path().string();
+    else if (EqualsIgnoreCase(name, romName + ".cROM"))
+      crom = entry.path().string();
+    else if (EqualsIgnoreCase(name, romName + ".cROMc"))
+      files.cache = entry.path().string();
+  }
+
+  files.source = !crz.empty() ? crz : crom;
+  if (files.source.empty()) return SerumCacheState::NoSource;
+  if (files.cache.empty())
+  {
+    files.cache = (dir / (romName + ".cROMc")).string();
+    return SerumCacheState::Missing;
+  }
+
+  uint64_t sourceSize = 0;
+  int64_t sourceMtime = 0;
+  if (!GetSourceStamp(files.source, sourceSize, sourceMtime)) return SerumCacheState::Fresh;
+
+  std::ifstream stamp(files.cache + ".stamp");
+  uint64_t stampSize = 0;
+  int64_t stampMtime = 0;
+  if (stamp >> stampSize >> stampMtime)
+    return (stampSize == sourceSize && stampMtime == sourceMtime) ? SerumCacheState::Fresh : SerumCacheState::Stale;
+
+  const fs::file_time_type cacheTime = fs::last_write_time(files.cache, ec);
+  if (ec) return SerumCacheState::Fresh;
+  return (cacheTime < fs::last_write_time(files.source, ec)) ? SerumCacheState::Stale : SerumCacheState::Fresh;
+}
+
+bool RemoveSerumCache(const SerumCacheFiles& files)
+{
+  std::error_code ec;
+  fs::remove(files.cache + ".stamp", ec);
+  return fs::remove(files.cache, ec) && !ec;
+}
+
+bool WriteSerumCacheStamp(const SerumCacheFiles& files)
+{
+  uint64_t sourceSize = 0;
+  int64_t sourceMtime = 0;
+  if (!GetSourceStamp(files.source, sourceSize, sourceMtime)) return false;
+
+  std::error_code ec;
+  if (!fs::exists(files.cache, ec)) return false;
+
+  std::ofstream stamp(files.cache + ".stamp", std::ios::trunc);
+  stamp << sourceSize << " " << sourceMtime << "\n";
+  return static_cast<bool>(stamp);
+}
+
+}  // namespace DMDUtil
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+
+namespace DMDUtil
+{
+
+enum class SerumCacheState
+{
+  NoSource,  // No cRZ or cROM, a cROMc alone is used as is.
+  Missing,
+  Stale,
+  Fresh,
+};
+
+struct SerumCacheFiles
+{
+  std::string source;
+  std::string cache;
+};
+
+// Compares <rom>.cROMc against the cRZ or cROM it was generated from. The size and modification time
+// of the source are kept in <rom>.cROMc.stamp; a cROMc without stamp is stale if it is older than the source.
+SerumCacheState CheckSerumCache(const std::string& altColorPath, const std::string& romName, SerumCacheFiles& files);
+// Deletes a stale cROMc, so libserum loads the source again.
+bool RemoveSerumCache(const SerumCacheFiles& files);
+// Records the source the cROMc was just generated from.
+bool WriteSerumCacheStamp(const SerumCacheFiles& files);
+
+}  // namespace DMDUtil
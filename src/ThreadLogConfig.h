@@ -0,0 +1,14 @@
+#pragma once
+
+#include <atomic>
+
+#include "DMDUtil/Config.h"
+
+namespace DMDUtil
+{
+
+// Makes Log() calls of the current thread use the log level and callback of the referenced configuration instead of
+// the global Config. Used by the threads of a DMD that has its own configuration, nullptr restores the default.
+void SetThreadLogConfig(const std::atomic<const Config*>* pConfig);
+
+}  // namespace DMDUtil
@@ -0,0 +1,56 @@
+#include "TimingHistogram.h"
+
+namespace DMDUtil
+{
+
+int TimingHistogram::BucketIndex(uint32_t us)
+{
+  if (us < (2u << kSubBucketBits)) return (int)us;
+
+  int msb = 31;
+  while (!(us & (1u << msb))) msb--;
+  int shift = msb - kSubBucketBits;
+  return (2 << kSubBucketBits) + ((shift - 1) << kSubBucketBits) + (int)((us >> shift) & ((1u << kSubBucketBits) - 1));
+}
+
+uint32_t TimingHistogram::BucketUpperBound(int index)
+{
+  if (index < (2 << kSubBucketBits)) return (uint32_t)index;
+
+  int shift = ((index - (2 << kSubBucketBits)) >> kSubBucketBits) + 1;
+  uint64_t sub = (uint64_t)(index & ((1 << kSubBucketBits) - 1)) + (1u << kSubBucketBits);
+  uint64_t upper = ((sub + 1) << shift) - 1;
+  return upper > UINT32_MAX ? UINT32_MAX : (uint32_t)upper;
+}
+
+void TimingHistogram::Record(uint32_t us)
+{
+  m_buckets[BucketIndex(us)]++;
+  m_count++;
+  m_total += us;
+  if (us < m_min) m_min = us;
+  if (us > m_max) m_max = us;
+}
+
+uint32_t TimingHistogram::Percentile(double quantile) const
+{
+  if (m_count == 0) return 0;
+
+  uint64_t rank = (uint64_t)(quantile * (double)m_count + 0.5);
+  if (rank < 1) rank = 1;
+  if (rank > m_count) rank = m_count;
+
+  uint64_t seen = 0;
+  for (int i = 0; i < kBucketCount; i++)
+  {
+    seen += m_buckets[i];
+    if (seen >= rank)
+    {
+      uint32_t upper = BucketUpperBound(i);
+      return upper > m_max ? m_max : upper;
+    }
+  }
+  return m_max;
+}
+
+}  // namespace DMDUtil
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+
+namespace DMDUtil
+{
+
+// Log-linear latency histogram: exact up to 15 us, then 8 buckets per power of two, so every bucket
+// is at most 1/8 of its value wide. Recording is a few shifts and an increment.
+class TimingHistogram
+{
+ public:
+  void Record(uint32_t us);
+  // Upper bound of the bucket that contains the given quantile, clamped to the largest value seen.
+  uint32_t Percentile(double quantile) const;
+
+  uint64_t GetCount() const { return m_count; }
+  uint64_t GetTotal() const { return m_total; }
+  uint32_t GetMin() const { return m_count ? m_min : 0; }
+  uint32_t GetMax() const { return m_max; }
+
+ private:
+  static constexpr int kSubBucketBits = 3;
+  static constexpr int kBucketCount = 240;
+
+  static int BucketIndex(uint32_t us);
+  static uint32_t BucketUpperBound(int index);
+
+  uint32_t m_buckets[kBucketCount] = {0};
+  uint64_t m_count = 0;
+  uint64_t m_total = 0;
+  uint32_t m_min = UINT32_MAX;
+  uint32_t m_max = 0;
+};
+
+}  // namespace DMDUtil
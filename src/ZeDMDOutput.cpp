@@ -0,0 +1,130 @@
+#include "ZeDMDOutput.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "ZeDMD.h"
+
+namespace DMDUtil
+{
+
+ZeDMDOutput::ZeDMDOutput(ZeDMD* pZeDMD, const char* pName, int roundedCorners, std::function<void()> onRendered)
+    : m_pZeDMD(pZeDMD), m_name(pName), m_roundedCorners(roundedCorners), m_onRendered(std::move(onRendered))
+{
+  m_panelWidth = m_pZeDMD->GetWidth();
+  m_panelHeight = m_pZeDMD->GetHeight();
+  for (int i = 0; i < 3; i++) m_pSlots[i] = new Slot();
+
+  m_pThread = new std::thread(&ZeDMDOutput::Run, this);
+}
+
+ZeDMDOutput::~ZeDMDOutput()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_running = false;
+  }
+  m_cv.notify_all();
+
+  m_pThread->join();
+  delete m_pThread;
+
+  for (int i = 0; i < 3; i++) delete m_pSlots[i];
+  delete m_pZeDMD;
+}
+
+void ZeDMDOutput::Submit(ZeDMDFrameFormat format, uint16_t width, uint16_t height, const void* pData,
+                         int roundedCorners, bool paced, uint64_t sequence)
+{
+  if (!paced)
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [&]() { return !m_running || !m_frameReady; });
+  }
+
+  // The write slot belongs to the caller until it is swapped.
+  Slot* pSlot = m_pSlots[m_writeSlot];
+  pSlot->format = format;
+  pSlot->width = width;
+  pSlot->height = height;
+  pSlot->roundedCorners = m_roundedCorners >= 0 ? m_roundedCorners : roundedCorners;
+  pSlot->paced = paced;
+  pSlot->sequence = sequence;
+  memcpy(pSlot->data, pData, (size_t)width * height * (format == ZeDMDFrameFormat::RGB888 ? 3 : 2));
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::swap(m_writeSlot, m_readySlot);
+    m_frameReady = true;
+    m_submittedSequence.store(sequence, std::memory_order_release);
+  }
+  m_cv.notify_all();
+}
+
+bool ZeDMDOutput::HasRendered(uint64_t sequence) const
+{
+  const uint64_t submitted = m_submittedSequence.load(std::memory_order_acquire);
+  return m_renderedSequence.load(std::memory_order_acquire) >= std::min(sequence, submitted);
+}
+
+void ZeDMDOutput::Run()
+{
+  while (true)
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [&]() { return !m_running || m_frameReady; });
+    // Frames submitted while the device is busy replace the ready one, the newest is rendered once it is free.
+    if (m_running && m_pSlots[m_readySlot]->paced)
+      m_cv.wait_until(lock, m_framePacer.GetNextSend(), [&]() { return !m_running; });
+    if (!m_running) return;
+
+    std::swap(m_readySlot, m_renderSlot);
+    m_frameReady = false;
+    lock.unlock();
+    m_cv.notify_all();
+
+    Render(m_pSlots[m_renderSlot]);
+    // Superseded frames are covered by the newer one, so fences wait for the device write of the last frame.
+    m_renderedSequence.store(m_pSlots[m_renderSlot]->sequence, std::memory_order_release);
+    m_onRendered();
+  }
+}
+
+void ZeDMDOutput::Render(Slot* pSlot)
+{
+  if (pSlot->width != m_width || pSlot->height != m_height)
+  {
+    m_width = pSlot->width;
+    m_height = pSlot->height;
+    // Activate the correct scaling mode.
+    m_pZeDMD->SetFrameSize(m_width, m_height);
+  }
+
+  m_outputFilter.Configure(m_width, m_height, pSlot->roundedCorners);
+  size_t size = (size_t)m_width * m_height;
+  if (pSlot->format == ZeDMDFrameFormat::RGB888)
+  {
+    m_outputFilter.ApplyRGB24(pSlot->data);
+    size *= 3;
+  }
+  else
+  {
+    m_outputFilter.ApplyRGB565((uint16_t*)pSlot->data);
+    size *= 2;
+  }
+
+  // libzedmd has its own update detection, only frames equal to the last one rendered are skipped here.
+  if (!m_framePacer.IsNewContent(pSlot->data, size)) return;
+
+  // libzedmd returns once it has taken the frame, the time that takes is the cost of a frame.
+  const FramePacer::Clock::time_point start = FramePacer::Clock::now();
+  if (pSlot->format == ZeDMDFrameFormat::RGB888)
+    m_pZeDMD->RenderRgb888(pSlot->data);
+  else
+    m_pZeDMD->RenderRgb565((uint16_t*)pSlot->data);
+  m_framePacer.RecordCost(
+      std::chrono::duration_cast<std::chrono::microseconds>(FramePacer::Clock::now() - start).count());
+  m_framePacer.RecordSend(start);
+}
+
+}  // namespace DMDUtil
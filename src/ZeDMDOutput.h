@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "FramePacer.h"
+#include "OutputFilters.h"
+
+class ZeDMD;
+
+namespace DMDUtil
+{
+
+enum class ZeDMDFrameFormat
+{
+  RGB888,
+  RGB565
+};
+
+// One ZeDMD with its own render thread. DMD::ZeDMDThread() converts each frame once and submits it to every
+// output, which applies its own rounded corners and renders at the rate its device takes frames, so a slow
+// WiFi panel doesn't hold back a USB one. A submitted frame that is still waiting is replaced by the next one.
+class ZeDMDOutput
+{
+ public:
+  // Takes ownership of the opened ZeDMD. roundedCorners -1 follows the radius passed to Submit(). onRendered is called
+  // on the render thread once a frame went to the device.
+  ZeDMDOutput(ZeDMD* pZeDMD, const char* pName, int roundedCorners, std::function<void()> onRendered);
+  ~ZeDMDOutput();
+
+  // Copies the frame. Unpaced, the call waits until the output took the previous frame, so none is replaced,
+  // and every frame is rendered right away. sequence is the ring sequence of the frame.
+  void Submit(ZeDMDFrameFormat format, uint16_t width, uint16_t height, const void* pData, int roundedCorners,
+              bool paced, uint64_t sequence);
+  // True once the device got every frame submitted up to the ring sequence, or a newer one that replaced it.
+  bool HasRendered(uint64_t sequence) const;
+
+  ZeDMD* GetZeDMD() const { return m_pZeDMD; }
+  const char* GetName() const { return m_name.c_str(); }
+  uint16_t GetWidth() const { return m_panelWidth; }
+  uint16_t GetHeight() const { return m_panelHeight; }
+  const FramePacer& GetFramePacer() const { return m_framePacer; }
+
+ private:
+  struct Slot
+  {
+    ZeDMDFrameFormat format = ZeDMDFrameFormat::RGB888;
+    uint16_t width = 0;
+    uint16_t height = 0;
+    int roundedCorners = 0;
+    bool paced = false;
+    uint64_t sequence = 0;
+    uint8_t data[256 * 64 * 3];
+  };
+
+  void Run();
+  void Render(Slot* pSlot);
+
+  ZeDMD* m_pZeDMD;
+  std::string m_name;
+  int m_roundedCorners;
+  uint16_t m_panelWidth;
+  uint16_t m_panelHeight;
+  // Frame size last set on the device.
+  uint16_t m_width = 0;
+  uint16_t m_height = 0;
+  OutputFilter m_outputFilter;
+  FramePacer m_framePacer;
+  std::function<void()> m_onRendered;
+  std::atomic<uint64_t> m_submittedSequence{0};
+  std::atomic<uint64_t> m_renderedSequence{0};
+
+  // Triple buffer like PixelcadeDMD: Submit() fills the write slot and swaps it with the ready slot, the render
+  // thread swaps the ready slot with the render slot.
+  Slot* m_pSlots[3];
+  int m_writeSlot = 0;
+  int m_readySlot = 1;
+  int m_renderSlot = 2;
+  bool m_frameReady = false;
+  bool m_running = true;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::thread* m_pThread;
+};
+
+}  // namespace DMDUtil
@@ -0,0 +1,178 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "FrameUtil.h"
+#include "PixelcadePlaneEncoder.h"
+#include "cargs.h"
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+struct Panel
+{
+  int width;
+  int height;
+  FrameUtil::ColorMatrix colorMatrix;
+  const char* name;
+};
+
+// Frames of a DMD scene: a static background with a band of changedRows rows that moves down one row
+// per frame. changedRows equal to the height changes every pixel of every frame.
+std::vector<std::vector<uint16_t>> GenerateFrames(const Panel& panel, int frameCount, int changedRows)
+{
+  uint32_t seed = 0x2545F491;
+  auto next = [&seed]()
+  {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+  };
+
+  const int length = panel.width * panel.height;
+  std::vector<std::vector<uint16_t>> frames(frameCount, std::vector<uint16_t>(length));
+  for (int i = 0; i < length; i++) frames[0][i] = (uint16_t)next();
+  for (int f = 1; f < frameCount; f++)
+  {
+    frames[f] = frames[f - 1];
+    for (int r = 0; r < changedRows; r++)
+    {
+      const int y = (f + r) % panel.height;
+      for (int x = 0; x < panel.width; x++) frames[f][y * panel.width + x] = (uint16_t)next();
+    }
+  }
+  return frames;
+}
+
+double NsPerFrame(Clock::duration elapsed, int frameCount)
+{
+  return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / frameCount;
+}
+
+// Encodes all frames with SplitIntoRgbPlanes() and with the plane encoder, once forced to encode full
+// frames and once incrementally. Returns false if the encoder output differs from SplitIntoRgbPlanes().
+bool RunBenchmark(const Panel& panel, int frameCount, int changedRows, int iterations)
+{
+  const std::vector<std::vector<uint16_t>> frames = GenerateFrames(panel, frameCount, changedRows);
+  const int length = panel.width * panel.height;
+  const int planesSize = length * 3 / 2;
+  std::vector<uint8_t> reference(planesSize);
+  std::vector<uint8_t> planes(planesSize);
+
+  DMDUtil::PixelcadePlaneEncoder encoder(panel.width, panel.height, panel.colorMatrix);
+  for (int f = 0; f < frameCount; f++)
+  {
+    FrameUtil::Helper::SplitIntoRgbPlanes(frames[f].data(), length, panel.width, panel.height / 2, reference.data(),
+                                          panel.colorMatrix);
+    encoder.Encode(frames[f].data(), planes.data());
+    if (memcmp(reference.data(), planes.data(), planesSize) != 0)
+    {
+      std::cerr << "Error: " << panel.name << " frame " << f << " differs from SplitIntoRgbPlanes\n";
+      return false;
+    }
+  }
+
+  Clock::duration splitTime{};
+  Clock::duration fullTime{};
+  Clock::duration incrementalTime{};
+  uint64_t encodedRows = 0;
+  for (int i = 0; i < iterations; i++)
+  {
+    Clock::time_point start = Clock::now();
+    for (const std::vector<uint16_t>& frame : frames)
+      FrameUtil::Helper::SplitIntoRgbPlanes(frame.data(), length, panel.width, panel.height / 2, reference.data(),
+                                            panel.colorMatrix);
+    splitTime += Clock::now() - start;
+
+    start = Clock::now();
+    for (const std::vector<uint16_t>& frame : frames)
+    {
+      encoder.Reset();
+      encoder.Encode(frame.data(), planes.data());
+    }
+    fullTime += Clock::now() - start;
+
+    encoder.Reset();
+    start = Clock::now();
+    for (const std::vector<uint16_t>& frame : frames) encodedRows += encoder.Encode(frame.data(), planes.data());
+    incrementalTime += Clock::now() - start;
+  }
+
+  const int totalFrames = frameCount * iterations;
+  const double splitNs = NsPerFrame(splitTime, totalFrames);
+  const double fullNs = NsPerFrame(fullTime, totalFrames);
+  const double incrementalNs = NsPerFrame(incrementalTime, totalFrames);
+  printf("%-10s changed rows %2d: split %7.0f ns, full %7.0f ns (%.1fx), incremental %7.0f ns (%.1fx, %.1f pairs)\n",
+         panel.name, changedRows, splitNs, fullNs, splitNs / fullNs, incrementalNs, splitNs / incrementalNs,
+         (double)encodedRows / totalFrames);
+  return true;
+}
+}  // namespace
+
+static struct cag_option options[] = {
+    {.identifier = 'f',
+     .access_letters = "f",
+     .access_name = "frames",
+     .value_name = "N",
+     .description = "Frames per scene (default: 256)"},
+    {.identifier = 'i',
+     .access_letters = "i",
+     .access_name = "iterations",
+     .value_name = "N",
+     .description = "Passes over the frames (default: 20)"},
+    {.identifier = 'h', .access_letters = "h", .access_name = "help", .description = "Show help"}};
+
+int main(int argc, char* argv[])
+{
+  int frameCount = 256;
+  int iterations = 20;
+
+  cag_option_context cagContext;
+  cag_option_init(&cagContext, options, CAG_ARRAY_SIZE(options), argc, argv);
+  while (cag_option_fetch(&cagContext))
+  {
+    const char id = cag_option_get_identifier(&cagContext);
+    switch (id)
+    {
+      case 'f':
+      {
+        const char* valueStr = cag_option_get_value(&cagContext);
+        if (valueStr && atoi(valueStr) > 0) frameCount = atoi(valueStr);
+        break;
+      }
+      case 'i':
+      {
+        const char* valueStr = cag_option_get_value(&cagContext);
+        if (valueStr && atoi(valueStr) > 0) iterations = atoi(valueStr);
+        break;
+      }
+      case 'h':
+        std::cerr << "Usage: " << argv[0] << " [options]\n";
+        cag_option_print(options, CAG_ARRAY_SIZE(options), stdout);
+        return 0;
+      default:
+        break;
+    }
+  }
+
+  const Panel panels[] = {{128, 32, FrameUtil::ColorMatrix::Rgb, "128x32 RGB"},
+                          {128, 32, FrameUtil::ColorMatrix::Rbg, "128x32 RBG"},
+                          {64, 32, FrameUtil::ColorMatrix::Rgb, "64x32 RGB"},
+                          {64, 32, FrameUtil::ColorMatrix::Rbg, "64x32 RBG"}};
+  const int changedRows[] = {32, 8, 1};
+
+  for (const Panel& panel : panels)
+  {
+    for (int rows : changedRows)
+    {
+      if (!RunBenchmark(panel, frameCount, rows, iterations)) return 1;
+    }
+  }
+  return 0;
+}
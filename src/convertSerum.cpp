@@ -1,8 +1,16 @@
+#include <algorithm>
+#include <atomic>
 #include <cstdarg>
+#include <cstdlib>
 #include <filesystem>
 #include <iostream>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
+#include "ProcessPool.h"
+#include "SerumCache.h"
 #include "cargs.h"
 #include "serum-decode.h"
 
@@ -30,6 +38,84 @@ void SERUM_CALLBACK SerumLogCallback(const char* format, va_list args, const voi
   fputc('\n', stdout);
 }
 
+// Converts every ROM below an altcolor directory whose cROMc is missing or outdated. libserum keeps
+// process-wide state, so each ROM is converted by an own worker process.
+int RunBatch(const char* program, const std::string& altColorPath, unsigned int workerCount, bool force,
+             const std::vector<std::string>& forwardArgs)
+{
+  namespace fs = std::filesystem;
+  std::error_code ec;
+  if (!fs::is_directory(altColorPath, ec))
+  {
+    std::cerr << "Error: " << altColorPath << " is not a directory\n";
+    return 1;
+  }
+
+  struct Job
+  {
+    std::string rom;
+    DMDUtil::SerumCacheFiles files;
+    int exitCode = 0;
+  };
+  std::vector<Job> jobs;
+  size_t upToDate = 0;
+  for (const auto& entry : fs::directory_iterator(altColorPath, ec))
+  {
+    if (!entry.is_directory(ec)) continue;
+    Job job;
+    job.rom = entry.path().filename().string();
+    const DMDUtil::SerumCacheState state = DMDUtil::CheckSerumCache(altColorPath, job.rom, job.files);
+    if (state == DMDUtil::SerumCacheState::NoSource) continue;
+    if (state == DMDUtil::SerumCacheState::Fresh && !force)
+    {
+      upToDate++;
+      continue;
+    }
+    jobs.push_back(std::move(job));
+  }
+  std::sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) { return a.rom < b.rom; });
+
+  if (workerCount == 0) workerCount = std::max(1u, std::thread::hardware_concurrency());
+  workerCount = std::max(1u, std::min<unsigned int>(workerCount, static_cast<unsigned int>(jobs.size())));
+  std::cout << "Batch start: " << jobs.size() << " ROMs to convert, " << upToDate << " up to date, " << workerCount
+            << " worker processes\n";
+
+  std::atomic<size_t> doneJobs{0};
+  std::mutex outputMutex;
+  auto runJob = [&](size_t jobIndex)
+  {
+    Job& job = jobs[jobIndex];
+
+    std::string command = DMDUtil::QuoteCommandArgument(program);
+    for (const std::string& arg : forwardArgs) command += " " + DMDUtil::QuoteCommandArgument(arg);
+    command += " " + DMDUtil::QuoteCommandArgument("--input=" + job.files.source);
+    command += " " + DMDUtil::QuoteCommandArgument("--alt-color-path=" + altColorPath);
+    command += " " + DMDUtil::QuoteCommandArgument("--rom=" + job.rom);
+    command += " > " + DMDUtil::QuoteCommandArgument(job.files.cache + ".log") + " 2>&1";
+    job.exitCode = DMDUtil::RunCommand(command);
+
+    std::lock_guard<std::mutex> lock(outputMutex);
+    std::cout << "Batch progress: " << (doneJobs.fetch_add(1) + 1) << "/" << jobs.size() << " " << job.rom
+              << " exit=" << job.exitCode << "\n";
+  };
+
+  DMDUtil::RunJobPool(jobs.size(), workerCount, runJob);
+
+  size_t failed = 0;
+  for (const Job& job : jobs)
+  {
+    if (job.exitCode == 0)
+    {
+      fs::remove(job.files.cache + ".log", ec);
+      continue;
+    }
+    failed++;
+    std::cerr << "Error: Conversion of " << job.rom << " failed, see " << job.files.cache << ".log\n";
+  }
+  std::cout << "Batch finished: " << (jobs.size() - failed) << "/" << jobs.size() << " ROMs converted\n";
+  return failed == 0 ? 0 : 1;
+}
+
 static struct cag_option options[] = {
     {.identifier = 'i',
      .access_letters = "i",
@@ -49,6 +135,16 @@ static struct cag_option options[] = {
     {.identifier = 'S', .access_name = "strip-sd", .description = "Remove SD (32p) colorization and keep HD only"},
     {.identifier = 'H', .access_name = "strip-hd", .description = "Remove HD (64p) colorization and keep SD only"},
     {.identifier = 'l', .access_letters = "l", .access_name = "logging", .description = "Enable libserum log output"},
+    {.identifier = 'b',
+     .access_name = "batch",
+     .value_name = "DIR",
+     .description = "Convert every ROM of an altcolor directory whose cROMc is missing or outdated, in parallel"},
+    {.identifier = 'j',
+     .access_letters = "j",
+     .access_name = "jobs",
+     .value_name = "N",
+     .description = "Batch mode: number of worker processes (optional, default is the number of cores)"},
+    {.identifier = 'f', .access_name = "force", .description = "Batch mode: also convert ROMs with an up to date cROMc"},
     {.identifier = 'h', .access_letters = "h", .access_name = "help", .description = "Show help"}};
 }  // namespace
 
@@ -60,6 +156,10 @@ int main(int argc, char* argv[])
   bool opt_strip_sd = false;
   bool opt_strip_hd = false;
   bool opt_logging = false;
+  const char* opt_batch = nullptr;
+  unsigned int opt_jobs = 0;
+  bool opt_force = false;
+  std::vector<std::string> forwardArgs;
 
   cag_option_context cag_context;
   cag_option_init(&cag_context, options, CAG_ARRAY_SIZE(options), argc, argv);
@@ -79,12 +179,27 @@ int main(int argc, char* argv[])
         break;
       case 'S':
         opt_strip_sd = true;
+        forwardArgs.push_back("--strip-sd");
         break;
       case 'H':
         opt_strip_hd = true;
+        forwardArgs.push_back("--strip-hd");
         break;
       case 'l':
         opt_logging = true;
+        forwardArgs.push_back("--logging");
+        break;
+      case 'b':
+        opt_batch = cag_option_get_value(&cag_context);
+        break;
+      case 'j':
+      {
+        const char* value = cag_option_get_value(&cag_context);
+        opt_jobs = value ? static_cast<unsigned int>(std::strtoul(value, nullptr, 10)) : 0;
+        break;
+      }
+      case 'f':
+        opt_force = true;
         break;
       case 'h':
         std::cerr << "Usage: " << argv[0] << " [OPTION]...\n";
@@ -95,14 +210,18 @@ int main(int argc, char* argv[])
     }
   }
 
-  if (!opt_input || opt_input[0] == '\0')
+  if (opt_strip_sd && opt_strip_hd)
   {
-    std::cerr << "Error: Missing --input\n";
+    std::cerr << "Error: --strip-sd and --strip-hd are mutually exclusive\n";
     return 1;
   }
-  if (opt_strip_sd && opt_strip_hd)
+  if (opt_batch && opt_batch[0] != '\0')
   {
-    std::cerr << "Error: --strip-sd and --strip-hd are mutually exclusive\n";
+    return RunBatch(argv[0], opt_batch, opt_jobs, opt_force, forwardArgs);
+  }
+  if (!opt_input || opt_input[0] == '\0')
+  {
+    std::cerr << "Error: Missing --input\n";
     return 1;
   }
 
@@ -173,6 +292,8 @@ int main(int argc, char* argv[])
 
   const std::filesystem::path outPath = altColorBasePath / romName / (romName + ".cROMc");
   Serum_Dispose();
+  // Lets libdmdutil tell whether the cROMc still matches its source.
+  DMDUtil::WriteSerumCacheStamp({inputPath.string(), outPath.string()});
   std::cout << "Generated cROMc: " << outPath.string() << "\n";
   return 0;
 }
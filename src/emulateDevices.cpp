@@ -0,0 +1,313 @@
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DMDUtil/DMDUtil.h"
+#include "PixelcadeEmulator.h"
+#include "TimingHistogram.h"
+#include "cargs.h"
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+constexpr uint16_t kFrameWidth = 128;
+constexpr uint16_t kFrameHeight = 32;
+
+std::atomic<bool> g_stopRequested{false};
+
+void HandleSigInt(int) { g_stopRequested.store(true, std::memory_order_release); }
+
+void DMDUTILCALLBACK LogToStdoutCallback(DMDUtil_LogLevel logLevel, const char* format, va_list args)
+{
+  (void)logLevel;
+  vfprintf(stdout, format, args);
+  fputc('\n', stdout);
+}
+
+// RGB24DMD that needs a fixed time for every frame, like a display behind a slow link. Update() runs on
+// the RGB24DMD thread of DMD, so the delay holds that consumer back in the frame ring.
+class SlowRGB24DMD : public DMDUtil::RGB24DMD
+{
+ public:
+  SlowRGB24DMD(uint16_t width, uint16_t height, int delayMs) : RGB24DMD(width, height), m_delayMs(delayMs) {}
+
+  void Update(uint8_t* pRGB24Data, uint16_t width = 0, uint16_t height = 0) override
+  {
+    const Clock::time_point now = Clock::now();
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (m_frames++ > 0)
+        m_interval.Record((uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(now - m_last).count());
+      m_last = now;
+    }
+
+    RGB24DMD::Update(pRGB24Data, width, height);
+    std::this_thread::sleep_for(std::chrono::milliseconds(m_delayMs));
+  }
+
+  uint64_t GetFrames() const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_frames;
+  }
+
+  DMDUtil::TimingHistogram GetInterval() const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_interval;
+  }
+
+ private:
+  int m_delayMs;
+  mutable std::mutex m_mutex;
+  uint64_t m_frames = 0;
+  Clock::time_point m_last;
+  DMDUtil::TimingHistogram m_interval;
+};
+
+// A diagonal color gradient that moves by one pixel per frame, so no two consecutive frames are equal.
+void RenderFrame(std::vector<uint8_t>& frame, uint32_t index)
+{
+  for (int y = 0; y < kFrameHeight; y++)
+  {
+    for (int x = 0; x < kFrameWidth; x++)
+    {
+      uint8_t* pPixel = frame.data() + (y * kFrameWidth + x) * 3;
+      const uint32_t phase = x + y + index;
+      pPixel[0] = (uint8_t)(phase * 8);
+      pPixel[1] = (uint8_t)(phase * 3);
+      pPixel[2] = (uint8_t)(255 - phase * 5);
+    }
+  }
+}
+
+void PrintInterval(const DMDUtil::TimingHistogram& interval)
+{
+  if (interval.GetCount() == 0) return;
+
+  printf("  frame interval: avg %.1f ms, p50 %.1f ms, p99 %.1f ms, max %.1f ms\n",
+         interval.GetTotal() / 1000.0 / interval.GetCount(), interval.Percentile(0.5) / 1000.0,
+         interval.Percentile(0.99) / 1000.0, interval.GetMax() / 1000.0);
+}
+
+void PrintPixelcadeReport(const DMDUtil::PixelcadeEmulator& emulator, int width, bool isV2, int baud, double seconds)
+{
+  const DMDUtil::PixelcadeEmulator::Stats stats = emulator.GetStats();
+  const uint64_t frames = stats.planeFrames + stats.rgb565Frames + stats.rgb888Frames;
+
+  printf("Pixelcade emulator %dx32 %s, %s:\n", width, isV2 ? "V2" : "v1",
+         baud > 0 ? (std::to_string(baud) + " baud").c_str() : "unlimited");
+  printf("  sessions %llu, init %llu, enable %llu\n", (unsigned long long)stats.sessions,
+         (unsigned long long)stats.inits, (unsigned long long)stats.enables);
+  printf("  frames received %llu (planes %llu, RGB565 %llu, RGB888 %llu), %.1f fps\n", (unsigned long long)frames,
+         (unsigned long long)stats.planeFrames, (unsigned long long)stats.rgb565Frames,
+         (unsigned long long)stats.rgb888Frames, seconds > 0 ? frames / seconds : 0.0);
+  printf("  bytes received %llu, %.1f kB/s, max backlog %d bytes\n", (unsigned long long)stats.bytes,
+         seconds > 0 ? stats.bytes / seconds / 1000.0 : 0.0, stats.maxBacklog);
+  printf("  invalid bytes %llu, unknown packets %llu\n", (unsigned long long)stats.invalidBytes,
+         (unsigned long long)stats.unknownPackets);
+  PrintInterval(stats.frameInterval);
+}
+}  // namespace
+
+static struct cag_option options[] = {
+    {.identifier = 'p', .access_letters = "p", .access_name = "pixelcade", .description = "Emulate a Pixelcade"},
+    {.identifier = 'm',
+     .access_letters = "m",
+     .access_name = "mini",
+     .description = "Emulate a 64x32 Pixelcade instead of a 128x32 one"},
+    {.identifier = '2',
+     .access_letters = "2",
+     .access_name = "v2",
+     .description = "Emulate V2 firmware, which takes RGB565 and RGB888 packets instead of bit planes"},
+    {.identifier = 'b',
+     .access_letters = "b",
+     .access_name = "baud",
+     .value_name = "N",
+     .description = "Bytes the Pixelcade reads per second at N baud, 8N1 (default: 115200, 0 is unlimited)"},
+    {.identifier = 's',
+     .access_letters = "s",
+     .access_name = "serve",
+     .description = "Only run the Pixelcade emulator and print its device for another process"},
+    {.identifier = 'r',
+     .access_letters = "r",
+     .access_name = "rgb24",
+     .value_name = "MS",
+     .description = "Add an RGB24DMD that needs MS milliseconds per frame"},
+    {.identifier = 'f',
+     .access_letters = "f",
+     .access_name = "fps",
+     .value_name = "N",
+     .description = "Frames queued per second (default: 60)"},
+    {.identifier = 'd',
+     .access_letters = "d",
+     .access_name = "duration",
+     .value_name = "SECONDS",
+     .description = "Run time, 0 runs until Ctrl+C (default: 10)"},
+    {.identifier = 'h', .access_letters = "h", .access_name = "help", .description = "Show help"}};
+
+int main(int argc, char* argv[])
+{
+  bool pixelcade = false;
+  int pixelcadeWidth = 128;
+  bool pixelcadeV2 = false;
+  int baud = 115200;
+  bool serve = false;
+  int rgb24DelayMs = -1;
+  int fps = 60;
+  int duration = 10;
+
+  cag_option_context cagContext;
+  cag_option_init(&cagContext, options, CAG_ARRAY_SIZE(options), argc, argv);
+  while (cag_option_fetch(&cagContext))
+  {
+    const char id = cag_option_get_identifier(&cagContext);
+    const char* valueStr = cag_option_get_value(&cagContext);
+    switch (id)
+    {
+      case 'p':
+        pixelcade = true;
+        break;
+      case 'm':
+        pixelcadeWidth = 64;
+        break;
+      case '2':
+        pixelcadeV2 = true;
+        break;
+      case 'b':
+        if (valueStr && atoi(valueStr) >= 0) baud = atoi(valueStr);
+        break;
+      case 's':
+        serve = true;
+        pixelcade = true;
+        break;
+      case 'r':
+        if (valueStr && atoi(valueStr) >= 0) rgb24DelayMs = atoi(valueStr);
+        break;
+      case 'f':
+        if (valueStr && atoi(valueStr) > 0) fps = atoi(valueStr);
+        break;
+      case 'd':
+        if (valueStr && atoi(valueStr) >= 0) duration = atoi(valueStr);
+        break;
+      case 'h':
+        std::cerr << "Usage: " << argv[0] << " [options]\n";
+        cag_option_print(options, CAG_ARRAY_SIZE(options), stdout);
+        return 0;
+      default:
+        break;
+    }
+  }
+
+  if (!pixelcade && rgb24DelayMs < 0)
+  {
+    std::cerr << "Error: nothing to emulate, use --pixelcade and/or --rgb24\n";
+    return 1;
+  }
+
+  std::signal(SIGINT, HandleSigInt);
+
+  DMDUtil::PixelcadeEmulator* pEmulator = nullptr;
+  if (pixelcade)
+  {
+    pEmulator = new DMDUtil::PixelcadeEmulator(pixelcadeWidth, pixelcadeV2, baud);
+    if (!pEmulator->Start())
+    {
+      std::cerr << "Error: unable to create a pseudo terminal\n";
+      delete pEmulator;
+      return 1;
+    }
+    printf("Pixelcade emulator on %s\n", pEmulator->GetDevice());
+    fflush(stdout);
+  }
+
+  const Clock::time_point start = Clock::now();
+  auto running = [&]()
+  {
+    return !g_stopRequested.load(std::memory_order_acquire) &&
+           (duration == 0 || Clock::now() - start < std::chrono::seconds(duration));
+  };
+
+  if (serve)
+  {
+    while (running()) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  else
+  {
+    DMDUtil::Config* pConfig = DMDUtil::Config::GetInstance();
+    pConfig->SetLogCallback(LogToStdoutCallback);
+    pConfig->SetLogLevel(DMDUtil_LogLevel_INFO);
+    pConfig->SetDMDServer(false);
+    pConfig->SetZeDMD(false);
+    pConfig->SetPIN2DMD(false);
+    pConfig->SetPixelcade(pixelcade);
+    if (pEmulator) pConfig->SetPixelcadeDevice(pEmulator->GetDevice());
+    pConfig->SetLocalDisplaysActive(pixelcade);
+
+    DMDUtil::DMD* pDmd = new DMDUtil::DMD();
+    SlowRGB24DMD* pRGB24DMD = nullptr;
+    if (rgb24DelayMs >= 0)
+    {
+      // DMD owns the sink once it is added.
+      pRGB24DMD = new SlowRGB24DMD(kFrameWidth, kFrameHeight, rgb24DelayMs);
+      pDmd->AddRGB24DMD(pRGB24DMD);
+    }
+
+    pDmd->FindDisplays();
+    while (pDmd->IsFinding()) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    if (pEmulator && pEmulator->GetStats().sessions == 0) std::cerr << "Warning: PixelcadeDMD did not connect\n";
+
+    std::vector<uint8_t> frame(kFrameWidth * kFrameHeight * 3);
+    const Clock::duration period = std::chrono::microseconds(1000000 / fps);
+    const Clock::time_point queueStart = Clock::now();
+    uint32_t queued = 0;
+    while (running())
+    {
+      RenderFrame(frame, queued);
+      pDmd->UpdateRGB24Data(frame.data(), kFrameWidth, kFrameHeight);
+      queued++;
+      std::this_thread::sleep_until(queueStart + period * queued);
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - queueStart).count();
+
+    printf("Frames queued: %u in %.1f s\n", queued, seconds);
+    for (const DMDUtil::DMD::SinkStats& sink : pDmd->GetSinkStats())
+    {
+      if (!sink.active) continue;
+
+      printf("  %s consumed %llu frames", sink.name, (unsigned long long)sink.frames);
+      if (sink.frameCostUs > 0) printf(", paced to %.1f ms per frame, %.1f fps", sink.frameCostUs / 1000.0, sink.fps);
+      printf("\n");
+    }
+    if (pRGB24DMD)
+    {
+      printf("Slow RGB24DMD, %d ms per frame:\n", rgb24DelayMs);
+      printf("  frames received %llu, %.1f fps\n", (unsigned long long)pRGB24DMD->GetFrames(),
+             seconds > 0 ? pRGB24DMD->GetFrames() / seconds : 0.0);
+      PrintInterval(pRGB24DMD->GetInterval());
+    }
+
+    // Stops the Pixelcade run thread, which logs its written and coalesced frames.
+    delete pDmd;
+  }
+
+  if (pEmulator)
+  {
+    PrintPixelcadeReport(*pEmulator, pixelcadeWidth, pixelcadeV2, baud,
+                         std::chrono::duration<double>(Clock::now() - start).count());
+    delete pEmulator;
+  }
+
+  return 0;
+}
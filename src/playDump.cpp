@@ -1,18 +1,24 @@
 #include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <csignal>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <deque>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <unordered_map>
 #include <unordered_set>
@@ -27,19 +33,32 @@
 #include <psapi.h>
 #elif defined(__APPLE__)
 #include <execinfo.h>
+#include <fcntl.h>
 #include <mach/mach.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #elif defined(__linux__)
 #include <execinfo.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #endif
 // clang-format on
 
 #include "DMDUtil/DMDUtil.h"
+#include "HexNibbles.h"
+#include "ProcessPool.h"
 #include "cargs.h"
 #include "miniz/miniz.h"
 #include "serum.h"
 
+using DMDUtil::DecodeHexNibbles;
+using DMDUtil::HexToInt;
+
 namespace
 {
 std::atomic<bool> g_stopRequested{false};
@@ -138,6 +157,7 @@ struct Frame
   uint32_t timestampMs = 0;
   uint32_t originalTimestampMs = 0;
   uint32_t durationMs = 0;
+  uint32_t originalIndex = 0;
   uint16_t width = 0;
   uint16_t height = 0;
   FrameFormat format = FrameFormat::Indexed;
@@ -222,14 +242,6 @@ static bool IsZipFile(const std::string& path)
   return false;
 }
 
-static int HexToInt(char ch)
-{
-  if (ch >= '0' && ch <= '9') return ch - '0';
-  if (ch >= 'a' && ch <= 'f') return 10 + (ch - 'a');
-  if (ch >= 'A' && ch <= 'F') return 10 + (ch - 'A');
-  return -1;
-}
-
 static uint8_t ScaleIndex(uint8_t value, uint8_t inDepth, uint8_t outDepth)
 {
   if (inDepth == outDepth) return value;
@@ -252,121 +264,132 @@ static uint8_t QuantizeToDepth(uint8_t r, uint8_t g, uint8_t b, uint8_t depth)
   return (depth == 2) ? (uint8_t)(v >> 6) : (uint8_t)(v >> 4);
 }
 
-static bool LoadTxtDumpStream(std::istream& file, uint8_t outDepth, std::vector<Frame>& frames)
+// Incremental parsers for the supported dump formats. Next() returns one frame at a time, so a dump
+// never has to be held in memory as a whole.
+class FrameParser
 {
-  std::string line;
-  Frame current;
-  bool inFrame = false;
-  uint16_t width = 0;
-  uint16_t height = 0;
-  int maxValue = 0;
+ public:
+  virtual ~FrameParser() {}
 
-  auto finalizeFrame = [&]()
-  {
-    if (!inFrame) return;
-    if (width == 0 || height == 0)
-    {
-      inFrame = false;
-      return;
-    }
+  // Returns false at the end of the dump or on a parse error, see Failed().
+  virtual bool Next(Frame& frame) = 0;
+  virtual const char* Name() const = 0;
+  bool Failed() const { return m_failed; }
 
-    uint8_t inDepth = (maxValue <= 3) ? 2 : 4;
-    if (maxValue > 15)
-    {
-      std::cerr << "Error: Invalid pixel value in txt dump\n";
-      inFrame = false;
-      return;
-    }
+ protected:
+  bool m_failed = false;
+};
 
-    if (inDepth != outDepth)
+static bool IsTimestampLine(const std::string& line) { return line.rfind("0x", 0) == 0 || line.rfind("0X", 0) == 0; }
+
+class TxtFrameParser : public FrameParser
+{
+ public:
+  TxtFrameParser(std::istream& stream, uint8_t outDepth) : m_stream(stream), m_outDepth(outDepth) {}
+
+  bool Next(Frame& frame) override;
+  const char* Name() const override { return "txt"; }
+
+ private:
+  bool FinalizeFrame(Frame& frame);
+
+  std::istream& m_stream;
+  uint8_t m_outDepth;
+  std::string m_line;
+  Frame m_current;
+  bool m_inFrame = false;
+  uint16_t m_width = 0;
+  uint16_t m_height = 0;
+  int m_maxValue = 0;
+};
+
+bool TxtFrameParser::FinalizeFrame(Frame& frame)
+{
+  if (!m_inFrame) return false;
+  m_inFrame = false;
+  if (m_width == 0 || m_height == 0) return false;
+
+  uint8_t inDepth = (m_maxValue <= 3) ? 2 : 4;
+  if (m_maxValue > 15)
+  {
+    std::cerr << "Error: Invalid pixel value in txt dump\n";
+    return false;
+  }
+
+  if (inDepth != m_outDepth)
+  {
+    for (size_t i = 0; i < m_current.data.size(); ++i)
     {
-      for (size_t i = 0; i < current.data.size(); ++i)
-      {
-        current.data[i] = ScaleIndex(current.data[i], inDepth, outDepth);
-      }
+      m_current.data[i] = ScaleIndex(m_current.data[i], inDepth, m_outDepth);
     }
+  }
 
-    current.width = width;
-    current.height = height;
-    frames.push_back(current);
-    current = Frame();
-    inFrame = false;
-  };
+  m_current.width = m_width;
+  m_current.height = m_height;
+  frame = std::move(m_current);
+  m_current = Frame();
+  return true;
+}
 
-  while (std::getline(file, line))
+bool TxtFrameParser::Next(Frame& frame)
+{
+  while (std::getline(m_stream, m_line))
   {
-    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (!m_line.empty() && m_line.back() == '\r') m_line.pop_back();
 
-    if (line.empty())
+    if (m_line.empty())
     {
-      finalizeFrame();
-      width = 0;
-      height = 0;
-      maxValue = 0;
+      const bool done = FinalizeFrame(frame);
+      m_width = 0;
+      m_height = 0;
+      m_maxValue = 0;
+      if (done) return true;
       continue;
     }
 
-    if (!inFrame)
+    if (!m_inFrame)
     {
-      if (line.rfind("0x", 0) != 0 && line.rfind("0X", 0) != 0)
+      if (!IsTimestampLine(m_line))
       {
         continue;
       }
-      current = Frame();
-      current.timestampMs = (uint32_t)strtoul(line.c_str(), nullptr, 16);
-      current.originalTimestampMs = current.timestampMs;
-      inFrame = true;
-      width = 0;
-      height = 0;
-      maxValue = 0;
+      m_current = Frame();
+      m_current.timestampMs = (uint32_t)strtoul(m_line.c_str(), nullptr, 16);
+      m_current.originalTimestampMs = m_current.timestampMs;
+      m_inFrame = true;
+      m_width = 0;
+      m_height = 0;
+      m_maxValue = 0;
       continue;
     }
 
-    if (width == 0)
+    if (m_width == 0)
     {
-      width = (uint16_t)line.size();
+      m_width = (uint16_t)m_line.size();
     }
-    else if (line.size() != width)
+    else if (m_line.size() != m_width)
     {
       std::cerr << "Error: Inconsistent line width in txt dump\n";
+      m_failed = true;
       return false;
     }
 
-    for (char ch : line)
+    for (char ch : m_line)
     {
       int value = HexToInt(ch);
       if (value < 0)
       {
         std::cerr << "Error: Invalid hex digit in txt dump\n";
+        m_failed = true;
         return false;
       }
-      current.data.push_back((uint8_t)value);
-      if (value > maxValue) maxValue = value;
+      m_current.data.push_back((uint8_t)value);
+      if (value > m_maxValue) m_maxValue = value;
     }
-    height++;
-  }
-
-  finalizeFrame();
-
-  if (frames.empty())
-  {
-    std::cerr << "Error: No frames found in txt dump\n";
-    return false;
-  }
-
-  return true;
-}
-
-static bool LoadTxtDump(const std::string& path, uint8_t outDepth, std::vector<Frame>& frames)
-{
-  std::ifstream file(path);
-  if (!file)
-  {
-    std::cerr << "Error: Unable to open input file: " << path << "\n";
-    return false;
+    m_height++;
   }
 
-  return LoadTxtDumpStream(file, outDepth, frames);
+  return FinalizeFrame(frame);
 }
 
 static bool ParseHexUint16(const std::string& line, size_t pos, uint16_t& value)
@@ -397,309 +420,258 @@ static bool ParseHexRgb24(const std::string& line, size_t pos, uint8_t& r, uint8
   return true;
 }
 
-static bool LoadRgb565DumpStream(std::istream& file, uint8_t outDepth, std::vector<Frame>& frames,
-                                 bool strictMode = true)
+class Rgb565FrameParser : public FrameParser
 {
-  (void)outDepth;
-  std::string line;
-  Frame current;
-  bool inFrame = false;
-  uint16_t width = 0;
-  uint16_t height = 0;
+ public:
+  // A non-strict parser drops malformed frames instead of failing, as needed for dumps written by
+  // an interrupted session.
+  Rgb565FrameParser(std::istream& stream, bool strictMode) : m_stream(stream), m_strictMode(strictMode) {}
+
+  bool Next(Frame& frame) override;
+  const char* Name() const override { return "rgb565"; }
+
+ private:
+  bool FinalizeFrame(Frame& frame);
+  void StartFrame();
+  void DropFrame();
+
+  std::istream& m_stream;
+  bool m_strictMode;
+  std::string m_line;
+  Frame m_current;
+  bool m_inFrame = false;
+  uint16_t m_width = 0;
+  uint16_t m_height = 0;
+};
 
-  auto finalizeFrame = [&]()
-  {
-    if (!inFrame) return;
-    if (width == 0 || height == 0)
-    {
-      inFrame = false;
-      return;
-    }
+bool Rgb565FrameParser::FinalizeFrame(Frame& frame)
+{
+  if (!m_inFrame) return false;
+  m_inFrame = false;
+  if (m_width == 0 || m_height == 0) return false;
+
+  m_current.width = m_width;
+  m_current.height = m_height;
+  m_current.format = FrameFormat::RGB565;
+  frame = std::move(m_current);
+  m_current = Frame();
+  return true;
+}
 
-    current.width = width;
-    current.height = height;
-    current.format = FrameFormat::RGB565;
-    frames.push_back(current);
-    current = Frame();
-    inFrame = false;
-  };
+void Rgb565FrameParser::StartFrame()
+{
+  m_current = Frame();
+  m_current.timestampMs = (uint32_t)strtoul(m_line.c_str(), nullptr, 16);
+  m_current.originalTimestampMs = m_current.timestampMs;
+  m_inFrame = true;
+  m_width = 0;
+  m_height = 0;
+}
+
+void Rgb565FrameParser::DropFrame()
+{
+  m_current = Frame();
+  m_inFrame = false;
+  m_width = 0;
+  m_height = 0;
+}
 
-  while (std::getline(file, line))
+bool Rgb565FrameParser::Next(Frame& frame)
+{
+  while (std::getline(m_stream, m_line))
   {
-    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (!m_line.empty() && m_line.back() == '\r') m_line.pop_back();
 
-    if (line.empty())
+    if (m_line.empty())
     {
-      finalizeFrame();
-      width = 0;
-      height = 0;
+      const bool done = FinalizeFrame(frame);
+      m_width = 0;
+      m_height = 0;
+      if (done) return true;
       continue;
     }
 
-    if (!inFrame)
+    if (!m_inFrame)
     {
-      if (line.rfind("0x", 0) != 0 && line.rfind("0X", 0) != 0)
+      if (IsTimestampLine(m_line))
       {
-        continue;
+        StartFrame();
       }
-      current = Frame();
-      current.timestampMs = (uint32_t)strtoul(line.c_str(), nullptr, 16);
-      current.originalTimestampMs = current.timestampMs;
-      inFrame = true;
-      width = 0;
-      height = 0;
       continue;
     }
 
     // Recover when a new timestamp header appears without a separating blank line.
-    if (line.rfind("0x", 0) == 0 || line.rfind("0X", 0) == 0)
+    if (IsTimestampLine(m_line))
     {
-      if (strictMode)
+      if (m_strictMode)
       {
         std::cerr << "Error: Missing blank separator in rgb565 dump\n";
+        m_failed = true;
         return false;
       }
-      finalizeFrame();
-      current = Frame();
-      current.timestampMs = (uint32_t)strtoul(line.c_str(), nullptr, 16);
-      current.originalTimestampMs = current.timestampMs;
-      inFrame = true;
-      width = 0;
-      height = 0;
+      const bool done = FinalizeFrame(frame);
+      StartFrame();
+      if (done) return true;
       continue;
     }
 
-    if ((line.size() % 4) != 0)
+    if ((m_line.size() % 4) != 0)
     {
-      if (strictMode)
+      if (m_strictMode)
       {
         std::cerr << "Error: Invalid line width in rgb565 dump\n";
+        m_failed = true;
         return false;
       }
       // Drop malformed frame and wait for next frame separator/header.
-      current = Frame();
-      inFrame = false;
-      width = 0;
-      height = 0;
+      DropFrame();
       continue;
     }
 
-    uint16_t lineWidth = (uint16_t)(line.size() / 4);
-    if (width == 0)
+    uint16_t lineWidth = (uint16_t)(m_line.size() / 4);
+    if (m_width == 0)
     {
-      width = lineWidth;
+      m_width = lineWidth;
     }
-    else if (lineWidth != width)
+    else if (lineWidth != m_width)
     {
-      if (strictMode)
+      if (m_strictMode)
       {
         std::cerr << "Error: Inconsistent line width in rgb565 dump\n";
+        m_failed = true;
         return false;
       }
-      current = Frame();
-      inFrame = false;
-      width = 0;
-      height = 0;
+      DropFrame();
       continue;
     }
 
-    for (size_t pos = 0; pos < line.size(); pos += 4)
+    for (size_t pos = 0; pos < m_line.size(); pos += 4)
     {
       uint16_t value = 0;
-      if (!ParseHexUint16(line, pos, value))
+      if (!ParseHexUint16(m_line, pos, value))
       {
-        if (strictMode)
+        if (m_strictMode)
         {
           std::cerr << "Error: Invalid hex digit in rgb565 dump\n";
+          m_failed = true;
           return false;
         }
-        current = Frame();
-        inFrame = false;
-        width = 0;
-        height = 0;
+        DropFrame();
         break;
       }
-      current.data16.push_back(value);
+      m_current.data16.push_back(value);
     }
-    if (!inFrame)
+    if (!m_inFrame)
     {
       continue;
     }
-    height++;
-  }
-
-  finalizeFrame();
-
-  if (frames.empty())
-  {
-    std::cerr << "Error: No frames found in rgb565 dump\n";
-    return false;
+    m_height++;
   }
 
-  return true;
+  return FinalizeFrame(frame);
 }
 
-static bool LoadRgb565Dump(const std::string& path, uint8_t outDepth, std::vector<Frame>& frames)
+class Rgb888FrameParser : public FrameParser
 {
-  std::ifstream file(path);
-  if (!file)
-  {
-    std::cerr << "Error: Unable to open input file: " << path << "\n";
-    return false;
-  }
+ public:
+  explicit Rgb888FrameParser(std::istream& stream) : m_stream(stream) {}
 
-  return LoadRgb565DumpStream(file, outDepth, frames);
-}
+  bool Next(Frame& frame) override;
+  const char* Name() const override { return "rgb888"; }
 
-static bool LoadRgb888DumpStream(std::istream& file, uint8_t outDepth, std::vector<Frame>& frames)
-{
-  (void)outDepth;
-  std::string line;
-  Frame current;
-  bool inFrame = false;
-  uint16_t width = 0;
-  uint16_t height = 0;
+ private:
+  bool FinalizeFrame(Frame& frame);
 
-  auto finalizeFrame = [&]()
-  {
-    if (!inFrame) return;
-    if (width == 0 || height == 0)
-    {
-      inFrame = false;
-      return;
-    }
+  std::istream& m_stream;
+  std::string m_line;
+  Frame m_current;
+  bool m_inFrame = false;
+  uint16_t m_width = 0;
+  uint16_t m_height = 0;
+};
 
-    current.width = width;
-    current.height = height;
-    current.format = FrameFormat::RGB888;
-    frames.push_back(current);
-    current = Frame();
-    inFrame = false;
-  };
+bool Rgb888FrameParser::FinalizeFrame(Frame& frame)
+{
+  if (!m_inFrame) return false;
+  m_inFrame = false;
+  if (m_width == 0 || m_height == 0) return false;
+
+  m_current.width = m_width;
+  m_current.height = m_height;
+  m_current.format = FrameFormat::RGB888;
+  frame = std::move(m_current);
+  m_current = Frame();
+  return true;
+}
 
-  while (std::getline(file, line))
+bool Rgb888FrameParser::Next(Frame& frame)
+{
+  while (std::getline(m_stream, m_line))
   {
-    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (!m_line.empty() && m_line.back() == '\r') m_line.pop_back();
 
-    if (line.empty())
+    if (m_line.empty())
     {
-      finalizeFrame();
-      width = 0;
-      height = 0;
+      const bool done = FinalizeFrame(frame);
+      m_width = 0;
+      m_height = 0;
+      if (done) return true;
       continue;
     }
 
-    if (!inFrame)
+    if (!m_inFrame)
     {
-      if (line.rfind("0x", 0) != 0 && line.rfind("0X", 0) != 0)
+      if (!IsTimestampLine(m_line))
       {
         continue;
       }
-      current = Frame();
-      current.timestampMs = (uint32_t)strtoul(line.c_str(), nullptr, 16);
-      current.originalTimestampMs = current.timestampMs;
-      inFrame = true;
-      width = 0;
-      height = 0;
+      m_current = Frame();
+      m_current.timestampMs = (uint32_t)strtoul(m_line.c_str(), nullptr, 16);
+      m_current.originalTimestampMs = m_current.timestampMs;
+      m_inFrame = true;
+      m_width = 0;
+      m_height = 0;
       continue;
     }
 
-    if ((line.size() % 6) != 0)
+    if ((m_line.size() % 6) != 0)
     {
       std::cerr << "Error: Invalid line width in rgb888 dump\n";
+      m_failed = true;
       return false;
     }
 
-    uint16_t lineWidth = (uint16_t)(line.size() / 6);
-    if (width == 0)
+    uint16_t lineWidth = (uint16_t)(m_line.size() / 6);
+    if (m_width == 0)
     {
-      width = lineWidth;
+      m_width = lineWidth;
     }
-    else if (lineWidth != width)
+    else if (lineWidth != m_width)
     {
       std::cerr << "Error: Inconsistent line width in rgb888 dump\n";
+      m_failed = true;
       return false;
     }
 
-    for (size_t pos = 0; pos < line.size(); pos += 6)
+    for (size_t pos = 0; pos < m_line.size(); pos += 6)
     {
       uint8_t r = 0;
       uint8_t g = 0;
       uint8_t b = 0;
-      if (!ParseHexRgb24(line, pos, r, g, b))
+      if (!ParseHexRgb24(m_line, pos, r, g, b))
       {
         std::cerr << "Error: Invalid hex digit in rgb888 dump\n";
+        m_failed = true;
         return false;
       }
-      current.data.push_back(r);
-      current.data.push_back(g);
-      current.data.push_back(b);
-    }
-    height++;
-  }
-
-  finalizeFrame();
-
-  if (frames.empty())
-  {
-    std::cerr << "Error: No frames found in rgb888 dump\n";
-    return false;
-  }
-
-  return true;
-}
-
-static bool LoadRgb888Dump(const std::string& path, uint8_t outDepth, std::vector<Frame>& frames)
-{
-  std::ifstream file(path);
-  if (!file)
-  {
-    std::cerr << "Error: Unable to open input file: " << path << "\n";
-    return false;
-  }
-
-  return LoadRgb888DumpStream(file, outDepth, frames);
-}
-
-static void FinalizeFrameDurations(std::vector<Frame>& frames)
-{
-  if (frames.empty()) return;
-
-  bool monotonic = true;
-  for (size_t i = 1; i < frames.size(); ++i)
-  {
-    if (frames[i].timestampMs < frames[i - 1].timestampMs)
-    {
-      monotonic = false;
-      break;
-    }
-  }
-
-  if (!monotonic)
-  {
-    uint32_t accumulated = 0;
-    for (Frame& frame : frames)
-    {
-      frame.durationMs = frame.timestampMs;
-      frame.originalTimestampMs = accumulated;
-      accumulated += frame.durationMs;
+      m_current.data.push_back(r);
+      m_current.data.push_back(g);
+      m_current.data.push_back(b);
     }
-    return;
-  }
-
-  for (size_t i = 0; i + 1 < frames.size(); ++i)
-  {
-    uint32_t curr = frames[i].timestampMs;
-    uint32_t next = frames[i + 1].timestampMs;
-    frames[i].durationMs = (next > curr) ? (next - curr) : 0;
-    frames[i].originalTimestampMs = curr;
+    m_height++;
   }
 
-  if (frames.size() > 1)
-  {
-    frames.back().durationMs = frames[frames.size() - 2].durationMs;
-  }
-  frames.back().originalTimestampMs = frames.back().timestampMs;
+  return FinalizeFrame(frame);
 }
 
 static bool ConvertUpdateToIndexed(const DMDUtil::DMD::Update& update, uint8_t outDepth, Frame& frame)
@@ -786,129 +758,155 @@ static bool ConvertUpdateToIndexed(const DMDUtil::DMD::Update& update, uint8_t o
   }
 }
 
-static bool LoadRawDump(const std::string& path, uint8_t outDepth, std::vector<Frame>& frames)
+class RawFrameParser : public FrameParser
 {
-  std::ifstream file(path, std::ios::binary);
-  if (!file)
-  {
-    std::cerr << "Error: Unable to open input file: " << path << "\n";
-    return false;
-  }
+ public:
+  RawFrameParser(std::istream& stream, uint8_t outDepth) : m_stream(stream), m_outDepth(outDepth) {}
+
+  bool Next(Frame& frame) override;
+  const char* Name() const override { return "raw"; }
+
+ private:
+  std::istream& m_stream;
+  uint8_t m_outDepth;
+  DMDUtil::DMD::Update m_update;
+};
 
+bool RawFrameParser::Next(Frame& frame)
+{
   while (true)
   {
     uint32_t timestamp = 0;
     uint32_t size = 0;
-    if (!file.read(reinterpret_cast<char*>(&timestamp), sizeof(timestamp))) break;
-    if (!file.read(reinterpret_cast<char*>(&size), sizeof(size))) break;
+    if (!m_stream.read(reinterpret_cast<char*>(&timestamp), sizeof(timestamp))) return false;
+    if (!m_stream.read(reinterpret_cast<char*>(&size), sizeof(size))) return false;
 
     if (size < sizeof(DMDUtil::DMD::Update))
     {
       std::cerr << "Error: Raw dump frame size is too small\n";
+      m_failed = true;
       return false;
     }
 
-    std::vector<uint8_t> buffer(size);
-    if (!file.read(reinterpret_cast<char*>(buffer.data()), size)) break;
-
-    DMDUtil::DMD::Update update;
-    memcpy(&update, buffer.data(), sizeof(update));
+    // Newer writers may append fields, only the known part of the update is used.
+    if (!m_stream.read(reinterpret_cast<char*>(&m_update), sizeof(m_update))) return false;
+    if (size > sizeof(m_update) && !m_stream.ignore(size - sizeof(m_update))) return false;
 
-    Frame frame;
+    frame = Frame();
     frame.timestampMs = timestamp;
     frame.originalTimestampMs = timestamp;
-    if (ConvertUpdateToIndexed(update, outDepth, frame))
+    if (ConvertUpdateToIndexed(m_update, m_outDepth, frame))
     {
-      frames.push_back(std::move(frame));
+      return true;
     }
   }
+}
 
-  if (frames.empty())
-  {
-    std::cerr << "Error: No frames found in raw dump\n";
-    return false;
-  }
-
-  return true;
+static InputFormat DetectFormatFromName(const std::string& name)
+{
+  if (EndsWithCaseInsensitive(name, ".565.txt")) return InputFormat::Rgb565;
+  if (EndsWithCaseInsensitive(name, ".888.txt")) return InputFormat::Rgb888;
+  if (EndsWithCaseInsensitive(name, ".raw")) return InputFormat::Raw;
+  if (EndsWithCaseInsensitive(name, ".txt")) return InputFormat::Txt;
+  return InputFormat::Unknown;
 }
 
-static bool LoadRawDumpFromBuffer(const uint8_t* data, size_t size, uint8_t outDepth, std::vector<Frame>& frames)
+// Decompresses a zip entry on demand, so only the current chunk is held in memory.
+class ZipEntryStreamBuf : public std::streambuf
 {
-  size_t offset = 0;
-  while (offset + sizeof(uint32_t) * 2 <= size)
-  {
-    uint32_t timestamp = 0;
-    uint32_t frameSize = 0;
-    memcpy(&timestamp, data + offset, sizeof(timestamp));
-    offset += sizeof(timestamp);
-    memcpy(&frameSize, data + offset, sizeof(frameSize));
-    offset += sizeof(frameSize);
+ public:
+  explicit ZipEntryStreamBuf(mz_zip_reader_extract_iter_state* pState) : m_pState(pState) {}
 
-    if (frameSize < sizeof(DMDUtil::DMD::Update))
-    {
-      std::cerr << "Error: Raw dump frame size is too small\n";
-      return false;
-    }
+ protected:
+  int_type underflow() override
+  {
+    if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+    size_t read = mz_zip_reader_extract_iter_read(m_pState, m_buffer, sizeof(m_buffer));
+    if (read == 0) return traits_type::eof();
+    setg(m_buffer, m_buffer, m_buffer + read);
+    return traits_type::to_int_type(*gptr());
+  }
 
-    if (offset + frameSize > size)
-    {
-      break;
-    }
+ private:
+  mz_zip_reader_extract_iter_state* m_pState;
+  char m_buffer[64 * 1024];
+};
 
-    std::vector<uint8_t> buffer(frameSize);
-    memcpy(buffer.data(), data + offset, frameSize);
-    offset += frameSize;
+// A dump file, or the best dump entry of a zip file, opened as a binary stream.
+class DumpInput
+{
+ public:
+  DumpInput() : m_stream(nullptr) {}
+  ~DumpInput();
+
+  static std::unique_ptr<DumpInput> Open(const std::string& path, InputFormat format);
+
+  std::istream& Stream() { return m_stream; }
+  InputFormat Format() const { return m_format; }
+  const std::string& Path() const { return m_path; }
+  bool IsZip() const { return m_zipOpen; }
+
+ private:
+  bool OpenZip(const std::string& path);
+
+  std::filebuf m_fileBuf;
+  mz_zip_archive m_zip;
+  bool m_zipOpen = false;
+  mz_zip_reader_extract_iter_state* m_pZipIter = nullptr;
+  std::unique_ptr<ZipEntryStreamBuf> m_pZipBuf;
+  std::istream m_stream;
+  InputFormat m_format = InputFormat::Unknown;
+  std::string m_path;
+};
 
-    DMDUtil::DMD::Update update;
-    memcpy(&update, buffer.data(), sizeof(update));
+DumpInput::~DumpInput()
+{
+  m_stream.rdbuf(nullptr);
+  m_pZipBuf.reset();
+  if (m_pZipIter) mz_zip_reader_extract_iter_free(m_pZipIter);
+  if (m_zipOpen) mz_zip_reader_end(&m_zip);
+}
 
-    Frame frame;
-    frame.timestampMs = timestamp;
-    frame.originalTimestampMs = timestamp;
-    if (ConvertUpdateToIndexed(update, outDepth, frame))
-    {
-      frames.push_back(std::move(frame));
-    }
+std::unique_ptr<DumpInput> DumpInput::Open(const std::string& path, InputFormat format)
+{
+  auto pInput = std::make_unique<DumpInput>();
+  pInput->m_path = path;
+  if (format == InputFormat::Zip)
+  {
+    if (!pInput->OpenZip(path)) return nullptr;
+    return pInput;
   }
 
-  if (frames.empty())
+  if (!pInput->m_fileBuf.open(path, std::ios::in | std::ios::binary))
   {
-    std::cerr << "Error: No frames found in raw dump\n";
-    return false;
+    std::cerr << "Error: Unable to open input file: " << path << "\n";
+    return nullptr;
   }
-
-  return true;
-}
-
-static InputFormat DetectFormatFromName(const std::string& name)
-{
-  if (EndsWithCaseInsensitive(name, ".565.txt")) return InputFormat::Rgb565;
-  if (EndsWithCaseInsensitive(name, ".888.txt")) return InputFormat::Rgb888;
-  if (EndsWithCaseInsensitive(name, ".raw")) return InputFormat::Raw;
-  if (EndsWithCaseInsensitive(name, ".txt")) return InputFormat::Txt;
-  return InputFormat::Unknown;
+  pInput->m_stream.rdbuf(&pInput->m_fileBuf);
+  pInput->m_format = format;
+  return pInput;
 }
 
-static bool LoadZipDump(const std::string& path, uint8_t outDepth, std::vector<Frame>& frames)
+bool DumpInput::OpenZip(const std::string& path)
 {
-  mz_zip_archive zip;
-  mz_zip_zero_struct(&zip);
-  if (!mz_zip_reader_init_file(&zip, path.c_str(), 0))
+  mz_zip_zero_struct(&m_zip);
+  if (!mz_zip_reader_init_file(&m_zip, path.c_str(), 0))
   {
     std::cerr << "Error: Unable to open zip file: " << path << "\n";
     return false;
   }
+  m_zipOpen = true;
 
   int bestIndex = -1;
   InputFormat bestFormat = InputFormat::Unknown;
   int bestPriority = -1;
   int firstFileIndex = -1;
-  const mz_uint fileCount = mz_zip_reader_get_num_files(&zip);
+  const mz_uint fileCount = mz_zip_reader_get_num_files(&m_zip);
 
   for (mz_uint i = 0; i < fileCount; ++i)
   {
     mz_zip_archive_file_stat stat;
-    if (!mz_zip_reader_file_stat(&zip, i, &stat))
+    if (!mz_zip_reader_file_stat(&m_zip, i, &stat))
     {
       continue;
     }
@@ -957,68 +955,764 @@ static bool LoadZipDump(const std::string& path, uint8_t outDepth, std::vector<F
 
   if (bestIndex < 0)
   {
-    mz_zip_reader_end(&zip);
     std::cerr << "Error: No files found in zip dump\n";
     return false;
   }
 
-  mz_zip_archive_file_stat stat;
-  if (!mz_zip_reader_file_stat(&zip, (mz_uint)bestIndex, &stat))
+  m_pZipIter = mz_zip_reader_extract_iter_new(&m_zip, (mz_uint)bestIndex, 0);
+  if (!m_pZipIter)
   {
-    mz_zip_reader_end(&zip);
-    std::cerr << "Error: Unable to read zip entry\n";
+    std::cerr << "Error: Unable to extract zip entry\n";
     return false;
   }
 
-  if (stat.m_uncomp_size > static_cast<mz_uint64>(std::numeric_limits<size_t>::max()))
-  {
-    mz_zip_reader_end(&zip);
-    std::cerr << "Error: Zip entry too large to extract\n";
-    return false;
-  }
+  m_pZipBuf = std::make_unique<ZipEntryStreamBuf>(m_pZipIter);
+  m_stream.rdbuf(m_pZipBuf.get());
+  m_format = (bestFormat == InputFormat::Unknown) ? InputFormat::Txt : bestFormat;
+  return true;
+}
+
+// A read-only view of a whole dump file. Pages behind the reader are released again, so the resident
+// part stays small even for very large dumps.
+class MappedFile
+{
+ public:
+  ~MappedFile();
+
+  bool Open(const std::string& path);
+  const char* Data() const { return m_pData; }
+  size_t Size() const { return m_size; }
+  void Release(size_t offset);
+
+ private:
+  const char* m_pData = nullptr;
+  size_t m_size = 0;
+  size_t m_released = 0;
+#if defined(_WIN32)
+  HANDLE m_file = INVALID_HANDLE_VALUE;
+  HANDLE m_mapping = nullptr;
+#endif
+};
+
+MappedFile::~MappedFile()
+{
+#if defined(_WIN32)
+  if (m_pData) UnmapViewOfFile(m_pData);
+  if (m_mapping) CloseHandle(m_mapping);
+  if (m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+#elif defined(__APPLE__) || defined(__linux__)
+  if (m_pData) munmap(const_cast<char*>(m_pData), m_size);
+#endif
+}
 
-  std::vector<uint8_t> buffer(static_cast<size_t>(stat.m_uncomp_size));
-  if (!mz_zip_reader_extract_to_mem(&zip, (mz_uint)bestIndex, buffer.data(), buffer.size(), 0))
+bool MappedFile::Open(const std::string& path)
+{
+#if defined(_WIN32)
+  m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                       FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (m_file == INVALID_HANDLE_VALUE) return false;
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0 ||
+      (uint64_t)size.QuadPart > (uint64_t)std::numeric_limits<size_t>::max())
+    return false;
+  m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!m_mapping) return false;
+  m_pData = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+  if (!m_pData) return false;
+  m_size = (size_t)size.QuadPart;
+  return true;
+#elif defined(__APPLE__) || defined(__linux__)
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0 || (uint64_t)st.st_size > (uint64_t)std::numeric_limits<size_t>::max())
   {
-    mz_zip_reader_end(&zip);
-    std::cerr << "Error: Unable to extract zip entry\n";
+    close(fd);
     return false;
   }
+  void* pData = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (pData == MAP_FAILED) return false;
+  madvise(pData, (size_t)st.st_size, MADV_SEQUENTIAL);
+  m_pData = static_cast<const char*>(pData);
+  m_size = (size_t)st.st_size;
+  return true;
+#else
+  (void)path;
+  return false;
+#endif
+}
 
-  if (bestFormat == InputFormat::Unknown)
-  {
-    bestFormat = DetectFormatFromName(stat.m_filename);
-  }
+void MappedFile::Release(size_t offset)
+{
+#if defined(__APPLE__) || defined(__linux__)
+  constexpr size_t kReleaseGranularity = 4 * 1024 * 1024;
+  const size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+  const size_t end = offset - (offset % pageSize);
+  if (end < m_released + kReleaseGranularity) return;
+  madvise(const_cast<char*>(m_pData) + m_released, end - m_released, MADV_DONTNEED);
+  m_released = end;
+#else
+  (void)offset;
+#endif
+}
 
-  bool ok = false;
-  if (bestFormat == InputFormat::Rgb565)
-  {
-    std::string content(reinterpret_cast<const char*>(buffer.data()), buffer.size());
-    std::istringstream stream(content);
-    ok = LoadRgb565DumpStream(stream, outDepth, frames);
-  }
-  else if (bestFormat == InputFormat::Rgb888)
-  {
-    std::string content(reinterpret_cast<const char*>(buffer.data()), buffer.size());
-    std::istringstream stream(content);
-    ok = LoadRgb888DumpStream(stream, outDepth, frames);
-  }
-  else if (bestFormat == InputFormat::Raw)
+// The text of one frame: its timestamp line up to the next timestamp line. nextHeader holds that
+// following line (if any), so a block can be re-parsed exactly like in the full stream.
+struct FrameBlock
+{
+  std::string_view text;
+  std::string_view nextHeader;
+  std::string storage;
+};
+
+// Splits a text dump at its timestamp lines, directly on a mapped file or on a buffered stream.
+class FrameBlockReader
+{
+ public:
+  FrameBlockReader(const MappedFile* pMapped, std::istream& stream) : m_pMapped(pMapped), m_stream(stream)
   {
-    ok = LoadRawDumpFromBuffer(buffer.data(), buffer.size(), outDepth, frames);
+    m_eof = m_pMapped != nullptr;
   }
-  else
+
+  bool Next(FrameBlock& block);
+
+ private:
+  static size_t FindHeader(const char* data, size_t size, size_t from);
+  static size_t LineEnd(const char* data, size_t size, size_t from);
+  bool Fill();
+
+  const MappedFile* m_pMapped;
+  std::istream& m_stream;
+  std::string m_buffer;
+  size_t m_pos = 0;
+  bool m_eof;
+};
+
+size_t FrameBlockReader::FindHeader(const char* data, size_t size, size_t from)
+{
+  // from is always at a line start.
+  size_t pos = from;
+  while (pos + 1 < size)
   {
-    std::string content(reinterpret_cast<const char*>(buffer.data()), buffer.size());
-    std::istringstream stream(content);
-    ok = LoadTxtDumpStream(stream, outDepth, frames);
+    if (data[pos] == '0' && (data[pos + 1] == 'x' || data[pos + 1] == 'X')) return pos;
+    const void* pNewline = memchr(data + pos, '\n', size - pos);
+    if (!pNewline) return std::string::npos;
+    pos = (size_t)(static_cast<const char*>(pNewline) - data) + 1;
   }
-
-  mz_zip_reader_end(&zip);
-  return ok;
+  return std::string::npos;
 }
 
-static bool ParseServer(const std::string& value, std::string& host, int& port)
+size_t FrameBlockReader::LineEnd(const char* data, size_t size, size_t from)
+{
+  const void* pNewline = memchr(data + from, '\n', size - from);
+  return pNewline ? (size_t)(static_cast<const char*>(pNewline) - data) + 1 : std::string::npos;
+}
+
+bool FrameBlockReader::Fill()
+{
+  if (m_eof) return false;
+  // Drop what earlier blocks already consumed before growing the buffer.
+  if (m_pos > 0)
+  {
+    m_buffer.erase(0, m_pos);
+    m_pos = 0;
+  }
+  constexpr size_t kChunkSize = 1024 * 1024;
+  const size_t oldSize = m_buffer.size();
+  m_buffer.resize(oldSize + kChunkSize);
+  m_stream.read(&m_buffer[oldSize], kChunkSize);
+  const size_t read = (size_t)m_stream.gcount();
+  m_buffer.resize(oldSize + read);
+  if (read < kChunkSize) m_eof = true;
+  return true;
+}
+
+bool FrameBlockReader::Next(FrameBlock& block)
+{
+  while (true)
+  {
+    const char* data = m_pMapped ? m_pMapped->Data() : m_buffer.data();
+    const size_t size = m_pMapped ? m_pMapped->Size() : m_buffer.size();
+
+    const size_t start = FindHeader(data, size, m_pos);
+    if (start == std::string::npos)
+    {
+      if (m_eof) return false;
+      // Keep a trailing partial line, it might turn out to be a header.
+      const size_t lastNewline = m_buffer.rfind('\n');
+      if (lastNewline != std::string::npos && lastNewline + 1 > m_pos) m_pos = lastNewline + 1;
+      Fill();
+      continue;
+    }
+
+    const size_t headerEnd = LineEnd(data, size, start);
+    size_t end = (headerEnd == std::string::npos) ? std::string::npos : FindHeader(data, size, headerEnd);
+    size_t nextHeaderEnd = size;
+    if (end != std::string::npos)
+    {
+      nextHeaderEnd = LineEnd(data, size, end);
+      if (nextHeaderEnd == std::string::npos)
+      {
+        if (!m_eof)
+        {
+          m_pos = start;
+          Fill();
+          continue;
+        }
+        nextHeaderEnd = size;
+      }
+    }
+    else
+    {
+      if (!m_eof)
+      {
+        m_pos = start;
+        Fill();
+        continue;
+      }
+      end = size;
+    }
+
+    if (m_pMapped)
+    {
+      block.text = std::string_view(data + start, end - start);
+      block.nextHeader = std::string_view(data + end, nextHeaderEnd - end);
+    }
+    else
+    {
+      // The stream buffer moves on the next call, the block owns a copy.
+      block.storage.assign(data + start, nextHeaderEnd - start);
+      block.text = std::string_view(block.storage.data(), end - start);
+      block.nextHeader = std::string_view(block.storage.data() + (end - start), nextHeaderEnd - end);
+    }
+    m_pos = end;
+    return true;
+  }
+}
+
+// Parses the frames of text dumps in parallel. A reader splits the dump into frame blocks, a small
+// worker pool decodes them with DecodeHexNibbles(), and Next() hands the frames out in dump order.
+// Blocks the fast path doesn't understand are passed to the reference parser, so the results and error
+// messages match the single-threaded parsers.
+class ParallelFrameParser : public FrameParser
+{
+ public:
+  ParallelFrameParser(DumpInput& input, uint8_t outDepth, bool strictMode);
+  ~ParallelFrameParser() override;
+
+  bool Next(Frame& frame) override;
+  const char* Name() const override;
+
+ private:
+  struct Job
+  {
+    FrameBlock block;
+    Frame frame;
+    bool hasFrame = false;
+    bool failed = false;
+    bool done = false;
+  };
+
+  static constexpr size_t kBlocksInFlight = 32;
+
+  void Run();
+  void Decode(Job& job) const;
+  bool DecodeFast(const FrameBlock& block, Frame& frame) const;
+
+  InputFormat m_format;
+  uint8_t m_outDepth;
+  bool m_strictMode;
+  MappedFile m_mapped;
+  std::unique_ptr<FrameBlockReader> m_pReader;
+  bool m_readerDone = false;
+  std::deque<std::shared_ptr<Job>> m_inFlight;
+  std::deque<std::shared_ptr<Job>> m_pending;
+  bool m_stop = false;
+  std::mutex m_mutex;
+  std::condition_variable m_workCv;
+  std::condition_variable m_doneCv;
+  std::vector<std::thread> m_threads;
+};
+
+ParallelFrameParser::ParallelFrameParser(DumpInput& input, uint8_t outDepth, bool strictMode)
+    : m_format(input.Format()), m_outDepth(outDepth), m_strictMode(strictMode)
+{
+  const bool mapped = !input.IsZip() && m_mapped.Open(input.Path());
+  m_pReader = std::make_unique<FrameBlockReader>(mapped ? &m_mapped : nullptr, input.Stream());
+
+  const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+  const size_t threadCount = hardwareThreads > 1 ? std::min<size_t>(hardwareThreads - 1, 8) : 0;
+  for (size_t i = 0; i < threadCount; ++i) m_threads.emplace_back(&ParallelFrameParser::Run, this);
+}
+
+ParallelFrameParser::~ParallelFrameParser()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_workCv.notify_all();
+  for (auto& thread : m_threads)
+  {
+    if (thread.joinable()) thread.join();
+  }
+}
+
+const char* ParallelFrameParser::Name() const
+{
+  switch (m_format)
+  {
+    case InputFormat::Rgb565:
+      return "rgb565";
+    case InputFormat::Rgb888:
+      return "rgb888";
+    default:
+      return "txt";
+  }
+}
+
+void ParallelFrameParser::Run()
+{
+  while (true)
+  {
+    std::shared_ptr<Job> job;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_workCv.wait(lock, [&]() { return m_stop || !m_pending.empty(); });
+      if (m_stop) return;
+      job = std::move(m_pending.front());
+      m_pending.pop_front();
+    }
+
+    Decode(*job);
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      job->done = true;
+    }
+    m_doneCv.notify_all();
+  }
+}
+
+bool ParallelFrameParser::Next(Frame& frame)
+{
+  while (true)
+  {
+    // Keep the pool busy with the following blocks while waiting for the oldest one.
+    while (!m_readerDone && m_inFlight.size() < kBlocksInFlight)
+    {
+      auto job = std::make_shared<Job>();
+      if (!m_pReader->Next(job->block))
+      {
+        m_readerDone = true;
+        break;
+      }
+      m_inFlight.push_back(job);
+      if (m_threads.empty()) continue;
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.push_back(std::move(job));
+      }
+      m_workCv.notify_one();
+    }
+
+    if (m_inFlight.empty()) return false;
+
+    std::shared_ptr<Job> job = std::move(m_inFlight.front());
+    m_inFlight.pop_front();
+    if (m_threads.empty())
+    {
+      Decode(*job);
+    }
+    else
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_doneCv.wait(lock, [&]() { return job->done; });
+    }
+
+    if (m_mapped.Data() && !m_inFlight.empty())
+    {
+      m_mapped.Release((size_t)(m_inFlight.front()->block.text.data() - m_mapped.Data()));
+    }
+
+    if (job->failed)
+    {
+      m_failed = true;
+      return false;
+    }
+    if (job->hasFrame)
+    {
+      frame = std::move(job->frame);
+      return true;
+    }
+  }
+}
+
+void ParallelFrameParser::Decode(Job& job) const
+{
+  if (DecodeFast(job.block, job.frame))
+  {
+    job.hasFrame = true;
+    return;
+  }
+
+  // Anything unusual goes through the reference parser, including the following timestamp line when
+  // the block isn't terminated by a blank line, exactly as the parser would see it in the full stream.
+  std::string text(job.block.text);
+  text.append(job.block.nextHeader);
+  std::istringstream stream(text);
+  std::unique_ptr<FrameParser> pParser;
+  switch (m_format)
+  {
+    case InputFormat::Rgb565:
+      pParser = std::make_unique<Rgb565FrameParser>(stream, m_strictMode);
+      break;
+    case InputFormat::Rgb888:
+      pParser = std::make_unique<Rgb888FrameParser>(stream);
+      break;
+    default:
+      pParser = std::make_unique<TxtFrameParser>(stream, m_outDepth);
+      break;
+  }
+  job.frame = Frame();
+  job.hasFrame = pParser->Next(job.frame);
+  job.failed = pParser->Failed();
+}
+
+bool ParallelFrameParser::DecodeFast(const FrameBlock& block, Frame& frame) const
+{
+  const std::string_view text = block.text;
+  size_t pos = text.find('\n');
+  if (pos == std::string_view::npos) return false;
+
+  // Timestamp line, "0x" followed by hex digits only.
+  size_t headerLength = pos;
+  if (headerLength > 0 && text[headerLength - 1] == '\r') headerLength--;
+  if (headerLength < 3 || headerLength > 10) return false;
+  uint32_t timestamp = 0;
+  for (size_t i = 2; i < headerLength; ++i)
+  {
+    int value = HexToInt(text[i]);
+    if (value < 0) return false;
+    timestamp = (timestamp << 4) | (uint32_t)value;
+  }
+  pos++;
+
+  const size_t digitsPerPixel = (m_format == InputFormat::Rgb565) ? 4 : (m_format == InputFormat::Rgb888) ? 6 : 1;
+  size_t lineLength = 0;
+  uint16_t height = 0;
+  bool terminated = false;
+  std::vector<uint8_t> nibbles;
+  while (pos < text.size())
+  {
+    size_t lineEnd = text.find('\n', pos);
+    if (lineEnd == std::string_view::npos) lineEnd = text.size();
+    size_t length = lineEnd - pos;
+    if (length > 0 && text[pos + length - 1] == '\r') length--;
+
+    if (length == 0)
+    {
+      terminated = true;
+      break;
+    }
+    if (lineLength == 0)
+    {
+      if ((length % digitsPerPixel) != 0 || length / digitsPerPixel > 0xFFFF) return false;
+      lineLength = length;
+    }
+    else if (length != lineLength)
+    {
+      return false;
+    }
+
+    const size_t offset = nibbles.size();
+    nibbles.resize(offset + length);
+    if (!DecodeHexNibbles(text.data() + pos, length, nibbles.data() + offset)) return false;
+    height++;
+    pos = lineEnd + 1;
+  }
+
+  // A timestamp line right after the pixels is an error or a recovery case of the reference parser.
+  if (height == 0 || (!terminated && !block.nextHeader.empty())) return false;
+
+  frame = Frame();
+  frame.timestampMs = timestamp;
+  frame.originalTimestampMs = timestamp;
+  frame.width = (uint16_t)(lineLength / digitsPerPixel);
+  frame.height = height;
+  const size_t pixels = (size_t)frame.width * height;
+
+  if (m_format == InputFormat::Rgb565)
+  {
+    frame.format = FrameFormat::RGB565;
+    frame.data16.resize(pixels);
+    for (size_t i = 0; i < pixels; ++i)
+    {
+      const uint8_t* n = &nibbles[i * 4];
+      frame.data16[i] = (uint16_t)((n[0] << 12) | (n[1] << 8) | (n[2] << 4) | n[3]);
+    }
+  }
+  else if (m_format == InputFormat::Rgb888)
+  {
+    frame.format = FrameFormat::RGB888;
+    frame.data.resize(pixels * 3);
+    for (size_t i = 0; i < pixels * 3; ++i)
+    {
+      frame.data[i] = (uint8_t)((nibbles[i * 2] << 4) | nibbles[i * 2 + 1]);
+    }
+  }
+  else
+  {
+    uint8_t maxValue = 0;
+    for (uint8_t value : nibbles) maxValue = std::max(maxValue, value);
+    const uint8_t inDepth = (maxValue <= 3) ? 2 : 4;
+    if (inDepth != m_outDepth)
+    {
+      for (uint8_t& value : nibbles) value = ScaleIndex(value, inDepth, m_outDepth);
+    }
+    frame.data = std::move(nibbles);
+  }
+  return true;
+}
+
+static std::unique_ptr<FrameParser> CreateFrameParser(DumpInput& input, uint8_t outDepth, bool strictMode,
+                                                      bool parallel)
+{
+  if (parallel && input.Format() != InputFormat::Raw)
+  {
+    return std::make_unique<ParallelFrameParser>(input, outDepth, strictMode);
+  }
+
+  switch (input.Format())
+  {
+    case InputFormat::Raw:
+      return std::make_unique<RawFrameParser>(input.Stream(), outDepth);
+    case InputFormat::Rgb565:
+      return std::make_unique<Rgb565FrameParser>(input.Stream(), strictMode);
+    case InputFormat::Rgb888:
+      return std::make_unique<Rgb888FrameParser>(input.Stream());
+    case InputFormat::Txt:
+    default:
+      return std::make_unique<TxtFrameParser>(input.Stream(), outDepth);
+  }
+}
+
+static uint64_t ComputePlannedSleepMs(uint32_t durationMs, bool delaySet, uint32_t delayMs)
+{
+  if (delaySet)
+  {
+    uint32_t sleepMs = delayMs;
+    if (durationMs > 0 && durationMs < sleepMs)
+    {
+      sleepMs = durationMs;
+    }
+    return sleepMs;
+  }
+  return durationMs;
+}
+
+// Result of a pass over a dump with the parser that plays it, so the counts match the frames played. Older dumps
+// store per frame durations instead of timestamps, which is only known once every timestamp has been seen.
+struct DumpScan
+{
+  size_t frameCount = 0;
+  size_t windowFrameCount = 0;
+  bool monotonic = true;
+  uint64_t estimatedPlaybackMs = 0;
+};
+
+static void ScanDump(FrameParser& parser, uint32_t startFrame, uint32_t endFrame, bool delaySet, uint32_t delayMs,
+                     DumpScan& scan)
+{
+  auto inWindow = [&](size_t index) { return index >= startFrame && index <= endFrame; };
+
+  // Both interpretations are summed up in the same pass, the final one is picked afterwards.
+  uint64_t monotonicMs = 0;
+  uint64_t durationsMs = 0;
+  uint32_t previousTimestamp = 0;
+  uint32_t previousDuration = 0;
+  Frame frame;
+  // A frame that fails to parse ends the playback as well, so the scan stops there too.
+  while (parser.Next(frame))
+  {
+    const uint32_t timestamp = frame.timestampMs;
+    const size_t index = scan.frameCount++;
+    if (inWindow(index))
+    {
+      scan.windowFrameCount++;
+      durationsMs += ComputePlannedSleepMs(timestamp, delaySet, delayMs);
+    }
+    if (index > 0)
+    {
+      if (timestamp < previousTimestamp) scan.monotonic = false;
+      previousDuration = (timestamp > previousTimestamp) ? (timestamp - previousTimestamp) : 0;
+      if (inWindow(index - 1)) monotonicMs += ComputePlannedSleepMs(previousDuration, delaySet, delayMs);
+    }
+    previousTimestamp = timestamp;
+  }
+
+  // The last frame repeats the duration of the one before.
+  if (scan.frameCount > 0 && inWindow(scan.frameCount - 1))
+    monotonicMs += ComputePlannedSleepMs(scan.frameCount > 1 ? previousDuration : 0, delaySet, delayMs);
+
+  scan.estimatedPlaybackMs = scan.monotonic ? monotonicMs : durationsMs;
+}
+
+// Streams the frames of a dump on a reader thread. At most kReadAheadFrames decoded frames are held in
+// memory, frames outside [startFrame, endFrame] are parsed and dropped, and durations are derived from
+// the following frame.
+class FrameSource
+{
+ public:
+  FrameSource(std::unique_ptr<DumpInput> pInput, std::unique_ptr<FrameParser> pParser, bool monotonic,
+              uint32_t startFrame, uint32_t endFrame);
+  ~FrameSource();
+
+  // Blocks until the next frame is decoded. Returns false at the end of the window or on a parse error.
+  bool Next(Frame& frame);
+  bool Failed() const { return m_pParser->Failed(); }
+  const char* Name() const { return m_pParser->Name(); }
+
+ private:
+  static constexpr size_t kReadAheadFrames = 64;
+
+  void Run();
+  bool Push(Frame& frame);
+
+  std::unique_ptr<DumpInput> m_pInput;
+  std::unique_ptr<FrameParser> m_pParser;
+  bool m_monotonic;
+  uint32_t m_startFrame;
+  uint32_t m_endFrame;
+  std::deque<Frame> m_frames;
+  bool m_done = false;
+  bool m_stop = false;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::thread m_thread;
+};
+
+FrameSource::FrameSource(std::unique_ptr<DumpInput> pInput, std::unique_ptr<FrameParser> pParser, bool monotonic,
+                         uint32_t startFrame, uint32_t endFrame)
+    : m_pInput(std::move(pInput)),
+      m_pParser(std::move(pParser)),
+      m_monotonic(monotonic),
+      m_startFrame(startFrame),
+      m_endFrame(endFrame)
+{
+  m_thread = std::thread(&FrameSource::Run, this);
+}
+
+FrameSource::~FrameSource()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_cv.notify_all();
+  if (m_thread.joinable()) m_thread.join();
+}
+
+bool FrameSource::Next(Frame& frame)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_cv.wait(lock, [&]() { return m_done || !m_frames.empty(); });
+  if (m_frames.empty()) return false;
+  frame = std::move(m_frames.front());
+  m_frames.pop_front();
+  lock.unlock();
+  m_cv.notify_all();
+  return true;
+}
+
+bool FrameSource::Push(Frame& frame)
+{
+  if (frame.originalIndex < m_startFrame || frame.originalIndex > m_endFrame) return true;
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_cv.wait(lock, [&]() { return m_stop || m_frames.size() < kReadAheadFrames; });
+  if (m_stop) return false;
+  m_frames.push_back(std::move(frame));
+  lock.unlock();
+  m_cv.notify_all();
+  return true;
+}
+
+void FrameSource::Run()
+{
+  Frame frame;
+  Frame pending;
+  bool hasPending = false;
+  bool hasDuration = false;
+  uint32_t index = 0;
+  uint32_t accumulated = 0;
+  uint32_t lastDuration = 0;
+
+  while (m_pParser->Next(frame))
+  {
+    frame.originalIndex = index++;
+
+    if (!m_monotonic)
+    {
+      frame.durationMs = frame.timestampMs;
+      frame.originalTimestampMs = accumulated;
+      accumulated += frame.durationMs;
+      if (!Push(frame) || frame.originalIndex >= m_endFrame) break;
+      continue;
+    }
+
+    if (hasPending)
+    {
+      pending.durationMs = (frame.timestampMs > pending.timestampMs) ? (frame.timestampMs - pending.timestampMs) : 0;
+      pending.originalTimestampMs = pending.timestampMs;
+      lastDuration = pending.durationMs;
+      hasDuration = true;
+      hasPending = false;
+      if (!Push(pending) || pending.originalIndex >= m_endFrame) break;
+    }
+
+    pending = std::move(frame);
+    frame = Frame();
+    hasPending = true;
+  }
+
+  if (hasPending)
+  {
+    // The last frame repeats the duration of the one before.
+    pending.durationMs = hasDuration ? lastDuration : 0;
+    pending.originalTimestampMs = pending.timestampMs;
+    Push(pending);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_done = true;
+  }
+  m_cv.notify_all();
+}
+
+// Opens a dump for streaming: a scan for frame count, timing mode and estimated playback time, then the reader for
+// the actual frames. Both use the same parser, zip entries are decompressed for each of them.
+static std::unique_ptr<FrameSource> OpenFrameSource(const std::string& path, InputFormat format, uint8_t outDepth,
+                                                    bool strictMode, bool parallel, uint32_t startFrame,
+                                                    uint32_t endFrame, bool delaySet, uint32_t delayMs,
+                                                    DumpScan& scan)
+{
+  std::unique_ptr<DumpInput> pScanInput = DumpInput::Open(path, format);
+  if (!pScanInput) return nullptr;
+  std::unique_ptr<FrameParser> pScanParser = CreateFrameParser(*pScanInput, outDepth, strictMode, parallel);
+  ScanDump(*pScanParser, startFrame, endFrame, delaySet, delayMs, scan);
+  pScanParser.reset();
+  pScanInput.reset();
+
+  std::unique_ptr<DumpInput> pInput = DumpInput::Open(path, format);
+  if (!pInput) return nullptr;
+  std::unique_ptr<FrameParser> pParser = CreateFrameParser(*pInput, outDepth, strictMode, parallel);
+  return std::make_unique<FrameSource>(std::move(pInput), std::move(pParser), scan.monotonic, startFrame, endFrame);
+}
+
+static bool ParseServer(const std::string& value, std::string& host, int& port)
 {
   if (value.empty()) return false;
   size_t colon = value.find_last_of(':');
@@ -1090,24 +1784,36 @@ static uint64_t GetProcessRssBytes()
 #endif
 }
 
-static uint64_t HashFrameRgb565(const std::vector<uint16_t>& data16)
+static uint64_t GetProcessPeakRssBytes()
 {
-  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data16.data());
-  const size_t byteCount = data16.size() * sizeof(uint16_t);
-  uint64_t hash = 1469598103934665603ull;  // FNV-1a
-  for (size_t i = 0; i < byteCount; ++i)
+#if defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS_EX pmc{};
+  if (GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&pmc), sizeof(pmc)))
   {
-    hash ^= bytes[i];
-    hash *= 1099511628211ull;
+    return static_cast<uint64_t>(pmc.PeakWorkingSetSize);
   }
-  hash ^= byteCount;
-  hash *= 1099511628211ull;
-  return hash;
+  return 0;
+#elif defined(__APPLE__) || defined(__linux__)
+  struct rusage usage{};
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+  {
+    return 0;
+  }
+#if defined(__APPLE__)
+  return static_cast<uint64_t>(usage.ru_maxrss);  // bytes on macOS
+#else
+  return static_cast<uint64_t>(usage.ru_maxrss) * 1024u;  // kilobytes on Linux
+#endif
+#else
+  return 0;
+#endif
 }
 
-static uint64_t HashBytesFNV1a64(const uint8_t* bytes, size_t byteCount)
+static uint64_t HashFrameRgb565(const std::vector<uint16_t>& data16)
 {
-  uint64_t hash = 1469598103934665603ull;
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data16.data());
+  const size_t byteCount = data16.size() * sizeof(uint16_t);
+  uint64_t hash = 1469598103934665603ull;  // FNV-1a
   for (size_t i = 0; i < byteCount; ++i)
   {
     hash ^= bytes[i];
@@ -1236,7 +1942,7 @@ static void WriteFeatureFlagNames(std::ostream& out, uint32_t featureFlags)
 }
 
 static LiveJsonFrameRecord MakeLiveJsonFrameRecord(uint32_t index, const Frame& frame,
-                                                   const DMDUtil::DMD::SerumCapture& capture)
+                                                   const DMDUtil::DMD::SerumCaptureRecord& capture)
 {
   LiveJsonFrameRecord record;
   record.index = index;
@@ -1251,9 +1957,9 @@ static LiveJsonFrameRecord MakeLiveJsonFrameRecord(uint32_t index, const Frame&
   record.hasOutput = capture.hasOutput;
   record.hasOutputTimestamp = capture.hasTimestamp;
   record.outputTimestampMs = capture.outputTimestampMs;
-  record.outputWidth = capture.update.width;
-  record.outputHeight = capture.update.height;
-  record.outputMode = capture.update.mode;
+  record.outputWidth = capture.outputWidth;
+  record.outputHeight = capture.outputHeight;
+  record.outputMode = capture.outputMode;
   record.serumResult = capture.serumResult;
   record.serumVersion = capture.serumVersion;
   record.serumFrameId = capture.serumFrameId;
@@ -1262,30 +1968,49 @@ static LiveJsonFrameRecord MakeLiveJsonFrameRecord(uint32_t index, const Frame&
   record.serumFeatureFlags = capture.serumFeatureFlags;
   record.colorizeTimeUs = capture.colorizeTimeUs;
   record.averageColorizeTimeUs = capture.averageColorizeTimeUs;
+  record.outputHashFNV1a64 = capture.outputHashFNV1a64;
+  return record;
+}
+
+// Collects the Serum captures the DMD delivers on its Serum thread, so playback can keep queueing frames and pick a
+// capture up once its frame left the pipeline.
+class SerumCaptureCollector
+{
+ public:
+  explicit SerumCaptureCollector(DMDUtil::DMD& dmd) : m_dmd(dmd) { m_dmd.SetSerumCaptureCallback(&OnCapture, this); }
+  ~SerumCaptureCollector() { m_dmd.SetSerumCaptureCallback(nullptr, nullptr); }
 
-  if (capture.hasOutput)
+  // Older captures that were never asked for are dropped.
+  bool Take(uint64_t sourceOrdinal, DMDUtil::DMD::SerumCaptureRecord& record, uint32_t timeoutMs)
   {
-    if (capture.update.mode == DMDUtil::DMD::Mode::RGB24)
-    {
-      record.outputHashFNV1a64 =
-          HashBytesFNV1a64(capture.update.data, static_cast<size_t>(capture.update.width) * capture.update.height * 3u);
-    }
-    else if (capture.update.mode == DMDUtil::DMD::Mode::SerumV1 || capture.update.mode == DMDUtil::DMD::Mode::Data ||
-             capture.update.mode == DMDUtil::DMD::Mode::NotColorized || capture.update.mode == DMDUtil::DMD::Mode::Vni)
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!m_cv.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                       [&]() { return m_records.find(sourceOrdinal) != m_records.end(); }))
     {
-      record.outputHashFNV1a64 =
-          HashBytesFNV1a64(capture.update.data, static_cast<size_t>(capture.update.width) * capture.update.height);
+      return false;
     }
-    else
+    auto it = m_records.find(sourceOrdinal);
+    record = std::move(it->second);
+    m_records.erase(m_records.begin(), std::next(it));
+    return true;
+  }
+
+ private:
+  static void DMDUTILCALLBACK OnCapture(const DMDUtil::DMD::SerumCaptureRecord& record, void* pUserData)
+  {
+    SerumCaptureCollector* const pCollector = static_cast<SerumCaptureCollector*>(pUserData);
     {
-      record.outputHashFNV1a64 =
-          HashBytesFNV1a64(reinterpret_cast<const uint8_t*>(capture.update.segData),
-                           static_cast<size_t>(capture.update.width) * capture.update.height * sizeof(uint16_t));
+      std::lock_guard<std::mutex> lock(pCollector->m_mutex);
+      pCollector->m_records[record.sourceOrdinal] = record;
     }
+    pCollector->m_cv.notify_all();
   }
 
-  return record;
-}
+  DMDUtil::DMD& m_dmd;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::map<uint64_t, DMDUtil::DMD::SerumCaptureRecord> m_records;
+};
 
 static uint64_t HashFrameInputSignature(const Frame& frame)
 {
@@ -1726,26 +2451,7 @@ static bool WriteFilteredTextDump(const std::string& outputPath, const std::vect
 
 static uint64_t ComputePlannedSleepMsForFrame(const Frame& frame, bool delaySet, uint32_t delayMs)
 {
-  if (delaySet)
-  {
-    uint32_t sleepMs = delayMs;
-    if (frame.durationMs > 0 && frame.durationMs < sleepMs)
-    {
-      sleepMs = frame.durationMs;
-    }
-    return sleepMs;
-  }
-  return frame.durationMs;
-}
-
-static uint64_t ComputeEstimatedPlaybackMs(const std::vector<Frame>& frames, bool delaySet, uint32_t delayMs)
-{
-  uint64_t totalMs = 0;
-  for (const Frame& frame : frames)
-  {
-    totalMs += ComputePlannedSleepMsForFrame(frame, delaySet, delayMs);
-  }
-  return totalMs;
+  return ComputePlannedSleepMs(frame.durationMs, delaySet, delayMs);
 }
 
 static std::string FormatDurationMs(uint64_t durationMs)
@@ -1765,59 +2471,90 @@ static std::string FormatDurationMs(uint64_t durationMs)
   return oss.str();
 }
 
-static bool WaitForDumpersToSettle(DMDUtil::DMD& dmd, std::atomic<bool>& stopRequested)
+// Nearest-rank percentile, values must be sorted.
+static uint32_t PercentileOf(const std::vector<uint32_t>& sortedValues, uint32_t percentile)
 {
-  constexpr auto kQuietWindow = std::chrono::milliseconds(5);
-  constexpr auto kMaxSettleWindow = std::chrono::milliseconds(50);
+  if (sortedValues.empty()) return 0;
+  size_t rank = (static_cast<size_t>(percentile) * sortedValues.size() + 99) / 100;
+  if (rank == 0) rank = 1;
+  return sortedValues[std::min(rank, sortedValues.size()) - 1];
+}
 
-  const auto settleDeadline = std::chrono::steady_clock::now() + kMaxSettleWindow;
-  bool warnedAboutMovingTarget = false;
+static const char* ColorizeCallName(DMDUtil::DMD::ColorizeCall call)
+{
+  switch (call)
+  {
+    case DMDUtil::DMD::ColorizeCall::SerumColorize:
+      return "Serum_Colorize";
+    case DMDUtil::DMD::ColorizeCall::SerumRotate:
+      return "Serum_Rotate";
+    case DMDUtil::DMD::ColorizeCall::SerumSceneTrigger:
+      return "Serum_Scene_Trigger";
+    case DMDUtil::DMD::ColorizeCall::VniColorize:
+      return "Vni_Colorize";
+  }
+  return "unknown";
+}
 
-  while (!stopRequested.load(std::memory_order_acquire))
+static const char* ColorizeResultName(DMDUtil::DMD::ColorizeResult result)
+{
+  switch (result)
   {
-    const uint16_t target = dmd.GetUpdateQueuePosition();
-    while (!stopRequested.load(std::memory_order_acquire) && !dmd.WaitForDumpers(target, 0))
-    {
-      if (std::chrono::steady_clock::now() >= settleDeadline)
-      {
-        if (!warnedAboutMovingTarget)
-        {
-          std::cout << "Dump settle timeout: queue kept moving, continuing with current output\n";
-        }
-        return false;
-      }
-      std::this_thread::sleep_for(std::chrono::milliseconds(1));
-    }
+    case DMDUtil::DMD::ColorizeResult::NewFrame:
+      return "new";
+    case DMDUtil::DMD::ColorizeResult::SameFrame:
+      return "same";
+    case DMDUtil::DMD::ColorizeResult::NoFrame:
+      return "none";
+    case DMDUtil::DMD::ColorizeResult::Rotation:
+      return "rotation";
+  }
+  return "unknown";
+}
 
-    bool stable = true;
-    const auto quietDeadline = std::chrono::steady_clock::now() + kQuietWindow;
-    while (!stopRequested.load(std::memory_order_acquire) && std::chrono::steady_clock::now() < quietDeadline)
-    {
-      if (dmd.GetUpdateQueuePosition() != target)
-      {
-        stable = false;
-        warnedAboutMovingTarget = true;
-        break;
-      }
-      std::this_thread::sleep_for(std::chrono::milliseconds(1));
-    }
+static void PrintBenchmarkReport(size_t frames, uint64_t elapsedUs, std::vector<uint32_t>& colorizeTimesUs,
+                                 const std::vector<DMDUtil::DMD::ColorizeTimingStats>& colorizeProfile,
+                                 const std::vector<DMDUtil::DMD::SinkStats>& sinksBefore,
+                                 const std::vector<DMDUtil::DMD::SinkStats>& sinksAfter, uint64_t peakRssBytes)
+{
+  const double seconds = static_cast<double>(std::max<uint64_t>(elapsedUs, 1)) / 1000000.0;
+  std::cout << "Benchmark: frames=" << frames << " elapsed=" << FormatDurationMs(elapsedUs / 1000)
+            << " fps=" << std::fixed << std::setprecision(1) << (static_cast<double>(frames) / seconds) << "\n";
 
-    if (stable)
-    {
-      return true;
-    }
+  if (!colorizeTimesUs.empty())
+  {
+    std::sort(colorizeTimesUs.begin(), colorizeTimesUs.end());
+    uint64_t totalUs = 0;
+    for (uint32_t value : colorizeTimesUs) totalUs += value;
+    std::cout << "Benchmark colorize: samples=" << colorizeTimesUs.size()
+              << " avgUs=" << (totalUs / colorizeTimesUs.size()) << " p50Us=" << PercentileOf(colorizeTimesUs, 50)
+              << " p90Us=" << PercentileOf(colorizeTimesUs, 90) << " p99Us=" << PercentileOf(colorizeTimesUs, 99)
+              << " maxUs=" << colorizeTimesUs.back() << "\n";
+  }
+  else
+  {
+    std::cout << "Benchmark colorize: no Serum captures\n";
+  }
 
-    if (std::chrono::steady_clock::now() >= settleDeadline)
-    {
-      if (warnedAboutMovingTarget)
-      {
-        std::cout << "Dump settle timeout: queue kept moving, continuing with current output\n";
-      }
-      return false;
-    }
+  for (const auto& entry : colorizeProfile)
+  {
+    std::cout << "Benchmark profile " << ColorizeCallName(entry.call) << " " << ColorizeResultName(entry.result)
+              << " flags=0x" << std::hex << entry.featureFlags << std::dec << ": calls=" << entry.count
+              << " avgUs=" << (entry.totalUs / std::max<uint64_t>(entry.count, 1)) << " p50Us=" << entry.p50Us
+              << " p90Us=" << entry.p90Us << " p99Us=" << entry.p99Us << " maxUs=" << entry.maxUs << "\n";
   }
 
-  return false;
+  for (size_t i = 0; i < sinksAfter.size() && i < sinksBefore.size(); ++i)
+  {
+    const uint64_t sinkFrames = sinksAfter[i].frames - sinksBefore[i].frames;
+    if (sinkFrames == 0 && !sinksAfter[i].active) continue;
+    std::cout << "Benchmark sink " << sinksAfter[i].name << ": frames=" << sinkFrames
+              << " fps=" << (static_cast<double>(sinkFrames) / seconds) << "\n";
+  }
+
+  std::cout << "Benchmark peak RSS: " << (peakRssBytes / (1024.0 * 1024.0)) << "MB\n";
+  std::cout.unsetf(std::ios::floatfield);
+  std::cout << std::setprecision(6);
 }
 
 static void SendStartupWarmupFrame(DMDUtil::DMD& dmd, const Frame& frame, uint8_t indexedDepth)
@@ -1925,17 +2662,13 @@ static bool WriteJsonDump(const std::string& sourceDumpPath, const std::string&
                           const std::string& inputPath, const std::string& romName)
 {
   uint8_t depth = 2;
-  std::vector<Frame> frames;
-  std::ifstream source(sourceDumpPath);
+  DumpScan scan;
+  std::unique_ptr<FrameSource> source = OpenFrameSource(sourceDumpPath, InputFormat::Rgb565, depth, false, true, 0,
+                                                        std::numeric_limits<uint32_t>::max(), false, 0, scan);
   if (!source)
   {
     return false;
   }
-  if (!LoadRgb565DumpStream(source, depth, frames, false))
-  {
-    return false;
-  }
-  FinalizeFrameDurations(frames);
 
   std::ofstream out(outputJsonPath, std::ios::binary | std::ios::trunc);
   if (!out)
@@ -1948,22 +2681,295 @@ static bool WriteJsonDump(const std::string& sourceDumpPath, const std::string&
   out << "  \"input\": \"" << inputPath << "\",\n";
   out << "  \"rom\": \"" << romName << "\",\n";
   out << "  \"sourceDump565\": \"" << sourceDumpPath << "\",\n";
-  out << "  \"frameCount\": " << frames.size() << ",\n";
   out << "  \"frames\": [\n";
-  for (size_t i = 0; i < frames.size(); ++i)
+  // Frames are streamed, so the final count is only known after the array.
+  size_t frameCount = 0;
+  Frame frame;
+  while (source->Next(frame))
   {
-    const Frame& frame = frames[i];
+    if (frameCount > 0) out << ",\n";
     const uint64_t hash = HashFrameRgb565(frame.data16);
-    out << "    {\"index\": " << i << ", \"timestampMs\": " << frame.timestampMs
+    out << "    {\"index\": " << frameCount << ", \"timestampMs\": " << frame.timestampMs
         << ", \"durationMs\": " << frame.durationMs << ", \"width\": " << frame.width
         << ", \"height\": " << frame.height << ", \"format\": \"rgb565\", \"hashFNV1a64\": " << hash << "}";
-    if (i + 1 < frames.size()) out << ",";
-    out << "\n";
+    ++frameCount;
+  }
+  if (frameCount == 0)
+  {
+    return false;
+  }
+  out << "\n";
+  out << "  ],\n";
+  out << "  \"frameCount\": " << frameCount << "\n";
+  out << "}\n";
+  return true;
+}
+
+struct BatchInput
+{
+  std::string path;
+  std::string rom;
+  std::string jsonPath;
+};
+
+struct BatchJob
+{
+  std::string rom;
+  std::string name;
+  std::vector<size_t> inputs;
+  int exitCode = -1;
+  uint64_t elapsedMs = 0;
+};
+
+static bool IsDumpFileName(const std::string& name)
+{
+  return EndsWithCaseInsensitive(name, ".txt") || EndsWithCaseInsensitive(name, ".raw") ||
+         EndsWithCaseInsensitive(name, ".zip");
+}
+
+// Dumps written by libdmdutil are named <rom>-<8 char suffix>.<ext>, the ROM name is what Serum needs.
+static std::string DeriveDumpRomName(const std::string& path)
+{
+  std::string name = GetBaseName(path);
+  if (EndsWithCaseInsensitive(name, ".zip")) name = StripExtension(name);
+  if (EndsWithCaseInsensitive(name, ".txt") || EndsWithCaseInsensitive(name, ".raw")) name = StripExtension(name);
+  if (EndsWithCaseInsensitive(name, ".565") || EndsWithCaseInsensitive(name, ".888")) name = StripExtension(name);
+
+  const size_t dash = name.find_last_of('-');
+  if (dash != std::string::npos && dash > 0 && name.size() - dash - 1 == 8)
+  {
+    bool isSuffix = true;
+    for (size_t i = dash + 1; i < name.size(); ++i)
+    {
+      const char ch = name[i];
+      if (!((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9'))) isSuffix = false;
+    }
+    if (isSuffix) name.resize(dash);
   }
+  return name;
+}
+
+// A directory contributes its dump files, sorted by name. A manifest lists one dump per line, optionally followed by
+// a tab and the ROM name; relative paths are resolved against the manifest's directory and # starts a comment.
+static bool CollectBatchInputs(const std::string& batchPath, std::vector<BatchInput>& outInputs)
+{
+  namespace fs = std::filesystem;
+  std::error_code ec;
+  if (fs::is_directory(batchPath, ec))
+  {
+    std::vector<std::string> paths;
+    for (const auto& entry : fs::directory_iterator(batchPath, ec))
+    {
+      if (ec) break;
+      if (!entry.is_regular_file()) continue;
+      if (IsDumpFileName(entry.path().filename().string())) paths.push_back(entry.path().string());
+    }
+    std::sort(paths.begin(), paths.end());
+    for (const std::string& path : paths)
+    {
+      BatchInput input;
+      input.path = path;
+      outInputs.push_back(std::move(input));
+    }
+    return !ec;
+  }
+
+  std::ifstream manifest(batchPath);
+  if (!manifest)
+  {
+    return false;
+  }
+  const fs::path baseDir = fs::path(batchPath).parent_path();
+  std::string line;
+  while (std::getline(manifest, line))
+  {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (line.empty() || line[0] == '#') continue;
+
+    BatchInput input;
+    const size_t tab = line.find('\t');
+    input.path = line.substr(0, tab);
+    if (tab != std::string::npos) input.rom = line.substr(tab + 1);
+    if (input.path.empty()) continue;
+    if (fs::path(input.path).is_relative()) input.path = (baseDir / input.path).string();
+    outInputs.push_back(std::move(input));
+  }
+  return true;
+}
+
+// Returns the frameCount field of a JSON dump written by this tool, or -1.
+static int64_t ReadJsonDumpFrameCount(const std::string& jsonPath)
+{
+  std::ifstream in(jsonPath, std::ios::binary);
+  if (!in)
+  {
+    return -1;
+  }
+  const std::string key = "\"frameCount\": ";
+  std::string line;
+  while (std::getline(in, line))
+  {
+    const size_t pos = line.find(key);
+    if (pos != std::string::npos) return strtoll(line.c_str() + pos + key.size(), nullptr, 10);
+  }
+  return -1;
+}
+
+static bool WriteBatchReport(const std::string& reportPath, const std::vector<BatchInput>& inputs,
+                             const std::vector<BatchJob>& jobs, unsigned int workerCount, bool reuseSerum,
+                             uint64_t elapsedMs, size_t& outFailed)
+{
+  std::ofstream out(reportPath, std::ios::binary | std::ios::trunc);
+  if (!out)
+  {
+    return false;
+  }
+
+  std::ostringstream dumps;
+  outFailed = 0;
+  bool first = true;
+  for (size_t jobIndex = 0; jobIndex < jobs.size(); ++jobIndex)
+  {
+    const BatchJob& job = jobs[jobIndex];
+    for (size_t inputIndex : job.inputs)
+    {
+      const BatchInput& input = inputs[inputIndex];
+      const int64_t frameCount = ReadJsonDumpFrameCount(input.jsonPath);
+      const bool ok = job.exitCode == 0 && frameCount >= 0;
+      if (!ok) ++outFailed;
+      if (!first) dumps << ",\n";
+      first = false;
+      dumps << "    {\"input\": \"" << EscapeJsonString(input.path) << "\", \"rom\": \"" << EscapeJsonString(job.rom)
+            << "\", \"job\": " << jobIndex << ", \"ok\": " << (ok ? "true" : "false")
+            << ", \"exitCode\": " << job.exitCode << ", \"jobElapsedMs\": " << job.elapsedMs
+            << ", \"frameCount\": " << (frameCount >= 0 ? frameCount : 0) << ", \"json\": \""
+            << EscapeJsonString(input.jsonPath) << "\", \"log\": \"" << EscapeJsonString(job.name + ".log") << "\"}";
+    }
+  }
+
+  out << "{\n";
+  out << "  \"schema\": \"dmdutil.playdump.batch.v1\",\n";
+  out << "  \"workers\": " << workerCount << ",\n";
+  out << "  \"reuseSerum\": " << (reuseSerum ? "true" : "false") << ",\n";
+  out << "  \"elapsedMs\": " << elapsedMs << ",\n";
+  out << "  \"dumpCount\": " << inputs.size() << ",\n";
+  out << "  \"failedCount\": " << outFailed << ",\n";
+  out << "  \"dumps\": [\n";
+  out << dumps.str() << "\n";
   out << "  ]\n";
   out << "}\n";
   return true;
 }
+
+// Serum and the Config singleton are process-wide, so every job runs in its own dmdutil-play-dump process. With
+// reuseSerum all dumps of a ROM go to the same process, which plays them back to back on a single Serum load.
+static int RunBatch(const char* program, const std::string& batchPath, const std::string& outputDir,
+                    unsigned int workerCount, bool reuseSerum, const char* rom,
+                    const std::vector<std::string>& forwardArgs)
+{
+  namespace fs = std::filesystem;
+  std::vector<BatchInput> inputs;
+  if (!CollectBatchInputs(batchPath, inputs))
+  {
+    std::cerr << "Error: Failed to read batch input " << batchPath << "\n";
+    return 1;
+  }
+  if (inputs.empty())
+  {
+    std::cerr << "Error: No dumps found in " << batchPath << "\n";
+    return 1;
+  }
+  std::error_code ec;
+  fs::create_directories(outputDir, ec);
+  if (ec)
+  {
+    std::cerr << "Error: Failed to create batch output directory " << outputDir << "\n";
+    return 1;
+  }
+
+  std::vector<BatchJob> jobs;
+  std::unordered_map<std::string, size_t> jobByRom;
+  for (size_t i = 0; i < inputs.size(); ++i)
+  {
+    BatchInput& input = inputs[i];
+    if (rom && rom[0] != '\0') input.rom = rom;
+    if (input.rom.empty()) input.rom = DeriveDumpRomName(input.path);
+
+    std::ostringstream name;
+    name << std::setw(4) << std::setfill('0') << i << "-" << StripExtension(GetBaseName(input.path));
+    input.jsonPath = (fs::path(outputDir) / (name.str() + ".json")).string();
+
+    if (reuseSerum)
+    {
+      auto it = jobByRom.find(input.rom);
+      if (it != jobByRom.end())
+      {
+        jobs[it->second].inputs.push_back(i);
+        continue;
+      }
+      jobByRom[input.rom] = jobs.size();
+    }
+    BatchJob job;
+    job.rom = input.rom;
+    job.name = reuseSerum ? "rom-" + input.rom : name.str();
+    job.inputs.push_back(i);
+    jobs.push_back(std::move(job));
+  }
+
+  if (workerCount == 0) workerCount = std::max(1u, std::thread::hardware_concurrency());
+  workerCount = std::min<unsigned int>(workerCount, static_cast<unsigned int>(jobs.size()));
+  std::cout << "Batch start: " << inputs.size() << " dumps in " << jobs.size() << " jobs, " << workerCount
+            << " worker processes\n";
+
+  const auto batchStart = std::chrono::steady_clock::now();
+  std::atomic<size_t> doneJobs{0};
+  std::mutex outputMutex;
+  auto runJob = [&](size_t jobIndex)
+  {
+    BatchJob& job = jobs[jobIndex];
+
+    const fs::path jobDir = fs::path(outputDir) / job.name;
+    std::error_code dirEc;
+    fs::create_directories(jobDir, dirEc);
+
+    std::string command = DMDUtil::QuoteCommandArgument(program);
+    for (const std::string& arg : forwardArgs) command += " " + DMDUtil::QuoteCommandArgument(arg);
+    command += " --no-local";
+    command += " " + DMDUtil::QuoteCommandArgument("--rom=" + job.rom);
+    command += " " + DMDUtil::QuoteCommandArgument("--dump-path=" + jobDir.string());
+    for (size_t inputIndex : job.inputs)
+    {
+      command += " " + DMDUtil::QuoteCommandArgument("--input=" + inputs[inputIndex].path);
+      command += " " + DMDUtil::QuoteCommandArgument("--dump-json=" + inputs[inputIndex].jsonPath);
+    }
+    command += " > " + DMDUtil::QuoteCommandArgument((fs::path(outputDir) / (job.name + ".log")).string()) + " 2>&1";
+
+    const auto jobStart = std::chrono::steady_clock::now();
+    job.exitCode = DMDUtil::RunCommand(command);
+    job.elapsedMs = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - jobStart).count());
+
+    std::lock_guard<std::mutex> lock(outputMutex);
+    std::cout << "Batch progress: " << (doneJobs.fetch_add(1) + 1) << "/" << jobs.size() << " " << job.name
+              << " (" << job.inputs.size() << " dumps) exit=" << job.exitCode
+              << " elapsed=" << FormatDurationMs(job.elapsedMs) << "\n";
+  };
+
+  DMDUtil::RunJobPool(jobs.size(), workerCount, runJob, &g_stopRequested);
+
+  const uint64_t elapsedMs = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - batchStart).count());
+  const std::string reportPath = (fs::path(outputDir) / "report.json").string();
+  size_t failed = 0;
+  if (!WriteBatchReport(reportPath, inputs, jobs, workerCount, reuseSerum, elapsedMs, failed))
+  {
+    std::cerr << "Error: Failed to write batch report " << reportPath << "\n";
+    return 1;
+  }
+  std::cout << "Batch finished: " << (inputs.size() - failed) << "/" << inputs.size() << " dumps succeeded in "
+            << FormatDurationMs(elapsedMs) << ", report written to " << reportPath << "\n";
+  return (failed == 0 && !g_stopRequested.load(std::memory_order_acquire)) ? 0 : 1;
+}
 }  // namespace
 
 static struct cag_option options[] = {
@@ -2067,6 +3073,32 @@ static struct cag_option options[] = {
      .value_name = "N",
      .description = "Replay/dump only frames up to zero-based frame index N"},
     {.identifier = 'R', .access_letters = "R", .access_name = "raw", .description = "Force raw dump parsing"},
+    {.identifier = 'F',
+     .access_name = "reference-parser",
+     .description = "Parse text dumps with the single-threaded reference parser (optional)"},
+    {.identifier = 'B',
+     .access_name = "benchmark",
+     .description = "Feed frames as fast as the pipeline accepts them, keep timestamps as metadata only and report "
+                    "throughput"},
+    {.identifier = 'B', .access_name = "as-fast-as-possible", .description = "Same as --benchmark"},
+    {.identifier = 'I',
+     .access_name = "synchronous",
+     .description = "Return from each frame only after Serum, the dumpers and all displays processed it (optional)"},
+    {.identifier = 'b',
+     .access_name = "batch",
+     .value_name = "DIR|MANIFEST",
+     .description = "Play every dump of a directory or manifest in parallel worker processes and write a JSON report"},
+    {.identifier = 'O',
+     .access_name = "batch-output",
+     .value_name = "DIR",
+     .description = "Batch mode: directory for the JSON dumps, logs and report.json (optional, default is batch)"},
+    {.identifier = 'J',
+     .access_name = "jobs",
+     .value_name = "N",
+     .description = "Batch mode: number of worker processes (optional, default is the number of cores)"},
+    {.identifier = 'Y',
+     .access_name = "reuse-serum",
+     .description = "Batch mode: play all dumps of a ROM in one worker so the Serum colorization is loaded once"},
     {.identifier = 'h', .access_letters = "h", .access_name = "help", .description = "Show help"}};
 
 int main(int argc, char* argv[])
@@ -2074,11 +3106,11 @@ int main(int argc, char* argv[])
   char identifier;
   cag_option_context cag_context;
 
-  const char* opt_input = nullptr;
+  std::vector<std::string> opt_inputs;
   const char* opt_alt_color_path = nullptr;
   const char* opt_server = nullptr;
   const char* opt_dump_path = nullptr;
-  const char* opt_dump_json = nullptr;
+  std::vector<std::string> opt_dump_jsons;
   const char* opt_coverage_json = nullptr;
   const char* opt_rom = nullptr;
   uint32_t opt_coverage_transition_tail = 0;
@@ -2098,6 +3130,15 @@ int main(int argc, char* argv[])
   uint32_t opt_startup_delay_ms = 0;
   bool opt_delay_set = true;
   bool opt_crash_trace = false;
+  bool opt_reference_parser = false;
+  bool opt_benchmark = false;
+  bool opt_synchronous = false;
+  const char* opt_batch = nullptr;
+  const char* opt_batch_output = nullptr;
+  uint32_t opt_jobs = 0;
+  bool opt_reuse_serum = false;
+  // Options a batch passes on to its worker processes.
+  std::vector<std::string> forwardArgs;
 
   cag_option_init(&cag_context, options, CAG_ARRAY_SIZE(options), argc, argv);
   while (cag_option_fetch(&cag_context))
@@ -2106,13 +3147,18 @@ int main(int argc, char* argv[])
     switch (identifier)
     {
       case 'i':
-        opt_input = cag_option_get_value(&cag_context);
+      {
+        const char* valueStr = cag_option_get_value(&cag_context);
+        if (valueStr) opt_inputs.push_back(valueStr);
         break;
+      }
       case 'a':
         opt_alt_color_path = cag_option_get_value(&cag_context);
+        if (opt_alt_color_path) forwardArgs.push_back(std::string("--alt-color-path=") + opt_alt_color_path);
         break;
       case 'd':
         opt_depth = (uint8_t)atoi(cag_option_get_value(&cag_context));
+        forwardArgs.push_back("--depth=" + std::to_string(opt_depth));
         break;
       case 's':
         opt_server = cag_option_get_value(&cag_context);
@@ -2140,6 +3186,7 @@ int main(int argc, char* argv[])
           int value = atoi(valueStr);
           if (value >= 0) opt_delay_ms = (uint32_t)value;
         }
+        forwardArgs.push_back("--delay-ms=" + std::to_string(opt_delay_ms));
         break;
       }
       case 'W':
@@ -2150,6 +3197,7 @@ int main(int argc, char* argv[])
           int value = atoi(valueStr);
           if (value >= 0) opt_startup_delay_ms = (uint32_t)value;
         }
+        forwardArgs.push_back("--startup-delay-ms=" + std::to_string(opt_startup_delay_ms));
         break;
       }
       case 'o':
@@ -2158,36 +3206,60 @@ int main(int argc, char* argv[])
       case 'l':
         DMDUtil::Config::GetInstance()->SetLogCallback(LogToStdoutCallback);
         DMDUtil::Config::GetInstance()->SetLogLevel(DMDUtil_LogLevel_DEBUG);
+        forwardArgs.push_back("--logging");
         break;
       case 'E':
         DMDUtil::Config::GetInstance()->SetExcludeColorizedFramesForZeDMD(true);
+        forwardArgs.push_back("--exclude-zedmd");
         break;
       case 'G':
         DMDUtil::Config::GetInstance()->SetExcludeColorizedFramesForRGB24DMD(true);
+        forwardArgs.push_back("--exclude-rgb24dmd");
         break;
       case 'P':
         DMDUtil::Config::GetInstance()->SetExcludeColorizedFramesForPIN2DMD(true);
+        forwardArgs.push_back("--exclude-pin2dmd");
         break;
       case 'C':
         DMDUtil::Config::GetInstance()->SetExcludeColorizedFramesForPixelcade(true);
+        forwardArgs.push_back("--exclude-pixelcade");
         break;
       case 'r':
         opt_rom = cag_option_get_value(&cag_context);
         break;
       case 'R':
         opt_force_raw = true;
+        forwardArgs.push_back("--raw");
+        break;
+      case 'F':
+        opt_reference_parser = true;
+        forwardArgs.push_back("--reference-parser");
+        break;
+      case 'B':
+        opt_benchmark = true;
+        forwardArgs.push_back("--benchmark");
+        break;
+      case 'I':
+        opt_synchronous = true;
+        forwardArgs.push_back("--synchronous");
         break;
       case 'x':
         opt_crash_trace = true;
+        forwardArgs.push_back("--crash-trace");
         break;
       case 'j':
-        opt_dump_json = cag_option_get_value(&cag_context);
+      {
+        const char* valueStr = cag_option_get_value(&cag_context);
+        opt_dump_jsons.push_back(valueStr ? valueStr : "");
         break;
+      }
       case 'q':
         opt_serum_profile = true;
+        forwardArgs.push_back("--serum-profile");
         break;
       case 'Q':
         opt_serum_profile_sparse = true;
+        forwardArgs.push_back("--serum-profile-sparse");
         break;
       case 'k':
         opt_coverage_json = cag_option_get_value(&cag_context);
@@ -2229,6 +3301,7 @@ int main(int argc, char* argv[])
             opt_start_frame = static_cast<uint32_t>(value);
           }
         }
+        forwardArgs.push_back("--start-frame=" + std::to_string(opt_start_frame));
         break;
       }
       case 'U':
@@ -2242,8 +3315,31 @@ int main(int argc, char* argv[])
             opt_end_frame = static_cast<uint32_t>(value);
           }
         }
+        forwardArgs.push_back("--end-frame=" + std::to_string(opt_end_frame));
+        break;
+      }
+      case 'b':
+        opt_batch = cag_option_get_value(&cag_context);
+        break;
+      case 'O':
+        opt_batch_output = cag_option_get_value(&cag_context);
+        break;
+      case 'J':
+      {
+        const char* valueStr = cag_option_get_value(&cag_context);
+        if (valueStr)
+        {
+          int value = atoi(valueStr);
+          if (value >= 0)
+          {
+            opt_jobs = static_cast<uint32_t>(value);
+          }
+        }
         break;
       }
+      case 'Y':
+        opt_reuse_serum = true;
+        break;
       case 'h':
         std::cerr << "Usage: " << argv[0] << " [OPTION]...\n";
         cag_option_print(options, CAG_ARRAY_SIZE(options), stdout);
@@ -2256,9 +3352,23 @@ int main(int argc, char* argv[])
     InstallCrashTraceHandlers();
   }
 
-  std::signal(SIGINT, HandleSigInt);
-
-  if (!opt_input)
+  std::signal(SIGINT, HandleSigInt);
+
+  if (opt_batch)
+  {
+    if (!opt_inputs.empty() || !opt_dump_jsons.empty() || opt_coverage_json || opt_server || opt_dump_zip)
+    {
+      std::cerr << "Error: --batch can't be combined with --input, --dump-json, --coverage-json, --server or "
+                   "--dump-zip\n";
+      return 1;
+    }
+    if (opt_dump_txt) forwardArgs.push_back("--dump-txt");
+    if (opt_dump_888) forwardArgs.push_back("--dump-888");
+    return RunBatch(argv[0], opt_batch, (opt_batch_output && opt_batch_output[0] != '\0') ? opt_batch_output : "batch",
+                    opt_jobs, opt_reuse_serum, opt_rom, forwardArgs);
+  }
+
+  if (opt_inputs.empty())
   {
     std::cerr << "Error: Missing input file\n";
     std::cerr << "Usage: " << argv[0] << " -i MY_DUMP_FILE.txt\n";
@@ -2271,9 +3381,17 @@ int main(int argc, char* argv[])
     std::cerr << "Error: Depth must be 2 or 4\n";
     return 1;
   }
-  if (opt_dump_json && opt_dump_json[0] == '\0')
+  for (const std::string& dumpJson : opt_dump_jsons)
+  {
+    if (dumpJson.empty())
+    {
+      std::cerr << "Error: --dump-json requires a non-empty file path\n";
+      return 1;
+    }
+  }
+  if (opt_dump_jsons.size() > 1 && opt_dump_jsons.size() != opt_inputs.size())
   {
-    std::cerr << "Error: --dump-json requires a non-empty file path\n";
+    std::cerr << "Error: Several --dump-json files need one per --input\n";
     return 1;
   }
   if (opt_coverage_json && opt_coverage_json[0] == '\0')
@@ -2281,13 +3399,25 @@ int main(int argc, char* argv[])
     std::cerr << "Error: --coverage-json requires a non-empty file path\n";
     return 1;
   }
-  if (opt_dump_json && opt_dump_zip)
+  if (!opt_dump_jsons.empty() && opt_dump_zip)
   {
     std::cerr << "Error: --dump-json currently does not support --dump-zip\n";
     return 1;
   }
-  const bool liveJsonRequested = opt_dump_json && opt_alt_color_path && opt_alt_color_path[0] != '\0';
-  if (opt_dump_json)
+  const bool serumRequested = opt_alt_color_path && opt_alt_color_path[0] != '\0';
+  // Several inputs play back to back on one DMD, so Serum is loaded once per ROM.
+  const bool multipleInputs = opt_inputs.size() > 1;
+  if (multipleInputs && opt_coverage_json)
+  {
+    std::cerr << "Error: --coverage-json supports a single --input only\n";
+    return 1;
+  }
+  if (multipleInputs && !opt_dump_jsons.empty() && (opt_dump_jsons.size() != opt_inputs.size() || !serumRequested))
+  {
+    std::cerr << "Error: --dump-json with several inputs needs one file per --input and --alt-color-path\n";
+    return 1;
+  }
+  if (!opt_dump_jsons.empty())
   {
     opt_dump_565 = true;
   }
@@ -2306,162 +3436,132 @@ int main(int argc, char* argv[])
     SetEnvFlag("SERUM_PROFILE_SPARSE_VECTORS", "1");
   }
 
-  std::string inputPath = opt_input;
-  InputFormat format = InputFormat::Txt;
-  if (IsZipFile(inputPath))
-  {
-    format = InputFormat::Zip;
-  }
-  else if (opt_force_raw || EndsWithCaseInsensitive(inputPath, ".raw"))
+  DMDUtil::Config* config = DMDUtil::Config::GetInstance();
+  if (opt_alt_color_path && opt_alt_color_path[0] != '\0')
   {
-    format = InputFormat::Raw;
+    config->SetAltColor(true);
+    config->SetAltColorPath(opt_alt_color_path);
   }
-  else if (EndsWithCaseInsensitive(inputPath, ".565.txt"))
+  if (opt_server && opt_server[0] != '\0')
   {
-    format = InputFormat::Rgb565;
+    std::string host;
+    int port = 6789;
+    ParseServer(opt_server, host, port);
+    config->SetDMDServer(true);
+    config->SetDMDServerAddr(host.c_str());
+    config->SetDMDServerPort(port);
+    config->SetLocalDisplaysActive(!opt_no_local);
   }
-  else if (EndsWithCaseInsensitive(inputPath, ".888.txt"))
+  else if (opt_no_local)
   {
-    format = InputFormat::Rgb888;
+    config->SetLocalDisplaysActive(false);
   }
 
-  std::vector<Frame> frames;
-  switch (format)
+  struct PlaybackInput
   {
-    case InputFormat::Raw:
-      if (!LoadRawDump(inputPath, opt_depth, frames)) return 1;
-      break;
-    case InputFormat::Rgb565:
-      if (!LoadRgb565Dump(inputPath, opt_depth, frames)) return 1;
-      break;
-    case InputFormat::Rgb888:
-      if (!LoadRgb888Dump(inputPath, opt_depth, frames)) return 1;
-      break;
-    case InputFormat::Zip:
-      if (!LoadZipDump(inputPath, opt_depth, frames)) return 1;
-      break;
-    case InputFormat::Txt:
-    default:
-      if (!LoadTxtDump(inputPath, opt_depth, frames)) return 1;
-      break;
-  }
-  FinalizeFrameDurations(frames);
+    std::string path;
+    std::string romName;
+    DumpScan scan;
+    std::unique_ptr<FrameSource> source;
+    Frame frame;
+    bool haveFrame = false;
+  };
 
-  std::vector<uint64_t> frameInputSignatures;
-  frameInputSignatures.reserve(frames.size());
-  std::vector<uint32_t> playbackOriginalIndices;
-  playbackOriginalIndices.reserve(frames.size());
-  for (size_t i = 0; i < frames.size(); ++i)
-  {
-    playbackOriginalIndices.push_back(static_cast<uint32_t>(i));
-  }
-  for (const Frame& frame : frames)
+  auto openInput = [&](const std::string& inputPath, PlaybackInput& input) -> bool
   {
-    frameInputSignatures.push_back(HashFrameInputSignature(frame));
-  }
+    input.path = inputPath;
+    InputFormat format = InputFormat::Txt;
+    if (IsZipFile(inputPath))
+    {
+      format = InputFormat::Zip;
+    }
+    else if (opt_force_raw || EndsWithCaseInsensitive(inputPath, ".raw"))
+    {
+      format = InputFormat::Raw;
+    }
+    else if (EndsWithCaseInsensitive(inputPath, ".565.txt"))
+    {
+      format = InputFormat::Rgb565;
+    }
+    else if (EndsWithCaseInsensitive(inputPath, ".888.txt"))
+    {
+      format = InputFormat::Rgb888;
+    }
 
-  if (!frames.empty() && (opt_start_frame > 0 || opt_end_frame != std::numeric_limits<uint32_t>::max()))
-  {
-    const size_t originalCount = frames.size();
-    const size_t startIndex = std::min<size_t>(opt_start_frame, frames.size());
-    const size_t endIndexExclusive = std::min<size_t>(frames.size(), static_cast<size_t>(opt_end_frame) + 1);
+    input.source = OpenFrameSource(inputPath, format, opt_depth, true, !opt_reference_parser, opt_start_frame,
+                                   opt_end_frame, opt_delay_set, opt_delay_ms, input.scan);
+    if (!input.source) return false;
 
-    if (startIndex >= endIndexExclusive)
+    // Prime the first frame before any display is opened, so empty or broken dumps fail early.
+    input.haveFrame = input.source->Next(input.frame);
+    if (!input.haveFrame && (input.source->Failed() || input.scan.frameCount == 0))
     {
-      frames.clear();
-      frameInputSignatures.clear();
-      playbackOriginalIndices.clear();
+      if (!input.source->Failed()) std::cerr << "Error: No frames found in " << input.source->Name() << " dump\n";
+      return false;
     }
-    else
+
+    if (opt_start_frame > 0 || opt_end_frame != std::numeric_limits<uint32_t>::max())
     {
-      frames = std::vector<Frame>(frames.begin() + static_cast<std::ptrdiff_t>(startIndex),
-                                  frames.begin() + static_cast<std::ptrdiff_t>(endIndexExclusive));
-      frameInputSignatures =
-          std::vector<uint64_t>(frameInputSignatures.begin() + static_cast<std::ptrdiff_t>(startIndex),
-                                frameInputSignatures.begin() + static_cast<std::ptrdiff_t>(endIndexExclusive));
-      playbackOriginalIndices =
-          std::vector<uint32_t>(playbackOriginalIndices.begin() + static_cast<std::ptrdiff_t>(startIndex),
-                                playbackOriginalIndices.begin() + static_cast<std::ptrdiff_t>(endIndexExclusive));
+      std::cout << "Frame window selected [" << opt_start_frame << ", ";
+      if (opt_end_frame == std::numeric_limits<uint32_t>::max())
+      {
+        std::cout << "end";
+      }
+      else
+      {
+        std::cout << opt_end_frame;
+      }
+      std::cout << "], kept " << input.scan.windowFrameCount << " frames out of " << input.scan.frameCount << "\n";
     }
 
-    std::cout << "Frame window selected [" << opt_start_frame << ", ";
-    if (opt_end_frame == std::numeric_limits<uint32_t>::max())
+    if (opt_rom && opt_rom[0] != '\0')
     {
-      std::cout << "end";
+      input.romName = opt_rom;
     }
     else
     {
-      std::cout << opt_end_frame;
+      input.romName = StripExtension(GetBaseName(inputPath));
     }
-    std::cout << "], kept " << frames.size() << " frames out of " << originalCount << "\n";
-  }
 
-  std::string romName;
-  if (opt_rom && opt_rom[0] != '\0')
-  {
-    romName = opt_rom;
-  }
-  else
-  {
-    romName = StripExtension(GetBaseName(inputPath));
-  }
+    if (input.romName.empty()) input.romName = "dump";
+    if (input.romName.size() > DMDUTIL_MAX_NAME_SIZE - 1)
+    {
+      input.romName.resize(DMDUTIL_MAX_NAME_SIZE - 1);
+    }
+    return true;
+  };
 
-  if (romName.empty()) romName = "dump";
-  if (romName.size() > DMDUTIL_MAX_NAME_SIZE - 1)
+  auto startupWarmup = [&](DMDUtil::DMD& dmd, const PlaybackInput& input)
   {
-    romName.resize(DMDUTIL_MAX_NAME_SIZE - 1);
-  }
+    if (opt_startup_delay_ms > 0 && input.haveFrame)
+    {
+      SendStartupWarmupFrame(dmd, input.frame, opt_depth);
+      std::cout << "Startup warmup: sent black frame " << input.frame.width << "x" << input.frame.height
+                << ", waiting " << opt_startup_delay_ms << "ms for colorization load\n";
+      std::this_thread::sleep_for(std::chrono::milliseconds(opt_startup_delay_ms));
+    }
+  };
 
-  DMDUtil::Config* config = DMDUtil::Config::GetInstance();
-  if (opt_alt_color_path && opt_alt_color_path[0] != '\0')
-  {
-    config->SetAltColor(true);
-    config->SetAltColorPath(opt_alt_color_path);
-  }
-  if (opt_server && opt_server[0] != '\0')
-  {
-    std::string host;
-    int port = 6789;
-    ParseServer(opt_server, host, port);
-    config->SetDMDServer(true);
-    config->SetDMDServerAddr(host.c_str());
-    config->SetDMDServerPort(port);
-    config->SetLocalDisplaysActive(!opt_no_local);
-  }
-  else if (opt_no_local)
-  {
-    config->SetLocalDisplaysActive(false);
-  }
+  PlaybackInput input;
+  if (!openInput(opt_inputs[0], input)) return 1;
 
   DMDUtil::DMD dmd;
-  dmd.SetRomName(romName.c_str());
+  if (opt_synchronous) dmd.SetExecutionMode(DMDUtil::DMD::ExecutionMode::Synchronous);
+  // Without pacing, rotations and dump timing have to follow the dump timestamps instead of the wall clock.
+  if (opt_benchmark) dmd.SetClockMode(DMDUtil::DMD::ClockMode::FrameTimestamps);
+  dmd.SetRomName(input.romName.c_str());
   if (opt_alt_color_path && opt_alt_color_path[0] != '\0')
   {
     dmd.SetAltColorPath(opt_alt_color_path);
   }
   dmd.FindDisplays();
 
-  for (int i = 0; i < 100 && DMDUtil::DMD::IsFinding(); ++i)
+  for (int i = 0; i < 100 && dmd.IsFinding(); ++i)
   {
     std::this_thread::sleep_for(std::chrono::milliseconds(50));
   }
 
-  const auto dumpStartTime = std::chrono::steady_clock::now();
-  std::vector<LiveJsonFrameRecord> liveJsonFrames;
-  bool liveJsonActive = liveJsonRequested;
-  bool liveJsonFallback = false;
-  if (liveJsonRequested)
-  {
-    liveJsonFrames.reserve(frames.size());
-    std::cout << "Live JSON capture requested for Serum playback metadata\n";
-  }
-  if (opt_startup_delay_ms > 0 && !frames.empty())
-  {
-    SendStartupWarmupFrame(dmd, frames.front(), opt_depth);
-    std::cout << "Startup warmup: sent black frame " << frames.front().width << "x" << frames.front().height
-              << ", waiting " << opt_startup_delay_ms << "ms for colorization load\n";
-    std::this_thread::sleep_for(std::chrono::milliseconds(opt_startup_delay_ms));
-  }
+  startupWarmup(dmd, input);
   if (opt_dump_txt || opt_dump_565 || opt_dump_888)
   {
     if (opt_dump_path && opt_dump_path[0] != '\0')
@@ -2477,291 +3577,434 @@ int main(int argc, char* argv[])
     if (opt_dump_888) dmd.DumpDMDRgb888();
   }
 
-  const uint8_t dumpR = 255;
-  const uint8_t dumpG = 69;
-  const uint8_t dumpB = 0;
-  const bool dumpEnabled = opt_dump_txt || opt_dump_565 || opt_dump_888;
-  const bool serumProfilingEnabled = opt_serum_profile || opt_serum_profile_sparse;
-  uint64_t peakRssBytes = 0;
-  uint32_t profiledFrames = 0;
-  const size_t totalFramesToPlay = frames.size();
-  const uint64_t estimatedPlaybackMs = ComputeEstimatedPlaybackMs(frames, opt_delay_set, opt_delay_ms);
-  uint64_t playedPlannedMs = 0;
-  size_t playedFramesCount = 0;
-  std::cout << "Playback start: " << totalFramesToPlay << " frames"
-            << ", estimated duration=" << FormatDurationMs(estimatedPlaybackMs) << "\n";
-  auto lastProgressLog = std::chrono::steady_clock::now();
+  // Capture ordinals keep counting across inputs, so no stale capture of a previous input can match.
+  uint64_t ordinalBase = 0;
+  auto playInput = [&](PlaybackInput& current, const char* dumpJsonPath) -> bool
+  {
+    const std::string& inputPath = current.path;
+    const std::string& romName = current.romName;
+    const DumpScan& scan = current.scan;
+    std::unique_ptr<FrameSource>& source = current.source;
+    Frame& frame = current.frame;
+    bool& haveFrame = current.haveFrame;
+    const bool liveJsonRequested = dumpJsonPath && serumRequested;
+    // The benchmark report takes its colorize times from the Serum captures, so frames carry their context then too.
+    const bool captureRequested = liveJsonRequested || (opt_benchmark && serumRequested);
+
+    const auto dumpStartTime = std::chrono::steady_clock::now();
+    std::vector<LiveJsonFrameRecord> liveJsonFrames;
+    bool liveJsonActive = liveJsonRequested;
+    bool liveJsonFallback = false;
+    if (liveJsonRequested)
+    {
+      liveJsonFrames.reserve(scan.windowFrameCount);
+      std::cout << "Live JSON capture requested for Serum playback metadata\n";
+    }
+
+    const uint8_t dumpR = 255;
+    const uint8_t dumpG = 69;
+    const uint8_t dumpB = 0;
+    const bool dumpEnabled = opt_dump_txt || opt_dump_565 || opt_dump_888;
+    const bool serumProfilingEnabled = opt_serum_profile || opt_serum_profile_sparse;
+    uint64_t peakRssBytes = 0;
+    uint32_t profiledFrames = 0;
+    const size_t totalFramesToPlay = scan.windowFrameCount;
+    const uint64_t estimatedPlaybackMs = scan.estimatedPlaybackMs;
+    // Coverage export selects from all played frames, so only then they are kept after playback.
+    const bool coverageRequested = opt_coverage_json && opt_coverage_json[0] != '\0';
+    std::vector<Frame> coveragePlayedFrames;
+    std::vector<uint64_t> coveragePlayedSignatures;
+    uint64_t playedPlannedMs = 0;
+    size_t playedFramesCount = 0;
+    std::cout << "Playback start: " << totalFramesToPlay << " frames"
+              << ", estimated duration=" << FormatDurationMs(estimatedPlaybackMs);
+    if (opt_benchmark) std::cout << " (benchmark, not paced)";
+    std::cout << "\n";
+    auto lastProgressLog = std::chrono::steady_clock::now();
+    constexpr size_t kDumpFencesInFlight = 16;
+    std::deque<DMDUtil::DMD::FenceId> dumpFences;
+
+    // A bounded window of frames stays in the pipeline. The Serum capture of a frame is collected once its fence
+    // resolved, instead of waiting for every capture right after queueing the frame.
+    struct InFlightFrame
+    {
+      DMDUtil::DMD::FenceId fence = 0;
+      uint64_t ordinal = 0;
+      uint32_t index = 0;
+      Frame header;  // Dimensions and format only, for the live JSON record.
+    };
+    std::deque<InFlightFrame> inFlightFrames;
+    std::vector<uint32_t> colorizeTimesUs;
+    bool captureActive = captureRequested;
+    std::unique_ptr<SerumCaptureCollector> captures;
+    if (captureRequested) captures = std::make_unique<SerumCaptureCollector>(dmd);
+    auto retireInFlightFrame = [&]()
+    {
+      const InFlightFrame& inFlight = inFlightFrames.front();
+      dmd.WaitFence(inFlight.fence, 2000);
+      if (captureActive)
+      {
+        DMDUtil::DMD::SerumCaptureRecord capture;
+        const uint32_t captureTimeoutMs = (inFlight.index == 0) ? 5000u : 250u;
+        if (captures->Take(inFlight.ordinal, capture, captureTimeoutMs))
+        {
+          colorizeTimesUs.push_back(capture.colorizeTimeUs);
+          if (liveJsonActive)
+          {
+            liveJsonFrames.push_back(MakeLiveJsonFrameRecord(inFlight.index, inFlight.header, capture));
+          }
+        }
+        else
+        {
+          captureActive = false;
+          captures.reset();
+          std::cout << "No Serum capture for playback frame " << inFlight.index;
+          if (opt_benchmark) std::cout << ", colorize times are incomplete";
+          std::cout << "\n";
+          if (liveJsonActive)
+          {
+            liveJsonActive = false;
+            liveJsonFallback = true;
+            liveJsonFrames.clear();
+            std::cout << "Live JSON fallback: using generated .565 dump instead\n";
+          }
+        }
+      }
+      inFlightFrames.pop_front();
+    };
+    const std::vector<DMDUtil::DMD::SinkStats> sinksBefore = dmd.GetSinkStats();
+    dmd.ResetColorizeProfile();
+    const auto playbackStartTime = std::chrono::steady_clock::now();
 
-  for (size_t frameIndex = 0; frameIndex < frames.size(); ++frameIndex)
-  {
-    const Frame& frame = frames[frameIndex];
-    if (g_stopRequested.load(std::memory_order_acquire))
+    for (size_t frameIndex = 0; haveFrame; ++frameIndex)
     {
-      break;
-    }
-
-    const uint32_t queueTimestamp = frame.originalTimestampMs;
-    DMDUtil::DMD::FrameContext frameContext;
-    frameContext.valid = true;
-    frameContext.sourceOrdinal = frameIndex;
-    frameContext.sourceFrameIndex = static_cast<uint32_t>(frameIndex);
-    frameContext.originalFrameIndex = frameIndex < playbackOriginalIndices.size() ? playbackOriginalIndices[frameIndex]
-                                                                                  : static_cast<uint32_t>(frameIndex);
-    frameContext.inputCrc32 = ComputeInputCrc32(frame);
-    frameContext.inputTimestampMs = frame.originalTimestampMs;
-    frameContext.inputDurationMs = frame.durationMs;
+      if (g_stopRequested.load(std::memory_order_acquire))
+      {
+        break;
+      }
 
-    if (frame.format == FrameFormat::RGB565)
-    {
-      if (!frame.data16.empty())
+      const uint32_t queueTimestamp = frame.originalTimestampMs;
+      DMDUtil::DMD::FrameContext frameContext;
+      frameContext.valid = true;
+      frameContext.sourceOrdinal = ordinalBase + frameIndex;
+      frameContext.sourceFrameIndex = static_cast<uint32_t>(frameIndex);
+      frameContext.originalFrameIndex = frame.originalIndex;
+      frameContext.inputCrc32 = ComputeInputCrc32(frame);
+      frameContext.inputTimestampMs = frame.originalTimestampMs;
+      frameContext.inputDurationMs = frame.durationMs;
+
+      if (frame.format == FrameFormat::RGB565)
       {
-        if (liveJsonRequested)
+        if (!frame.data16.empty())
         {
-          dmd.UpdateRGB16DataWithMetadataAndTimestamp(frame.data16.data(), frame.width, frame.height, queueTimestamp,
-                                                      frameContext, false);
+          if (captureRequested)
+          {
+            dmd.UpdateRGB16DataWithMetadataAndTimestamp(frame.data16.data(), frame.width, frame.height, queueTimestamp,
+                                                        frameContext, false);
+          }
+          else
+          {
+            dmd.UpdateRGB16DataWithTimestamp(frame.data16.data(), frame.width, frame.height, queueTimestamp, false);
+          }
         }
-        else
+      }
+      else if (frame.format == FrameFormat::RGB888)
+      {
+        if (!frame.data.empty())
         {
-          dmd.UpdateRGB16DataWithTimestamp(frame.data16.data(), frame.width, frame.height, queueTimestamp, false);
+          if (captureRequested)
+          {
+            dmd.UpdateRGB24DataWithMetadataAndTimestamp(frame.data.data(), frame.width, frame.height, queueTimestamp,
+                                                        frameContext, false);
+          }
+          else
+          {
+            dmd.UpdateRGB24DataWithTimestamp(frame.data.data(), frame.width, frame.height, queueTimestamp, false);
+          }
         }
       }
-    }
-    else if (frame.format == FrameFormat::RGB888)
-    {
-      if (!frame.data.empty())
+      else if (!frame.data.empty())
       {
-        if (liveJsonRequested)
+        if (captureRequested)
         {
-          dmd.UpdateRGB24DataWithMetadataAndTimestamp(frame.data.data(), frame.width, frame.height, queueTimestamp,
-                                                      frameContext, false);
+          dmd.UpdateDataWithMetadataAndTimestamp(frame.data.data(), opt_depth, frame.width, frame.height, dumpR, dumpG,
+                                                 dumpB, queueTimestamp, frameContext, false);
         }
         else
         {
-          dmd.UpdateRGB24DataWithTimestamp(frame.data.data(), frame.width, frame.height, queueTimestamp, false);
+          dmd.UpdateDataWithTimestamp(frame.data.data(), opt_depth, frame.width, frame.height, dumpR, dumpG, dumpB,
+                                      queueTimestamp, false);
         }
       }
-    }
-    else if (!frame.data.empty())
-    {
-      if (liveJsonRequested)
+
+      if (opt_benchmark || captureActive)
       {
-        dmd.UpdateDataWithMetadataAndTimestamp(frame.data.data(), opt_depth, frame.width, frame.height, dumpR, dumpG,
-                                               dumpB, queueTimestamp, frameContext, false);
+        InFlightFrame inFlight;
+        inFlight.fence = dmd.InsertFence();
+        inFlight.ordinal = frameContext.sourceOrdinal;
+        inFlight.index = static_cast<uint32_t>(frameIndex);
+        inFlight.header.width = frame.width;
+        inFlight.header.height = frame.height;
+        inFlight.header.format = frame.format;
+        inFlightFrames.push_back(std::move(inFlight));
+        if (inFlightFrames.size() > kDumpFencesInFlight) retireInFlightFrame();
       }
-      else
+
+      if (dumpEnabled && !opt_benchmark && !captureActive)
       {
-        dmd.UpdateDataWithTimestamp(frame.data.data(), opt_depth, frame.width, frame.height, dumpR, dumpG, dumpB,
-                                    queueTimestamp, false);
+        // Keep a bounded window of frames in flight instead of settling after every frame, so the
+        // dump stage stays busy while playback waits on the oldest outstanding fence only.
+        dumpFences.push_back(dmd.InsertFence());
+        if (dumpFences.size() > kDumpFencesInFlight)
+        {
+          dmd.WaitFence(dumpFences.front(), 2000);
+          dumpFences.pop_front();
+        }
       }
-    }
 
-    if (liveJsonActive)
-    {
-      DMDUtil::DMD::SerumCapture capture;
-      const uint32_t captureTimeoutMs = (frameIndex == 0) ? 5000u : 250u;
-      if (dmd.WaitForSerumColorizeCapture(frameContext.sourceOrdinal, capture, captureTimeoutMs))
+      const uint32_t sleepMs = static_cast<uint32_t>(ComputePlannedSleepMsForFrame(frame, opt_delay_set, opt_delay_ms));
+
+      if (sleepMs > 0 && !opt_benchmark)
       {
-        liveJsonFrames.push_back(MakeLiveJsonFrameRecord(static_cast<uint32_t>(frameIndex), frame, capture));
+        std::this_thread::sleep_for(std::chrono::milliseconds(sleepMs));
       }
-      else
+      playedPlannedMs += sleepMs;
+      playedFramesCount = frameIndex + 1;
+
+      const size_t playedFrames = frameIndex + 1;
+      const bool periodicFrameLog = !opt_benchmark && (playedFrames % 250) == 0;
+      const bool periodicTimeLog = std::chrono::steady_clock::now() - lastProgressLog >= std::chrono::seconds(1);
+      if (playedFrames == totalFramesToPlay || periodicFrameLog || periodicTimeLog)
       {
-        liveJsonActive = false;
-        liveJsonFallback = true;
-        liveJsonFrames.clear();
-        std::cout << "Live JSON fallback: no Serum capture for playback frame " << frameIndex
-                  << ", using generated .565 dump instead\n";
+        const double percent = totalFramesToPlay > 0
+                                   ? (100.0 * static_cast<double>(playedFrames) / static_cast<double>(totalFramesToPlay))
+                                   : 100.0;
+        uint64_t remainingMs = estimatedPlaybackMs > playedPlannedMs ? (estimatedPlaybackMs - playedPlannedMs) : 0;
+        if (opt_benchmark)
+        {
+          // Without pacing the planned durations say nothing about the remaining time, extrapolate the rate instead.
+          const uint64_t elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                         std::chrono::steady_clock::now() - playbackStartTime)
+                                         .count();
+          remainingMs = totalFramesToPlay > playedFrames ? elapsedMs * (totalFramesToPlay - playedFrames) / playedFrames
+                                                         : 0;
+        }
+        std::cout << "Playback progress: " << playedFrames << "/" << totalFramesToPlay << " (" << percent
+                  << "%), eta=" << FormatDurationMs(remainingMs) << "\n";
+        lastProgressLog = std::chrono::steady_clock::now();
       }
-    }
 
-    if (dumpEnabled)
-    {
-      WaitForDumpersToSettle(dmd, g_stopRequested);
+      if (serumProfilingEnabled)
+      {
+        const uint64_t rssBytes = GetProcessRssBytes();
+        if (rssBytes > peakRssBytes)
+        {
+          peakRssBytes = rssBytes;
+        }
+        ++profiledFrames;
+        if (profiledFrames % 240 == 0)
+        {
+          std::cout << "Profile RAM: rssMB=" << (rssBytes / (1024.0 * 1024.0))
+                    << " peakMB=" << (peakRssBytes / (1024.0 * 1024.0)) << " frames=" << profiledFrames << "\n";
+        }
+      }
+
+      if (coverageRequested)
+      {
+        coveragePlayedSignatures.push_back(HashFrameInputSignature(frame));
+        coveragePlayedFrames.push_back(std::move(frame));
+      }
+      haveFrame = source->Next(frame);
     }
 
-    const uint32_t sleepMs = static_cast<uint32_t>(ComputePlannedSleepMsForFrame(frame, opt_delay_set, opt_delay_ms));
+    ordinalBase += playedFramesCount;
 
-    if (sleepMs > 0)
+    if (source->Failed())
     {
-      std::this_thread::sleep_for(std::chrono::milliseconds(sleepMs));
+      std::cerr << "Error: Failed to read " << source->Name() << " dump, playback stopped after " << playedFramesCount
+                << " frames\n";
     }
-    playedPlannedMs += sleepMs;
-    playedFramesCount = frameIndex + 1;
 
-    const size_t playedFrames = frameIndex + 1;
-    const bool periodicFrameLog = (playedFrames % 250) == 0;
-    const bool periodicTimeLog = std::chrono::steady_clock::now() - lastProgressLog >= std::chrono::seconds(1);
-    if (playedFrames == totalFramesToPlay || periodicFrameLog || periodicTimeLog)
+    while (!inFlightFrames.empty()) retireInFlightFrame();
+
+    if (dumpEnabled)
     {
-      const double percent = totalFramesToPlay > 0
-                                 ? (100.0 * static_cast<double>(playedFrames) / static_cast<double>(totalFramesToPlay))
-                                 : 100.0;
-      const uint64_t remainingMs = estimatedPlaybackMs > playedPlannedMs ? (estimatedPlaybackMs - playedPlannedMs) : 0;
-      std::cout << "Playback progress: " << playedFrames << "/" << totalFramesToPlay << " (" << percent
-                << "%), eta=" << FormatDurationMs(remainingMs) << "\n";
-      lastProgressLog = std::chrono::steady_clock::now();
+      dumpFences.clear();
+      if (!dmd.Flush(2000)) std::cout << "Dump flush timeout: continuing with current output\n";
     }
 
-    if (serumProfilingEnabled)
+    if (opt_benchmark)
     {
-      const uint64_t rssBytes = GetProcessRssBytes();
-      if (rssBytes > peakRssBytes)
-      {
-        peakRssBytes = rssBytes;
-      }
-      ++profiledFrames;
-      if (profiledFrames % 240 == 0)
-      {
-        std::cout << "Profile RAM: rssMB=" << (rssBytes / (1024.0 * 1024.0))
-                  << " peakMB=" << (peakRssBytes / (1024.0 * 1024.0)) << " frames=" << profiledFrames << "\n";
-      }
+      const uint64_t elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                                     std::chrono::steady_clock::now() - playbackStartTime)
+                                     .count();
+      PrintBenchmarkReport(playedFramesCount, elapsedUs, colorizeTimesUs, dmd.GetColorizeProfile(), sinksBefore,
+                           dmd.GetSinkStats(), GetProcessPeakRssBytes());
     }
-  }
 
-  if (g_stopRequested.load(std::memory_order_acquire))
-  {
-    uint16_t target = dmd.GetUpdateQueuePosition();
-    for (int i = 0; i < 10; ++i)
+    if (g_stopRequested.load(std::memory_order_acquire))
     {
-      std::this_thread::sleep_for(std::chrono::milliseconds(10));
-      uint16_t current = dmd.GetUpdateQueuePosition();
-      if (current == target) break;
-      target = current;
+      std::cout << "Playback interrupted by SIGINT after " << playedFramesCount << "/" << totalFramesToPlay
+                << " frames\n";
     }
-    dmd.WaitForDumpers(target, 2000);
-    std::cout << "Playback interrupted by SIGINT after " << playedFramesCount << "/" << totalFramesToPlay
-              << " frames\n";
-  }
 
-  if (opt_dump_json)
-  {
-    if (liveJsonRequested && !liveJsonFallback && liveJsonFrames.size() == playedFramesCount)
+    if (dumpJsonPath)
     {
-      if (!WriteLiveJsonDump(opt_dump_json, inputPath, romName, liveJsonFrames))
+      if (liveJsonRequested && !liveJsonFallback && liveJsonFrames.size() == playedFramesCount)
+      {
+        if (!WriteLiveJsonDump(dumpJsonPath, inputPath, romName, liveJsonFrames))
+        {
+          std::cerr << "Error: Failed to write live JSON dump " << dumpJsonPath << "\n";
+          return false;
+        }
+        const auto elapsed =
+            std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - dumpStartTime)
+                .count();
+        std::cout << "Live JSON dump written to " << dumpJsonPath << " (frames=" << liveJsonFrames.size()
+                  << ", elapsed=" << elapsed << "ms)\n";
+      }
+      else
       {
-        std::cerr << "Error: Failed to write live JSON dump " << opt_dump_json << "\n";
-        return 1;
+        if (multipleInputs)
+        {
+          // The generated dump holds the frames of every input played so far.
+          std::cerr << "Error: No live Serum metadata for " << inputPath << ", JSON dump not written\n";
+          return false;
+        }
+        std::string latestRgb565DumpPath;
+        const std::string dumpDir = (opt_dump_path && opt_dump_path[0] != '\0') ? opt_dump_path : ".";
+        if (!FindLatestRgb565Dump(dumpDir, romName, latestRgb565DumpPath))
+        {
+          std::cerr << "Error: Failed to locate generated .565.txt dump for ROM " << romName << "\n";
+          return false;
+        }
+        if (!WriteJsonDump(latestRgb565DumpPath, dumpJsonPath, inputPath, romName))
+        {
+          std::cerr << "Error: Failed to write JSON dump " << dumpJsonPath << "\n";
+          return false;
+        }
+        const auto elapsed =
+            std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - dumpStartTime)
+                .count();
+        std::cout << "JSON dump written to " << dumpJsonPath << " (source: " << latestRgb565DumpPath
+                  << ", elapsed=" << elapsed << "ms)\n";
       }
-      const auto elapsed =
-          std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - dumpStartTime)
-              .count();
-      std::cout << "Live JSON dump written to " << opt_dump_json << " (frames=" << liveJsonFrames.size()
-                << ", elapsed=" << elapsed << "ms)\n";
     }
-    else
+
+    if (coverageRequested)
     {
-      std::string latestRgb565DumpPath;
-      const std::string dumpDir = (opt_dump_path && opt_dump_path[0] != '\0') ? opt_dump_path : ".";
-      if (!FindLatestRgb565Dump(dumpDir, romName, latestRgb565DumpPath))
+      const std::vector<Frame>& coverageFrames = coveragePlayedFrames;
+      const std::vector<uint64_t>& coverageSignatures = coveragePlayedSignatures;
+
+      const std::vector<LiveJsonFrameRecord>* coverageLiveFrames = nullptr;
+      std::vector<LiveJsonFrameRecord> partialLiveJsonFrames;
+      if (!liveJsonFrames.empty())
       {
-        std::cerr << "Error: Failed to locate generated .565.txt dump for ROM " << romName << "\n";
-        return 1;
+        if (playedFramesCount > 0 && playedFramesCount < liveJsonFrames.size())
+        {
+          partialLiveJsonFrames.assign(liveJsonFrames.begin(),
+                                       liveJsonFrames.begin() + static_cast<std::ptrdiff_t>(playedFramesCount));
+          coverageLiveFrames = &partialLiveJsonFrames;
+        }
+        else
+        {
+          coverageLiveFrames = &liveJsonFrames;
+        }
       }
-      if (!WriteJsonDump(latestRgb565DumpPath, opt_dump_json, inputPath, romName))
+
+      FrameFormat coverageFormat = FrameFormat::Indexed;
+      if (!FramesShareFormat(coverageFrames, coverageFormat))
       {
-        std::cerr << "Error: Failed to write JSON dump " << opt_dump_json << "\n";
-        return 1;
+        std::cerr << "Error: Coverage export frames do not share a single text dump format\n";
+        return false;
       }
-      const auto elapsed =
-          std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - dumpStartTime)
-              .count();
-      std::cout << "JSON dump written to " << opt_dump_json << " (source: " << latestRgb565DumpPath
-                << ", elapsed=" << elapsed << "ms)\n";
-    }
-  }
 
-  if (opt_coverage_json && opt_coverage_json[0] != '\0')
-  {
-    std::vector<Frame> coverageFrames;
-    std::vector<uint64_t> coverageSignatures;
-    if (playedFramesCount > 0 && playedFramesCount < frames.size())
-    {
-      coverageFrames.assign(frames.begin(), frames.begin() + static_cast<std::ptrdiff_t>(playedFramesCount));
-      coverageSignatures.assign(frameInputSignatures.begin(),
-                                frameInputSignatures.begin() + static_cast<std::ptrdiff_t>(playedFramesCount));
-    }
-    else
-    {
-      coverageFrames = frames;
-      coverageSignatures = frameInputSignatures;
-    }
+      const std::string coverageDumpPath = BuildCoverageDumpPath(opt_coverage_json, coverageFormat);
+      const std::vector<uint32_t> selectedCoverageIndices = BuildCoverageSelectedIndices(
+          coverageFrames, coverageSignatures, opt_coverage_transition_tail, opt_coverage_max_frames, coverageLiveFrames);
 
-    const std::vector<LiveJsonFrameRecord>* coverageLiveFrames = nullptr;
-    std::vector<LiveJsonFrameRecord> partialLiveJsonFrames;
-    if (!liveJsonFrames.empty())
-    {
-      if (playedFramesCount > 0 && playedFramesCount < liveJsonFrames.size())
+      if (!WriteCoverageJson(opt_coverage_json, inputPath, coverageFrames, coverageSignatures,
+                             opt_coverage_transition_tail, opt_coverage_max_frames, coverageLiveFrames,
+                             &coverageDumpPath))
       {
-        partialLiveJsonFrames.assign(liveJsonFrames.begin(),
-                                     liveJsonFrames.begin() + static_cast<std::ptrdiff_t>(playedFramesCount));
-        coverageLiveFrames = &partialLiveJsonFrames;
+        std::cerr << "Error: Failed to write coverage JSON " << opt_coverage_json << "\n";
+        return false;
+      }
+      std::vector<Frame> selectedCoverageFrames;
+      if (!selectedCoverageIndices.empty())
+      {
+        selectedCoverageFrames.reserve(selectedCoverageIndices.size());
+        size_t selectedPos = 0;
+        for (size_t i = 0; i < coverageFrames.size() && selectedPos < selectedCoverageIndices.size(); ++i)
+        {
+          if (selectedCoverageIndices[selectedPos] == i)
+          {
+            selectedCoverageFrames.push_back(coverageFrames[i]);
+            ++selectedPos;
+          }
+        }
       }
       else
       {
-        coverageLiveFrames = &liveJsonFrames;
+        selectedCoverageFrames = coverageFrames;
       }
-    }
 
-    FrameFormat coverageFormat = FrameFormat::Indexed;
-    if (!FramesShareFormat(coverageFrames, coverageFormat))
-    {
-      std::cerr << "Error: Coverage export frames do not share a single text dump format\n";
-      return 1;
-    }
-
-    const std::string coverageDumpPath = BuildCoverageDumpPath(opt_coverage_json, coverageFormat);
-    const std::vector<uint32_t> selectedCoverageIndices = BuildCoverageSelectedIndices(
-        coverageFrames, coverageSignatures, opt_coverage_transition_tail, opt_coverage_max_frames, coverageLiveFrames);
+      if (!WriteFilteredTextDump(coverageDumpPath, selectedCoverageFrames))
+      {
+        std::cerr << "Error: Failed to write coverage dump " << coverageDumpPath << "\n";
+        return false;
+      }
 
-    if (!WriteCoverageJson(opt_coverage_json, inputPath, coverageFrames, coverageSignatures,
-                           opt_coverage_transition_tail, opt_coverage_max_frames, coverageLiveFrames,
-                           &coverageDumpPath))
-    {
-      std::cerr << "Error: Failed to write coverage JSON " << opt_coverage_json << "\n";
-      return 1;
+      std::cout << "Coverage JSON written to " << opt_coverage_json << " (" << coverageFrames.size()
+                << " input frames)\n";
+      std::cout << "Coverage dump written to " << coverageDumpPath << " (" << selectedCoverageFrames.size()
+                << " selected frames)\n";
     }
-    std::vector<Frame> selectedCoverageFrames;
-    if (!selectedCoverageIndices.empty())
+
+    if (serumProfilingEnabled)
     {
-      selectedCoverageFrames.reserve(selectedCoverageIndices.size());
-      size_t selectedPos = 0;
-      for (size_t i = 0; i < coverageFrames.size() && selectedPos < selectedCoverageIndices.size(); ++i)
+      const uint64_t rssBytes = GetProcessRssBytes();
+      if (rssBytes > peakRssBytes)
       {
-        if (selectedCoverageIndices[selectedPos] == i)
-        {
-          selectedCoverageFrames.push_back(coverageFrames[i]);
-          ++selectedPos;
-        }
+        peakRssBytes = rssBytes;
       }
-    }
-    else
-    {
-      selectedCoverageFrames = coverageFrames;
+      std::cout << "Profile RAM final: rssMB=" << (rssBytes / (1024.0 * 1024.0))
+                << " peakMB=" << (peakRssBytes / (1024.0 * 1024.0)) << " frames=" << profiledFrames << "\n";
     }
 
-    if (!WriteFilteredTextDump(coverageDumpPath, selectedCoverageFrames))
-    {
-      std::cerr << "Error: Failed to write coverage dump " << coverageDumpPath << "\n";
-      return 1;
-    }
+    std::cout << "Playback finished: " << playedFramesCount << "/" << totalFramesToPlay << " frames processed\n";
 
-    std::cout << "Coverage JSON written to " << opt_coverage_json << " (" << coverageFrames.size()
-              << " input frames)\n";
-    std::cout << "Coverage dump written to " << coverageDumpPath << " (" << selectedCoverageFrames.size()
-              << " selected frames)\n";
-  }
+    return !source->Failed();
+  };
 
-  if (serumProfilingEnabled)
+  int exitCode = 0;
+  std::string loadedRom = input.romName;
+  for (size_t inputIndex = 0; inputIndex < opt_inputs.size(); ++inputIndex)
   {
-    const uint64_t rssBytes = GetProcessRssBytes();
-    if (rssBytes > peakRssBytes)
+    if (g_stopRequested.load(std::memory_order_acquire)) break;
+    if (inputIndex > 0)
     {
-      peakRssBytes = rssBytes;
+      input = PlaybackInput{};
+      if (!openInput(opt_inputs[inputIndex], input))
+      {
+        exitCode = 1;
+        continue;
+      }
+      std::cout << "Next input " << (inputIndex + 1) << "/" << opt_inputs.size() << ": " << input.path << "\n";
+      // The virtual clock restarts with the timeline of the next dump.
+      if (opt_benchmark) dmd.SetClockMode(DMDUtil::DMD::ClockMode::FrameTimestamps);
+      if (input.romName != loadedRom)
+      {
+        loadedRom = input.romName;
+        dmd.SetRomName(loadedRom.c_str());
+        startupWarmup(dmd, input);
+      }
     }
-    std::cout << "Profile RAM final: rssMB=" << (rssBytes / (1024.0 * 1024.0))
-              << " peakMB=" << (peakRssBytes / (1024.0 * 1024.0)) << " frames=" << profiledFrames << "\n";
-  }
 
-  std::cout << "Playback finished: " << playedFramesCount << "/" << totalFramesToPlay << " frames processed\n";
+    const char* dumpJsonPath = nullptr;
+    if (!opt_dump_jsons.empty()) dumpJsonPath = opt_dump_jsons[std::min(inputIndex, opt_dump_jsons.size() - 1)].c_str();
+    if (!playInput(input, dumpJsonPath)) exitCode = 1;
+  }
 
-  return 0;
+  return exitCode;
 }
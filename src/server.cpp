@@ -140,7 +140,7 @@ int main(int argc, char* argv[])
   while (true)
   {
     pDmd->FindDisplays();
-    while (DMDUtil::DMD::IsFinding()) this_thread::sleep_for(chrono::milliseconds(100));
+    while (pDmd->IsFinding()) this_thread::sleep_for(chrono::milliseconds(100));
 
     if (pDmd->HasDisplay() || !opt_wait) break;
     this_thread::sleep_for(chrono::milliseconds(1000));
@@ -10,7 +10,7 @@ int main(int argc, const char* argv[])
   printf("Finding displays...\n");
 
   pDmd->FindDisplays();
-  while (DMDUtil::DMD::IsFinding()) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  while (pDmd->IsFinding()) std::this_thread::sleep_for(std::chrono::milliseconds(100));
 
   if (!pDmd->HasDisplay())
   {
@@ -0,0 +1,307 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "DiscoveryCache.h"
+#include "FramePacer.h"
+#include "FrameUtil.h"
+#include "HexNibbles.h"
+#include "PixelcadePlaneEncoder.h"
+#include "ScalePlan.h"
+
+// Compares the fast paths of the library with the code they replace. Returns 1 if any of them differs.
+
+namespace
+{
+using namespace DMDUtil;
+
+uint32_t s_seed = 0x2545F491;
+
+uint32_t NextRandom()
+{
+  s_seed ^= s_seed << 13;
+  s_seed ^= s_seed >> 17;
+  s_seed ^= s_seed << 5;
+  return s_seed;
+}
+
+// Every second pixel is black if sparse is set, scale downs that pick lit pixels or average a block see both.
+void FillRandom(std::vector<uint8_t>& frame, int bytes, bool sparse)
+{
+  for (size_t i = 0; i < frame.size(); i += bytes)
+  {
+    const uint32_t value = NextRandom();
+    for (int b = 0; b < bytes; b++) frame[i + b] = (sparse && (value & 0x100)) ? 0 : (uint8_t)(value >> (8 * b));
+  }
+}
+
+bool TestHexNibbles()
+{
+  static const char kDigits[] = "0123456789abcdefABCDEF";
+  static const char kInvalid[] = "gG/:@`\x80\xff \n";
+  std::vector<char> text;
+  std::vector<uint8_t> fast;
+  std::vector<uint8_t> reference;
+
+  for (int run = 0; run < 10000; run++)
+  {
+    const size_t count = NextRandom() % 100;
+    text.resize(count);
+    for (char& ch : text) ch = kDigits[NextRandom() % (sizeof(kDigits) - 1)];
+    // Every fourth run has one invalid character, in the SIMD blocks as well as in the tail.
+    if (count > 0 && run % 4 == 0) text[NextRandom() % count] = kInvalid[NextRandom() % (sizeof(kInvalid) - 1)];
+
+    fast.assign(count, 0);
+    reference.assign(count, 0);
+    const bool fastOk = DecodeHexNibbles(text.data(), count, fast.data());
+    const bool referenceOk = DecodeHexNibblesScalar(text.data(), count, reference.data());
+    if (fastOk != referenceOk || (fastOk && fast != reference))
+    {
+      std::cerr << "Error: DecodeHexNibbles differs from the scalar decoder for " << std::string(text.data(), count)
+                << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+struct ScaleCase
+{
+  ScaleOp op;
+  uint16_t srcWidth;
+  uint16_t srcHeight;
+  uint16_t dstWidth;
+  uint16_t dstHeight;
+  uint8_t bits;
+  const char* name;
+};
+
+// The FrameUtil calls of ScalePlan::Apply().
+void ScaleReference(const ScaleCase& c, uint8_t* pDst, const uint8_t* pSrc)
+{
+  switch (c.op)
+  {
+    case ScaleOp::Center:
+      FrameUtil::Helper::Center(pDst, c.dstWidth, c.dstHeight, pSrc, c.srcWidth, c.srcHeight, c.bits);
+      break;
+
+    case ScaleOp::ScaleDown:
+      FrameUtil::Helper::ScaleDown(pDst, c.dstWidth, c.dstHeight, pSrc, c.srcWidth, c.srcHeight, c.bits);
+      break;
+
+    case ScaleOp::ScaleUp:
+      FrameUtil::Helper::ScaleUp(pDst, pSrc, c.srcWidth, c.srcHeight, c.bits);
+      break;
+
+    case ScaleOp::ScaleUpDown:
+    {
+      std::vector<uint8_t> upscaled(c.srcWidth * 2 * c.srcHeight * 2 * ((c.bits + 7) / 8));
+      FrameUtil::Helper::ScaleUp(upscaled.data(), pSrc, c.srcWidth, c.srcHeight, c.bits);
+      FrameUtil::Helper::ScaleDown(pDst, c.dstWidth, c.dstHeight, upscaled.data(), c.srcWidth * 2, c.srcHeight * 2,
+                                   c.bits);
+      break;
+    }
+
+    case ScaleOp::CenterIndexed:
+      FrameUtil::Helper::CenterIndexed(pDst, c.dstWidth, c.dstHeight, pSrc, c.srcWidth, c.srcHeight);
+      break;
+
+    case ScaleOp::ScaleDownIndexed:
+      FrameUtil::Helper::ScaleDownIndexed(pDst, c.dstWidth, c.dstHeight, pSrc, c.srcWidth, c.srcHeight);
+      break;
+
+    case ScaleOp::ScaleDownPUP:
+      FrameUtil::Helper::ScaleDownPUP(pDst, c.dstWidth, c.dstHeight, pSrc, c.srcWidth, c.srcHeight);
+      break;
+  }
+}
+
+bool TestScalePlans()
+{
+  // The sizes the display sinks scale between.
+  static const ScaleCase kCases[] = {
+      {ScaleOp::Center, 128, 16, 128, 32, 24, "Center RGB24"},
+      {ScaleOp::ScaleDown, 256, 64, 128, 32, 24, "ScaleDown RGB24"},
+      {ScaleOp::ScaleUp, 128, 32, 256, 64, 24, "ScaleUp RGB24"},
+      {ScaleOp::ScaleUpDown, 128, 32, 192, 64, 24, "ScaleUpDown RGB24"},
+      {ScaleOp::Center, 128, 16, 128, 32, 16, "Center RGB565"},
+      {ScaleOp::ScaleDown, 192, 64, 128, 32, 16, "ScaleDown RGB565"},
+      {ScaleOp::CenterIndexed, 128, 16, 128, 32, 8, "CenterIndexed"},
+      {ScaleOp::ScaleDownIndexed, 256, 64, 128, 32, 8, "ScaleDownIndexed"},
+      {ScaleOp::ScaleDownPUP, 192, 64, 128, 32, 8, "ScaleDownPUP"},
+  };
+
+  for (const ScaleCase& c : kCases)
+  {
+    const ScalePlan* pPlan = ScalePlan::Get(c.op, c.srcWidth, c.srcHeight, c.dstWidth, c.dstHeight, c.bits);
+    const int bytes = (c.bits + 7) / 8;
+    std::vector<uint8_t> src(c.srcWidth * c.srcHeight * bytes);
+    std::vector<uint8_t> fast(c.dstWidth * c.dstHeight * bytes);
+    std::vector<uint8_t> reference(fast.size());
+
+    for (int run = 0; run < 16; run++)
+    {
+      FillRandom(src, bytes, run % 2 == 1);
+      // Indexed frames hold palette indexes.
+      if (c.bits == 8)
+        for (uint8_t& index : src) index &= 0x0F;
+
+      pPlan->Run(fast.data(), src.data());
+      ScaleReference(c, reference.data(), src.data());
+      if (fast != reference)
+      {
+        std::cerr << "Error: ScalePlan " << c.name << (pPlan->IsMapped() ? " (mapped)" : "")
+                  << " differs from FrameUtil\n";
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool TestPixelcadePlaneEncoder()
+{
+  struct Panel
+  {
+    int width;
+    int height;
+    FrameUtil::ColorMatrix colorMatrix;
+    const char* name;
+  };
+  static const Panel kPanels[] = {
+      {128, 32, FrameUtil::ColorMatrix::Rgb, "128x32 RGB"},
+      {128, 32, FrameUtil::ColorMatrix::Rbg, "128x32 RBG"},
+      {64, 32, FrameUtil::ColorMatrix::Rgb, "64x32 RGB"},
+      {64, 32, FrameUtil::ColorMatrix::Rbg, "64x32 RBG"},
+  };
+
+  for (const Panel& panel : kPanels)
+  {
+    const int length = panel.width * panel.height;
+    PixelcadePlaneEncoder encoder(panel.width, panel.height, panel.colorMatrix);
+    if (!encoder.IsSupported())
+    {
+      std::cerr << "Error: No plane encoder for the " << panel.name << " panel\n";
+      return false;
+    }
+
+    std::vector<uint16_t> frame(length);
+    std::vector<uint8_t> planes(length * 3 / 2);
+    std::vector<uint8_t> reference(planes.size());
+    for (uint16_t& pixel : frame) pixel = (uint16_t)NextRandom();
+
+    for (int f = 0; f < 64; f++)
+    {
+      // Changes a few rows, every eighth frame all of them, and forces a full encode now and then.
+      const int changedRows = (f % 8 == 0) ? panel.height : (int)(NextRandom() % 4);
+      for (int r = 0; r < changedRows; r++)
+      {
+        const int y = (changedRows == panel.height) ? r : (int)(NextRandom() % panel.height);
+        for (int x = 0; x < panel.width; x++) frame[y * panel.width + x] = (uint16_t)NextRandom();
+      }
+      if (f % 16 == 15) encoder.Reset();
+
+      FrameUtil::Helper::SplitIntoRgbPlanes(frame.data(), length, panel.width, panel.height / 2, reference.data(),
+                                            panel.colorMatrix);
+      encoder.Encode(frame.data(), planes.data());
+      if (planes != reference)
+      {
+        std::cerr << "Error: " << panel.name << " frame " << f << " differs from SplitIntoRgbPlanes\n";
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool TestFramePacer()
+{
+  FramePacer pacer;
+  uint8_t frame[64] = {0};
+
+  if (!pacer.IsNewContent(frame, sizeof(frame)) || pacer.IsNewContent(frame, sizeof(frame)))
+  {
+    std::cerr << "Error: FramePacer doesn't skip a repeated frame\n";
+    return false;
+  }
+  frame[10] = 1;
+  if (!pacer.IsNewContent(frame, sizeof(frame)))
+  {
+    std::cerr << "Error: FramePacer skips a changed frame\n";
+    return false;
+  }
+
+  // The first sample is taken as is, the next ones move the average by an eighth. Unchanged counters add nothing.
+  pacer.RecordCumulativeCost(1000, 1);
+  pacer.RecordCumulativeCost(1000, 1);
+  pacer.RecordCumulativeCost(5000, 3);
+  if (pacer.GetCostUs() != 1125)
+  {
+    std::cerr << "Error: FramePacer cost is " << pacer.GetCostUs() << " us instead of 1125 us\n";
+    return false;
+  }
+
+  const FramePacer::Clock::time_point now = FramePacer::Clock::now();
+  pacer.RecordSend(now);
+  if (pacer.GetNextSend() != now + std::chrono::microseconds(1125))
+  {
+    std::cerr << "Error: FramePacer doesn't space the frames by their cost\n";
+    return false;
+  }
+  return true;
+}
+
+bool TestDiscoveryCache()
+{
+  const std::string path = (std::filesystem::temp_directory_path() / "dmdutil_test_fast_paths.ini").string();
+
+  DiscoveryCache cache;
+  cache.zedmd = {"/dev/ttyUSB0", "5.1.2", 128, 32, false, false};
+  cache.pixelcade = {"/dev/ttyACM0", "PIXELCADE-V2", 128, 32, true, true};
+  const bool saved = SaveDiscoveryCache(path, cache);
+  const DiscoveryCache loaded = LoadDiscoveryCache(path);
+  std::filesystem::remove(path);
+  if (!saved || !(loaded == cache))
+  {
+    std::cerr << "Error: DiscoveryCache doesn't round-trip through " << path << "\n";
+    return false;
+  }
+
+  if (!(LoadDiscoveryCache(path) == DiscoveryCache()))
+  {
+    std::cerr << "Error: A missing DiscoveryCache file doesn't give an empty cache\n";
+    return false;
+  }
+  return true;
+}
+}  // namespace
+
+int main()
+{
+  struct Test
+  {
+    const char* name;
+    bool (*run)();
+  };
+  static const Test kTests[] = {
+      {"DecodeHexNibbles", TestHexNibbles},
+      {"ScalePlan", TestScalePlans},
+      {"PixelcadePlaneEncoder", TestPixelcadePlaneEncoder},
+      {"FramePacer", TestFramePacer},
+      {"DiscoveryCache", TestDiscoveryCache},
+  };
+
+  int failed = 0;
+  for (const Test& test : kTests)
+  {
+    const bool passed = test.run();
+    printf("%s: %s\n", test.name, passed ? "passed" : "FAILED");
+    if (!passed) failed++;
+  }
+  return failed > 0 ? 1 : 0;
+}